@@ -568,6 +568,7 @@ void gen_code( Module *module, const FuncDef *fd, Stream *out, const t_labelMap
          case P_EVAL: csOpName = "EVAL"; break;
          case P_OOB : csOpName = "OOB "; break;
          case P_TRDN: csOpName = "TRDN"; break;
+         case P_INSW: csOpName = "INSW"; break;
          default:
             csOpName = "????";
       }
@@ -733,6 +734,49 @@ void gen_code( Module *module, const FuncDef *fd, Stream *out, const t_labelMap
          out->writeString( ".endswitch\n\n" );
 
       }
+      else if ( opcode == P_INSW )
+      {
+         // the set of an INSW: the landings are not used
+         out->writeString( "\n" );
+         uint32 advance = calc_next( code );
+         iPos += advance;
+         code += advance;
+
+         uint64 sw_count = (uint64) loadInt64( code - sizeof(int64) );
+         uint16 sw_int = (int16) (sw_count >> 48);
+         uint16 sw_str = (int16) (sw_count >> 16);
+
+         iPos += sizeof( int32 );
+         code += sizeof( int32 );
+
+         while( sw_int > 0 )
+         {
+            if (! options.m_isomorphic )
+               out->writeString( "\t\t" );
+            String temp = ".case ";
+            temp.writeNumber( (int64)  loadInt64( code ) );
+            out->writeString( temp + "\n" );
+            code += sizeof( int64 ) + sizeof( int32 );
+            iPos += sizeof( int64 ) + sizeof( int32 );
+            --sw_int;
+         }
+
+         while( sw_str > 0 )
+         {
+            if ( ! options.m_isomorphic )
+               out->writeString( "\t\t" );
+            out->writeString( ".case " );
+            write_string( out,  *reinterpret_cast<int32 *>(code), module );
+            out->writeString( "\n" );
+            code += sizeof( int32 ) + sizeof( int32 );
+            iPos += sizeof( int32 ) + sizeof( int32 );
+            --sw_str;
+         }
+
+         if ( !options.m_isomorphic )
+            out->writeString( "\t" );
+         out->writeString( ".endset\n" );
+      }
       else {
          uint32 advance = calc_next( code );
          iPos += advance;
@@ -786,7 +830,15 @@ void Analizer( FuncDef *fd, t_labelMap &labels )
       }
 
 
-      if ( opcode != P_SWCH ) {
+      if ( opcode == P_INSW ) {
+         // skip the set; it has no landings.
+         code += calc_next( code );
+         uint64 sw_count = (uint64) loadInt64( code - sizeof(int64) );
+         code += sizeof( int32 ) +
+               ((uint16) (sw_count >> 48)) * ( sizeof( int64 ) + sizeof( int32 ) ) +
+               ((uint16) (sw_count >> 16)) * ( sizeof( int32 ) + sizeof( int32 ) );
+      }
+      else if ( opcode != P_SWCH ) {
          code += calc_next( code );
       }
       else
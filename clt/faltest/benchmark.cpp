@@ -0,0 +1,277 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: benchmark.cpp
+
+   Repeated runs, statistics and reports for benchmark scripts.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 14:05:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Repeated runs, statistics and reports for benchmark scripts.
+*/
+
+#include <falcon/string.h>
+#include <falcon/stream.h>
+#include <algorithm>
+#include "benchmark.h"
+
+#define JSON_TIME_FMT "%.6f"
+#define JSON_OPS_FMT  "%.1f"
+
+namespace Falcon {
+
+BenchResult::BenchResult( const String &id, const String &filename,
+      const String &shortDesc, const String &category ):
+   m_id( id ),
+   m_filename( filename ),
+   m_short( shortDesc ),
+   m_category( category ),
+   m_ops( 0.0 )
+{
+   m_id.bufferize();
+   m_filename.bufferize();
+   m_short.bufferize();
+   m_category.bufferize();
+}
+
+
+void BenchResult::addSample( double time, double ops )
+{
+   m_samples.push_back( time );
+   if ( ops > 0.0 )
+      m_ops = ops;
+}
+
+
+double BenchResult::minimum() const
+{
+   if ( m_samples.empty() )
+      return 0.0;
+   return *std::min_element( m_samples.begin(), m_samples.end() );
+}
+
+
+double BenchResult::maximum() const
+{
+   if ( m_samples.empty() )
+      return 0.0;
+   return *std::max_element( m_samples.begin(), m_samples.end() );
+}
+
+
+double BenchResult::percentile( double pct ) const
+{
+   if ( m_samples.empty() )
+      return 0.0;
+
+   std::vector<double> sorted( m_samples );
+   std::sort( sorted.begin(), sorted.end() );
+
+   // nearest rank: the smallest sample with at least pct% of the samples below or at it.
+   uint32 rank = (uint32) ( pct / 100.0 * sorted.size() + 0.999999 );
+   if ( rank == 0 )
+      rank = 1;
+   else if ( rank > sorted.size() )
+      rank = sorted.size();
+   return sorted[ rank - 1 ];
+}
+
+
+double BenchResult::opsPerSec() const
+{
+   double med = median();
+   if ( m_ops <= 0.0 || med <= 0.0 )
+      return 0.0;
+   return m_ops / med;
+}
+
+
+static void s_jsonString( String &target, const String &value )
+{
+   target += '"';
+   for ( uint32 i = 0; i < value.length(); ++i )
+   {
+      uint32 chr = value.getCharAt( i );
+      switch( chr )
+      {
+         case '"': target += "\\\""; break;
+         case '\\': target += "\\\\"; break;
+         case '\n': target += "\\n"; break;
+         case '\r': target += "\\r"; break;
+         case '\t': target += "\\t"; break;
+         default:
+            if ( chr < 0x20 )
+            {
+               target += "\\u";
+               target.writeNumberHex( chr, false, 4 );
+            }
+            else
+               target.append( chr );
+      }
+   }
+   target += '"';
+}
+
+
+void BenchResult::writeJSON( Stream *out ) const
+{
+   String temp = "{ \"id\": ";
+   s_jsonString( temp, m_id );
+   temp += ", \"file\": ";
+   s_jsonString( temp, m_filename );
+   temp += ", \"short\": ";
+   s_jsonString( temp, m_short );
+   temp += ", \"category\": ";
+   s_jsonString( temp, m_category );
+   temp += ",\n      \"runs\": ";
+   temp.writeNumber( (int64) runs() );
+   temp += ", \"min\": ";
+   temp.writeNumber( minimum(), JSON_TIME_FMT );
+   temp += ", \"median\": ";
+   temp.writeNumber( median(), JSON_TIME_FMT );
+   temp += ", \"p95\": ";
+   temp.writeNumber( percentile( 95.0 ), JSON_TIME_FMT );
+   temp += ", \"max\": ";
+   temp.writeNumber( maximum(), JSON_TIME_FMT );
+   temp += ", \"ops\": ";
+   temp.writeNumber( m_ops, JSON_OPS_FMT );
+   temp += ", \"opsPerSec\": ";
+   temp.writeNumber( opsPerSec(), JSON_OPS_FMT );
+   temp += " }";
+   out->writeString( temp );
+}
+
+
+void writeBenchReport( Stream *out, const t_benchResults &results,
+      int64 timeFactor, int repeat )
+{
+   String temp = "{\n   \"version\": ";
+   s_jsonString( temp, FALCON_VERSION );
+   temp += ",\n   \"timeFactor\": ";
+   temp.writeNumber( timeFactor );
+   temp += ",\n   \"repeat\": ";
+   temp.writeNumber( (int64) repeat );
+   temp += ",\n   \"benchmarks\": [";
+   out->writeString( temp );
+
+   for ( uint32 i = 0; i < results.size(); ++i )
+   {
+      out->writeString( i == 0 ? "\n   " : ",\n   " );
+      results[i]->writeJSON( out );
+   }
+
+   out->writeString( "\n   ]\n}\n" );
+}
+
+
+/** Reads a JSON string value starting at pos, which must be at the opening quote. */
+static bool s_readString( const String &src, uint32 &pos, String &value )
+{
+   if ( pos >= src.length() || src.getCharAt( pos ) != '"' )
+      return false;
+
+   value = "";
+   ++pos;
+   while( pos < src.length() )
+   {
+      uint32 chr = src.getCharAt( pos++ );
+      if ( chr == '"' )
+         return true;
+      if ( chr == '\\' && pos < src.length() )
+         chr = src.getCharAt( pos++ );
+      value.append( chr );
+   }
+   return false;
+}
+
+
+/** Finds the value of a key after pos; leaves pos on the first char of the value. */
+static bool s_findKey( const String &src, uint32 &pos, const String &key )
+{
+   String quoted = "\"" + key + "\"";
+   uint32 found = src.find( quoted, pos );
+   if ( found == String::npos )
+      return false;
+
+   pos = found + quoted.length();
+   while( pos < src.length() &&
+         ( src.getCharAt( pos ) == ':' || src.getCharAt( pos ) == ' '
+           || src.getCharAt( pos ) == '\t' || src.getCharAt( pos ) == '\r'
+           || src.getCharAt( pos ) == '\n' ) )
+   {
+      ++pos;
+   }
+   return pos < src.length();
+}
+
+
+double BenchBaseline::slowdown( const BenchResult &result ) const
+{
+   if ( m_opsPerSec > 0.0 && result.opsPerSec() > 0.0 )
+      return ( m_opsPerSec / result.opsPerSec() - 1.0 ) * 100.0;
+
+   if ( m_median > 0.0 )
+      return ( result.median() / m_median - 1.0 ) * 100.0;
+
+   return 0.0;
+}
+
+
+/** Reads the number value of a key in the entry ending at end. */
+static bool s_readNumber( const String &src, uint32 pos, uint32 end,
+      const String &key, double &value )
+{
+   if ( ! s_findKey( src, pos, key ) || pos > end )
+      return false;
+
+   uint32 numEnd = pos;
+   while( numEnd < end && src.getCharAt( numEnd ) != ',' && src.getCharAt( numEnd ) != ' ' )
+      ++numEnd;
+   return src.subString( pos, numEnd ).parseDouble( value );
+}
+
+
+bool readBenchBaseline( Stream *in, t_baselineMap &baseline )
+{
+   String src;
+   uint32 chr;
+   while( in->get( chr ) )
+      src.append( chr );
+
+   if ( ! in->good() )
+      return false;
+
+   // each entry written by BenchResult::writeJSON starts with its id.
+   uint32 pos = 0;
+   while( s_findKey( src, pos, "id" ) )
+   {
+      String id;
+      if ( ! s_readString( src, pos, id ) )
+         break;
+
+      uint32 end = src.find( "}", pos );
+      if ( end == String::npos )
+         break;
+
+      BenchBaseline entry;
+      if ( s_readNumber( src, pos, end, "median", entry.m_median ) )
+      {
+         s_readNumber( src, pos, end, "opsPerSec", entry.m_opsPerSec );
+         baseline[ id ] = entry;
+      }
+      pos = end;
+   }
+
+   return true;
+}
+
+}
+
+/* end of benchmark.cpp */
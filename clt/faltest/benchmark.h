@@ -0,0 +1,105 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: benchmark.h
+
+   Repeated runs, statistics and reports for benchmark scripts.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 14:05:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Header file needed for the testsuite application.
+   Repeated runs, statistics and reports for benchmark scripts.
+*/
+
+#ifndef flc_benchmark_H
+#define flc_benchmark_H
+
+#include <falcon/setup.h>
+#include <falcon/string.h>
+#include <falcon/stream.h>
+#include <vector>
+#include <map>
+
+namespace Falcon {
+
+/** Timings collected for a script run more than once.
+   Each sample is the time the script declared through timings(),
+   or the whole execution time if the script didn't call it.
+*/
+class BenchResult
+{
+   String m_id;
+   String m_filename;
+   String m_short;
+   String m_category;
+   std::vector<double> m_samples;
+   double m_ops;
+
+public:
+   BenchResult( const String &id, const String &filename,
+         const String &shortDesc, const String &category );
+
+   void addSample( double time, double ops );
+
+   const String &id() const { return m_id; }
+   uint32 runs() const { return m_samples.size(); }
+   double ops() const { return m_ops; }
+
+   double minimum() const;
+   double maximum() const;
+   double median() const { return percentile( 50.0 ); }
+
+   /** Nearest rank percentile of the samples. */
+   double percentile( double pct ) const;
+
+   /** Operations per second at the median time (0 if unknown). */
+   double opsPerSec() const;
+
+   /** Writes the result as a JSON object. */
+   void writeJSON( Stream *out ) const;
+};
+
+/** Figures of a benchmark read back from a saved report. */
+class BenchBaseline
+{
+public:
+   double m_median;
+   double m_opsPerSec;
+
+   BenchBaseline():
+      m_median( 0.0 ),
+      m_opsPerSec( 0.0 )
+   {}
+
+   /** Slowdown of a new result with respect to this one, in percent.
+      Operations per second are compared when both sides know them, so
+      that changing the time factor or the size of a benchmark doesn't
+      invalidate the baseline; otherwise median times are compared.
+   */
+   double slowdown( const BenchResult &result ) const;
+};
+
+typedef std::vector<BenchResult *> t_benchResults;
+typedef std::map<String, BenchBaseline> t_baselineMap;
+
+/** Writes a whole benchmark report in JSON format. */
+void writeBenchReport( Stream *out, const t_benchResults &results,
+      int64 timeFactor, int repeat );
+
+/** Reads the figures of a report previously written by writeBenchReport.
+   \return false if the stream can't be read.
+*/
+bool readBenchBaseline( Stream *in, t_baselineMap &baseline );
+
+}
+
+#endif
+
+/* end of benchmark.h */
@@ -48,6 +48,7 @@
 #endif
 
 #include "scriptdata.h"
+#include "benchmark.h"
 
 #define DEF_PREC  5
 #define TIME_PRINT_FMT "%.3f"
@@ -72,6 +73,10 @@ String opt_subcat;
 String opt_path;
 String opt_libpath;
 int opt_tf;
+int opt_repeat;
+String opt_json;
+String opt_baseline;
+double opt_threshold;
 Stream *output;
 
 int passedCount;
@@ -93,6 +98,13 @@ double execTime;
 
 Falcon::List opt_testList;
 
+/** Results of the repeated runs, in execution order */
+t_benchResults benchResults;
+
+/** Figures read from the baseline report */
+t_baselineMap benchBaseline;
+int regressionCount;
+
 /** Main script dictionary */
 t_idScriptMap scriptMap;
 
@@ -132,16 +144,20 @@ static void usage()
    stdOut->writeString( "Usage: faltest [options] -d testsuite_directory [tests ids]\n" );
    stdOut->writeString( "\n" );
    stdOut->writeString( "Options:\n" );
+   stdOut->writeString( "   -b <file>   compare with a report saved by -j\n" );
    stdOut->writeString( "   -c <cat>    only perform tests in this category\n" );
    stdOut->writeString( "   -C <subcat> only perform test in this subcategory\n" );
    stdOut->writeString( "   -d <path>   tests are in specified directory\n" );
    stdOut->writeString( "   -l          Just list available tests and exit\n" );
    stdOut->writeString( "   -L          Changes Falcon load path.\n" );
    stdOut->writeString( "   -h/-?       Show this help\n" );
+   stdOut->writeString( "   -j <file>   write a JSON report of the repeated runs\n" );
    stdOut->writeString( "   -m          do NOT compile in memory\n" );
    stdOut->writeString( "   -M          Check for memory allocation correctness.\n" );
    stdOut->writeString( "   -f <n>      set time factor to N for benchmarks\n" );
    stdOut->writeString( "   -o <file>   Output report here (defaults stdout)\n" );
+   stdOut->writeString( "   -r <n>      run each test N times and report median and p95 times\n" );
+   stdOut->writeString( "   -R <pct>    slowdown over the baseline that counts as a failure (default 10)\n" );
    stdOut->writeString( "   -s          perform module serialization test\n" );
    stdOut->writeString( "   -S          compile via assembly\n" );
    stdOut->writeString( "   -t          record and display timings\n" );
@@ -167,6 +183,8 @@ void parse_options( int argc, char *argv[] )
    opt_timings = false;
    opt_inTimings = false;
    opt_tf = 1;
+   opt_repeat = 0;
+   opt_threshold = 10.0;
 
    // option decoding
    for ( int i = 1; i < argc; i++ )
@@ -177,6 +195,20 @@ void parse_options( int argc, char *argv[] )
       {
          switch ( op[1] )
          {
+            case 'b':
+               if( op[2] != 0 )
+                  opt_baseline = op + 2;
+               else if ( i < argc - 1 ) {
+                  i++;
+                  opt_baseline = argv[i];
+               }
+               else {
+                  stdOut->writeString( "Must specify an argument for -b\n" );
+                  usage();
+                  exit(1);
+               }
+            break;
+
             case 'c':
                if( op[2] != 0 )
                   opt_category = op + 2;
@@ -234,6 +266,21 @@ void parse_options( int argc, char *argv[] )
             break;
 
             case '?': case 'h': usage(); exit(0);
+
+            case 'j':
+               if( op[2] != 0 )
+                  opt_json = op + 2;
+               else if ( i < argc - 1 ) {
+                  i++;
+                  opt_json = argv[i];
+               }
+               else {
+                  stdOut->writeString( "Must specify an argument for -j\n" );
+                  usage();
+                  exit(1);
+               }
+            break;
+
             case 'l': opt_justlist = true; break;
             case 'm': opt_compmem = false; break;
             case 'M': opt_checkmem = true; break;
@@ -252,6 +299,38 @@ void parse_options( int argc, char *argv[] )
                }
             break;
 
+            case 'r':
+              if( op[2] != 0 )
+                  opt_repeat = atoi(op + 2);
+               else if ( i < argc - 1 ) {
+                  i++;
+                  opt_repeat = atoi(argv[i]);
+               }
+               else {
+                  stdOut->writeString( "Must specify an argument for -r\n" );
+                  usage();
+                  exit(1);
+               }
+               if (opt_repeat <= 0)
+                  opt_repeat = 1;
+            break;
+
+            case 'R':
+              if( op[2] != 0 )
+                  opt_threshold = atof(op + 2);
+               else if ( i < argc - 1 ) {
+                  i++;
+                  opt_threshold = atof(argv[i]);
+               }
+               else {
+                  stdOut->writeString( "Must specify an argument for -R\n" );
+                  usage();
+                  exit(1);
+               }
+               if (opt_threshold < 0.0)
+                  opt_threshold = 0.0;
+            break;
+
             case 's': opt_serialize = true; break;
             case 'S': opt_compasm = true; break;
             case 't': opt_timings = true; break;
@@ -287,6 +366,10 @@ void parse_options( int argc, char *argv[] )
          opt_testList.pushBack( new String(argv[i]) );
       }
    }
+
+   // reports and comparisons need repeated runs.
+   if ( opt_repeat == 0 && ( opt_json != "" || opt_baseline != "" ) )
+      opt_repeat = 1;
 }
 
 bool readline( Stream &script, String &line )
@@ -650,7 +733,7 @@ bool testScript( ScriptData *script,
    // 3. execute
    TestSuite::setSuccess( true );
    TestSuite::setTimeFactor( opt_tf );
-   if ( opt_timings )
+   if ( opt_timings || opt_repeat > 0 )
          execTime = Sys::_seconds();
 
    // inject args and script name
@@ -691,7 +774,7 @@ bool testScript( ScriptData *script,
          return false;
       }
 
-      if ( opt_timings )
+      if ( opt_timings || opt_repeat > 0 )
          execTime = Sys::_seconds() - execTime;
    }
    catch( Error *err )
@@ -719,6 +802,80 @@ bool testScript( ScriptData *script,
 }
 
 
+/************************************************
+   Benchmarking
+*************************************************/
+
+/** Runs a script opt_repeat times, recording a timing sample for each run.
+   The sample is the time declared by the script through timings(), or
+   the whole execution time if the script didn't declare it.
+*/
+bool benchScript( ScriptData *script,
+         ModuleLoader *modloader, Module *core, Module *testSuite,
+         String &reason, String &trace, BenchResult *&bench )
+{
+   String id, shortDesc, category;
+   ScriptData::IdToIdCode( script->id(), id );
+   script->getProperty( "Short", shortDesc );
+   script->getProperty( "Category", category );
+   bench = new BenchResult( id, script->filename(), shortDesc, category );
+
+   for ( int run = 0; run < opt_repeat; ++run )
+   {
+      bool success = testScript( script, modloader, core, testSuite, reason, trace );
+
+      // always read the timings, so that they are not left for the next run.
+      numeric tott, opNum;
+      TestSuite::getTimings( tott, opNum );
+
+      if ( ! success )
+      {
+         delete bench;
+         bench = 0;
+         return false;
+      }
+
+      bench->addSample( tott > 0.0 ? tott : execTime, opNum );
+   }
+
+   benchResults.push_back( bench );
+   return true;
+}
+
+
+void describeBench( const BenchResult *bench )
+{
+   String temp = " (median ";
+   temp.writeNumber( bench->median(), TIME_PRINT_FMT );
+   temp += " p95 ";
+   temp.writeNumber( bench->percentile( 95.0 ), TIME_PRINT_FMT );
+   temp += " secs";
+   if ( bench->opsPerSec() > 0.0 )
+   {
+      temp += ", ";
+      temp.writeNumber( bench->opsPerSec(), TIME_PRINT_FMT );
+      temp += " ops/sec";
+   }
+   temp += ")";
+
+   t_baselineMap::const_iterator base = benchBaseline.find( bench->id() );
+   if ( base != benchBaseline.end() )
+   {
+      double delta = base->second.slowdown( *bench );
+      temp += delta > opt_threshold ? " [REGRESSION " : " [";
+      if ( delta >= 0.0 )
+         temp += "+";
+      temp.writeNumber( delta, "%.1f" );
+      temp += "%]";
+
+      if ( delta > opt_threshold )
+         regressionCount++;
+   }
+
+   output->writeString( temp );
+}
+
+
 void gauge()
 {
    if ( opt_output != "" )
@@ -786,7 +943,10 @@ void executeTests( ModuleLoader *modloader )
          s_outBlocks = memPool->allocatedItems();
       }
 
-      bool success = testScript( script, modloader, core, testSuite, reason, trace );
+      BenchResult *bench = 0;
+      bool success = opt_repeat > 0 ?
+            benchScript( script, modloader, core, testSuite, reason, trace, bench ) :
+            testScript( script, modloader, core, testSuite, reason, trace );
 
       if ( success )
       {
@@ -804,7 +964,11 @@ void executeTests( ModuleLoader *modloader )
             temp += ")";
             output->writeString( temp );
          }
-         if ( opt_inTimings )
+         if ( bench != 0 )
+         {
+            describeBench( bench );
+         }
+         else if ( opt_inTimings )
          {
             numeric tott, opNum;
             TestSuite::getTimings( tott, opNum );
@@ -923,6 +1087,21 @@ int main( int argc, char *argv[] )
    modloader->compileInMemory( opt_compmem );
    modloader->sourceEncoding( "utf-8" );
 
+   regressionCount = 0;
+   if ( opt_baseline != "" )
+   {
+      FileStream *fs_base = new FileStream;
+      fs_base->open( opt_baseline );
+      Stream *base = TranscoderFactory( "utf-8", fs_base, true );
+      if( fs_base->bad() || ! readBenchBaseline( base, benchBaseline ) )
+      {
+         stdErr->writeString( "faltest: FATAL - can't read baseline " + opt_baseline + "\n" );
+         stdErr->flush();
+         exit(1);
+      }
+      delete base;
+   }
+
    int32 error;
    if ( opt_path == "" )
       opt_path = ".";
@@ -1015,6 +1194,16 @@ int main( int argc, char *argv[] )
       completed += "\n";
       output->writeString( completed );
 
+      if ( opt_baseline != "" )
+      {
+         String regressions = "Regressions over ";
+         regressions.writeNumber( opt_threshold, "%.1f" );
+         regressions += "%: ";
+         regressions.writeNumber( (int64) regressionCount );
+         regressions += "\n";
+         output->writeString( regressions );
+      }
+
       stdOut->writeString( "\n" );
       if( opt_verbose && opt_output != "" )
       {
@@ -1100,12 +1289,33 @@ int main( int argc, char *argv[] )
    }
 
 
+   if ( opt_json != "" )
+   {
+      FileStream *fs_json = new FileStream;
+      fs_json->create( opt_json, FileStream::e_aUserWrite | FileStream::e_aReadOnly );
+      if( fs_json->bad() )
+      {
+         stdErr->writeString( "faltest: can't write the report " + opt_json + "\n" );
+         delete fs_json;
+      }
+      else
+      {
+         Stream *json = TranscoderFactory( "utf-8", fs_json, true );
+         writeBenchReport( json, benchResults, opt_tf, opt_repeat );
+         json->flush();
+         delete json;
+      }
+   }
+
+   for ( uint32 i = 0; i < benchResults.size(); ++i )
+      delete benchResults[i];
+
    stdOut->writeString( "faltest: done.\n" );
 
    delete stdOut;
    delete stdErr;
 
-   if ( failedCount > 0 )
+   if ( failedCount > 0 || regressionCount > 0 )
        return 2;
    return 0;
 }
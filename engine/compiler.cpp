@@ -868,6 +868,29 @@ void Compiler::addConstant( const String &name, Value *val, uint32 line )
 }
 
 
+void Compiler::settingsKey( String &target ) const
+{
+   target.A( m_strict ? "strict" : "nostrict" ).A( "\n" ).A( m_language );
+
+   // the map is ordered by name, so the description is stable.
+   MapIterator iter = m_constants.begin();
+   while( iter.hasCurrent() )
+   {
+      const Value *val = *(Value **) iter.currentValue();
+      target.A( "\n" ).A( *(String *) iter.currentKey() ).A( "=" );
+      switch( val->type() )
+      {
+         case Value::t_imm_bool: target.A( val->asBool() ? "true" : "false" ); break;
+         case Value::t_imm_integer: target.A( "i" ).N( val->asInteger() ); break;
+         case Value::t_imm_num: target.A( "n" ).N( val->asNumeric() ); break;
+         case Value::t_imm_string: target.A( "s" ).A( *val->asString() ); break;
+         default: target.A( "nil" ); break;
+      }
+      iter.next();
+   }
+}
+
+
 void Compiler::closeFunction()
 {
    StmtFunction *func = static_cast<Falcon::StmtFunction *>( getContext() );
@@ -41,6 +41,7 @@ Continuation::Continuation( const Continuation& e ):
    if( e.m_top != 0 )
    {
       m_top = e.m_top->copyDeep( &m_bottom );
+      m_items.adopt( m_top, m_bottom, 0 );
    }
    else
    {
@@ -89,9 +90,10 @@ bool Continuation::jump( const Item &jump_param )
       m_bComplete = true;
 
       // engage the previous frame
-      m_bottom->prev( m_callingFrame );
       for ( uint32 i = 0; i < m_params.length(); ++i )
          m_callingFrame->stack().append( m_params[i] );
+      m_context->items().adopt( m_top, m_bottom, m_callingFrame );
+      m_bottom->prev( m_callingFrame );
       m_bottom->prepareParams( m_callingFrame, m_params.length() );
 
       // Set the new frame
@@ -136,10 +138,11 @@ void Continuation::suspend( const Item& retval )
       m_params.append( frame->m_params[i] );
    }
 
-   // disengage the stack.
-   frame->prev(0);
+   // disengage the stack, saving the items of the frames.
    m_bottom = frame;
    m_top = m_vm->currentFrame();
+   m_items.adopt( m_top, m_bottom, 0 );
+   frame->prev(0);
    // and remove the parameters
    m_callingFrame->pop( frame->m_param_count );
    m_context->setFrames( m_callingFrame );
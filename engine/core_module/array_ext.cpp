@@ -32,6 +32,9 @@
 #include <falcon/coretable.h>
 #include <falcon/vm.h>
 #include <falcon/eng_messages.h>
+#include <falcon/mt.h>
+#include <falcon/sys.h>
+#include <falcon/memory.h>
 
 
 #include <string.h>
@@ -1245,151 +1248,688 @@ FALCON_FUNC  mth_arrayScan ( ::Falcon::VMachine *vm )
    vm->retval(-1);
 }
 
+//===============================================================
+// Sort engine
+//
+// Arrays whose items can be compared without calling back the VM
+// (numbers, strings and other flat items) are sorted in place, with
+// kernels specialized on the kind of the items. All the other sorts
+// (custom comparators, keys, objects) work on a permutation of the
+// positions of a private copy of the array, so that the items are never
+// moved around while the scripts are running, and the GC always sees them.
+//
+
+// below this size, partitions are sorted by insertion.
+#define ARRAYSORT_INSERTION_THRESHOLD  16
+// minimum size for the radix sort of integer arrays.
+#define ARRAYSORT_RADIX_THRESHOLD      256
+// minimum size for sorting on more threads.
+#define ARRAYSORT_PARALLEL_THRESHOLD   65536
+// maximum number of threads used by a parallel sort.
+#define ARRAYSORT_MAX_THREADS          16
+
+typedef enum {
+   e_sk_int,
+   e_sk_num,
+   e_sk_string,
+   e_sk_flat,
+   e_sk_deep
+} t_sortKind;
+
+/** Determines the kernel that can be used to sort a set of items. */
+static t_sortKind arraySort_kind( const Item* items, uint32 count )
+{
+   bool bInt = true;
+   bool bNum = true;
+   bool bString = true;
+
+   for( uint32 i = 0; i < count; ++i )
+   {
+      switch( items[i].type() )
+      {
+         case FLC_ITEM_INT: bString = false; break;
+         case FLC_ITEM_NUM: bInt = bString = false; break;
+         case FLC_ITEM_STRING: bInt = bNum = false; break;
+         case FLC_ITEM_NIL: case FLC_ITEM_BOOL: case FLC_ITEM_RANGE:
+            bInt = bNum = bString = false;
+            break;
+
+         default:
+            // comparing those may call back the VM.
+            return e_sk_deep;
+      }
+   }
+
+   if ( bInt ) return e_sk_int;
+   if ( bNum ) return e_sk_num;
+   if ( bString ) return e_sk_string;
+   return e_sk_flat;
+}
+
+class SortIntLess {
+public:
+   bool operator()( const Item& a, const Item& b ) const {
+      return a.asInteger() < b.asInteger();
+   }
+};
+
+class SortNumLess {
+public:
+   bool operator()( const Item& a, const Item& b ) const {
+      if ( a.isInteger() && b.isInteger() )
+         return a.asInteger() < b.asInteger();
+      return a.forceNumeric() < b.forceNumeric();
+   }
+};
+
+/** Same as String::compare, but working on the raw storage of strings of the same width. */
+static int arraySort_strcmp( const String& a, const String& b )
+{
+   uint32 cs = a.manipulator()->charSize();
+   if ( cs != b.manipulator()->charSize() )
+      return a.compare( b );
+
+   uint32 len1 = a.length();
+   uint32 len2 = b.length();
+   uint32 len = len1 > len2 ? len2 : len1;
+
+   switch( cs )
+   {
+      case 1:
+      {
+         int res = memcmp( a.getRawStorage(), b.getRawStorage(), len );
+         if ( res != 0 )
+            return res;
+      }
+      break;
+
+      case 2:
+      {
+         const uint16* s1 = (const uint16*) a.getRawStorage();
+         const uint16* s2 = (const uint16*) b.getRawStorage();
+         for ( uint32 i = 0; i < len; ++i )
+            if ( s1[i] != s2[i] )
+               return s1[i] < s2[i] ? -1 : 1;
+      }
+      break;
+
+      default:
+      {
+         const uint32* s1 = (const uint32*) a.getRawStorage();
+         const uint32* s2 = (const uint32*) b.getRawStorage();
+         for ( uint32 i = 0; i < len; ++i )
+            if ( s1[i] != s2[i] )
+               return s1[i] < s2[i] ? -1 : 1;
+      }
+   }
 
+   if ( len1 < len2 )
+      return -1;
+   return len1 > len2 ? 1 : 0;
+}
+
+class SortStringLess {
+public:
+   bool operator()( const Item& a, const Item& b ) const {
+      return arraySort_strcmp( *a.asString(), *b.asString() ) < 0;
+   }
+};
+
+class SortItemLess {
+public:
+   bool operator()( const Item& a, const Item& b ) const {
+      return a.compare( b ) < 0;
+   }
+};
+
+/** Compares positions by the items found there. */
+template<class _Less>
+class SortIndexLess {
+public:
+   SortIndexLess( const Item* items ): m_items( items ) {}
+
+   bool operator()( uint32 a, uint32 b ) const {
+      return m_less( m_items[a], m_items[b] );
+   }
+
+private:
+   const Item* m_items;
+   _Less m_less;
+};
+
+/** Compares positions calling a script function on the items found there. */
+class SortFlexLess {
+public:
+   SortFlexLess( VMachine* vm, const Item& sorter, const Item* items ):
+      m_vm( vm ),
+      m_sorter( sorter ),
+      m_items( items )
+   {}
+
+   bool operator()( uint32 a, uint32 b ) const
+   {
+      m_vm->pushParam( m_items[a] );
+      m_vm->pushParam( m_items[b] );
+      m_vm->callItemAtomic( m_sorter, 2 );
+
+      const Item& res = m_vm->regA();
+      if ( res.isInteger() )
+         return res.asInteger() < 0;
+      if ( res.isNumeric() )
+         return res.asNumeric() < 0.0;
+      return false;
+   }
 
-#define MINMAL_QUICKSORT_THRESHOLD     4
-inline void arraySort_swap( Item *a, int i, int j)
+private:
+   VMachine* m_vm;
+   const Item& m_sorter;
+   const Item* m_items;
+};
+
+/** Temporary buffer, released also when a comparator raises an error. */
+template<class _T>
+class SortBuffer {
+public:
+   SortBuffer( uint32 count ):
+      m_data( (_T*) memAlloc( sizeof( _T ) * (count == 0 ? 1 : count) ) )
+   {}
+   ~SortBuffer() { memFree( m_data ); }
+
+   _T* data() const { return m_data; }
+
+private:
+   _T* m_data;
+};
+
+
+template<class _T>
+static inline void arraySort_swap( _T* a, int32 i, int32 j )
 {
-   Item T = a[i];
+   _T t = a[i];
    a[i] = a[j];
-   a[j] = T;
+   a[j] = t;
+}
+
+static int32 arraySort_depth( uint32 count )
+{
+   int32 depth = 0;
+   while( count > 1 )
+   {
+      count >>= 1;
+      depth += 2;
+   }
+   return depth;
+}
+
+/** Stable insertion sort of [lo, hi). */
+template<class _T, class _Less>
+static void arraySort_insertion( _T* a, int32 lo, int32 hi, const _Less& less )
+{
+   for ( int32 i = lo + 1; i < hi; ++i )
+   {
+      _T v = a[i];
+      int32 j = i;
+      while ( j > lo && less( v, a[j-1] ) )
+      {
+         a[j] = a[j-1];
+         --j;
+      }
+      a[j] = v;
+   }
 }
 
-static void arraySort_quickSort( Item *array, int32 l, int32 r )
+template<class _T, class _Less>
+static void arraySort_siftDown( _T* a, int32 root, int32 count, const _Less& less )
 {
-   int32 i;
-   int32 j;
-   Item v;
+   _T v = a[root];
+   int32 child;
+   while( (child = root * 2 + 1) < count )
+   {
+      if ( child + 1 < count && less( a[child], a[child+1] ) )
+         ++child;
+      if ( ! less( v, a[child] ) )
+         break;
+      a[root] = a[child];
+      root = child;
+   }
+   a[root] = v;
+}
+
+template<class _T, class _Less>
+static void arraySort_heap( _T* a, int32 count, const _Less& less )
+{
+   for ( int32 i = count / 2 - 1; i >= 0; --i )
+      arraySort_siftDown( a, i, count, less );
+
+   for ( int32 i = count - 1; i > 0; --i )
+   {
+      arraySort_swap( a, 0, i );
+      arraySort_siftDown( a, 0, i, less );
+   }
+}
+
+/** Introspective sort of [lo, hi).
 
-   if ( ( r-l ) > MINMAL_QUICKSORT_THRESHOLD )
+   Quicksort with median of three, falling back to heapsort when the
+   partitions are too unbalanced. The scans are bounded, so that an
+   inconsistent comparator can't bring them out of the range.
+*/
+template<class _T, class _Less>
+static void arraySort_intro( _T* a, int32 lo, int32 hi, int32 depth, const _Less& less )
+{
+   while ( hi - lo > ARRAYSORT_INSERTION_THRESHOLD )
    {
-      i = ( r + l ) / 2;
-      if ( array[l] > array[i] ) arraySort_swap( array, l , i );
-      if ( array[l] > array[r] ) arraySort_swap( array , l, r );
-      if ( array[i] > array[r] ) arraySort_swap( array, i, r );
+      if ( depth-- == 0 )
+      {
+         arraySort_heap( a + lo, hi - lo, less );
+         return;
+      }
 
-      j = r - 1;
-      arraySort_swap( array , i, j );
-      i = l;
-      v = array[j];
+      // put the median of first, middle and last in a[lo].
+      int32 mid = lo + (hi - lo) / 2;
+      if ( less( a[mid], a[lo] ) ) arraySort_swap( a, lo, mid );
+      if ( less( a[hi-1], a[mid] ) )
+      {
+         arraySort_swap( a, mid, hi-1 );
+         if ( less( a[mid], a[lo] ) ) arraySort_swap( a, lo, mid );
+      }
+      arraySort_swap( a, lo, mid );
+
+      _T pivot = a[lo];
+      int32 i = lo;
+      int32 j = hi;
       for(;;)
       {
-            while( array[++i] < v );
-            while( array[--j] > v );
-            if ( j < i ) break;
-            arraySort_swap ( array , i , j );
+         do ++i; while ( i < hi && less( a[i], pivot ) );
+         do --j; while ( j > lo && less( pivot, a[j] ) );
+         if ( i >= j )
+            break;
+         arraySort_swap( a, i, j );
+      }
+      arraySort_swap( a, lo, j );
+
+      // recurse on the smaller part, loop on the larger.
+      if ( j - lo < hi - j - 1 )
+      {
+         arraySort_intro( a, lo, j, depth, less );
+         lo = j + 1;
       }
-      arraySort_swap( array , i, r - 1 );
-      arraySort_quickSort( array, l , j );
-      arraySort_quickSort( array, i + 1 , r );
+      else
+      {
+         arraySort_intro( a, j + 1, hi, depth, less );
+         hi = j;
+      }
+   }
+
+   arraySort_insertion( a, lo, hi, less );
+}
+
+/** Stable merge of src[lo, mid) and src[mid, hi) into dst[lo, hi). */
+template<class _T, class _Less>
+static void arraySort_merge( const _T* src, _T* dst, int32 lo, int32 mid, int32 hi, const _Less& less )
+{
+   int32 i = lo;
+   int32 j = mid;
+   int32 k = lo;
+
+   while ( i < mid && j < hi )
+   {
+      if ( less( src[j], src[i] ) )
+         dst[k++] = src[j++];
+      else
+         dst[k++] = src[i++];
    }
+
+   while ( i < mid )
+      dst[k++] = src[i++];
+   while ( j < hi )
+      dst[k++] = src[j++];
 }
 
+/** Stable bottom-up merge sort; tmp must hold count elements. */
+template<class _T, class _Less>
+static void arraySort_mergeSort( _T* a, int32 count, _T* tmp, const _Less& less )
+{
+   for ( int32 lo = 0; lo < count; lo += ARRAYSORT_INSERTION_THRESHOLD )
+   {
+      int32 hi = lo + ARRAYSORT_INSERTION_THRESHOLD;
+      arraySort_insertion( a, lo, hi < count ? hi : count, less );
+   }
+
+   _T* src = a;
+   _T* dst = tmp;
+   for ( int32 width = ARRAYSORT_INSERTION_THRESHOLD; width < count; width *= 2 )
+   {
+      for ( int32 lo = 0; lo < count; lo += width * 2 )
+      {
+         int32 mid = lo + width < count ? lo + width : count;
+         int32 hi = mid + width < count ? mid + width : count;
+         arraySort_merge( src, dst, lo, mid, hi, less );
+      }
+
+      _T* t = src;
+      src = dst;
+      dst = t;
+   }
+
+   if ( src != a )
+      memcpy( (void*) a, src, sizeof( _T ) * count );
+}
 
-static void arraySort_insertionSort( VMachine *vm, Item *array, int lo0, int hi0)
+/** LSD radix sort of integer items on their 64 bits. */
+static void arraySort_radix( Item* items, uint32 count )
 {
-   int32 i;
-   int32 j;
-   Item v;
+   static const uint64 signBit = ((uint64) 1) << 63;
+   uint32 counts[8][256];
+   memset( counts, 0, sizeof( counts ) );
+
+   for ( uint32 i = 0; i < count; ++i )
+   {
+      uint64 key = ((uint64) items[i].asInteger()) ^ signBit;
+      for ( int d = 0; d < 8; ++d )
+         counts[d][ (key >> (d*8)) & 0xFF ]++;
+   }
 
+   SortBuffer<Item> buffer( count );
+   Item* src = items;
+   Item* dst = buffer.data();
+   uint64 first = ((uint64) items[0].asInteger()) ^ signBit;
 
-   for ( i = lo0 + 1 ; i <= hi0 ; i++ )
+   for ( int d = 0; d < 8; ++d )
    {
-      v = array[i];
-      j = i;
-      while ( ( j > lo0 ) && ( array[j-1] > v ) )
+      uint32* cnt = counts[d];
+      // all the keys share this digit; nothing to do.
+      if ( cnt[ (first >> (d*8)) & 0xFF ] == count )
+         continue;
+
+      uint32 pos = 0;
+      for ( int b = 0; b < 256; ++b )
+      {
+         uint32 c = cnt[b];
+         cnt[b] = pos;
+         pos += c;
+      }
+
+      for ( uint32 i = 0; i < count; ++i )
       {
-         array[j] = array[j-1];
-         j--;
+         uint64 key = ((uint64) src[i].asInteger()) ^ signBit;
+         dst[ cnt[ (key >> (d*8)) & 0xFF ]++ ] = src[i];
       }
-      array[j] = v;
+
+      Item* t = src;
+      src = dst;
+      dst = t;
    }
+
+   if ( src != items )
+      memcpy( (void*) items, src, sizeof( Item ) * count );
 }
 
-static void arraySort_quickSort_flex( VMachine *vm, Item *comparer, Item *array, int32 l, int32 r )
+
+/** Sorts a chunk of a parallel sort. */
+template<class _Less>
+class SortChunk: public Runnable
 {
-   int32 i;
-   int32 j;
-   Item v;
+public:
+   Item* m_items;
+   Item* m_tmp;
+   int32 m_lo;
+   int32 m_mid;
+   int32 m_hi;
+   bool m_bStable;
+   const _Less* m_less;
+
+   virtual void* run()
+   {
+      if ( m_bStable )
+         arraySort_mergeSort( m_items + m_lo, m_hi - m_lo, m_tmp + m_lo, *m_less );
+      else
+         arraySort_intro( m_items, m_lo, m_hi, arraySort_depth( m_hi - m_lo ), *m_less );
+      return 0;
+   }
+};
 
-   if ( ( r-l ) > MINMAL_QUICKSORT_THRESHOLD )
+/** Merges two sorted chunks of a parallel sort. */
+template<class _Less>
+class MergeChunk: public SortChunk<_Less>
+{
+public:
+   virtual void* run()
+   {
+      arraySort_merge( this->m_items, this->m_tmp, this->m_lo, this->m_mid, this->m_hi, *this->m_less );
+      return 0;
+   }
+};
+
+/** Runs some jobs on separate threads; the calling thread runs the first. */
+static void arraySort_runAll( Runnable** jobs, int32 count )
+{
+   SysThread* threads[ ARRAYSORT_MAX_THREADS ];
+   for ( int32 i = 1; i < count; ++i )
    {
-      i = ( r + l ) / 2;
+      threads[i] = new SysThread( jobs[i] );
+      if ( ! threads[i]->start() )
+      {
+         threads[i]->disengage();
+         threads[i] = 0;
+      }
+   }
 
-      vm->pushParam( array[l] );
-      vm->pushParam( array[i] );
-      vm->callItemAtomic( *comparer, 2 );
+   jobs[0]->run();
 
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array, l , i );
+   for ( int32 i = 1; i < count; ++i )
+   {
+      void* dummy;
+      if ( threads[i] != 0 )
+         threads[i]->join( dummy );
+      else
+         jobs[i]->run();
+   }
+}
 
-      vm->pushParam( array[l] );
-      vm->pushParam( array[r] );
-      vm->callItemAtomic( *comparer, 2 );
+/** Sorts chunks of the array on different threads, then merges them. */
+template<class _Less>
+static void arraySort_parallel( Item* items, int32 count, int32 threads, const _Less& less, bool bStable )
+{
+   SortBuffer<Item> buffer( count );
+   int32 bounds[ ARRAYSORT_MAX_THREADS + 1 ];
+   for ( int32 i = 0; i <= threads; ++i )
+      bounds[i] = (int32) (((int64) count * i) / threads);
+
+   SortChunk<_Less> sorters[ ARRAYSORT_MAX_THREADS ];
+   MergeChunk<_Less> mergers[ ARRAYSORT_MAX_THREADS ];
+   Runnable* jobs[ ARRAYSORT_MAX_THREADS ];
+
+   for ( int32 i = 0; i < threads; ++i )
+   {
+      SortChunk<_Less>& s = sorters[i];
+      s.m_items = items;
+      s.m_tmp = buffer.data();
+      s.m_lo = bounds[i];
+      s.m_hi = bounds[i+1];
+      s.m_bStable = bStable;
+      s.m_less = &less;
+      jobs[i] = &s;
+   }
+   arraySort_runAll( jobs, threads );
+
+   // merge the chunks pairwise, bouncing between the array and the buffer.
+   Item* src = items;
+   Item* dst = buffer.data();
+   int32 chunks = threads;
+   while ( chunks > 1 )
+   {
+      int32 merged = 0;
+      for ( int32 i = 0; i < chunks; i += 2 )
+      {
+         MergeChunk<_Less>& m = mergers[merged];
+         m.m_items = src;
+         m.m_tmp = dst;
+         m.m_lo = bounds[i];
+         // an odd chunk at the end is just copied.
+         m.m_mid = bounds[i+1];
+         m.m_hi = i + 1 < chunks ? bounds[i+2] : bounds[i+1];
+         m.m_less = &less;
+         jobs[merged] = &m;
+         bounds[merged] = bounds[i];
+         ++merged;
+      }
+      bounds[merged] = count;
+      arraySort_runAll( jobs, merged );
 
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array , l, r );
+      chunks = merged;
+      Item* t = src;
+      src = dst;
+      dst = t;
+   }
 
-      vm->pushParam( array[i] );
-      vm->pushParam( array[r] );
-      vm->callItemAtomic( *comparer, 2 );
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array, i, r );
+   if ( src != items )
+      memcpy( (void*) items, src, sizeof( Item ) * count );
+}
 
-      j = r - 1;
-      arraySort_swap( array, i, j );
-      i = l;
-      v = array[j];
-      for(;;)
+/** Sorts items that can be compared without the VM. */
+template<class _Less>
+static void arraySort_flat( Item* items, uint32 count, const _Less& less, bool bStable )
+{
+   if ( count >= ARRAYSORT_PARALLEL_THRESHOLD )
+   {
+      int32 threads = Sys::_cpuCount();
+      if ( threads > ARRAYSORT_MAX_THREADS )
+         threads = ARRAYSORT_MAX_THREADS;
+      if ( threads > 1 )
       {
-            do {
-               vm->pushParam( array[++i] );
-               vm->pushParam( v );
-               vm->callItemAtomic( *comparer, 2 );
-            }
-            while( vm->regA().asInteger() < 0 );
-
-            do {
-               vm->pushParam( array[--j] );
-               vm->pushParam( v );
-               vm->callItemAtomic( *comparer, 2 );
-            }
-            while( vm->regA().asInteger() > 0 );
-
-            if ( j < i ) break;
-            arraySort_swap ( array , i , j );
+         arraySort_parallel( items, (int32) count, threads, less, bStable );
+         return;
       }
-      arraySort_swap( array , i, r - 1 );
-      arraySort_quickSort( array, l , j );
-      arraySort_quickSort( array, i + 1 , r );
+   }
+
+   if ( bStable )
+   {
+      SortBuffer<Item> buffer( count );
+      arraySort_mergeSort( items, (int32) count, buffer.data(), less );
+   }
+   else
+      arraySort_intro( items, 0, (int32) count, arraySort_depth( count ), less );
+}
+
+/** Sorts a copy of the items by permutation, and stores the result in the array. */
+template<class _Less>
+static void arraySort_indirect( CoreArray* array, const Item* copy, uint32 count, const _Less& less, bool bStable )
+{
+   SortBuffer<uint32> index( count );
+   uint32* idx = index.data();
+   for ( uint32 i = 0; i < count; ++i )
+      idx[i] = i;
+
+   if ( bStable )
+   {
+      SortBuffer<uint32> buffer( count );
+      arraySort_mergeSort( idx, (int32) count, buffer.data(), less );
+   }
+   else
+      arraySort_intro( idx, 0, (int32) count, arraySort_depth( count ), less );
+
+   // the scripts may have changed the array in the meanwhile.
+   array->items().resize( count );
+   Item* items = array->items().elements();
+   for ( uint32 i = 0; i < count; ++i )
+      items[i] = copy[ idx[i] ];
+}
+
+/** Sorts a copy of the items by their keys (which may be the items themselves). */
+static void arraySort_byKeys( CoreArray* array, const Item* copy, const Item* keys, uint32 count, bool bStable )
+{
+   switch( arraySort_kind( keys, count ) )
+   {
+      case e_sk_int:
+         arraySort_indirect( array, copy, count, SortIndexLess<SortIntLess>( keys ), bStable );
+         break;
+      case e_sk_num:
+         arraySort_indirect( array, copy, count, SortIndexLess<SortNumLess>( keys ), bStable );
+         break;
+      case e_sk_string:
+         arraySort_indirect( array, copy, count, SortIndexLess<SortStringLess>( keys ), bStable );
+         break;
+      default:
+         arraySort_indirect( array, copy, count, SortIndexLess<SortItemLess>( keys ), bStable );
    }
 }
 
+/** Creates a private copy of an array, visible to the GC as a local of the current frame. */
+static CoreArray* arraySort_copy( VMachine* vm, CoreArray* array, uint32 local )
+{
+   CoreArray* copy = new CoreArray( array->length() );
+   copy->items().merge( array->items() );
+   *vm->local( local ) = copy;
+   return copy;
+}
 
-static void arraySort_insertionSort_flex( VMachine *vm, Item *comparer, Item *array, int lo0, int hi0)
+/** Common part of sort() and stableSort(). */
+static void arraySort_impl( VMachine* vm, bool bStable )
 {
-   int32 i;
-   int32 j;
-   Item v;
+   Item *array_itm;
+   Item *sorter_itm;
+
+   if( vm->self().isMethodic() )
+   {
+      array_itm = &vm->self();
+      sorter_itm = vm->param( 0 );
+   }
+   else
+   {
+      array_itm = vm->param( 0 );
+      sorter_itm = vm->param( 1 );
+   }
+
+   if ( array_itm == 0 || ! array_itm->isArray()
+        || (sorter_itm != 0 && ! sorter_itm->isNil() && ! sorter_itm->isCallable())
+      )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         origin( e_orig_runtime ).
+         extra( vm->self().isMethodic() ? "[C]" : "A,[C]" ) );
+   }
+
+   CoreArray *array = array_itm->asArray();
+   uint32 count = array->length();
+   if ( count < 2 )
+      return;
 
-   for ( i = lo0 + 1 ; i <= hi0 ; i++ )
+   if ( sorter_itm == 0 || sorter_itm->isNil() )
    {
-      v = array[i];
-      j = i;
-      while ( j > lo0 )
+      Item *items = array->items().elements();
+      switch( arraySort_kind( items, count ) )
       {
-         vm->pushParam( array[j-1] );
-         vm->pushParam( v );
-         vm->callItemAtomic( *comparer, 2 );
+         case e_sk_int:
+            if ( count >= ARRAYSORT_RADIX_THRESHOLD )
+               arraySort_radix( items, count );
+            else
+               arraySort_intro( items, 0, (int32) count, arraySort_depth( count ), SortIntLess() );
+            return;
 
-         if ( vm->regA().asInteger() <= 0 )
-            break;
+         case e_sk_num: arraySort_flat( items, count, SortNumLess(), bStable ); return;
+         case e_sk_string: arraySort_flat( items, count, SortStringLess(), bStable ); return;
+         case e_sk_flat: arraySort_flat( items, count, SortItemLess(), bStable ); return;
 
-         array[j] = array[j-1];
-         j--;
+         default:
+         {
+            // the comparisons may run scripts.
+            vm->addLocals( 1 );
+            const Item* copy = arraySort_copy( vm, array, 0 )->items().elements();
+            arraySort_byKeys( array, copy, copy, count, bStable );
+         }
       }
-      array[j] = v;
+   }
+   else
+   {
+      // fetching as we're going to change the stack
+      Item sorter = *sorter_itm;
+      vm->addLocals( 1 );
+      const Item* copy = arraySort_copy( vm, array, 0 )->items().elements();
+      arraySort_indirect( array, copy, count, SortFlexLess( vm, sorter, copy ), bStable );
    }
 }
 
-
 /*#
    @function arraySort
    @brief Sorts an array, possibly using an arbitrary ordering criterion.
@@ -1400,13 +1940,19 @@ static void arraySort_insertionSort_flex( VMachine *vm, Item *comparer, Item *ar
    smaller one, and the last element is the bigger one. String sorting is performed
    lexicographically. To sort the data based on an arbitrary criterion, or to sort
    complex items, or objects, based on some of their contents, the caller may
-   provide a sortFunc that will receive two parameters. The sortFunc must return -1
-   if the first parameter is be considered greater than the second, 0 if they
-   are equal and 1 if the second parameter is to be considered greater.
+   provide a sortFunc that will receive two parameters. The sortFunc must return
+   a value greater than zero if the first parameter is to be considered greater
+   than the second, 0 if they are equal and a value less than zero if the second
+   parameter is to be considered greater.
 
    Sort function is called in atomic mode. The called function cannot be
    interrupted by external kind requests, and it cannot sleep or yield the
    execution to other coroutines.
+
+   Arrays made only of numbers or only of strings are sorted by specialized
+   code, and large arrays of this kind are sorted using all the processors
+   of the machine. The sort is not stable: items comparing equal may be
+   found in any order after the sort; see @a arrayStableSort.
 */
 
 /*#
@@ -1417,23 +1963,80 @@ static void arraySort_insertionSort_flex( VMachine *vm, Item *comparer, Item *ar
    @see arraySort
 */
 FALCON_FUNC  mth_arraySort( ::Falcon::VMachine *vm )
+{
+   arraySort_impl( vm, false );
+}
+
+/*#
+   @function arrayStableSort
+   @brief Sorts an array preserving the order of equal items.
+   @param array The array that will be sorted.
+   @optparam sortingFunc A function used to compare two items.
+
+   This function works as @a arraySort, but items that are considered
+   equal keep the order they had in the array before the sort.
+*/
+
+/*#
+   @method stableSort Array
+   @brief Sorts an array preserving the order of equal items.
+   @optparam sortingFunc A function used to compare two items.
+
+   @see arrayStableSort
+*/
+FALCON_FUNC  mth_arrayStableSort( ::Falcon::VMachine *vm )
+{
+   arraySort_impl( vm, true );
+}
+
+/*#
+   @function arraySortBy
+   @brief Sorts an array on a key extracted from each item.
+   @param array The array that will be sorted.
+   @param keyFunc A function returning the sorting key of an item.
+
+   The function calls keyFunc once for each item in the array, and
+   then sorts the items by the keys they generated. This is much faster
+   than comparing the items through a function, as the script is called
+   just once per item, while the keys are compared by the engine.
+
+   The sort is stable; items having the same key keep the order they
+   had in the array.
+
+   @code
+      people = [ ["Smith", 42], ["Doe", 23], ["Roe", 42] ]
+      people.sortBy( {x => x[1]} )
+      // [ ["Doe", 23], ["Smith", 42], ["Roe", 42] ]
+   @endcode
+
+   The key function is called in atomic mode.
+*/
+
+/*#
+   @method sortBy Array
+   @brief Sorts an array on a key extracted from each item.
+   @param keyFunc A function returning the sorting key of an item.
+
+   @see arraySortBy
+*/
+FALCON_FUNC  mth_arraySortBy( ::Falcon::VMachine *vm )
 {
    Item *array_itm;
-   Item *sorter_itm;
+   Item *key_itm;
 
    if( vm->self().isMethodic() )
    {
       array_itm = &vm->self();
-      sorter_itm = vm->param( 0 );
+      key_itm = vm->param( 0 );
    }
    else
    {
       array_itm = vm->param( 0 );
-      sorter_itm = vm->param( 1 );
+      key_itm = vm->param( 1 );
    }
 
    if ( array_itm == 0 || ! array_itm->isArray()
-        || (sorter_itm != 0 && ! sorter_itm->isCallable())
+        || key_itm == 0 || ! key_itm->isCallable()
       )
    {
       throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
@@ -1442,20 +2045,25 @@ FALCON_FUNC  mth_arraySort( ::Falcon::VMachine *vm )
    }
 
    CoreArray *array = array_itm->asArray();
-   Item *vector = array->items().elements();
+   uint32 count = array->length();
+   if ( count < 2 )
+      return;
+
+   // fetching as we're going to change the stack
+   Item keyFunc = *key_itm;
+   vm->addLocals( 2 );
+   const Item* copy = arraySort_copy( vm, array, 0 )->items().elements();
 
-   if ( sorter_itm == 0 )
+   CoreArray* keys = new CoreArray( count );
+   *vm->local( 1 ) = keys;
+   for ( uint32 i = 0; i < count; ++i )
    {
-      arraySort_quickSort( vector, 0, array->length() - 1 );
-      arraySort_insertionSort( vm, vector, 0, array->length() -1 );
+      vm->pushParam( copy[i] );
+      vm->callItemAtomic( keyFunc, 1 );
+      keys->append( vm->regA() );
    }
-   else {
-      // fetching as we're going to change the stack
-      Item sorter = *sorter_itm;
 
-      arraySort_quickSort_flex( vm, &sorter, vector, 0, array->length() - 1 );
-      arraySort_insertionSort_flex( vm, &sorter, vector, 0, array->length() -1 );
-   }
+   arraySort_byKeys( array, copy, keys->items().elements(), count, true );
 }
 
 /*#
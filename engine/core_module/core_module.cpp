@@ -678,6 +678,10 @@ Module* core_module_init()
       addParam("func")->addParam("start")->addParam("end");
    self->addClassMethod( array_meta, "sort", &Falcon::core::mth_arraySort ).asSymbol()->
       addParam("sortingFunc");
+   self->addClassMethod( array_meta, "stableSort", &Falcon::core::mth_arrayStableSort ).asSymbol()->
+      addParam("sortingFunc");
+   self->addClassMethod( array_meta, "sortBy", &Falcon::core::mth_arraySortBy ).asSymbol()->
+      addParam("keyFunc");
    self->addClassMethod( array_meta, "remove", &Falcon::core::mth_arrayRemove ).asSymbol()->
       addParam("itemPos")->addParam("lastItemPos");
    self->addClassMethod( array_meta, "merge", &Falcon::core::mth_arrayMerge ).asSymbol()->
@@ -749,6 +753,8 @@ Module* core_module_init()
       addParam("key");
    self->addClassMethod( dict_meta,  "set", &Falcon::core::mth_dictSet ).asSymbol()->
       addParam("key")->addParam("value");
+   self->addClassMethod( dict_meta,  "inc", &Falcon::core::mth_dictInc ).asSymbol()->
+      addParam("key")->addParam("amount");
    self->addClassMethod( dict_meta, "find", &Falcon::core::mth_dictFind ).asSymbol()->
       addParam("key");
    self->addClassMethod( dict_meta, "best", &Falcon::core::mth_dictBest ).asSymbol()->
@@ -1145,6 +1151,9 @@ Module* core_module_init()
       addParam("wcoll");
    self->addClassMethod( gc_cls, "adjust", &Falcon::core::GC_adjust ).setReadOnly(true).asSymbol()->
       addParam("mode");
+   self->addClassMethod( gc_cls, "census", &Falcon::core::GC_census ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "track", &Falcon::core::GC_track ).setReadOnly(true).asSymbol()->
+      addParam("rate");
    self->addClassProperty( gc_cls, "ADJ_NONE" ).setInteger(RAMP_MODE_OFF).setReadOnly(true);
    self->addClassProperty( gc_cls, "ADJ_STRICT" ).setInteger(RAMP_MODE_STRICT_ID).setReadOnly(true);
    self->addClassProperty( gc_cls, "ADJ_LOOSE" ).setInteger(RAMP_MODE_LOOSE_ID).setReadOnly(true);
@@ -1439,6 +1448,10 @@ Module* core_module_init()
       addParam("array")->addParam("item")->addParam("start")->addParam("end");
    self->addExtFunc( "arraySort", &Falcon::core::mth_arraySort )->
       addParam("array")->addParam("sortingFunc");
+   self->addExtFunc( "arrayStableSort", &Falcon::core::mth_arrayStableSort )->
+      addParam("array")->addParam("sortingFunc");
+   self->addExtFunc( "arraySortBy", &Falcon::core::mth_arraySortBy )->
+      addParam("array")->addParam("keyFunc");
    self->addExtFunc( "arrayRemove", &Falcon::core::mth_arrayRemove )->
       addParam("array")->addParam("itemPos")->addParam("lastItemPos");
    self->addExtFunc( "arrayMerge", &Falcon::core::mth_arrayMerge )->
@@ -1473,6 +1486,10 @@ Module* core_module_init()
       addParam("dict")->addParam("key");
    self->addExtFunc( "dictSet", &Falcon::core::mth_dictSet )->
       addParam("dict")->addParam("key")->addParam("value");
+   self->addExtFunc( "dictInc", &Falcon::core::mth_dictInc )->
+      addParam("dict")->addParam("key")->addParam("amount");
+   self->addExtFunc( "histogram", &Falcon::core::histogram )->
+      addParam("array")->addParam("dict");
    self->addExtFunc( "dictFind", &Falcon::core::mth_dictFind )->
       addParam("dict")->addParam("key");
    self->addExtFunc( "dictBest", &Falcon::core::mth_dictBest )->
@@ -1632,6 +1649,8 @@ Module* core_module_init()
       addParam("size");
    self->addClassMethod( stream_class, "readLine", &Falcon::core::Stream_readLine ).asSymbol()->
       addParam("buffer")->addParam("size");
+   self->addClassMethod( stream_class, "lines", &Falcon::core::Stream_lines ).asSymbol()->
+      addParam("size");
    self->addClassMethod( stream_class, "write", &Falcon::core::Stream_write ).asSymbol()->
       addParam("buffer")->addParam("size")->addParam("start");
    self->addClassMethod( stream_class, "seek", &Falcon::core::Stream_seek ).asSymbol()->
@@ -1890,6 +1909,8 @@ Module* core_module_init()
    //=======================================================================
    Falcon::Symbol *sequence_class = self->addClass( "Sequence" );
    sequence_class->exported(false);
+   // known, to create the one-way sequences returned by native functions.
+   sequence_class->setWKS(true);
 
    self->addClassMethod( sequence_class, "comp", &Falcon::core::Sequence_comp ).asSymbol()->
       addParam("source")->addParam("filter");
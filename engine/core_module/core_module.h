@@ -228,6 +228,8 @@ CoreObject* GC_Factory( const CoreClass *cls, void *user_data, bool );
 FALCON_FUNC  GC_adjust( ::Falcon::VMachine *vm );
 FALCON_FUNC  GC_enable( ::Falcon::VMachine *vm );
 FALCON_FUNC  GC_perform( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_census( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_track( ::Falcon::VMachine *vm );
 
 FALCON_FUNC  gcEnable( ::Falcon::VMachine *vm );
 FALCON_FUNC  gcSetThreshold( ::Falcon::VMachine *vm );
@@ -269,6 +271,7 @@ FALCON_FUNC  Stream_read ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_grab ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_readLine ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_grabLine ( ::Falcon::VMachine *vm );
+FALCON_FUNC  Stream_lines ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_readText ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_grabText ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_write ( ::Falcon::VMachine *vm );
@@ -353,6 +356,8 @@ FALCON_FUNC  mth_arrayResize ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayFind ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayScan ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arraySort( ::Falcon::VMachine *vm );
+FALCON_FUNC  mth_arrayStableSort( ::Falcon::VMachine *vm );
+FALCON_FUNC  mth_arraySortBy( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayRemove( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayMerge( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayHead ( ::Falcon::VMachine *vm );
@@ -381,6 +386,8 @@ FALCON_FUNC  mth_dictKeys( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictValues( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictGet( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictSet( ::Falcon::VMachine *vm );
+FALCON_FUNC  mth_dictInc( ::Falcon::VMachine *vm );
+FALCON_FUNC  histogram( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictFind( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictBest( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_dictRemove( ::Falcon::VMachine *vm );
@@ -26,6 +26,7 @@
 #include <falcon/item.h>
 #include <falcon/carray.h>
 #include <falcon/coredict.h>
+#include <falcon/lineardict.h>
 #include <falcon/iterator.h>
 #include <falcon/vm.h>
 #include <falcon/fassert.h>
@@ -616,6 +617,135 @@ FALCON_FUNC  mth_dictSet( ::Falcon::VMachine *vm )
    }
 }
 
+/*#
+   @function dictInc
+   @brief Adds an amount to the value stored under a key.
+   @param dict A dictionary.
+   @param key The key of the counter.
+   @optparam amount The amount to be added (defaults to 1).
+   @return The new value of the counter.
+
+   If the key is not in the dictionary, it is stored with @b amount as value;
+   otherwise, @b amount is added to the value associated with the key. This
+   allows to keep counters and histograms with a single search of the key.
+
+   @note This method bypasses getIndex__ and setIndex__ overrides in blessed
+   (POOP) dictionaries.
+*/
+
+/*#
+   @method inc Dictionary
+   @brief Adds an amount to the value stored under a key.
+   @param key The key of the counter.
+   @optparam amount The amount to be added (defaults to 1).
+   @return The new value of the counter.
+
+   If the key is not in the dictionary, it is stored with @b amount as value;
+   otherwise, @b amount is added to the value associated with the key. This
+   allows to keep counters and histograms with a single search of the key.
+
+   @note This method bypasses getIndex__ and setIndex__ overrides in blessed
+   (POOP) dictionaries.
+*/
+FALCON_FUNC  mth_dictInc( ::Falcon::VMachine *vm )
+{
+   Item *i_dict, *i_key, *i_amount;
+
+   if( vm->self().isMethodic() )
+   {
+      i_dict = &vm->self();
+      i_key = vm->param(0);
+      i_amount = vm->param(1);
+   }
+   else {
+      i_dict = vm->param(0);
+      i_key = vm->param(1);
+      i_amount = vm->param(2);
+   }
+
+   if( i_dict == 0  || ! i_dict->isDict() || i_key == 0
+       || ( i_amount != 0 && ! i_amount->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( vm->self().isMethodic() ? "X,[N]" : "D,X,[N]" ) );
+   }
+
+   Item amount = i_amount == 0 ? Item( (int64) 1 ) : *i_amount;
+   CoreDict *dict = i_dict->asDict();
+   Item *value = dict->find( *i_key );
+   if ( value == 0 )
+   {
+      dict->put( *i_key, amount );
+      vm->retval( amount );
+   }
+   else {
+      value->add( amount, *value );
+      vm->retval( *value );
+   }
+}
+
+/*#
+   @function histogram
+   @brief Counts the occurrences of the items in an array.
+   @param array The items to be counted.
+   @optparam dict A dictionary where to add the counts.
+   @return A dictionary having the items of @b array as keys, and the
+      count of their occurrences as values.
+
+   If @b dict is given, the counts are added to the values it already
+   holds, and it's returned.
+
+   @code
+   h = histogram( [ 3, 1, 3, 2, 3 ] )
+   > h[3]                              // 3
+   histogram( [ 1, 4 ], h )
+   > h[1], " ", h[4]                   // 2 1
+   @endcode
+
+   Dictionaries having only integer keys are searched faster, so this is
+   an efficient way to build histograms of integer values.
+
+   @see dictInc
+*/
+FALCON_FUNC  histogram( ::Falcon::VMachine *vm )
+{
+   Item *i_array = vm->param(0);
+   Item *i_dict = vm->param(1);
+
+   if( i_array == 0 || ! i_array->isArray()
+       || ( i_dict != 0 && ! i_dict->isNil() && ! i_dict->isDict() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( "A,[D]" ) );
+   }
+
+   CoreDict *dict = i_dict != 0 && i_dict->isDict() ?
+         i_dict->asDict() : new CoreDict( new LinearDict );
+
+   // the array may change when keys are compared through overrides
+   CoreArray *array = i_array->asArray();
+   for( uint32 i = 0; i < array->length(); ++i )
+   {
+      const Item *key = array->items()[i].dereference();
+      Item *value = dict->find( *key );
+      if ( value == 0 )
+      {
+         if ( key->isString() )
+            dict->put( new CoreString( *key->asString() ), (int64) 1 );
+         else
+            dict->put( *key, (int64) 1 );
+      }
+      else if ( value->isInteger() )
+         value->setInteger( value->asInteger() + 1 );
+      else
+         value->add( Item( (int64) 1 ), *value );
+   }
+
+   vm->retval( dict );
+}
+
 /*#
    @function dictFind
    @brief Returns an iterator set to a given key.
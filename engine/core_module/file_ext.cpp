@@ -36,6 +36,9 @@
 #include <falcon/uri.h>
 #include <falcon/vfsprovider.h>
 #include <falcon/transcoding.h>
+#include <falcon/sequence.h>
+#include <falcon/iterator.h>
+#include <falcon/mempool.h>
 
 #include "core_module.h"
 
@@ -534,41 +537,17 @@ FALCON_FUNC  Stream_readLine ( ::Falcon::VMachine *vm )
 
    // we're idling while using VM memory, but we know we're keeping the data structure constant.
    vm->idle();
-
-   uint32 c = 0, c1 = 0;
-   int pos = 0;
-   bool getOk = file->get( c );
-   while( getOk && pos < size )
-   {
-      if ( c == (uint32)'\r' ) {
-         c1 = c;
-         getOk = file->get( c );
-         continue;
-      }
-      else if ( c == (uint32)'\n' ) {
-         break;
-      }
-      else if ( c1 != 0 ) {
-         c1 = 0;
-         str->append( c1 );
-         ++pos;
-      }
-
-      str->append( c );
-      ++pos;
-      getOk = file->get( c );
-   }
-
+   bool bRead = file->readLine( *str, (uint32) size );
    vm->unidle();
 
-   if ( ! getOk && ! file->eof() )
+   if ( file->bad() || ( ! bRead && ! file->eof() ) )
    {
       s_breakage( file );
    }
 
    // even if we read an empty line AND then we hit eof, we must return true,
    // so the program knows that the last line is empty.
-   vm->regA().setBoolean( getOk || pos > 0 );
+   vm->regA().setBoolean( bRead );
 }
 
 /*#
@@ -654,48 +633,224 @@ FALCON_FUNC  Stream_grabLine ( ::Falcon::VMachine *vm )
       str->reserve( size );
 
    vm->idle();
-   uint32 c = 0, c1 = 0;
-   int pos = 0;
-   bool getOk = file->get( c );
-   while( getOk && (size < 0 || pos < size) )
-   {
-      if ( c == (uint32)'\r' ) {
-         c1 = c;
-         getOk = file->get( c );
-         continue;
-      }
-      else if ( c == (uint32)'\n' ) {
-         break;
-      }
-      else if ( c1 != 0 ) {
-         c1 = 0;
-         str->append( c1 );
-         ++pos;
+   bool bRead = file->readLine( *str, size < 0 ? 0 : (uint32) size );
+   vm->unidle();
+
+   if ( file->bad() || ( ! bRead && ! file->eof() ) )
+   {
+      s_breakage( file );
+   }
+
+   if ( ! bRead )
+   {
+      // no more lines -- consider it null
+      vm->retval( (int64) 0 );
+      vm->regA().setOob( true );
+   }
+   // otherwise, let the returned string to go.
+}
+
+
+/** One-way sequence of the lines of a stream.
+   Lines are read straight from the stream as the VM iterates over
+   the sequence; the current and the next lines are cached, so that
+   the VM can tell which one is the last.
+
+   The sequence refers to the script level stream object, so that
+   changes of encoding or buffering of the stream are honored.
+*/
+class StreamLineSeq: public Sequence
+{
+public:
+   StreamLineSeq( const Item& stream, uint32 size ):
+      m_stream( stream ),
+      m_size( size ),
+      m_bHasCur( false ),
+      m_bHasNext( false ),
+      m_bComplete( false )
+   {}
+
+   StreamLineSeq( const StreamLineSeq& other ):
+      m_stream( other.m_stream ),
+      m_size( other.m_size ),
+      m_cur( other.m_cur ),
+      m_next( other.m_next ),
+      m_bHasCur( other.m_bHasCur ),
+      m_bHasNext( other.m_bHasNext ),
+      m_bComplete( other.m_bComplete )
+   {}
+
+   virtual ~StreamLineSeq() {}
+
+   virtual const Item &front() const { return unsupported( "front" ); }
+   virtual const Item &back() const { return unsupported( "back" ); }
+   virtual void clear() { unsupported( "clear" ); }
+   virtual void append( const Item & ) { unsupported( "append" ); }
+   virtual void prepend( const Item & ) { unsupported( "prepend" ); }
+
+   virtual bool empty() const
+   {
+      return ! m_bHasCur && ! fill( m_cur, m_bHasCur );
+   }
+
+   virtual StreamLineSeq* clone() const
+   {
+      // the copy shares the stream, so the lines go to the first who reads them.
+      return new StreamLineSeq( *this );
+   }
+
+   virtual void gcMark( uint32 gen )
+   {
+      memPool->markItem( m_stream );
+      if ( m_bHasCur )
+         memPool->markItem( m_cur );
+      if ( m_bHasNext )
+         memPool->markItem( m_next );
+
+      Sequence::gcMark( gen );
+   }
+
+protected:
+   virtual void getIterator( Iterator& tgt, bool tail ) const { Sequence::getIterator( tgt, tail ); }
+   virtual void copyIterator( Iterator& tgt, const Iterator& source ) const { Sequence::copyIterator( tgt, source ); }
+   virtual void insert( Iterator &, const Item & ) { unsupported( "insert" ); }
+   virtual void erase( Iterator & ) { unsupported( "erase" ); }
+   virtual bool hasPrev( const Iterator & ) const { return true; }
+   virtual bool prev( Iterator & ) const { unsupported( "prev" ); return false; }
+   virtual bool equalIterator( const Iterator &, const Iterator & ) const { return true; }
+
+   virtual bool hasCurrent( const Iterator & ) const
+   {
+      return m_bHasCur || fill( m_cur, m_bHasCur );
+   }
+
+   virtual bool hasNext( const Iterator &iter ) const
+   {
+      return hasCurrent( iter ) && ( m_bHasNext || fill( m_next, m_bHasNext ) );
+   }
+
+   virtual bool next( Iterator & ) const
+   {
+      if ( m_bHasNext )
+      {
+         m_cur = m_next;
+         m_bHasNext = false;
+         return true;
       }
 
-      str->append( c );
-      ++pos;
-      getOk = file->get( c );
+      m_bHasCur = false;
+      return fill( m_cur, m_bHasCur );
    }
 
-   vm->unidle();
+   virtual Item& getCurrent( const Iterator & )
+   {
+      if ( ! m_bHasCur )
+         fill( m_cur, m_bHasCur );
+      return m_cur;
+   }
 
-   if ( ! getOk )
+   virtual Item& getCurrentKey( const Iterator & )
    {
-      if ( ! file->eof() )
+      throw new CodeError( ErrorParam( e_non_dict_seq, __LINE__ )
+         .origin( e_orig_runtime ).extra( "Stream.lines" ) );
+   }
+
+private:
+   Item m_stream;
+   uint32 m_size;
+   mutable Item m_cur;
+   mutable Item m_next;
+   mutable bool m_bHasCur;
+   mutable bool m_bHasNext;
+   mutable bool m_bComplete;
+
+   const Item& unsupported( const char* op ) const
+   {
+      throw new CodeError( ErrorParam( e_not_implemented, __LINE__ )
+         .origin( e_orig_runtime ).extra( String( "Stream.lines." ) + op ) );
+   }
+
+   /** Reads the next line in target. */
+   bool fill( Item& target, bool& bHas ) const
+   {
+      if ( m_bComplete )
+         return false;
+
+      Stream *file = dyncast<Stream *>( m_stream.asObjectSafe()->getFalconData() );
+      CoreString *line = new CoreString;
+      if ( m_size > 0 )
+         line->reserve( m_size );
+
+      bool bRead = file->readLine( *line, m_size );
+      if ( file->bad() || ( ! bRead && ! file->eof() ) )
       {
+         m_bComplete = true;
          s_breakage( file );
       }
-      // a last line with some data?
-      else if( pos == 0 )
+
+      if ( ! bRead )
       {
-         // no? -- consider it null
-         vm->retval( (int64) 0 );
-         vm->regA().setOob( true );
+         m_bComplete = true;
+         return false;
       }
+
+      target = line;
+      bHas = true;
+      return true;
    }
-   // otherwise, let the returned string to go.
+};
+
+/*#
+   @method lines Stream
+   @brief Returns a sequence of the lines in the stream.
+   @optparam size Maximum count of characters in a line.
+   @return A sequence that can be traversed once.
+   @raise IoError on system errors.
+
+   The lines are read as with @a Stream.grabLine while the sequence is
+   traversed, but without calling a script method for each line. The
+   returned sequence can be used in for/in loops and comprehensions:
+
+   @code
+   s = InputStream( "file.txt" )
+   for line in s.lines()
+      > "LINE: ", line
+   end
+   s.close()
+   @endcode
+
+   Each line is a newly allocated string; the EOL sequence is not part of it.
+   As the lines are consumed by reading them, the sequence can be traversed
+   only once, and other reads on the stream in the meanwhile affect the
+   lines being returned.
+*/
+FALCON_FUNC  Stream_lines ( ::Falcon::VMachine *vm )
+{
+   Item *i_size = vm->param(0);
 
+   if ( i_size != 0 && ! i_size->isOrdinal() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( "[N]" ) );
+   }
+
+   int64 size = i_size == 0 ? 0 : i_size->forceInteger();
+   if ( i_size != 0 && size <= 0 )
+   {
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( vm->moduleString( rtl_zero_size ) ) );
+   }
+
+   Item *seq_class = vm->findWKI( "Sequence" );
+   fassert( seq_class != 0 );
+
+   CoreObject *co = seq_class->asClass()->createInstance();
+   StreamLineSeq *seq = new StreamLineSeq( vm->self(), (uint32) size );
+   seq->owner( co );
+   co->setUserData( seq );
+   vm->retval( co );
 }
 
 /*#
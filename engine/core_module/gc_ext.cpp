@@ -15,6 +15,7 @@
 
 #include "core_module.h"
 #include <falcon/memory.h>
+#include <falcon/heapcensus.h>
 
 /*#
    @beginmodule core
@@ -160,6 +161,115 @@ FALCON_FUNC  GC_adjust( ::Falcon::VMachine *vm )
    }
 }
 
+
+static CoreDict* internal_census_entries( const Map &entries )
+{
+   CoreDict *cd = new CoreDict( new LinearDict( entries.size() ) );
+
+   MapIterator iter = entries.begin();
+   while( iter.hasCurrent() )
+   {
+      HeapCensus::Entry *entry = *(HeapCensus::Entry **) iter.currentValue();
+      CoreDict *ed = new CoreDict( new LinearDict( 2 ) );
+      ed->put( new CoreString( "count" ), (int64) entry->m_count );
+      ed->put( new CoreString( "bytes" ), (int64) entry->m_bytes );
+
+      cd->put( new CoreString( *(String *) iter.currentKey() ), ed );
+      iter.next();
+   }
+
+   return cd;
+}
+
+/*#
+   @method census GC
+   @brief Counts the live items by kind and by allocation site.
+   @return A dictionary describing the items currently alive.
+
+   Walks the memory managed by the garbage collector and returns a
+   dictionary with the following keys:
+   - items: count of the live items.
+   - bytes: estimated memory retained by the live items.
+   - pending: items found dead and still waiting to be reclaimed.
+   - kinds: a dictionary of item kinds.
+   - sites: a dictionary of allocation sites, filled only when
+     allocation site tracking is turned on through @a GC.track.
+
+   Kinds are "array", "dict", "string", "membuf", "function", "class",
+   "range", "reference", "module", "pointer" and "other"; objects are
+   filed under the name of their class, as "object:MyClass". Sites are
+   in the form "module:line". Each entry in kinds and sites is a
+   dictionary holding the "count" of the items and the "bytes" they
+   retain.
+
+   The retained memory is an estimate of the memory directly owned by
+   each item (i.e. the character buffer of a string, or the item vector
+   of an array); the items held by containers are accounted separately.
+
+   The creation of new items is blocked while the census is taken, so
+   this method is meant for diagnostic of memory usage, and shouldn't
+   be called in tight loops.
+
+   @see GC.track
+*/
+
+FALCON_FUNC  GC_census( ::Falcon::VMachine *vm )
+{
+   HeapCensus census;
+   memPool->census( census );
+
+   CoreDict *cd = new CoreDict( new LinearDict( 5 ) );
+   cd->put( new CoreString( "items" ), (int64) census.items() );
+   cd->put( new CoreString( "bytes" ), (int64) census.bytes() );
+   cd->put( new CoreString( "pending" ), (int64) census.pending() );
+   cd->put( new CoreString( "kinds" ), internal_census_entries( census.kinds() ) );
+   cd->put( new CoreString( "sites" ), internal_census_entries( census.sites() ) );
+   vm->retval( cd );
+}
+
+/*#
+   @method track GC
+   @brief Sets or gets the sampling rate of allocation site tracking.
+   @optparam rate One every rate newly created items is tracked; 0 to turn tracking off.
+   @return The sampling rate previously set (0 if tracking was off).
+
+   When tracking is on, the module and line of the script creating a
+   new item are recorded for one item every rate, and reported by
+   @a GC.census under the "sites" key. Items created by functions of
+   binary modules are charged to the script line calling them.
+
+   A rate of 1 tracks every item, but slows down sensibly the creation
+   of new items; a rate of some hundreds is usually enough to spot the
+   lines generating most of the data in long running programs.
+
+   Turning tracking off discards the sites recorded up to date.
+*/
+
+FALCON_FUNC  GC_track( ::Falcon::VMachine *vm )
+{
+   Item *i_rate = vm->param(0);
+   vm->retval( (int64) memPool->trackSites() );
+
+   if ( i_rate != 0 )
+   {
+      if ( ! i_rate->isOrdinal() )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin(e_orig_runtime)
+            .extra( "[N]" ) );
+      }
+
+      int64 rate = i_rate->forceInteger();
+      if ( rate < 0 || rate > 0x7FFFFFFF )
+      {
+         throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .origin(e_orig_runtime) );
+      }
+
+      memPool->trackSites( (uint32) rate );
+   }
+}
+
 // Reflective path method
 void GC_usedMem_rfrom(CoreObject *instance, void *user_data, Item &property, const PropEntry& )
 {
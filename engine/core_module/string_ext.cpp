@@ -438,8 +438,8 @@ FALCON_FUNC  mth_strSplitTrimmed ( ::Falcon::VMachine *vm )
    {
       uint32 sp_pos = 0;
       // skip matching pattern-
-      while ( tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos ) &&
-              sp_pos < sp_len && pos <= tg_len - sp_len ) {
+      while ( sp_pos < sp_len && pos < tg_len && tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos ) &&
+              pos <= tg_len - sp_len ) {
          sp_pos++;
          pos++;
       }
@@ -458,8 +458,9 @@ FALCON_FUNC  mth_strSplitTrimmed ( ::Falcon::VMachine *vm )
          while( sp_pos == sp_len && pos <= tg_len - sp_len ) {
             sp_pos = 0;
             last_pos = pos;
-            while ( tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos )
-                    && sp_pos < sp_len && pos <= tg_len - sp_len ) {
+            while ( sp_pos < sp_len && pos < tg_len
+                    && tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos )
+                    && pos <= tg_len - sp_len ) {
                sp_pos++;
                pos++;
             }
@@ -618,8 +619,8 @@ FALCON_FUNC  mth_strSplit ( ::Falcon::VMachine *vm )
    {
       uint32 sp_pos = 0;
       // skip matching pattern-
-      while ( tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos ) &&
-              sp_pos < sp_len && pos <= tg_len - sp_len ) {
+      while ( sp_pos < sp_len && pos < tg_len && tg_str->getCharAt( pos ) == sp_str->getCharAt( sp_pos ) &&
+              pos <= tg_len - sp_len ) {
          sp_pos++;
          pos++;
       }
@@ -1350,8 +1351,8 @@ FALCON_FUNC  mth_strReplace ( ::Falcon::VMachine *vm )
       int32 ned_pos = 0;
       int32 pos = 0;
       // skip matching pattern
-      while ( tg_str->getCharAt( start + pos ) == ned_str->getCharAt( ned_pos )
-               && ned_pos < (int32) ned_len && start + ned_pos <= end )
+      while ( ned_pos < (int32) ned_len && start + ned_pos <= end
+               && tg_str->getCharAt( start + pos ) == ned_str->getCharAt( ned_pos ) )
       {
          ned_pos++;
          pos++;
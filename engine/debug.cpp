@@ -47,7 +47,7 @@ namespace Falcon
       return m_watches;
    }
 
-   const ItemArray& DebugVMachine::stackTrace() const
+   const FrameStack& DebugVMachine::stackTrace() const
    {
       return stack();
    }
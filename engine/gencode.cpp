@@ -20,6 +20,8 @@
 #include <falcon/stream.h>
 #include <falcon/fassert.h>
 #include <falcon/linemap.h>
+#include <falcon/genericvector.h>
+#include <falcon/traits.h>
 
 namespace Falcon
 {
@@ -184,6 +186,9 @@ void GenCode::generate( const SourceTree *st  )
          gen_pcode( P_RET );
       }
    }
+
+   // the module is complete; share its strings with the other modules.
+   m_module->stringTable().intern();
 }
 
 void GenCode::gen_pcode( byte pcode,
@@ -1552,8 +1557,18 @@ void GenCode::gen_expression( const Expression *exp, t_valType &xValue )
       case Expression::t_exeq: mode = 2; opname = P_EXEQ; break;
       case Expression::t_neq: mode = 2; opname = P_NEQ; break;
 
-      case Expression::t_in: mode = 2; opname = P_IN; break;
-      case Expression::t_notin: mode = 2; opname = P_NOIN; break;
+      case Expression::t_in:
+      case Expression::t_notin:
+         // membership in a literal list is checked against a switch table
+         if ( exp->second()->type() == Value::t_array_decl &&
+               gen_in_set( exp->first(), exp->second()->asArray(), exp->type() == Expression::t_notin ) )
+         {
+            xValue = l_value;
+            return;
+         }
+         mode = 2;
+         opname = exp->type() == Expression::t_in ? P_IN : P_NOIN;
+      break;
       case Expression::t_provides: mode = 2; opname = P_PROV; break;
       case Expression::t_fbind: mode = 2; opname = P_FORB; break;
 
@@ -1817,6 +1832,80 @@ void GenCode::gen_array_decl( const ArrayDecl *dcl )
 }
 
 
+/** Inserts a literal in a vector of literals sorted by value, skipping duplicates. */
+static void s_insertSorted( GenericVector &vect, const Value *val )
+{
+   uint32 lower = 0, higher = vect.size();
+   while( lower < higher )
+   {
+      uint32 point = ( lower + higher ) / 2;
+      const Value *current = *(const Value **) vect.at( point );
+      if ( *current == *val )
+         return;
+      if ( *current < *val )
+         lower = point + 1;
+      else
+         higher = point;
+   }
+   vect.insert( (void *) val, lower );
+}
+
+bool GenCode::gen_in_set( const Value *item, const ArrayDecl *set, bool negate )
+{
+   GenericVector ints( &traits::t_voidp() );
+   GenericVector strs( &traits::t_voidp() );
+
+   ListElement *iter = set->begin();
+   while( iter != 0 )
+   {
+      const Value *val = (const Value *) iter->data();
+      if ( val->type() == Value::t_imm_integer )
+         s_insertSorted( ints, val );
+      else if ( val->type() == Value::t_imm_string )
+         s_insertSorted( strs, val );
+      else
+         return false;
+      iter = iter->next();
+   }
+
+   if ( ints.empty() && strs.empty() )
+      return false;
+   if ( ints.size() > 0x7FFF || strs.size() > 0x7FFF )
+      return false;
+
+   c_varpar sizes_par;
+   sizes_par.m_type = e_parNTD64;
+   sizes_par.m_content.immediate64 = ((int64) ints.size()) << 48 | ((int64) strs.size()) << 16;
+
+   if ( item->isSimple() )
+      gen_pcode( P_INSW, c_param_fixed( negate ? 1 : 0 ), item, sizes_par );
+   else {
+      gen_complex_value( item );
+      gen_pcode( P_INSW, c_param_fixed( negate ? 1 : 0 ), e_parA, sizes_par );
+   }
+
+   // the table, as for the switch; there isn't any nil case and landings are unused.
+   int32 dummy = 0xFFFFFFFF;
+   int32 landing = 0;
+   m_outTemp->write( &dummy, sizeof( dummy ) );
+
+   for ( uint32 i = 0; i < ints.size(); ++i )
+   {
+      int64 value = (*(const Value **) ints.at( i ))->asInteger();
+      m_outTemp->write( &value, sizeof( value ) );
+      m_outTemp->write( &landing, sizeof( landing ) );
+   }
+
+   for ( uint32 i = 0; i < strs.size(); ++i )
+   {
+      int32 strid = m_module->stringTable().findId( *(*(const Value **) strs.at( i ))->asString() );
+      m_outTemp->write( &strid, sizeof( strid ) );
+      m_outTemp->write( &landing, sizeof( landing ) );
+   }
+
+   return true;
+}
+
 void GenCode::gen_range_decl( const RangeDecl *dcl )
 {
    if ( dcl->isOpen() )
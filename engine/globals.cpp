@@ -25,6 +25,7 @@
 #include <falcon/vfs_file.h>
 #include <falcon/strtable.h>
 #include <falcon/modulecache.h>
+#include <falcon/interntable.h>
 
 namespace Falcon
 {
@@ -42,6 +43,7 @@ namespace Engine
    static String* s_sSrcEnc = 0;
    static String* s_searchPath = 0;
    static ModuleCache* s_moduleCache = 0;
+   static InternTable* s_internTable = 0;
 
 #ifdef FALCON_SYSTEM_WIN
    static bool s_bWindowsNamesConversion = true;
@@ -112,6 +114,8 @@ namespace Engine
       memPool = new MemPool;
       memPool->start();
 
+      s_internTable = new InternTable;
+
       // create the default file VSF
       addVFS( "file", new VFSFile );
       addVFS( "", new VFSFile );
@@ -135,6 +139,10 @@ namespace Engine
       delete s_moduleCache;
       s_moduleCache = 0;
 
+      // the modules and the items may share the interned strings up to here.
+      delete s_internTable;
+      s_internTable = 0;
+
       releaseLanguage();
       releaseEncodings();
 
@@ -281,6 +289,21 @@ namespace Engine
    {
       return s_moduleCache;
    }
+
+   uint32 flushModuleCache()
+   {
+      uint32 count = 0;
+      s_mtx.lock();
+      if ( s_moduleCache != 0 )
+         count = s_moduleCache->clear();
+      s_mtx.unlock();
+      return count;
+   }
+
+   InternTable* getInternTable()
+   {
+      return s_internTable;
+   }
 }
 
 }
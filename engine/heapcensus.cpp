@@ -0,0 +1,178 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: heapcensus.cpp
+
+   Snapshot of the live items held by the memory pool.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 19:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Snapshot of the live items held by the memory pool.
+*/
+
+#include <falcon/heapcensus.h>
+#include <falcon/traits.h>
+#include <falcon/string.h>
+#include <falcon/item.h>
+#include <falcon/coreobject.h>
+#include <falcon/carray.h>
+#include <falcon/coredict.h>
+#include <falcon/corefunc.h>
+#include <falcon/corerange.h>
+#include <falcon/cclass.h>
+#include <falcon/membuf.h>
+#include <falcon/livemodule.h>
+#include <falcon/garbagepointer.h>
+#include <falcon/proptable.h>
+#include <falcon/symbol.h>
+
+namespace Falcon {
+
+HeapCensus::HeapCensus():
+   m_kinds( &traits::t_string(), &traits::t_voidp() ),
+   m_sites( &traits::t_string(), &traits::t_voidp() ),
+   m_classes( &traits::t_voidp(), &traits::t_voidp() ),
+   m_modules( &traits::t_voidp(), &traits::t_voidp() ),
+   m_items( 0 ),
+   m_bytes( 0 ),
+   m_pending( 0 )
+{}
+
+
+HeapCensus::~HeapCensus()
+{
+   MapIterator iter = m_kinds.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(Entry**) iter.currentValue();
+      iter.next();
+   }
+
+   iter = m_sites.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(Entry**) iter.currentValue();
+      iter.next();
+   }
+}
+
+
+void HeapCensus::addTo( Map &map, const String &key, uint32 bytes )
+{
+   Entry *entry;
+   void *found = map.find( &key );
+   if ( found != 0 )
+      entry = *(Entry**) found;
+   else
+   {
+      entry = new Entry;
+      map.insert( &key, entry );
+   }
+
+   entry->m_count++;
+   entry->m_bytes += bytes;
+}
+
+
+void HeapCensus::prepare( GarbageableBase *item )
+{
+   if ( CoreClass *cls = dynamic_cast<CoreClass*>( item ) )
+      m_classes.insert( cls, cls );
+   else if ( LiveModule *lmod = dynamic_cast<LiveModule*>( item ) )
+      m_modules.insert( lmod, lmod );
+}
+
+
+void HeapCensus::account( GarbageableBase *item, const String *site )
+{
+   String kind;
+   uint32 bytes;
+
+   // arrays and functions are both call points; check the arrays first.
+   if ( CoreArray *arr = dynamic_cast<CoreArray*>( item ) )
+   {
+      kind = "array";
+      bytes = sizeof( CoreArray ) + arr->items().esize( arr->items().allocated() );
+   }
+   else if ( CoreObject *obj = dynamic_cast<CoreObject*>( item ) )
+   {
+      // the symbol of the class is valid as long as its module is alive.
+      const CoreClass *cls = obj->generator();
+      kind = "object";
+      bytes = sizeof( CoreObject );
+      if ( cls != 0 && m_classes.find( cls ) != 0
+            && cls->liveModule() != 0 && m_modules.find( cls->liveModule() ) != 0 )
+      {
+         kind += ":";
+         kind += cls->symbol()->name();
+         bytes += cls->properties().added() * sizeof( Item );
+      }
+   }
+   else if ( StringGarbage *sg = dynamic_cast<StringGarbage*>( item ) )
+   {
+      kind = "string";
+      bytes = sizeof( CoreString ) + sg->str()->allocated();
+   }
+   else if ( CoreDict *dict = dynamic_cast<CoreDict*>( item ) )
+   {
+      kind = "dict";
+      bytes = sizeof( CoreDict ) + dict->length() * 2 * sizeof( Item );
+   }
+   else if ( MemBuf *mb = dynamic_cast<MemBuf*>( item ) )
+   {
+      kind = "membuf";
+      bytes = sizeof( MemBuf ) + mb->size();
+   }
+   else if ( dynamic_cast<CoreFunc*>( item ) != 0 )
+   {
+      kind = "function";
+      bytes = sizeof( CoreFunc );
+   }
+   else if ( dynamic_cast<CoreClass*>( item ) != 0 )
+   {
+      kind = "class";
+      bytes = sizeof( CoreClass );
+   }
+   else if ( dynamic_cast<CoreRange*>( item ) != 0 )
+   {
+      kind = "range";
+      bytes = sizeof( CoreRange );
+   }
+   else if ( dynamic_cast<GarbageItem*>( item ) != 0 )
+   {
+      kind = "reference";
+      bytes = sizeof( GarbageItem );
+   }
+   else if ( dynamic_cast<LiveModule*>( item ) != 0 )
+   {
+      kind = "module";
+      bytes = sizeof( LiveModule );
+   }
+   else if ( dynamic_cast<GarbagePointer*>( item ) != 0 )
+   {
+      kind = "pointer";
+      bytes = sizeof( GarbagePointer );
+   }
+   else
+   {
+      kind = "other";
+      bytes = item->occupation();
+   }
+
+   m_items++;
+   m_bytes += bytes;
+   addTo( m_kinds, kind, bytes );
+   if ( site != 0 )
+      addTo( m_sites, *site, bytes );
+}
+
+}
+
+/* end of heapcensus.cpp */
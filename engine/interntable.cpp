@@ -0,0 +1,159 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: interntable.cpp
+
+   Engine wide table of immutable strings.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 20:41:07 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Engine wide table of immutable strings.
+*/
+
+#include <falcon/interntable.h>
+#include <falcon/string.h>
+#include <falcon/memory.h>
+#include <string.h>
+
+#define INTERN_INITIAL_BUCKETS 512
+
+namespace Falcon {
+
+class InternTable::Entry: public BaseAlloc
+{
+public:
+   String m_str;
+   Entry *m_next;
+
+   Entry( Entry *next ):
+      m_next( next )
+   {}
+};
+
+
+InternTable::InternTable():
+   m_bucketCount( INTERN_INITIAL_BUCKETS ),
+   m_count( 0 )
+{
+   m_buckets = (Entry **) memAlloc( m_bucketCount * sizeof( Entry* ) );
+   memset( m_buckets, 0, m_bucketCount * sizeof( Entry* ) );
+}
+
+
+InternTable::~InternTable()
+{
+   for( uint32 i = 0; i < m_bucketCount; ++i )
+   {
+      Entry *entry = m_buckets[i];
+      while( entry != 0 )
+      {
+         Entry *next = entry->m_next;
+         if ( entry->m_str.m_storage != 0 )
+            memFree( entry->m_str.m_storage );
+         delete entry;
+         entry = next;
+      }
+   }
+
+   memFree( m_buckets );
+}
+
+
+void InternTable::grow()
+{
+   uint32 count = m_bucketCount * 2;
+   Entry **buckets = (Entry **) memAlloc( count * sizeof( Entry* ) );
+   memset( buckets, 0, count * sizeof( Entry* ) );
+
+   for( uint32 i = 0; i < m_bucketCount; ++i )
+   {
+      Entry *entry = m_buckets[i];
+      while( entry != 0 )
+      {
+         Entry *next = entry->m_next;
+         uint32 pos = entry->m_str.m_hash & (count - 1);
+         entry->m_next = buckets[pos];
+         buckets[pos] = entry;
+         entry = next;
+      }
+   }
+
+   memFree( m_buckets );
+   m_buckets = buckets;
+   m_bucketCount = count;
+}
+
+
+const String *InternTable::intern( const String &str )
+{
+   uint32 hash = str.hash();
+   uint32 charSize = str.manipulator()->charSize();
+
+   m_mtx.lock();
+   Entry *entry = m_buckets[ hash & (m_bucketCount - 1) ];
+   while( entry != 0 )
+   {
+      if ( entry->m_str.m_hash == hash
+            && entry->m_str.manipulator()->charSize() == charSize
+            && entry->m_str.equals( str ) )
+      {
+         m_mtx.unlock();
+         return &entry->m_str;
+      }
+      entry = entry->m_next;
+   }
+
+   if ( m_count >= m_bucketCount )
+      grow();
+
+   // the entry owns a copy of the data, that its static string shares.
+   uint32 size = str.size();
+   byte *data = 0;
+   if ( size > 0 )
+   {
+      data = (byte *) memAlloc( size );
+      memcpy( data, str.getRawStorage(), size );
+   }
+
+   uint32 pos = hash & (m_bucketCount - 1);
+   entry = new Entry( m_buckets[pos] );
+   switch( charSize )
+   {
+      case 1: entry->m_str.m_class = csh::f_handler_static(); break;
+      case 2: entry->m_str.m_class = csh::f_handler_static16(); break;
+      default: entry->m_str.m_class = csh::f_handler_static32(); break;
+   }
+   entry->m_str.m_storage = data;
+   entry->m_str.m_size = size;
+   entry->m_str.m_bFlags = String::flag_interned;
+   entry->m_str.m_hash = hash;
+
+   m_buckets[pos] = entry;
+   m_count++;
+   m_mtx.unlock();
+
+   return &entry->m_str;
+}
+
+
+void InternTable::share( String &target )
+{
+   if ( target.isInterned() )
+      return;
+
+   const String *interned = intern( target );
+   target.copy( *interned );
+   target.m_bFlags |= String::flag_interned;
+   target.m_hash = interned->m_hash;
+}
+
+}
+
+/* end of interntable.cpp */
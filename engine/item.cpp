@@ -306,6 +306,40 @@ void SafeItem::setGCPointer( GarbagePointer *shell )
 //===========================================================================
 // Generic item manipulators
 
+uint32 Item::hash() const
+{
+   const Item *item = dereference();
+   switch( item->type() )
+   {
+      case FLC_ITEM_BOOL:
+         return item->asBoolean() ? 1 : 0;
+
+      case FLC_ITEM_INT:
+      {
+         uint64 value = (uint64) item->asInteger();
+         return (uint32)( value ^ ( value >> 32 ) );
+      }
+
+      case FLC_ITEM_NUM:
+      {
+         // integral numbers are equal to the same integers.
+         numeric value = item->asNumeric();
+         uint64 bits;
+         if ( value > -9.2e18 && value < 9.2e18 && (numeric)(int64) value == value )
+            bits = (uint64)(int64) value;
+         else
+            memcpy( &bits, &value, sizeof( bits ) );
+         return (uint32)( bits ^ ( bits >> 32 ) );
+      }
+
+      case FLC_ITEM_STRING:
+         return item->asString()->hash();
+   }
+
+   return item->type();
+}
+
+
 bool Item::isTrue() const
 {
    switch( dereference()->type() )
@@ -96,15 +96,15 @@ void co_num_add( const Item& first, const Item& second, Item& third )
 void co_string_add( const Item& first, const Item& second, Item& third )
 {
    String *sf = first.asString();
-   CoreString *dest = new CoreString( *sf );
+   CoreString *dest = new CoreString;
 
-   // Clones also garbage status
+   // long results share growable data, so that repeated additions are cheap.
 
    const Item *op2 = second.dereference();
 
    if( op2->isString() )
    {
-      dest->append( *op2->asString() );
+      dest->concat( *sf, *op2->asString() );
    }
    else
    {
@@ -115,7 +115,7 @@ void co_string_add( const Item& first, const Item& second, Item& third )
       else
          op2->toString( tgt );
 
-      dest->append( tgt );
+      dest->concat( *sf, tgt );
    }
 
    third = dest;
@@ -1295,10 +1295,11 @@ int co_int_compare( const Item& first, const Item& second )
 
       case FLC_ITEM_INT:
       {
-         // converting the int to a 32 bit integer is not a simple matter
-         int64 v = (first.asInteger() - second.asInteger()) ;
-         if (v==0) return 0;
-         if ( v > 0 ) return 1;
+         // don't subtract; the difference may overflow.
+         int64 v1 = first.asInteger();
+         int64 v2 = second.asInteger();
+         if ( v1 == v2 ) return 0;
+         if ( v1 > v2 ) return 1;
          return -1;
       }
 
@@ -1463,7 +1464,9 @@ int co_string_compare( const Item& first, const Item& second )
    }
    else if ( second.isString() )
    {
-      return first.asString()->compare( *second.asString() );
+      const String *s1 = first.asString();
+      const String *s2 = second.asString();
+      return s1 == s2 ? 0 : s1->compare( *s2 );
    }
    else if ( second.isUnbound() )
    {
@@ -653,6 +653,7 @@ Item::e_sercode Item::deserialize( Stream *file, VMachine *vm )
             }
 
             if( retval == sc_ok ) {
+               dict->checkKeys();
                CoreDict* cdict = new CoreDict( dict );
                cdict->bless( blessed ? true : false );
                setDict( cdict );
@@ -0,0 +1,211 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: itemstack.cpp
+
+   Segmented item stack shared by the frames of a context.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 17:05:22 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Segmented item stack shared by the frames of a context.
+*/
+
+#include <falcon/itemstack.h>
+#include <falcon/itemarray.h>
+#include <falcon/stackframe.h>
+#include <falcon/memory.h>
+#include <falcon/fassert.h>
+
+#include <string.h>
+
+// Items in the first segment, and minimum size of the other ones.
+#define ITEMSTACK_SEGMENT_SIZE   1024
+// A new frame is opened in the next segment if less than this is left.
+#define ITEMSTACK_MIN_ROOM       32
+
+namespace Falcon
+{
+
+class ItemStack::Segment
+{
+public:
+   Segment* m_next;
+   uint32 m_alloc;
+
+   Item* items() { return (Item*) (this + 1); }
+   Item* end() { return items() + m_alloc; }
+
+   static Segment* create( uint32 alloc )
+   {
+      Segment* seg = (Segment*) memAlloc( sizeof( Segment ) + sizeof( Item ) * alloc );
+      seg->m_next = 0;
+      seg->m_alloc = alloc;
+      return seg;
+   }
+};
+
+
+void FrameStack::relocate( uint32 size )
+{
+   fassert( m_owner != 0 );
+
+   Item* old = m_base;
+   // leave room to grow, so that a growing frame is moved only a few times.
+   ItemStack::Segment* seg = m_owner->next( (ItemStack::Segment*) m_segment, size * 2 );
+   m_owner->place( *this, seg, seg->items() );
+   memcpy( (void*) m_base, old, sizeof( Item ) * m_size );
+}
+
+
+void FrameStack::copyOnto( uint32 from, const ItemArray& src )
+{
+   uint32 len = src.length();
+   if ( from + len > m_size )
+      resize( from + len );
+
+   memcpy( (void*)(m_base + from), src.elements(), sizeof( Item ) * len );
+}
+
+//====================================================
+// Item stack
+//
+
+ItemStack::ItemStack():
+   m_first( 0 )
+{
+}
+
+
+ItemStack::~ItemStack()
+{
+   Segment* seg = m_first;
+   while( seg != 0 )
+   {
+      Segment* next = seg->m_next;
+      memFree( seg );
+      seg = next;
+   }
+}
+
+
+ItemStack::Segment* ItemStack::next( Segment* seg, uint32 size )
+{
+   Segment** pnext = seg == 0 ? &m_first : &seg->m_next;
+   Segment* nseg = *pnext;
+
+   if ( nseg != 0 && nseg->m_alloc >= size )
+      return nseg;
+
+   // Nothing lives above the topmost frame; the segments there are free.
+   while( nseg != 0 )
+   {
+      Segment* next = nseg->m_next;
+      memFree( nseg );
+      nseg = next;
+   }
+
+   nseg = Segment::create( size < ITEMSTACK_SEGMENT_SIZE ? ITEMSTACK_SEGMENT_SIZE : size );
+   *pnext = nseg;
+   return nseg;
+}
+
+
+void ItemStack::place( FrameStack& window, Segment* seg, Item* base )
+{
+   window.m_owner = this;
+   window.m_segment = seg;
+   window.m_base = base;
+   window.m_alloc = (uint32) (seg->end() - base);
+}
+
+
+void ItemStack::attach( StackFrame* frame, StackFrame* below )
+{
+   FrameStack& window = frame->stack();
+
+   if ( below == 0 )
+   {
+      Segment* seg = m_first != 0 ? m_first : next( 0, ITEMSTACK_SEGMENT_SIZE );
+      place( window, seg, seg->items() );
+   }
+   else
+   {
+      const FrameStack& bw = below->stack();
+      fassert( bw.m_owner == this );
+
+      if ( bw.m_alloc - bw.m_size >= ITEMSTACK_MIN_ROOM )
+      {
+         place( window, (Segment*) bw.m_segment, bw.m_base + bw.m_size );
+      }
+      else
+      {
+         Segment* seg = next( (Segment*) bw.m_segment, ITEMSTACK_SEGMENT_SIZE );
+         place( window, seg, seg->items() );
+      }
+   }
+
+   window.m_size = 0;
+}
+
+
+void ItemStack::adopt( StackFrame* top, StackFrame* bottom, StackFrame* below )
+{
+   // we must work from the bottom up, but the chain goes the other way.
+   uint32 count = 1;
+   StackFrame* frame = top;
+   while( frame != bottom )
+   {
+      frame = frame->prev();
+      ++count;
+   }
+
+   StackFrame** frames = (StackFrame**) memAlloc( sizeof( StackFrame* ) * count );
+   frame = top;
+   for( uint32 i = count; i > 0; --i )
+   {
+      frames[i-1] = frame;
+      frame = frame->prev();
+   }
+
+   for( uint32 i = 0; i < count; ++i )
+   {
+      frame = frames[i];
+      FrameStack old = frame->stack();
+
+      attach( frame, i == 0 ? below : frames[i-1] );
+      FrameStack& window = frame->stack();
+      window.reserve( old.m_size );
+      memcpy( (void*) window.m_base, old.m_base, sizeof( Item ) * old.m_size );
+      window.m_size = old.m_size;
+
+      if ( i > 0 )
+         frame->prepareParams( frames[i-1], frame->m_param_count );
+   }
+
+   memFree( frames );
+}
+
+
+uint32 ItemStack::allocated() const
+{
+   uint32 count = 0;
+   Segment* seg = m_first;
+   while( seg != 0 )
+   {
+      count += seg->m_alloc;
+      seg = seg->m_next;
+   }
+
+   return count;
+}
+
+}
+
+/* end of itemstack.cpp */
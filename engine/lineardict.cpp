@@ -31,11 +31,13 @@ LinearDict::LinearDict():
    m_size(0),
    m_alloc(0),
    m_data(0),
-   m_mark( 0xFFFFFFFF )
+   m_mark( 0xFFFFFFFF ),
+   m_bIntKeys( true )
 {}
 
 LinearDict::LinearDict( uint32 size ):
-   m_mark( 0xFFFFFFFF )
+   m_mark( 0xFFFFFFFF ),
+   m_bIntKeys( true )
 {
    m_data = (LinearDictEntry *) memAlloc( esize( size ) );
    length(0);
@@ -215,6 +217,9 @@ bool LinearDict::addInternal( uint32 pos, const Item &key, const Item &value )
    if ( pos > m_size )
       return false;
 
+   if ( ! key.isInteger() )
+      m_bIntKeys = false;
+
    // haven't we got enough space?
    if ( m_alloc <= m_size  )
    {
@@ -253,10 +258,12 @@ bool LinearDict::removeAt( uint32 pos )
       return false;
 
    if ( pos < m_size - 1 )
-      memmove( m_data + pos, m_data + pos + 1, esize( m_size - pos ) );
+      memmove( m_data + pos, m_data + pos + 1, esize( m_size - pos - 1 ) );
    // otherwise, there's nothing to move...
 
    length( m_size - 1 );
+   if ( m_size == 0 )
+      m_bIntKeys = true;
 
    // for now, do not reallocate.
    m_invalidPos = pos;
@@ -266,8 +273,64 @@ bool LinearDict::removeAt( uint32 pos )
 }
 
 
+bool LinearDict::findInteger( int64 key, uint32 &ret_pos ) const
+{
+   if ( m_size == 0 )
+   {
+      ret_pos = 0;
+      return false;
+   }
+
+   int64 first = m_data[0].key().asInteger();
+   int64 last = m_data[m_size-1].key().asInteger();
+
+   // appending or prepending is common when filling a dictionary.
+   if ( key > last )
+   {
+      ret_pos = m_size;
+      return false;
+   }
+
+   if ( key < first )
+   {
+      ret_pos = 0;
+      return false;
+   }
+
+   // contiguous keys? -- then they are directly indexed.
+   if ( (uint64) last - (uint64) first == m_size - 1 )
+   {
+      ret_pos = (uint32) ((uint64) key - (uint64) first);
+      return true;
+   }
+
+   uint32 lower = 0;
+   uint32 higher = m_size;
+   while( lower < higher )
+   {
+      uint32 point = (lower + higher) / 2;
+      int64 current = m_data[point].key().asInteger();
+      if ( current < key )
+         lower = point + 1;
+      else if ( current > key )
+         higher = point;
+      else
+      {
+         ret_pos = point;
+         return true;
+      }
+   }
+
+   ret_pos = lower;
+   return false;
+}
+
+
 bool LinearDict::findInternal( const Item &key, uint32 &ret_pos ) const
 {
+   if ( m_bIntKeys && key.isInteger() )
+      return findInteger( key.asInteger(), ret_pos );
+
    uint32 lower = 0, higher, point;
    higher = m_size;
 
@@ -347,6 +410,7 @@ LinearDict *LinearDict::clone() const
    {
       ret = new LinearDict( m_size );
       ret->length( m_size );
+      ret->m_bIntKeys = m_bIntKeys;
       memcpy( ret->m_data, m_data, esize( m_size ) );
 
       // duplicate strings
@@ -371,9 +435,24 @@ void LinearDict::clear()
    m_data = 0;
    m_alloc = 0;
    m_size = 0;
+   m_bIntKeys = true;
    invalidateAllIters();
 }
 
+
+void LinearDict::checkKeys()
+{
+   m_bIntKeys = true;
+   for( uint32 i = 0; i < m_size; ++i )
+   {
+      if ( ! m_data[i].key().isInteger() )
+      {
+         m_bIntKeys = false;
+         break;
+      }
+   }
+}
+
 void LinearDict::gcMark( uint32 gen )
 {
    if ( m_mark  != gen )
@@ -421,10 +500,12 @@ void LinearDict::erase( Iterator &iter )
    
    uint32 pos = (uint32)iter.position();
    if ( pos < m_size - 1 )
-      memmove( m_data + pos, m_data + pos + 1, esize( m_size - pos ) );
+      memmove( m_data + pos, m_data + pos + 1, esize( m_size - pos - 1 ) );
    // otherwise, there's nothing to move...
 
    length( m_size - 1 );
+   if ( m_size == 0 )
+      m_bIntKeys = true;
 
    // the next item has automatically moved on the position pointed by us
    // but the other iterators should be killed.
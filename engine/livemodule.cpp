@@ -21,6 +21,8 @@
 #include <falcon/memory.h>
 #include <falcon/fassert.h>
 #include <falcon/mempool.h>
+#include <falcon/switchindex.h>
+#include <falcon/traits.h>
 
 #include <string.h>
 
@@ -36,6 +38,7 @@ LiveModule::LiveModule( Module *mod, bool bPrivate ):
    m_module( mod ),
    m_aacc( 0 ),
    m_iacc( 0 ),
+   m_switchIndex( 0 ),
    m_bPrivate( bPrivate ),
    m_bAlive(true),
    m_needsCompleteLink( true ),
@@ -61,6 +64,17 @@ LiveModule::~LiveModule()
    if ( m_strings != 0 )
       memFree( m_strings );
 
+   if ( m_switchIndex != 0 )
+   {
+      MapIterator iter = m_switchIndex->begin();
+      while( iter.hasCurrent() )
+      {
+         delete *(SwitchIndex **) iter.currentValue();
+         iter.next();
+      }
+      delete m_switchIndex;
+   }
+
    m_module->decref();
    memPool->accountItems( m_iacc );
    gcMemAccount( m_aacc );
@@ -100,6 +114,22 @@ Item *LiveModule::findModuleItem( const String &symName ) const
    return const_cast<Item*>(&m_globals[ sym->itemId() ]);
 }
 
+const SwitchIndex *LiveModule::switchIndex( byte *table, uint64 count ) const
+{
+   if ( m_switchIndex == 0 )
+      m_switchIndex = new Map( &traits::t_voidp(), &traits::t_voidp() );
+   else
+   {
+      void *found = m_switchIndex->find( table );
+      if ( found != 0 )
+         return *(SwitchIndex **) found;
+   }
+
+   SwitchIndex *index = new SwitchIndex( m_module, table, count );
+   m_switchIndex->insert( table, index );
+   return index;
+}
+
 bool LiveModule::finalize()
 {
    // resist early destruction
@@ -137,9 +167,13 @@ String* LiveModule::getString( uint32 stringId ) const
    
    if( m_strings[stringId] == 0 )
    {
-      CoreString* dest = new CoreString( *m_module->stringTable().get( stringId ) );
+      const String *src = m_module->stringTable().get( stringId );
+      CoreString* dest = new CoreString( *src );
       m_strings[stringId] = dest;
-      dest->bufferize();
+      // interned data stays valid and unchanged until the engine shutdown;
+      // static strings are copied on write, so we can share it.
+      if ( ! src->isInterned() )
+         dest->bufferize();
       gcMemUnaccount( sizeof( CoreString ) + dest->allocated() );
       memPool->accountItems( -1 );
       m_aacc += sizeof( CoreString ) + dest->allocated();
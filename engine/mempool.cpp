@@ -30,6 +30,8 @@
 #include <falcon/membuf.h>
 #include <falcon/garbagepointer.h>
 #include <falcon/garbagelock.h>
+#include <falcon/heapcensus.h>
+#include <falcon/traits.h>
 
 
 #include <string>
@@ -60,7 +62,12 @@ MemPool::MemPool():
    m_th(0),
    m_bLive(false),
    m_bRequestSweep( false ),
-   m_lockGen( 0 )
+   m_lockGen( 0 ),
+   m_censusTarget( 0 ),
+   m_siteRate( 0 ),
+   m_siteTick( 0 ),
+   m_siteNames( &traits::t_string(), &traits::t_voidp() ),
+   m_itemSites( &traits::t_voidp(), &traits::t_voidp() )
 {
    m_vmRing = 0;
 
@@ -100,11 +107,15 @@ MemPool::~MemPool()
    // ensure the thread is down.
    stop();
 
-   clearRing( m_newRoot );
-   clearRing( m_garbageRoot );
+   clearRing( m_newRoot, m_mingen );
+   clearRing( m_garbageRoot, m_mingen );
    delete m_newRoot;
    delete m_garbageRoot;
 
+   m_mtx_newitem.lock();
+   clearSites();
+   m_mtx_newitem.unlock();
+
    // delete the garbage lock ring.
    GarbageLock *ge = m_lockRoot->next();
    while( ge != m_lockRoot )
@@ -276,7 +287,7 @@ void MemPool::electOlderVM()
 }
 
 
-void MemPool::clearRing( GarbageableBase *ringRoot )
+void MemPool::clearRing( GarbageableBase *ringRoot, uint32 mingen )
 {
    TRACE( "Entering sweep %ld, allocated %ld", (long)gcMemAllocated(), (long)m_allocatedItems );
    // delete the garbage ring.
@@ -287,13 +298,21 @@ void MemPool::clearRing( GarbageableBase *ringRoot )
    GarbageableBase *later_ring = 0;
    while( ring != m_garbageRoot )
    {
-      if ( ring->mark() < m_mingen )
+      if ( ring->mark() < mingen )
       {
          ring->nextGarbage()->prevGarbage( ring->prevGarbage() );
          ring->prevGarbage()->nextGarbage( ring->nextGarbage() );
          GarbageableBase *dropped = ring;
          ring = ring->nextGarbage();
 
+         // forget the site before the memory can be reused by another item.
+         if ( m_siteRate != 0 )
+         {
+            m_mtx_newitem.lock();
+            m_itemSites.erase( dropped );
+            m_mtx_newitem.unlock();
+         }
+
          // a module? -- do it later
          if( ! dropped->finalize() )
          {
@@ -344,6 +363,174 @@ void MemPool::storeForGarbage( Garbageable *ptr )
    m_newRoot->prevGarbage()->nextGarbage( ptr );
    m_newRoot->prevGarbage( ptr );
    m_mtx_newitem.unlock();
+
+   if ( m_siteRate != 0 )
+      recordSite( ptr );
+}
+
+
+/** Finds the module and line of the script creating a new item.
+   Items created by external functions are charged to the script calling them.
+*/
+static bool s_allocationSite( String &site )
+{
+   VMachine *vm = VMachine::getCurrent();
+   if ( vm == 0 || vm->currentContext() == 0 )
+      return false;
+
+   const Symbol *sym = vm->currentSymbol();
+   uint32 line = 0;
+   if ( sym != 0 && sym->isFunction() )
+   {
+      line = sym->module()->getLineAt( sym->getFuncDef()->basePC() + vm->programCounter() );
+   }
+   else
+   {
+      const Symbol *caller;
+      uint32 pc;
+      uint32 level = 0;
+
+      sym = 0;
+      while( vm->getTraceStep( level++, caller, line, pc ) )
+      {
+         if ( caller->isFunction() )
+         {
+            sym = caller;
+            break;
+         }
+      }
+
+      if ( sym == 0 )
+         return false;
+   }
+
+   site = sym->module()->name();
+   site += ":";
+   site.writeNumber( (int64) line );
+   return true;
+}
+
+
+void MemPool::recordSite( GarbageableBase *ptr )
+{
+   String site;
+   uint32 rate = m_siteRate;
+   bool bSampled = rate != 0
+         && ((uint32) atomicInc( m_siteTick )) % rate == 0
+         && s_allocationSite( site );
+
+   m_mtx_newitem.lock();
+   if ( bSampled )
+   {
+      String *name;
+      void *found = m_siteNames.find( &site );
+      if ( found != 0 )
+         name = *(String **) found;
+      else
+      {
+         name = new String( site );
+         name->bufferize();
+         m_siteNames.insert( &site, name );
+      }
+
+      found = m_itemSites.find( ptr );
+      if ( found != 0 )
+         *(String **) found = name;
+      else
+         m_itemSites.insert( ptr, name );
+   }
+   else
+   {
+      // the address may have been used by an item destroyed outside the sweep.
+      m_itemSites.erase( ptr );
+   }
+   m_mtx_newitem.unlock();
+}
+
+
+// WARNING -- this must be called with m_mtx_newitem locked
+void MemPool::clearSites()
+{
+   MapIterator iter = m_siteNames.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(String **) iter.currentValue();
+      iter.next();
+   }
+
+   m_siteNames.clear();
+   m_itemSites.clear();
+}
+
+
+void MemPool::trackSites( uint32 rate )
+{
+   m_mtx_newitem.lock();
+   m_siteRate = rate;
+   if ( rate == 0 )
+      clearSites();
+   m_mtx_newitem.unlock();
+}
+
+
+static void s_censusPrepare( HeapCensus &census, GarbageableBase *root )
+{
+   GarbageableBase *ring = root->nextGarbage();
+   while( ring != root )
+   {
+      census.prepare( ring );
+      ring = ring->nextGarbage();
+   }
+}
+
+
+static void s_censusRing( HeapCensus &census, GarbageableBase *root,
+      const Map &itemSites, uint32 mingen )
+{
+   GarbageableBase *ring = root->nextGarbage();
+   while( ring != root )
+   {
+      if ( ring->mark() < mingen )
+         census.accountPending();
+      else
+      {
+         void *found = itemSites.empty() ? 0 : itemSites.find( ring );
+         census.account( ring, found != 0 ? *(String **) found : 0 );
+      }
+      ring = ring->nextGarbage();
+   }
+}
+
+
+// WARNING -- this must be called by the GC thread, or while it is not running.
+void MemPool::takeCensus( HeapCensus &census )
+{
+   m_mtx_newitem.lock();
+   s_censusPrepare( census, m_garbageRoot );
+   s_censusPrepare( census, m_newRoot );
+   s_censusRing( census, m_garbageRoot, m_itemSites, m_mingen );
+   s_censusRing( census, m_newRoot, m_itemSites, m_mingen );
+   m_mtx_newitem.unlock();
+}
+
+
+void MemPool::census( HeapCensus &census )
+{
+   m_mtx_census.lock();
+   if ( m_th == 0 )
+   {
+      takeCensus( census );
+   }
+   else
+   {
+      m_mtxRequest.lock();
+      m_censusTarget = &census;
+      m_eRequest.set();
+      m_mtxRequest.unlock();
+
+      m_eCensusDone.wait();
+   }
+   m_mtx_census.unlock();
 }
 
 void MemPool::accountItems( int itemCount )
@@ -507,10 +694,10 @@ void MemPool::markItem( const Item &item )
 }
 
 
-void MemPool::gcSweep()
+void MemPool::gcSweep( uint32 mingen )
 {
 
-   TRACE( "Sweeping %ld (mingen: %d, gen: %d)", (long)gcMemAllocated(), m_mingen, m_generation );
+   TRACE( "Sweeping %ld (mingen: %d, gen: %d)", (long)gcMemAllocated(), mingen, m_generation );
 
    m_mtx_ramp.lock();
    // ramp mode may change while we do the lock...
@@ -518,7 +705,7 @@ void MemPool::gcSweep()
    rm->onScanInit();
    m_mtx_ramp.unlock();
 
-   clearRing( m_garbageRoot );
+   clearRing( m_garbageRoot, mingen );
 
    m_mtx_ramp.lock();
    rm->onScanComplete();
@@ -656,6 +843,19 @@ void* MemPool::run()
          MESSAGE( "Skipping new ring inclusion due to safe area lock." );
       }
 
+      // the garbage ring is ours now: serve census requests.
+      m_mtxRequest.lock();
+      HeapCensus *census = m_censusTarget;
+      m_censusTarget = 0;
+      m_mtxRequest.unlock();
+
+      if ( census != 0 )
+      {
+         MESSAGE( "Taking heap census" );
+         takeCensus( *census );
+         m_eCensusDone.set();
+      }
+
       // if we're in active mode, send a block request to all the enabled vms.
       bool active = false;
       if ( state == 2 )
@@ -824,14 +1024,17 @@ void* MemPool::run()
                TRACE( "Priority with %d", m_vmCount );
             }
          }
+         // a VM registered from now on raises m_mingen above the marks
+         // we're about to give; sweep with the generation seen here.
+         uint32 sweepGen = m_mingen;
          m_mtx_vms.unlock();
          m_mtxRequest.unlock();
 
          // before sweeping, mark -- eventually -- the locked items.
-         markLocked();
+         markLocked( sweepGen );
 
          // all is marked, we can sweep
-         gcSweep();
+         gcSweep( sweepGen );
 
          // should we notify about the sweep being complete?
 
@@ -991,12 +1194,12 @@ void MemPool::removeGarbageLock( GarbageLock *ptr )
 }
 
 
-void MemPool::markLocked()
+void MemPool::markLocked( uint32 mingen )
 {
    fassert( m_lockRoot != 0 );
 
    // is there any VM keeping the locked items alive?
-   if ( m_mingen <= m_lockGen )
+   if ( mingen <= m_lockGen )
       return;
 
    m_lockGen = m_generation;
@@ -1004,22 +1207,18 @@ void MemPool::markLocked()
    // Lock root never changes.
    GarbageLock *rlock = this->m_lockRoot;
    GarbageLock *lock = rlock;
-   Item itm;
+
+   // The ring is held for the whole walk: a lock removed by another
+   // thread while we are on it would leave us on a deleted node.
+   m_mtx_lockitem.lock();
    do
    {
       // The root item never needs to be marked
-      m_mtx_lockitem.lock();
       lock = lock->next();
-      itm = lock->item();
-      m_mtx_lockitem.unlock();
-
-      // if a new item is inserted now, NP:
-      // it gets marked with current generation.
-      // If it gets deleted, it will just get an extra mark
-      // and live for an extra turn.
-      memPool->markItem( itm );
+      memPool->markItem( lock->item() );
 
    } while( lock != rlock );
+   m_mtx_lockitem.unlock();
 }
 
 //=======================================================================
@@ -33,6 +33,7 @@
 
 #include <falcon/globals.h>
 #include <falcon/modulecache.h>
+#include <falcon/mt.h>
 
 #include <memory>
 
@@ -86,7 +87,8 @@ ModuleLoader::ModuleLoader( const ModuleLoader &other ):
    m_delayRaise( other.m_delayRaise ),
    m_ignoreSources( other.m_ignoreSources ),
    m_saveRemote( other.m_saveRemote ),
-   m_compileErrors( other.m_compileErrors )
+   m_compileErrors( other.m_compileErrors ),
+   m_cacheDir( other.m_cacheDir )
 {
    setSearchPath( other.getSearchPath() );
 }
@@ -482,7 +484,30 @@ Module *ModuleLoader::loadFile( const URI& uri, t_filetype type, bool scan )
             }
             else
             {
-               mod = loadSource( origUri.get() );
+               String cachePath;
+               if ( m_cacheDir != "" && ! alwaysRecomp() )
+                  cachedModulePath( origUri.get(), cachePath );
+
+               // is there an up-to-date module in the cache directory?
+               // The times have a resolution of a second; a module saved in
+               // the same second the source was changed can't be trusted.
+               if ( cachePath != "" && Sys::fal_stats( cachePath, fs )
+                    && *fs.m_mtime > *foundStats.m_mtime )
+               {
+                  try {
+                     mod = loadModule( cachePath );
+                  }
+                  catch( Error *e )
+                  {
+                     // possibly, saved by another engine version
+                     e->decref();
+                     mod = loadSource( origUri.get() );
+                  }
+               }
+               else
+               {
+                  mod = loadSource( origUri.get() );
+               }
             }
          }
          break;
@@ -845,9 +870,12 @@ void  ModuleLoader::raiseError( int code, const String &expl, int fsError )
 Module *ModuleLoader::loadSource( const String &file )
 {
    ModuleCache* mc = Engine::getModuleCache();
+   String cacheKey;
    if( mc != 0 )
    {
-      Module* mod = mc->find( file );
+      // the same source may be compiled differently by other loaders.
+      sourceCacheKey( file, cacheKey );
+      Module* mod = mc->find( cacheKey, file );
       if( mod != 0 )
          return mod;
    }
@@ -880,7 +908,7 @@ Module *ModuleLoader::loadSource( const String &file )
 
       if( mc != 0 )
       {
-         mod = mc->add( file, mod );
+         mod = mc->add( cacheKey, file, mod );
       }
    }
    catch (Error *)
@@ -950,7 +978,17 @@ Module *ModuleLoader::loadSource( Stream *fin, const String &path, const String
    module->path( path );
 
    // if the base load source worked, save the result (if configured to do so).
-   if ( m_saveModule )
+   if ( m_saveModule && m_cacheDir != "" )
+   {
+      if ( ! saveCachedModule( module, path ) && m_saveMandatory )
+      {
+         String cachePath;
+         cachedModulePath( path, cachePath );
+         module->decref();
+         raiseError( e_file_output, cachePath );
+      }
+   }
+   else if ( m_saveModule )
    {
       URI tguri( path );
       fassert( tguri.isValid() );
@@ -982,6 +1020,78 @@ Module *ModuleLoader::loadSource( Stream *fin, const String &path, const String
 }
 
 
+void ModuleLoader::sourceCacheKey( const String &path, String &key ) const
+{
+   // loadSource() turns template mode on by itself for detected templates.
+   bool bTemplate = m_forceTemplate
+         || ( m_detectTemplate && path.length() > 4 && path.subString( path.length() - 4 ) == ".ftd" );
+
+   key = path;
+   key.A( "\n" ).A( m_srcEncoding ).A( bTemplate ? "\nftd" : "\nfal" );
+
+   // the search path drives the modules loaded by the meta-compiler.
+   key.A( "\n" ).A( getSearchPath() ).A( "\n" );
+   m_compiler.settingsKey( key );
+}
+
+
+void ModuleLoader::cachedModulePath( const String &path, String &target ) const
+{
+   String key;
+   sourceCacheKey( path, key );
+
+   // FNV-1a over the key; the module name keeps the cache readable.
+   uint64 hash = 14695981039346656037ULL;
+   for ( uint32 i = 0; i < key.length(); ++i )
+   {
+      hash ^= key.getCharAt( i );
+      hash *= 1099511628211ULL;
+   }
+
+   String modName;
+   getModuleName( path, modName );
+
+   target = m_cacheDir;
+   if ( target.length() != 0 && target.getCharAt( target.length() - 1 ) != '/' )
+      target += "/";
+   target += modName;
+   target += ".";
+   target.writeNumberHex( hash, false, 16 );
+   target += ".fam";
+}
+
+
+bool ModuleLoader::saveCachedModule( Module *module, const String &path )
+{
+   static volatile int32 s_saveCount = 0;
+
+   String cachePath;
+   cachedModulePath( path, cachePath );
+
+   String tempPath = cachePath;
+   tempPath.A( "." ).N( Sys::_getpid() ).A( "." ).N( (int64) atomicInc( s_saveCount ) );
+
+   URI tempUri( tempPath );
+   URI cacheUri( cachePath );
+   VFSProvider* vfs = Engine::getVFS( cacheUri.scheme() );
+   fassert( vfs != 0 );
+
+   Stream *out = vfs->create( tempUri, VFSProvider::CParams() );
+   if ( out == 0 )
+      return false;
+
+   bool bDone = module->save( out ) && out->close();
+   delete out;
+
+   // the move replaces atomically the module other loaders may be reading.
+   if ( ! bDone || ! vfs->move( tempUri, cacheUri ) )
+   {
+      vfs->unlink( tempUri );
+      return false;
+   }
+
+   return true;
+}
 
 }
 
@@ -425,6 +425,7 @@ bool Module::load( Stream *is, bool skipHeader )
    */
    if ( ! stringTable().load( is ) )
       return false;
+   stringTable().intern();
 
    if ( ! m_symbols.load( this, is ) )
       return false;
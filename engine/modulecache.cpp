@@ -26,9 +26,10 @@ namespace Falcon {
 class CacheEntry: public BaseAlloc
 {
 public:
-   CacheEntry( Module* mod, const TimeStamp& tsDate ):
+   CacheEntry( Module* mod, const TimeStamp& tsDate, int64 size = -1 ):
       m_module( mod ),
-      m_ts( tsDate )
+      m_ts( tsDate ),
+      m_size( size )
       {}
 
    ~CacheEntry()
@@ -36,16 +37,25 @@ public:
       m_module->decref();
    }
 
-   void change( Module* mod, const TimeStamp& tsDate )
+   void change( Module* mod, const TimeStamp& tsDate, int64 size = -1 )
    {
       m_module->decref();
       mod->incref();
       m_module = mod;
       m_ts = tsDate;
+      m_size = size;
+   }
+
+   /** The times have a resolution of a second; the size tells apart
+      some of the changes done in the same second. */
+   bool isStale( const FileStat& fm ) const
+   {
+      return fm.m_mtime->compare( m_ts ) > 0 || fm.m_size != m_size;
    }
 
    Module* m_module;
    TimeStamp m_ts;
+   int64 m_size;
 };
 
 ModuleCache::ModuleCache():
@@ -64,12 +74,17 @@ ModuleCache::~ModuleCache()
 }
 
 Module* ModuleCache::add( const String& muri, Module* module )
+{
+   return add( muri, muri, module );
+}
+
+Module* ModuleCache::add( const String& key, const String& muri, Module* module )
 {
    FileStat fm;
    bool gotStats = Sys::fal_stats( muri, fm );
 
    m_mtx.lock();
-   void* data = m_modMap.find( &muri );
+   void* data = m_modMap.find( &key );
    if( data != 0 )
    {
       CacheEntry* mod_cache = *(CacheEntry**) data;
@@ -84,9 +99,9 @@ Module* ModuleCache::add( const String& muri, Module* module )
 
          return module;
       }
-      else if( fm.m_mtime->compare( mod_cache->m_ts ) > 0 )
+      else if( mod_cache->isStale( fm ) )
       {
-         mod_cache->change( module, *fm.m_mtime );
+         mod_cache->change( module, *fm.m_mtime, fm.m_size );
          m_mtx.unlock();
 
          return module;
@@ -106,13 +121,13 @@ Module* ModuleCache::add( const String& muri, Module* module )
       // had we been able to get the stats?
       if( gotStats )
       {
-         m_modMap.insert( &muri, new CacheEntry( module, *fm.m_mtime ) );
+         m_modMap.insert( &key, new CacheEntry( module, *fm.m_mtime, fm.m_size ) );
       }
       else
       {
          // insert the module with a null timestamp; any other timestamp
          // read later from the system
-         m_modMap.insert( &muri, new CacheEntry( module, TimeStamp() ) );
+         m_modMap.insert( &key, new CacheEntry( module, TimeStamp() ) );
       }
       module->incref();
       m_mtx.unlock();
@@ -140,16 +155,21 @@ bool ModuleCache::remove( const String& muri )
 }
 
 Module* ModuleCache::find( const String& muri )
+{
+   return find( muri, muri );
+}
+
+Module* ModuleCache::find( const String& key, const String& muri )
 {
    FileStat fm;
    bool gotStats = Sys::fal_stats( muri, fm );
 
    m_mtx.lock();
-   void* data = m_modMap.find( &muri );
+   void* data = m_modMap.find( &key );
    if( data != 0 )
    {
       CacheEntry* emod = *(CacheEntry**) data;
-      if ( !gotStats || fm.m_mtime->compare( emod->m_ts ) > 0 )
+      if ( !gotStats || emod->isStale( fm ) )
       {
          // ignore the find
          m_mtx.unlock();
@@ -167,6 +187,33 @@ Module* ModuleCache::find( const String& muri )
    return 0;
 }
 
+uint32 ModuleCache::clear()
+{
+   // detach the entries, and destroy them outside the lock
+   Map entries( &traits::t_string(), &traits::t_voidp() );
+
+   m_mtx.lock();
+   MapIterator iter = m_modMap.begin();
+   while( iter.hasCurrent() )
+   {
+      entries.insert( iter.currentKey(), *(void**) iter.currentValue() );
+      iter.next();
+   }
+   m_modMap.clear();
+   m_mtx.unlock();
+
+   uint32 count = 0;
+   iter = entries.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(CacheEntry**) iter.currentValue();
+      ++count;
+      iter.next();
+   }
+
+   return count;
+}
+
 }
 
 /* end of modulecache.cpp */
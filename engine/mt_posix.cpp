@@ -25,8 +25,6 @@
 namespace Falcon
 {
 
-static Mutex s_cs;
-
 ThreadSpecific::ThreadSpecific( void (*destructor)(void*) )
 {
    #ifndef NDEBUG
@@ -37,6 +35,31 @@ ThreadSpecific::ThreadSpecific( void (*destructor)(void*) )
    #endif
 }
 
+#if defined(__GNUC__)
+
+// GCC and compatible compilers provide the atomic operations as builtins.
+
+/** Performs an atomic thread safe increment. */
+int32 atomicInc( volatile int32 &data )
+{
+   return __sync_add_and_fetch( &data, 1 );
+}
+
+/** Performs an atomic thread safe decrement. */
+int32 atomicDec( volatile int32 &data )
+{
+   return __sync_sub_and_fetch( &data, 1 );
+}
+
+bool atomicCAS( volatile int32 &data, int32 expected, int32 value )
+{
+   return __sync_bool_compare_and_swap( &data, expected, value );
+}
+
+#else
+
+static Mutex s_cs;
+
 /** Performs an atomic thread safe increment. */
 int32 atomicInc( volatile int32 &data )
 {
@@ -55,6 +78,18 @@ int32 atomicDec( volatile int32 &data )
    return res;
 }
 
+bool atomicCAS( volatile int32 &data, int32 expected, int32 value )
+{
+   s_cs.lock();
+   bool done = data == expected;
+   if ( done )
+      data = value;
+   s_cs.unlock();
+   return done;
+}
+
+#endif
+
 
 
 void Event::set()
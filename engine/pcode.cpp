@@ -140,7 +140,7 @@ void PCODE::deendianize( byte* code, uint32 codeSize, bool into )
       }
 
       // if the operation is a switch, it's handled a bit specially.
-      if ( opcode == P_SWCH || opcode == P_SELE )
+      if ( opcode == P_SWCH || opcode == P_SELE || opcode == P_INSW )
       {
          // get the switch table (aready de-endianized in the above step)
          iPos -= sizeof(int64);
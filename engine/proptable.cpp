@@ -94,8 +94,9 @@ bool PropertyTable::findKey( const String &key, uint32 &pos ) const
    {
       // get the table row
       current = m_entries[point].m_name;
+      int cmp = key.compare( *current );
 
-      if( *current == key ) {
+      if( cmp == 0 ) {
          pos = point;
          return true;
       }
@@ -104,7 +105,7 @@ bool PropertyTable::findKey( const String &key, uint32 &pos ) const
          if ( lower == higher -1 )
          {
             // key is EVEN less than the lower one
-            if ( key < *current )
+            if ( cmp < 0 )
             {
                pos = lower;
                return false;
@@ -126,7 +127,7 @@ bool PropertyTable::findKey( const String &key, uint32 &pos ) const
             break;
          }
 
-         if ( key > *current )
+         if ( cmp > 0 )
          {
             lower = point;
          }
@@ -19,6 +19,7 @@
 
 #include <falcon/stackframe.h>
 #include <falcon/mempool.h>
+#include <falcon/globals.h>
 
 namespace Falcon
 {
@@ -155,6 +155,42 @@ bool Stream::readString( String &target, uint32 size )
    return true;
 }
 
+bool Stream::readLine( String &target, uint32 size )
+{
+   uint32 chr;
+   uint32 count = 0;
+   bool bRead = false;
+
+   while( get( chr ) )
+   {
+      if ( chr == (uint32) '\n' )
+         return true;
+
+      if ( chr == (uint32) '\r' )
+      {
+         uint32 next;
+         if ( ! get( next ) )
+            return bRead;
+         if ( next == (uint32) '\n' )
+            return true;
+         unget( next );
+      }
+
+      // the line is too long; the rest is read by the next call.
+      if ( size != 0 && count == size )
+      {
+         unget( chr );
+         return true;
+      }
+
+      target.append( chr );
+      ++count;
+      bRead = true;
+   }
+
+   return bRead;
+}
+
 bool Stream::writeString( const String &source, uint32 begin, uint32 end )
 {
    uint32 pos = begin;
@@ -384,6 +384,139 @@ bool StreamBuffer::put( uint32 chr )
    return true;
 }
 
+int32 StreamBuffer::peekSpan( const byte*& data, int32 count )
+{
+   if ( count > m_bufSize )
+      count = m_bufSize;
+
+   int32 avail = m_bufLen - m_bufPos;
+   if ( avail < count )
+   {
+      if ( avail == 0 || m_changed )
+      {
+         // nothing to keep, or pending data to be written first.
+         if ( ! refill() )
+            return -1;
+      }
+      else
+      {
+         // move what's left at the beginning, and read after it.
+         memmove( m_buffer, m_buffer + m_bufPos, avail );
+         m_filePos += m_bufPos;
+         m_bufPos = 0;
+         m_bufLen = avail;
+      }
+
+      while( m_bufLen - m_bufPos < count )
+      {
+         int32 readIn = m_stream->read( m_buffer + m_bufLen, m_bufSize - m_bufLen );
+         if ( readIn <= 0 )
+            break;
+         m_bufLen += readIn;
+      }
+   }
+
+   data = m_buffer + m_bufPos;
+   return m_bufLen - m_bufPos;
+}
+
+/** Appends bytes read from the buffer to a string, as characters. */
+static void s_appendBytes( String& target, const byte* data, uint32 count )
+{
+   uint32 cs = target.manipulator()->charSize();
+   uint32 size = target.size();
+   if ( size + count * cs > target.allocated() )
+   {
+      // grow geometrically, lines are usually built in a few steps.
+      uint32 grown = (target.allocated() / cs) * 2;
+      target.reserve( size / cs + count > grown ? size / cs + count : grown );
+   }
+
+   byte* dest = target.getRawStorage() + size;
+   switch( cs )
+   {
+      case 1:
+         memcpy( dest, data, count );
+         break;
+
+      case 2:
+         for ( uint32 i = 0; i < count; ++i )
+            ((uint16*) dest)[i] = data[i];
+         break;
+
+      default:
+         for ( uint32 i = 0; i < count; ++i )
+            ((uint32*) dest)[i] = data[i];
+   }
+
+   target.size( size + count * cs );
+}
+
+bool StreamBuffer::readLine( String &target, uint32 size )
+{
+   // pushed back characters must be read first.
+   if ( ! bufferEmpty() )
+      return Stream::readLine( target, size );
+
+   target.bufferize();
+   uint32 count = 0;
+   bool bRead = false;
+
+   for(;;)
+   {
+      const byte* data;
+      int32 avail = peekSpan( data );
+      if ( avail == 1 && data[0] == '\r' )
+      {
+         // we need to know what follows the CR.
+         avail = peekSpan( data, 2 );
+         if ( avail == 1 )
+         {
+            consumeSpan( 1 );
+            return bRead;
+         }
+      }
+
+      if ( avail <= 0 )
+         return bRead;
+
+      uint32 len = (uint32) avail;
+      uint32 room = size == 0 ? len : size - count;
+
+      // the EOL is not stored, so it can be found a bit after the room left.
+      uint32 scan = room + 2 < len ? room + 2 : len;
+      const byte* eol = (const byte*) memchr( data, '\n', scan );
+      if ( eol != 0 )
+      {
+         uint32 take = (uint32) (eol - data);
+         uint32 keep = take > 0 && data[take-1] == '\r' ? take - 1 : take;
+         if ( keep <= room )
+         {
+            s_appendBytes( target, data, keep );
+            consumeSpan( take + 1 );
+            return true;
+         }
+      }
+
+      // the line is too long; the rest is read by the next call.
+      if ( room < len )
+      {
+         s_appendBytes( target, data, room );
+         consumeSpan( room );
+         return true;
+      }
+
+      // a CR at the end may be followed by a LF in the next span.
+      if ( data[len-1] == '\r' )
+         --len;
+
+      s_appendBytes( target, data, len );
+      consumeSpan( len );
+      count += len;
+      bRead = true;
+   }
+}
+
 bool StreamBuffer::resizeBuffer( uint32 size )
 {
    fassert( size > 0 );
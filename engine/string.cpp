@@ -23,6 +23,7 @@
 #include <falcon/stream.h>
 #include <falcon/common.h>
 #include <falcon/vm.h>
+#include <falcon/mt.h>
 #include <string.h>
 #include <cstring>
 #include <stdlib.h>
@@ -30,6 +31,22 @@
 
 namespace Falcon {
 
+/** Header of the data block shared by strings built through String::concat(). */
+struct StringSharedBlock
+{
+   volatile int32 m_refCount;
+   /** Bytes used by the longest string referencing the block. */
+   volatile int32 m_used;
+   uint32 m_capacity;
+   /** Keeps the character data aligned. */
+   uint32 m_padding;
+};
+
+static inline StringSharedBlock *s_sharedBlock( byte *storage )
+{
+   return ((StringSharedBlock *) storage) - 1;
+}
+
 namespace csh {
 
 Byte* f_handler_static() {
@@ -265,7 +282,8 @@ void Byte::subString( const String *str, int32 start, int32 end, String *tgt ) c
       else
          storage = tgt->getRawStorage();
 
-      memcpy( storage, str->getRawStorage() + (start * cs) , len  );
+      // the target may be the source itself (as in String::trim).
+      memmove( storage, str->getRawStorage() + (start * cs) , len  );
       tgt->size( len );
    }
 
@@ -480,9 +498,12 @@ void Byte::reserve( String *str, uint32 size, bool relative, bool block ) const
 
    uint32 nextAlloc = size * chs;
 
-   // the required size may be already allocated
-   if ( nextAlloc > str->allocated() )
+   // the required size may be already allocated; shared data is never written.
+   if ( nextAlloc > str->allocated() || str->isShared() )
    {
+      if ( nextAlloc < str->m_size )
+         nextAlloc = str->m_size;
+
       byte *mem = (byte *) memAlloc( nextAlloc );
       uint32 size = str->m_size;
       if ( str->m_size > 0 )
@@ -491,6 +512,7 @@ void Byte::reserve( String *str, uint32 size, bool relative, bool block ) const
       // we can now destroy the old string.
       if ( str->allocated() != 0 )
          memFree( str->m_storage );
+      str->unshare();
 
       str->m_storage = mem;
       str->m_size = size;
@@ -604,7 +626,7 @@ void Static16::setCharAt( String *str, uint32 pos, uint32 chr ) const
    {
       uint32 *buf32 =  (uint32 *) memAlloc( size * 2 );
       uint16 *buf16 = (uint16 *) str->getRawStorage();
-      for ( int i = 0; i < size; i ++ )
+      for ( int i = 0; i < size / 2; i ++ )
          buf32[ i ] = (uint32) buf16[ i ];
 
       buf32[ pos ] = chr;
@@ -688,7 +710,7 @@ void Buffer16::setCharAt( String *str, uint32 pos, uint32 chr ) const
       int32 size = str->size();
       uint32 *buf32 =  (uint32 *) memAlloc( size * 2 );
       uint16 *buf16 = (uint16 *) str->getRawStorage();
-      for ( int i = 0; i < size; i ++ )
+      for ( int i = 0; i < size / 2; i ++ )
          buf32[ i ] = (uint32) buf16[ i ];
 
       buf32[ pos ] = chr;
@@ -863,6 +885,7 @@ void Static32::remove( String *str, uint32 pos, uint32 len ) const
 
 void Static::destroy( String *str ) const
 {
+   str->unshare();
    if ( str->allocated() > 0 ) {
       memFree( str->getRawStorage() );
       str->allocated( 0 );
@@ -900,6 +923,7 @@ void Buffer::reserve( String *str, uint32 size, bool relative, bool block ) cons
 
 void Buffer::destroy( String *str ) const
 {
+   str->unshare();
    if ( str->allocated() > 0 ) {
       memFree( str->getRawStorage() );
       str->allocated( 0 );
@@ -920,6 +944,7 @@ String::String() :
   m_size( 0 ),
   m_storage( 0 ),
   m_bExported( false ),
+  m_bFlags( 0 ),
   m_bCore( false )
 {
 }
@@ -928,6 +953,7 @@ String::String() :
 String::String( uint32 size ):
    m_class( csh::f_handler_buffer() ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    m_storage = (byte *) memAlloc( size );
@@ -940,6 +966,7 @@ String::String( const char *data ):
    m_allocated( 0 ),
    m_storage( (byte*) const_cast< char *>(data) ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    m_size = strlen( data );
@@ -948,6 +975,7 @@ String::String( const char *data ):
 String::String( const char *data, int32 len ):
    m_class( csh::f_handler_buffer() ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    m_size = len >= 0 ? len : strlen( data );
@@ -961,6 +989,7 @@ String::String( const wchar_t *data ):
    m_allocated( 0 ),
    m_storage( (byte*) const_cast< wchar_t *>(data) ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    if ( sizeof( wchar_t ) == 2 )
@@ -979,6 +1008,7 @@ String::String( const wchar_t *data, int32 len ):
    m_allocated( 0 ),
    m_storage( (byte *) const_cast< wchar_t *>( data ) ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    if ( sizeof( wchar_t ) == 2 )
@@ -1009,12 +1039,14 @@ String::String( const String &other, uint32 begin, uint32 end ):
    m_size( 0 ),
    m_storage( 0 ),
    m_bExported( false ),
+   m_bFlags( 0 ),
    m_bCore( false )
 {
    // by default, copy manipulator
    m_class = other.m_class;
 
-   if ( other.m_allocated == 0 )
+   // shared data is referenced as a whole only.
+   if ( other.m_allocated == 0 && ! other.isShared() )
    {
       if ( other.m_size == 0 ) {
          m_size = 0;
@@ -1043,9 +1075,19 @@ String::String( const String &other, uint32 begin, uint32 end ):
 
 void String::copy( const String &other )
 {
+   if ( &other == this )
+      return;
+
+   // shared data is just referenced; take the reference before dropping ours.
+   if ( other.isShared() )
+      atomicInc( s_sharedBlock( other.m_storage )->m_refCount );
+
    if ( m_allocated != 0 )
       m_class->destroy( this );
+   else
+      unshare();
 
+   m_bFlags = 0;
    m_class = other.m_class;
    m_size = other.m_size;
    m_allocated = other.m_allocated;
@@ -1054,8 +1096,18 @@ void String::copy( const String &other )
       if ( m_size > 0 )
          memcpy( m_storage, other.m_storage, m_size );
    }
+   else if ( other.isShared() )
+   {
+      m_storage = other.m_storage;
+      m_bFlags = flag_shared;
+   }
    else
+   {
+      // static copies of interned strings are interned as well.
       m_storage = other.m_storage;
+      m_bFlags = other.m_bFlags & flag_interned;
+      m_hash = other.m_hash;
+   }
 }
 
 
@@ -1063,8 +1115,11 @@ String &String::adopt( char *buffer, uint32 size, uint32 allocated )
 {
    if ( m_allocated != 0 )
       m_class->destroy( this );
+   else
+      unshare();
 
    m_class = csh::f_handler_buffer();
+   m_bFlags = 0;
    m_size = size;
    m_allocated = allocated;
    m_storage = (byte *) buffer;
@@ -1077,12 +1132,15 @@ String &String::adopt( wchar_t *buffer, uint32 size, uint32 allocated )
 {
    if ( m_allocated != 0 )
       m_class->destroy( this );
+   else
+      unshare();
 
    if ( sizeof( wchar_t ) == 2 )
       m_class = csh::f_handler_buffer16();
    else
       m_class = csh::f_handler_buffer32();
 
+   m_bFlags = 0;
    m_size = size * sizeof( wchar_t );
    m_allocated = allocated;
    m_storage = (byte *) buffer;
@@ -1090,6 +1148,93 @@ String &String::adopt( wchar_t *buffer, uint32 size, uint32 allocated )
    return *this;
 }
 
+void String::releaseShared()
+{
+   StringSharedBlock *blk = s_sharedBlock( m_storage );
+   if ( atomicDec( blk->m_refCount ) == 0 )
+      memFree( blk );
+   m_bFlags &= ~flag_shared;
+}
+
+
+String &String::concat( const String &head, const String &tail )
+{
+   if ( this == &head || this == &tail )
+   {
+      String temp;
+      temp.concat( head, tail );
+      copy( temp );
+      return *this;
+   }
+
+   uint32 headCs = head.m_class->charSize();
+   uint32 tailCs = tail.m_class->charSize();
+   uint32 cs = headCs > tailCs ? headCs : tailCs;
+   uint32 headLen = head.length();
+   uint32 tailLen = tail.length();
+   uint32 total = (headLen + tailLen) * cs;
+
+   // short results are not worth sharing.
+   if ( total < FALCON_STRING_SHARE_THRESHOLD )
+   {
+      copy( head );
+      append( tail );
+      return *this;
+   }
+
+   byte *mem = 0;
+
+   // can we claim the free room after the head?
+   if ( head.isShared() && headCs == cs )
+   {
+      StringSharedBlock *blk = s_sharedBlock( head.m_storage );
+      if ( blk->m_used == (int32) head.m_size && total <= blk->m_capacity
+            && atomicCAS( blk->m_used, (int32) head.m_size, (int32) total ) )
+      {
+         csh::adaptBuffer( tail.m_storage, 0, tailCs, head.m_storage, headLen, cs, tailLen );
+         atomicInc( blk->m_refCount );
+         mem = head.m_storage;
+      }
+   }
+
+   if ( mem == 0 )
+   {
+      // the results of repeated concatenations grow geometrically.
+      uint32 capacity = total;
+      if ( total < 0x3FFFFFFF )
+         capacity += head.isShared() ? total : total / 4;
+      capacity = ((capacity / FALCON_STRING_ALLOCATION_BLOCK) + 1) * FALCON_STRING_ALLOCATION_BLOCK;
+
+      StringSharedBlock *blk = (StringSharedBlock *) memAlloc( sizeof( StringSharedBlock ) + capacity );
+      blk->m_refCount = 1;
+      blk->m_used = (int32) total;
+      blk->m_capacity = capacity;
+      mem = (byte *) (blk + 1);
+
+      csh::adaptBuffer( head.m_storage, 0, headCs, mem, 0, cs, headLen );
+      csh::adaptBuffer( tail.m_storage, 0, tailCs, mem, headLen, cs, tailLen );
+   }
+
+   if ( m_allocated != 0 )
+      m_class->destroy( this );
+   else
+      unshare();
+
+   switch( cs )
+   {
+      case 1: m_class = csh::f_handler_static(); break;
+      case 2: m_class = csh::f_handler_static16(); break;
+      case 4: m_class = csh::f_handler_static32(); break;
+   }
+
+   m_storage = mem;
+   m_size = total;
+   m_allocated = 0;
+   m_bFlags = flag_shared;
+   return *this;
+}
+
+
 int String::compare( const char *other ) const
 {
    uint32 pos = 0;
@@ -1208,8 +1353,77 @@ int String::compareIgnoreCase( const wchar_t *other ) const
    return 0;
 }
 
+bool String::equals( const String &other ) const
+{
+   if ( m_class->charSize() != other.m_class->charSize() )
+      return compare( other ) == 0;
+
+   if ( m_size != other.m_size )
+      return false;
+
+   // copies of the same (i.e. interned) string share their data
+   return m_storage == other.m_storage || m_size == 0
+      || memcmp( m_storage, other.m_storage, m_size ) == 0;
+}
+
+
+uint32 String::hash() const
+{
+   if ( isInterned() )
+      return m_hash;
+
+   // FNV-1a on the character values, so that it doesn't depend on charSize()
+   uint32 h = 2166136261U;
+   uint32 len = length();
+   for( uint32 pos = 0; pos < len; ++pos )
+   {
+      uint32 chr = getCharAt( pos );
+      do {
+         h = ( h ^ ( chr & 0xFF ) ) * 16777619U;
+         chr >>= 8;
+      } while( chr != 0 );
+   }
+   return h;
+}
+
+
+template<typename _T>
+static int s_compareChars( const _T *s1, const _T *s2, uint32 len )
+{
+   for( uint32 pos = 0; pos < len; ++pos )
+   {
+      if ( s1[pos] != s2[pos] )
+         return s1[pos] < s2[pos] ? -1 : 1;
+   }
+   return 0;
+}
+
+
 int String::compare( const String &other ) const
 {
+   uint32 cs = m_class->charSize();
+   if ( cs == other.m_class->charSize() )
+   {
+      uint32 len1 = m_size;
+      uint32 len2 = other.m_size;
+      uint32 len = ( len1 > len2 ? len2 : len1 ) / cs;
+      int res = 0;
+
+      if ( m_storage != other.m_storage && len > 0 )
+      {
+         switch( cs )
+         {
+            case 1: res = memcmp( m_storage, other.m_storage, len ); break;
+            case 2: res = s_compareChars( (uint16*) m_storage, (uint16*) other.m_storage, len ); break;
+            default: res = s_compareChars( (uint32*) m_storage, (uint32*) other.m_storage, len ); break;
+         }
+      }
+
+      if ( res != 0 )
+         return res < 0 ? -1 : 1;
+      return len1 < len2 ? -1 : ( len1 > len2 ? 1 : 0 );
+   }
+
    uint32 len1 = length();
    uint32 len2 = other.length();
    uint32 len = len1 > len2 ? len2 : len1;
@@ -1577,6 +1791,8 @@ bool String::deserialize( Stream *in, bool bStatic )
    size = endianInt32(size);
    m_bExported = (size & 0x80000000) == 0x80000000;
    size = size & 0x7FFFFFFF;
+   unshare();
+   m_bFlags = 0;
 
    // if the size of the deserialized string is 0, we have an empty string.
    if ( size == 0 )
@@ -1704,7 +1920,8 @@ bool String::setCharSize( uint32 nsize, uint32 subst )
    // use allocated to decide re-allocation under new char size.
    byte *mem = getRawStorage();
    uint32 oldcs = m_class->charSize();
-   uint32 nalloc = (allocated()/oldcs) * nsize;
+   // static and shared strings have no allocated memory of their own.
+   uint32 nalloc = ((allocated() > size() ? allocated() : size())/oldcs) * nsize;
    uint32 oldsize = size();
    byte *nmem = (byte*) memAlloc( nalloc );
    csh::Base* manipulator = csh::adaptBuffer( mem, 0, oldcs, nmem, 0, nsize, length() );
@@ -2039,6 +2256,7 @@ void String::trim( int mode )
 {
    uint32 front = 0;
    uint32 len = length();
+   m_bFlags &= flag_shared;
 
    // modes: 0 = all, 1 = front, 2 = back
 
@@ -2121,6 +2339,8 @@ bool String::fromUTF8( const char *utf8 )
 bool String::fromUTF8( const char *utf8, int len )
 {
    // destroy old contents
+   unshare();
+   m_bFlags = 0;
 
    if ( m_allocated )
    {
@@ -2428,6 +2648,7 @@ void String::clear()
 {
 	m_class->destroy(this);
 	m_class = csh::f_handler_static();
+	m_bFlags = 0;
 	m_storage = 0;
 	m_size = 0;
 	m_allocated = 0;
@@ -24,6 +24,11 @@
 #include <falcon/string.h>
 #include <falcon/traits.h>
 #include <falcon/fassert.h>
+#include <falcon/globals.h>
+#include <falcon/interntable.h>
+
+/** Longest string (in characters) shared by StringTable::intern(). */
+#define STRTABLE_MAX_INTERN_LEN  128
 
 namespace Falcon {
 
@@ -194,6 +199,20 @@ bool StringTable::load( Stream *in )
    return true;
 }
 
+void StringTable::intern()
+{
+   InternTable *table = Engine::getInternTable();
+   if ( table == 0 )
+      return;
+
+   for( uint32 i = 0; i < m_vector.size(); i++ )
+   {
+      String *str = *(String **) m_vector.at( i );
+      if ( str->length() > 0 && str->length() <= STRTABLE_MAX_INTERN_LEN )
+         table->share( *str );
+   }
+}
+
 bool StringTable::skip( Stream *in ) const
 {
    fassert(in);
@@ -0,0 +1,233 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: switchindex.cpp
+
+   Hashed lookup of the cases of large switch tables.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 22:05:31 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Hashed lookup of the cases of large switch tables.
+*/
+
+#include <falcon/switchindex.h>
+#include <falcon/string.h>
+#include <falcon/module.h>
+#include <falcon/common.h>
+#include <falcon/memory.h>
+
+#define SWITCH_NO_LANDING 0xFFFFFFFF
+
+namespace Falcon {
+
+/** Size of the hash tables: a power of two at least twice the count of keys. */
+static uint32 s_tableSize( uint16 count )
+{
+   uint32 size = 16;
+   while( size < (uint32) count * 2 )
+      size <<= 1;
+   return size;
+}
+
+static uint32 s_intHash( int64 value )
+{
+   uint64 h = ((uint64) value) * UI64LIT( 0x9E3779B97F4A7C15 );
+   return (uint32)( h >> 32 );
+}
+
+
+SwitchIndex::SwitchIndex( const Module *mod, byte *table, uint64 count ):
+   m_denseBase( 0 ),
+   m_denseSize( 0 ),
+   m_dense( 0 ),
+   m_intMask( 0 ),
+   m_intKeys( 0 ),
+   m_intLandings( 0 ),
+   m_strMask( 0 ),
+   m_strKeys( 0 ),
+   m_strHashes( 0 ),
+   m_strLandings( 0 )
+{
+   uint16 sw_int = (uint16) ( count >> 48 );
+   uint16 sw_rng = (uint16) ( count >> 32 );
+   uint16 sw_str = (uint16) ( count >> 16 );
+
+   // skip the nil landing
+   byte *base = table + sizeof( uint32 );
+   if ( sw_int > 0 )
+      indexIntegers( base, sw_int );
+
+   base += sw_int * ( sizeof( int64 ) + sizeof( uint32 ) )
+         + sw_rng * ( sizeof( int32 ) + sizeof( int32 ) + sizeof( uint32 ) );
+   if ( sw_str > 0 )
+      indexStrings( mod, base, sw_str );
+}
+
+
+SwitchIndex::~SwitchIndex()
+{
+   if ( m_dense != 0 )
+      memFree( m_dense );
+
+   if ( m_intKeys != 0 )
+   {
+      memFree( m_intKeys );
+      memFree( m_intLandings );
+   }
+
+   if ( m_strKeys != 0 )
+   {
+      memFree( m_strKeys );
+      memFree( m_strHashes );
+      memFree( m_strLandings );
+   }
+}
+
+
+void SwitchIndex::indexIntegers( byte *base, uint16 count )
+{
+   const uint32 step = sizeof( int64 ) + sizeof( uint32 );
+
+   // the cases are sorted; see if they are dense enough for a jump table.
+   int64 first = loadInt64( base );
+   int64 last = loadInt64( base + ( count - 1 ) * step );
+   uint64 span = (uint64) last - (uint64) first + 1;
+
+   if ( last >= first && span != 0 && span <= (uint64) count * 2 )
+   {
+      m_denseBase = first;
+      m_denseSize = (uint32) span;
+      m_dense = (uint32 *) memAlloc( m_denseSize * sizeof( uint32 ) );
+      for( uint32 i = 0; i < m_denseSize; ++i )
+         m_dense[i] = SWITCH_NO_LANDING;
+
+      for( uint16 i = 0; i < count; ++i )
+      {
+         byte *pos = base + i * step;
+         m_dense[ (uint64) loadInt64( pos ) - (uint64) first ] = *reinterpret_cast<uint32 *>( pos + sizeof( int64 ) );
+      }
+      return;
+   }
+
+   uint32 size = s_tableSize( count );
+   m_intMask = size - 1;
+   m_intKeys = (int64 *) memAlloc( size * sizeof( int64 ) );
+   m_intLandings = (uint32 *) memAlloc( size * sizeof( uint32 ) );
+   for( uint32 i = 0; i < size; ++i )
+      m_intLandings[i] = SWITCH_NO_LANDING;
+
+   for( uint16 i = 0; i < count; ++i )
+   {
+      byte *pos = base + i * step;
+      int64 value = loadInt64( pos );
+      uint32 slot = s_intHash( value ) & m_intMask;
+      while( m_intLandings[slot] != SWITCH_NO_LANDING && m_intKeys[slot] != value )
+         slot = ( slot + 1 ) & m_intMask;
+
+      // the first case wins, as in the binary search.
+      if ( m_intLandings[slot] == SWITCH_NO_LANDING )
+      {
+         m_intKeys[slot] = value;
+         m_intLandings[slot] = *reinterpret_cast<uint32 *>( pos + sizeof( int64 ) );
+      }
+   }
+}
+
+
+void SwitchIndex::indexStrings( const Module *mod, byte *base, uint16 count )
+{
+   const uint32 step = sizeof( int32 ) + sizeof( uint32 );
+
+   uint32 size = s_tableSize( count );
+   m_strMask = size - 1;
+   m_strKeys = (const String **) memAlloc( size * sizeof( String* ) );
+   m_strHashes = (uint32 *) memAlloc( size * sizeof( uint32 ) );
+   m_strLandings = (uint32 *) memAlloc( size * sizeof( uint32 ) );
+   for( uint32 i = 0; i < size; ++i )
+      m_strKeys[i] = 0;
+
+   for( uint16 i = 0; i < count; ++i )
+   {
+      byte *pos = base + i * step;
+      const String *key = mod->getString( *reinterpret_cast<int32 *>( pos ) );
+      if ( key == 0 )
+         continue;
+
+      uint32 hash = key->hash();
+      uint32 slot = hash & m_strMask;
+      while( m_strKeys[slot] != 0 && ! ( m_strHashes[slot] == hash && m_strKeys[slot]->equals( *key ) ) )
+         slot = ( slot + 1 ) & m_strMask;
+
+      if ( m_strKeys[slot] == 0 )
+      {
+         m_strKeys[slot] = key;
+         m_strHashes[slot] = hash;
+         m_strLandings[slot] = *reinterpret_cast<uint32 *>( pos + sizeof( int32 ) );
+      }
+   }
+}
+
+
+bool SwitchIndex::findInteger( int64 value, uint32 &landing ) const
+{
+   if ( m_dense != 0 )
+   {
+      uint64 offset = (uint64) value - (uint64) m_denseBase;
+      if ( value < m_denseBase || offset >= m_denseSize )
+         return false;
+
+      uint32 target = m_dense[ offset ];
+      if ( target == SWITCH_NO_LANDING )
+         return false;
+      landing = target;
+      return true;
+   }
+
+   if ( m_intKeys == 0 )
+      return false;
+
+   uint32 slot = s_intHash( value ) & m_intMask;
+   while( m_intLandings[slot] != SWITCH_NO_LANDING )
+   {
+      if ( m_intKeys[slot] == value )
+      {
+         landing = m_intLandings[slot];
+         return true;
+      }
+      slot = ( slot + 1 ) & m_intMask;
+   }
+
+   return false;
+}
+
+
+bool SwitchIndex::findString( const String &value, uint32 &landing ) const
+{
+   if ( m_strKeys == 0 )
+      return false;
+
+   uint32 hash = value.hash();
+   uint32 slot = hash & m_strMask;
+   while( m_strKeys[slot] != 0 )
+   {
+      if ( m_strHashes[slot] == hash && m_strKeys[slot]->equals( value ) )
+      {
+         landing = m_strLandings[slot];
+         return true;
+      }
+      slot = ( slot + 1 ) & m_strMask;
+   }
+
+   return false;
+}
+
+}
+
+/* end of switchindex.cpp */
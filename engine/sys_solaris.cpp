@@ -216,6 +216,12 @@ int64 _getpid() {
    return (int64) getpid();
 }
 
+int32 _cpuCount()
+{
+   long count = sysconf( _SC_NPROCESSORS_ONLN );
+   return count > 0 ? (int32) count : 1;
+}
+
 }
 }
 
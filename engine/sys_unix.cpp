@@ -227,6 +227,16 @@ int64 _getpid() {
    return (int64) getpid();
 }
 
+int32 _cpuCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+   long count = sysconf( _SC_NPROCESSORS_ONLN );
+   return count > 0 ? (int32) count : 1;
+#else
+   return 1;
+#endif
+}
+
 }
 }
 
@@ -354,6 +354,13 @@ int64 _getpid() {
    return (int64) GetCurrentProcessId();
 }
 
+int32 _cpuCount()
+{
+   SYSTEM_INFO info;
+   GetSystemInfo( &info );
+   return info.dwNumberOfProcessors > 0 ? (int32) info.dwNumberOfProcessors : 1;
+}
+
 }
 }
 
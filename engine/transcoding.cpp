@@ -21,6 +21,7 @@
 #include <falcon/transcoding.h>
 #include <falcon/stream.h>
 #include <falcon/stringstream.h>
+#include <falcon/streambuffer.h>
 #include <falcon/sys.h>
 
 #include <falcon/stdstreams.h>
@@ -30,6 +31,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace Falcon {
 
 #include "trans_tables.h"
@@ -221,9 +230,21 @@ protected:
        uint32 m_nMinUntl;
        uint32 m_nMaxUntl;
 
+   /** Translates a byte into an unicode character.
+      Returns false if the byte can't be translated; chr is then set to '?'.
+   */
+   virtual bool decode( byte in, uint32 &chr ) const;
+
+   /** Translates an unicode character into a byte.
+      Returns false if the character can't be translated; out is then set to '?'.
+   */
+   bool encode( uint32 chr, byte &out ) const;
+
 public:
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readString( String &target, uint32 size );
+   virtual bool writeString( const String &source, uint32 begin=0, uint32 end = csh::npos );
 };
 
 
@@ -238,8 +259,8 @@ protected:
        }
 
     TranscoderOEM( const TranscoderOEM &other );
-public:
-   virtual bool get( uint32 &chr );
+
+   virtual bool decode( byte in, uint32 &chr ) const;
 };
 
 
@@ -569,6 +590,219 @@ bool Transcoder::readString( String &source, uint32 size )
    return exitStatus;
 }
 
+uint32 Transcoder::readBuffered( String &target, uint32 size )
+{
+   uint32 count = 0;
+   uint32 chr;
+
+   while( count < size && popBuffer( chr ) )
+   {
+      target.append( chr );
+      ++count;
+   }
+
+   return count;
+}
+
+
+//=============================================================================
+// Bulk transcoding support
+//
+// readString() and writeString() work on blocks of bytes instead of going
+// through get() and put() for each character. Runs of characters that are
+// represented by a single byte (i.e. ASCII in UTF-8) are found a vector at
+// a time and copied in one step.
+//
+
+// bytes read or written in one step by the bulk transcoders.
+#define TRANSCODER_BLOCK_SIZE  4096
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FALCON_TRANSCODER_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/* -1 = still unknown; concurrent first calls just compute it twice. */
+static volatile int s_avx2 = -1;
+
+static bool s_hasAVX2()
+{
+   if ( s_avx2 < 0 )
+   {
+      __builtin_cpu_init();
+      s_avx2 = __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+   }
+   return s_avx2 == 1;
+}
+
+AVX2_TARGET
+static uint32 s_runBelowAVX2( const byte* data, uint32 len, byte limit )
+{
+   const __m256i top = _mm256_set1_epi8( (char) (limit - 1) );
+   const __m256i zero = _mm256_setzero_si256();
+   uint32 pos = 0;
+   while( pos + 32 <= len )
+   {
+      __m256i v = _mm256_loadu_si256( (const __m256i*) (data + pos) );
+      // the saturated difference is zero only for the bytes below limit.
+      __m256i eq = _mm256_cmpeq_epi8( _mm256_subs_epu8( v, top ), zero );
+      if ( _mm256_movemask_epi8( eq ) != -1 )
+         break;
+      pos += 32;
+   }
+   return pos;
+}
+#endif
+
+/** Counts the leading bytes of data that are below limit. */
+static uint32 s_runBelow( const byte* data, uint32 len, byte limit )
+{
+   uint32 pos = 0;
+
+#ifdef FALCON_TRANSCODER_AVX2
+   if ( len >= 32 && s_hasAVX2() )
+      pos = s_runBelowAVX2( data, len, limit );
+#endif
+
+#ifdef __SSE2__
+   const __m128i top = _mm_set1_epi8( (char) (limit - 1) );
+   const __m128i zero = _mm_setzero_si128();
+   while( pos + 16 <= len )
+   {
+      __m128i v = _mm_loadu_si128( (const __m128i*) (data + pos) );
+      __m128i eq = _mm_cmpeq_epi8( _mm_subs_epu8( v, top ), zero );
+      if ( _mm_movemask_epi8( eq ) != 0xFFFF )
+         break;
+      pos += 16;
+   }
+#endif
+
+   while( pos < len && data[pos] < limit )
+      ++pos;
+
+   return pos;
+}
+
+/** Reads from a stream until size bytes are read, the stream is over or an error occurs. */
+static uint32 s_readFull( Stream* stream, byte* buffer, uint32 size )
+{
+   uint32 done = 0;
+   while( done < size )
+   {
+      int32 res = stream->read( buffer + done, size - done );
+      if ( res <= 0 )
+         break;
+      done += res;
+   }
+   return done;
+}
+
+/** Makes room for a string to grow up to size bytes, growing geometrically. */
+static void s_reserve( String& target, uint32 size )
+{
+   if ( size > target.allocated() )
+   {
+      uint32 cs = target.manipulator()->charSize();
+      uint32 grown = (target.allocated() / cs) * 2;
+      target.reserve( size / cs > grown ? size / cs : grown );
+   }
+}
+
+/** Appends count characters below 0x100 to a buffered string. */
+static void s_appendBytes( String& target, const byte* data, uint32 count )
+{
+   uint32 cs = target.manipulator()->charSize();
+   uint32 size = target.size();
+   s_reserve( target, size + count * cs );
+   byte* dest = target.getRawStorage() + size;
+
+   switch( cs )
+   {
+      case 1:
+         memcpy( dest, data, count );
+         break;
+
+      case 2:
+         for ( uint32 i = 0; i < count; ++i )
+            ((uint16*) dest)[i] = data[i];
+         break;
+
+      default:
+         for ( uint32 i = 0; i < count; ++i )
+            ((uint32*) dest)[i] = data[i];
+   }
+
+   target.size( size + count * cs );
+}
+
+/** Appends count UTF-16 units, none of which is a surrogate, to a buffered string. */
+static void s_appendUnits( String& target, const uint16* data, uint32 count, bool bSwap )
+{
+   uint32 cs = target.manipulator()->charSize();
+   uint32 size = target.size();
+
+   if ( cs == 1 )
+   {
+      // stay narrow as long as possible.
+      s_reserve( target, size + count );
+      byte* dest = target.getRawStorage() + size;
+      uint32 i = 0;
+      for ( ; i < count; ++i )
+      {
+         uint16 unit = bSwap ? (uint16) ((data[i] >> 8) | (data[i] << 8)) : data[i];
+         if ( unit > 0xFF )
+            break;
+         dest[i] = (byte) unit;
+      }
+      target.size( size + i );
+      if ( i == count )
+         return;
+
+      target.setCharSize( 2 );
+      data += i;
+      count -= i;
+      cs = 2;
+      size = target.size();
+   }
+
+   s_reserve( target, size + count * cs );
+   byte* dest = target.getRawStorage() + size;
+   if ( cs == 2 )
+   {
+      if ( bSwap )
+      {
+         for ( uint32 i = 0; i < count; ++i )
+            ((uint16*) dest)[i] = (uint16) ((data[i] >> 8) | (data[i] << 8));
+      }
+      else
+         memcpy( dest, data, count * 2 );
+   }
+   else
+   {
+      for ( uint32 i = 0; i < count; ++i )
+         ((uint32*) dest)[i] = bSwap ? (uint16) ((data[i] >> 8) | (data[i] << 8)) : data[i];
+   }
+
+   target.size( size + count * cs );
+}
+
+/** Character at a given position in the raw storage of a string. */
+inline uint32 s_charAt( const byte* data, uint32 cs, uint32 pos )
+{
+   switch( cs )
+   {
+      case 1: return data[pos];
+      case 2: return ((const uint16*) data)[pos];
+   }
+   return ((const uint32*) data)[pos];
+}
+
+
+/** Writes a block of bytes, returning false on failure. */
+static bool s_writeBlock( Stream* stream, const byte* data, uint32 len )
+{
+   return len == 0 || stream->write( data, len ) == (int32) len;
+}
+
 
 //=============================================================================
 // Transparent byte oriented transcoder.
@@ -616,6 +850,67 @@ bool TranscoderByte::put( uint32 chr )
    return ( m_stream->write( &b, 1 ) == 1 );
 }
 
+bool TranscoderByte::readString( String &target, uint32 size )
+{
+   m_parseStatus = true;
+   target.size( 0 );
+   target.bufferize();
+   size -= readBuffered( target, size );
+
+   byte buffer[ TRANSCODER_BLOCK_SIZE ];
+   while( size > 0 )
+   {
+      uint32 req = size < TRANSCODER_BLOCK_SIZE ? size : TRANSCODER_BLOCK_SIZE;
+      uint32 len = s_readFull( m_stream, buffer, req );
+      s_appendBytes( target, buffer, len );
+      size -= len;
+
+      if ( len < req )
+         break;
+   }
+
+   // a short read is fine at the end of the stream, not on error.
+   m_parseStatus = m_stream->good();
+   return m_parseStatus;
+}
+
+bool TranscoderByte::writeString( const String &source, uint32 begin, uint32 end )
+{
+   m_parseStatus = true;
+   if ( end > source.length() )
+      end = source.length();
+   if ( begin >= end )
+      return true;
+
+   const byte* data = source.getRawStorage();
+   uint32 cs = source.manipulator()->charSize();
+   if ( cs == 1 )
+      return s_writeBlock( m_stream, data + begin, end - begin );
+
+   byte buffer[ TRANSCODER_BLOCK_SIZE ];
+   uint32 len = 0;
+   for ( uint32 pos = begin; pos < end; ++pos )
+   {
+      uint32 chr = s_charAt( data, cs, pos );
+      if ( chr <= 0xFF )
+         buffer[len++] = (byte) chr;
+      else
+      {
+         buffer[len++] = m_substitute;
+         m_parseStatus = false;
+      }
+
+      if ( len == TRANSCODER_BLOCK_SIZE )
+      {
+         if ( ! s_writeBlock( m_stream, buffer, len ) )
+            return false;
+         len = 0;
+      }
+   }
+
+   return s_writeBlock( m_stream, buffer, len );
+}
+
 TranscoderByte *TranscoderByte::clone() const
 {
    return new TranscoderByte( *this );
@@ -752,42 +1047,338 @@ bool TranscoderUTF8::get( uint32 &chr )
    return true;
 }
 
-bool TranscoderUTF8::put( uint32 chr )
+/** Encodes a character in UTF-8; returns the count of bytes written in res. */
+inline uint32 s_encodeUTF8( uint32 chr, byte* res )
 {
-   m_parseStatus = true;
-   byte res[4];
-   uint32 resCount;
-
    if ( chr < 0x80 )
    {
       res[0] = (byte) chr;
-      resCount = 1;
+      return 1;
    }
    else if ( chr < 0x800 )
    {
       res[0] = 0xC0 | ((chr >> 6 ) & 0x1f);
       res[1] = 0x80 | (0x3f & chr);
-      resCount = 2;
+      return 2;
    }
    else if ( chr < 0x10000 )
    {
       res[0] = 0xE0 | ((chr >> 12) & 0x0f );
       res[1] = 0x80 | ((chr >> 6) & 0x3f );
       res[2] = 0x80 | (0x3f & chr);
-      resCount = 3;
+      return 3;
    }
-   else
+
+   res[0] = 0xF0 | ((chr >> 18) & 0x7 );
+   res[1] = 0x80 | ((chr >> 12) & 0x3f );
+   res[2] = 0x80 | ((chr >> 6) & 0x3f );
+   res[3] = 0x80 | (0x3f & chr);
+   return 4;
+}
+
+/** Length of an UTF-8 sequence starting with a given byte (1 for invalid bytes). */
+inline uint32 s_lengthUTF8( byte in )
+{
+   if ( (in & 0xF8) == 0xF0 ) return 4;
+   if ( (in & 0xF0) == 0xE0 ) return 3;
+   if ( (in & 0xE0) == 0xC0 ) return 2;
+   return 1;
+}
+
+/** Decodes UTF-8 data as get() would, up to the first invalid sequence.
+   \return The count of bytes consumed, including the invalid sequence.
+*/
+static uint32 s_decodeUTF8( const byte* data, uint32 len, String& target, bool& bBad )
+{
+   uint32 pos = 0;
+   bBad = false;
+
+   while( pos < len )
    {
-      res[0] = 0xF0 | ((chr >> 18) & 0x7 );
-      res[1] = 0x80 | ((chr >> 12) & 0x3f );
-      res[2] = 0x80 | ((chr >> 6) & 0x3f );
-      res[3] = 0x80 | (0x3f & chr);
-      resCount = 4;
+      uint32 run = s_runBelow( data + pos, len - pos, 0x80 );
+      if ( run > 0 )
+      {
+         s_appendBytes( target, data + pos, run );
+         pos += run;
+         continue;
+      }
+
+      byte in = data[pos++];
+      uint32 chr;
+      int count;
+      if ( (in & 0xF8) == 0xF0 )
+      {
+         chr = (in & 0x7 ) << 18;
+         count = 18;
+      }
+      else if ( (in & 0xF0) == 0xE0 )
+      {
+         chr = (in & 0xF) << 12;
+         count = 12;
+      }
+      else if ( (in & 0xE0) == 0xC0 )
+      {
+         chr = (in & 0x1F) << 6;
+         count = 6;
+      }
+      else
+      {
+         bBad = true;
+         return pos;
+      }
+
+      while( count > 0 )
+      {
+         // incomplete or broken sequence
+         if ( pos == len || (data[pos] & 0xC0) != 0x80 )
+         {
+            if ( pos < len )
+               ++pos;
+            bBad = true;
+            return pos;
+         }
+
+         count -= 6;
+         chr |= (data[pos++] & 0x3f) << count;
+      }
+
+      target.append( chr );
    }
 
+   return pos;
+}
+
+bool TranscoderUTF8::put( uint32 chr )
+{
+   m_parseStatus = true;
+   byte res[4];
+   uint32 resCount = s_encodeUTF8( chr, res );
+
    return ( m_stream->write( res, resCount ) == (int32) resCount);
 }
 
+bool TranscoderUTF8::readString( String &target, uint32 size )
+{
+   m_parseStatus = true;
+   target.size( 0 );
+   target.bufferize();
+   size -= readBuffered( target, size );
+
+   // room to complete a sequence broken by the end of the block.
+   byte buffer[ TRANSCODER_BLOCK_SIZE + 3 ];
+   while( size > 0 )
+   {
+      // each character takes at least a byte, so we can't read too much.
+      uint32 req = size < TRANSCODER_BLOCK_SIZE ? size : TRANSCODER_BLOCK_SIZE;
+      uint32 len = s_readFull( m_stream, buffer, req );
+      if ( len == req )
+      {
+         for ( uint32 back = 1; back <= 3 && back <= len; ++back )
+         {
+            byte in = buffer[len - back];
+            if ( (in & 0xC0) != 0x80 )
+            {
+               uint32 need = s_lengthUTF8( in );
+               if ( need > back )
+                  len += s_readFull( m_stream, buffer + len, need - back );
+               break;
+            }
+         }
+      }
+
+      uint32 before = target.length();
+      bool bBad;
+      uint32 done = s_decodeUTF8( buffer, len, target, bBad );
+      if ( bBad )
+      {
+         // stop here as get() would; what follows is read back by the next reads.
+         m_parseStatus = false;
+         String rest;
+         rest.bufferize();
+         while( done < len )
+            done += s_decodeUTF8( buffer + done, len - done, rest, bBad );
+         unget( rest );
+         break;
+      }
+
+      size -= target.length() - before;
+      if ( len < req )
+         break;
+   }
+
+   if ( ! m_stream->good() )
+      m_parseStatus = false;
+   return m_parseStatus;
+}
+
+/** Offset of the first byte after a given count of complete UTF-8 sequences. */
+static uint32 s_offsetUTF8( const byte* data, uint32 len, uint32& chars )
+{
+   uint32 pos = 0;
+   while( chars > 0 && pos < len )
+   {
+      uint32 next = pos + s_lengthUTF8( data[pos] );
+      if ( next > len )
+         break;
+      pos = next;
+      --chars;
+   }
+   return pos;
+}
+
+bool TranscoderUTF8::readLine( String &target, uint32 size )
+{
+   if ( ! bufferEmpty() || ! m_stream->isStreamBuffer() )
+      return Stream::readLine( target, size );
+
+   m_parseStatus = true;
+   StreamBuffer* sb = static_cast<StreamBuffer*>( m_stream );
+   target.bufferize();
+   uint32 count = 0;
+   uint32 want = 1;
+   bool bRead = false;
+
+   for(;;)
+   {
+      const byte* data;
+      int32 avail = sb->peekSpan( data, want );
+      if ( avail <= 0 )
+         return bRead;
+
+      // less than we asked means that the stream is over.
+      bool bEnd = (uint32) avail < want;
+      want = 1;
+
+      uint32 len = (uint32) avail;
+      uint32 room = size == 0 ? len : size - count;
+
+      // the EOL is not stored, so it can be found a bit after the room left;
+      // each character takes at most 4 bytes.
+      uint32 scan = room < len / 4 ? room * 4 + 2 : len;
+      if ( scan > len )
+         scan = len;
+
+      const byte* eol = (const byte*) memchr( data, '\n', scan );
+      uint32 take = len;
+      uint32 decode = len;
+      bool bLineEnd = false;
+
+      if ( eol != 0 )
+      {
+         take = (uint32) (eol - data);
+         decode = take > 0 && data[take-1] == '\r' ? take - 1 : take;
+         uint32 left = room;
+         if ( size == 0 || s_offsetUTF8( data, decode, left ) == decode )
+         {
+            ++take;
+            bLineEnd = true;
+         }
+      }
+
+      if ( ! bLineEnd && size != 0 )
+      {
+         // the line is too long; the rest is read by the next call.
+         uint32 left = room;
+         uint32 off = s_offsetUTF8( data, len, left );
+         if ( left == 0 && off < len )
+         {
+            take = decode = off;
+            bLineEnd = true;
+         }
+      }
+
+      if ( ! bLineEnd && ! bEnd )
+      {
+         // don't split a sequence between two spans...
+         for ( uint32 back = 1; back <= 3 && back <= len; ++back )
+         {
+            if ( (data[len - back] & 0xC0) != 0x80 )
+            {
+               if ( s_lengthUTF8( data[len - back] ) > back )
+                  take = len - back;
+               break;
+            }
+         }
+
+         // ... nor a CR from the LF that may follow it.
+         if ( take == len && data[take - 1] == '\r' )
+            --take;
+
+         if ( take == 0 )
+         {
+            // peek again asking for the missing bytes.
+            want = s_lengthUTF8( data[0] );
+            if ( want <= len )
+               want = len + 1;
+            continue;
+         }
+
+         decode = take;
+      }
+      else if ( ! bLineEnd && data[len - 1] == '\r' )
+      {
+         // a CR at the end of the stream is not part of the line.
+         decode = len - 1;
+      }
+
+      uint32 before = target.length();
+      bool bBad;
+      uint32 done = s_decodeUTF8( data, decode, target, bBad );
+      count += target.length() - before;
+      bRead = bRead || bLineEnd || count > 0;
+
+      if ( bBad )
+      {
+         // the line ends where get() would have failed.
+         sb->consumeSpan( done );
+         m_parseStatus = false;
+         return count > 0;
+      }
+
+      sb->consumeSpan( take );
+      if ( bLineEnd || bEnd )
+         return bRead;
+   }
+}
+
+bool TranscoderUTF8::writeString( const String &source, uint32 begin, uint32 end )
+{
+   m_parseStatus = true;
+   if ( end > source.length() )
+      end = source.length();
+
+   const byte* data = source.getRawStorage();
+   uint32 cs = source.manipulator()->charSize();
+
+   byte buffer[ TRANSCODER_BLOCK_SIZE + 4 ];
+   uint32 len = 0;
+   uint32 pos = begin;
+   while( pos < end )
+   {
+      uint32 run = 0;
+      if ( cs == 1 )
+      {
+         uint32 room = TRANSCODER_BLOCK_SIZE - len;
+         run = s_runBelow( data + pos, end - pos < room ? end - pos : room, 0x80 );
+         memcpy( buffer + len, data + pos, run );
+         len += run;
+         pos += run;
+      }
+
+      if ( run == 0 )
+         len += s_encodeUTF8( s_charAt( data, cs, pos++ ), buffer + len );
+
+      if ( len >= TRANSCODER_BLOCK_SIZE )
+      {
+         if ( ! s_writeBlock( m_stream, buffer, len ) )
+            return false;
+         len = 0;
+      }
+   }
+
+   return s_writeBlock( m_stream, buffer, len );
+}
+
 TranscoderUTF8 *TranscoderUTF8::clone() const
 {
    return new TranscoderUTF8( *this );
@@ -918,7 +1509,7 @@ bool TranscoderUTF16::get( uint32 &chr )
       }
 
       // fine, we can complete.
-      chr |= (in & 0x3FF);
+      chr = (chr | (in & 0x3FF)) + 0x10000;
    }
    else
       chr = (uint32) in;
@@ -970,13 +1561,14 @@ bool TranscoderUTF16::put( uint32 chr )
          return false;
    }
    else {
+      chr -= 0x10000;
       out = 0xD800 | ((chr >> 10) & 0x3FF);
       if( m_streamEndian != m_hostEndian )
          out = (out >> 8 ) | ( out << 8 );
       if ( m_stream->write( &out, 2 ) != 2 )
          return false;
 
-      out = 0xDC00 | ((chr >> 10) & 0x3FF);
+      out = 0xDC00 | (chr & 0x3FF);
       if( m_streamEndian != m_hostEndian )
          out = (out >> 8 ) | ( out << 8 );
       if ( m_stream->write( &out, 2 ) != 2 )
@@ -986,6 +1578,158 @@ bool TranscoderUTF16::put( uint32 chr )
    return true;
 }
 
+inline uint16 s_swap16( uint16 unit, bool bSwap )
+{
+   return bSwap ? (uint16) ((unit >> 8) | (unit << 8)) : unit;
+}
+
+/** Decodes UTF-16 data as get() would, up to the first invalid sequence.
+   \return The count of units consumed, including the invalid sequence.
+*/
+static uint32 s_decodeUTF16( const uint16* data, uint32 count, bool bSwap, String& target, bool& bBad )
+{
+   uint32 pos = 0;
+   bBad = false;
+
+   while( pos < count )
+   {
+      uint32 run = 0;
+      while( pos + run < count && (s_swap16( data[pos + run], bSwap ) & 0xF800) != 0xD800 )
+         ++run;
+
+      if ( run > 0 )
+      {
+         s_appendUnits( target, data + pos, run, bSwap );
+         pos += run;
+         continue;
+      }
+
+      uint16 high = s_swap16( data[pos++], bSwap );
+      if ( high > 0xDBFF || pos == count )
+      {
+         bBad = true;
+         return pos;
+      }
+
+      uint16 low = s_swap16( data[pos++], bSwap );
+      if ( low < 0xDC00 || low > 0xDFFF )
+      {
+         bBad = true;
+         return pos;
+      }
+
+      target.append( ((((uint32) high & 0x3FF) << 10) | (low & 0x3FF)) + 0x10000 );
+   }
+
+   return pos;
+}
+
+bool TranscoderUTF16::readString( String &target, uint32 size )
+{
+   m_parseStatus = true;
+   target.size( 0 );
+   target.bufferize();
+   size -= readBuffered( target, size );
+
+   // the first character decides the byte order.
+   if ( size > 0 && m_bFirstIn )
+   {
+      uint32 chr;
+      if ( ! get( chr ) )
+         return m_stream->good();
+      target.append( chr );
+      --size;
+   }
+
+   bool bSwap = m_streamEndian != m_hostEndian;
+   // room to complete a surrogate pair broken by the end of the block.
+   uint16 buffer[ TRANSCODER_BLOCK_SIZE / 2 + 1 ];
+   while( size > 0 )
+   {
+      uint32 req = (size < TRANSCODER_BLOCK_SIZE / 2 ? size : TRANSCODER_BLOCK_SIZE / 2) * 2;
+      uint32 len = s_readFull( m_stream, (byte*) buffer, req );
+      // an odd byte at the end of the stream is dropped, as get() does.
+      uint32 count = len / 2;
+
+      if ( len == req && (s_swap16( buffer[count-1], bSwap ) & 0xFC00) == 0xD800 )
+      {
+         if ( s_readFull( m_stream, (byte*) (buffer + count), 2 ) == 2 )
+            ++count;
+      }
+
+      uint32 before = target.length();
+      bool bBad;
+      uint32 done = s_decodeUTF16( buffer, count, bSwap, target, bBad );
+      if ( bBad )
+      {
+         // stop here as get() would; what follows is read back by the next reads.
+         m_parseStatus = false;
+         String rest;
+         rest.bufferize();
+         while( done < count )
+            done += s_decodeUTF16( buffer + done, count - done, bSwap, rest, bBad );
+         unget( rest );
+         break;
+      }
+
+      size -= target.length() - before;
+      if ( len < req )
+         break;
+   }
+
+   if ( ! m_stream->good() )
+      m_parseStatus = false;
+   return m_parseStatus;
+}
+
+bool TranscoderUTF16::writeString( const String &source, uint32 begin, uint32 end )
+{
+   m_parseStatus = true;
+   if ( end > source.length() )
+      end = source.length();
+   if ( begin >= end )
+      return true;
+
+   // the first character writes the byte order mark.
+   if ( m_bFirstOut )
+   {
+      if ( ! put( source.getCharAt( begin ) ) )
+         return false;
+      ++begin;
+   }
+
+   const byte* data = source.getRawStorage();
+   uint32 cs = source.manipulator()->charSize();
+   bool bSwap = m_streamEndian != m_hostEndian;
+
+   if ( cs == 2 && ! bSwap )
+      return s_writeBlock( m_stream, data + begin * 2, (end - begin) * 2 );
+
+   uint16 buffer[ TRANSCODER_BLOCK_SIZE / 2 + 2 ];
+   uint32 count = 0;
+   for ( uint32 pos = begin; pos < end; ++pos )
+   {
+      uint32 chr = s_charAt( data, cs, pos );
+      if ( chr < 0x10000 )
+         buffer[count++] = s_swap16( (uint16) chr, bSwap );
+      else
+      {
+         chr -= 0x10000;
+         buffer[count++] = s_swap16( (uint16) (0xD800 | ((chr >> 10) & 0x3FF)), bSwap );
+         buffer[count++] = s_swap16( (uint16) (0xDC00 | (chr & 0x3FF)), bSwap );
+      }
+
+      if ( count >= TRANSCODER_BLOCK_SIZE / 2 )
+      {
+         if ( ! s_writeBlock( m_stream, (byte*) buffer, count * 2 ) )
+            return false;
+         count = 0;
+      }
+   }
+
+   return s_writeBlock( m_stream, (byte*) buffer, count * 2 );
+}
+
 TranscoderUTF16 *TranscoderUTF16::clone() const
 {
    return new TranscoderUTF16( *this );
@@ -1006,18 +1750,8 @@ TranscoderISO_CP::TranscoderISO_CP( const TranscoderISO_CP &other ):
    m_nMaxUntl( other.m_nMaxUntl )
 {}
 
-bool TranscoderISO_CP::get( uint32 &chr )
+bool TranscoderISO_CP::decode( byte in, uint32 &chr ) const
 {
-   m_parseStatus = true;
-
-   if( popBuffer( chr ) )
-      return true;
-
-   // converting the character into an unicode.
-   byte in;
-   if ( m_stream->read( &in, 1 ) != 1 )
-      return false;
-
    if ( in < 0xA0 )
    {
       chr = (uint32) in;
@@ -1027,23 +1761,36 @@ bool TranscoderISO_CP::get( uint32 &chr )
    if ( in >= 0xA0 + m_dirTabSize )
    {
       chr = (uint32) '?';
-      m_parseStatus = false;
-      return true;
+      return false;
    }
 
    chr = (uint32) m_directTable[ in - 0xA0 ];
    if ( chr == 0 ) {
       chr = (uint32) '?';
-      m_parseStatus = false;
+      return false;
    }
 
    return true;
 }
 
-bool TranscoderISO_CP::put( uint32 chr )
+bool TranscoderISO_CP::get( uint32 &chr )
 {
    m_parseStatus = true;
-   byte out;
+
+   if( popBuffer( chr ) )
+      return true;
+
+   // converting the character into an unicode.
+   byte in;
+   if ( m_stream->read( &in, 1 ) != 1 )
+      return false;
+
+   m_parseStatus = decode( in, chr );
+   return true;
+}
+
+bool TranscoderISO_CP::encode( uint32 chr, byte &out ) const
+{
    if ( chr >= m_nMinUntl && chr <= m_nMaxUntl )
    {
       out = (byte) chr;
@@ -1070,8 +1817,7 @@ bool TranscoderISO_CP::put( uint32 chr )
             if ( lower == higher )  // not found
             {
                out = (byte) '?';
-               m_parseStatus = false;
-               break;
+               return false;
             }
             // last try. In pair sized dictionaries, it can be also in the other node
             else if ( lower == higher -1 )
@@ -1093,10 +1839,102 @@ bool TranscoderISO_CP::put( uint32 chr )
       }
    }
 
+   return true;
+}
+
+bool TranscoderISO_CP::put( uint32 chr )
+{
+   byte out;
+   m_parseStatus = encode( chr, out );
+
    // write the result
    return (m_stream->write( &out, 1 ) == 1);
 }
 
+bool TranscoderISO_CP::readString( String &target, uint32 size )
+{
+   bool exitStatus = true;
+   target.size( 0 );
+   target.bufferize();
+   size -= readBuffered( target, size );
+
+   // bytes up to m_nMaxUntl are the same in unicode.
+   byte limit = (byte) (m_nMaxUntl + 1);
+   byte buffer[ TRANSCODER_BLOCK_SIZE ];
+   while( size > 0 )
+   {
+      uint32 req = size < TRANSCODER_BLOCK_SIZE ? size : TRANSCODER_BLOCK_SIZE;
+      uint32 len = s_readFull( m_stream, buffer, req );
+
+      uint32 pos = 0;
+      while( pos < len )
+      {
+         uint32 run = s_runBelow( buffer + pos, len - pos, limit );
+         if ( run > 0 )
+         {
+            s_appendBytes( target, buffer + pos, run );
+            pos += run;
+            continue;
+         }
+
+         uint32 chr;
+         if ( ! decode( buffer[pos++], chr ) )
+            exitStatus = false;
+         target.append( chr );
+      }
+
+      size -= len;
+      if ( len < req )
+         break;
+   }
+
+   m_parseStatus = exitStatus;
+   return exitStatus;
+}
+
+bool TranscoderISO_CP::writeString( const String &source, uint32 begin, uint32 end )
+{
+   bool exitStatus = true;
+   if ( end > source.length() )
+      end = source.length();
+
+   const byte* data = source.getRawStorage();
+   uint32 cs = source.manipulator()->charSize();
+   byte limit = (byte) (m_nMaxUntl + 1);
+
+   byte buffer[ TRANSCODER_BLOCK_SIZE ];
+   uint32 len = 0;
+   uint32 pos = begin;
+   while( pos < end )
+   {
+      uint32 run = 0;
+      if ( cs == 1 )
+      {
+         uint32 room = TRANSCODER_BLOCK_SIZE - len;
+         run = s_runBelow( data + pos, end - pos < room ? end - pos : room, limit );
+         memcpy( buffer + len, data + pos, run );
+         len += run;
+         pos += run;
+      }
+
+      if ( run == 0 )
+      {
+         if ( ! encode( s_charAt( data, cs, pos++ ), buffer[len++] ) )
+            exitStatus = false;
+      }
+
+      if ( len == TRANSCODER_BLOCK_SIZE )
+      {
+         if ( ! s_writeBlock( m_stream, buffer, len ) )
+            return false;
+         len = 0;
+      }
+   }
+
+   m_parseStatus = exitStatus;
+   return s_writeBlock( m_stream, buffer, len );
+}
+
 TranscoderCP1252::TranscoderCP1252( Stream *s, bool bOwn ):
    TranscoderISO_CP( s, bOwn )
 {
@@ -1322,18 +2160,8 @@ TranscoderOEM::TranscoderOEM( const TranscoderOEM &other ):
    TranscoderISO_CP( other )
 {}
 
-bool TranscoderOEM::get( uint32 &chr )
+bool TranscoderOEM::decode( byte in, uint32 &chr ) const
 {
-   m_parseStatus = true;
-
-   if( popBuffer( chr ) )
-      return true;
-
-   // converting the character into an unicode.
-   byte in;
-   if ( m_stream->read( &in, 1 ) != 1 )
-      return false;
-
    if ( in >= m_nMinUntl && in <= m_nMaxUntl )
    {
       chr = (uint32) in;
@@ -1343,14 +2171,10 @@ bool TranscoderOEM::get( uint32 &chr )
    if ( in >= 0xFF )
    {
       chr = (uint32) '?';
-      m_parseStatus = false;
-      return true;
+      return false;
    }
 
-   chr = chr < m_nMinUntl ? 
-      (uint32) m_directTable[ in ] :
-      (uint32) m_directTable[ in + m_nMinUntl - m_nMaxUntl-1 ];
-
+   chr = (uint32) m_directTable[ in + m_nMinUntl - m_nMaxUntl-1 ];
    return true;
 }
 
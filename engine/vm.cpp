@@ -266,6 +266,7 @@ void VMachine::internal_construct()
    m_opHandlers[ P_OOB ] = opcodeHandler_OOB;
    m_opHandlers[ P_TRDN ] = opcodeHandler_TRDN;
    m_opHandlers[ P_EXEQ ] = opcodeHandler_EXEQ;
+   m_opHandlers[ P_INSW ] = opcodeHandler_INSW;
 
    // Finally, register to the GC system
    memPool->registerVM( this );
@@ -1885,13 +1886,16 @@ bool VMachine::seekString( const String *value, byte *base, uint16 size, uint32
       fassert( paragon != 0 );
       if ( paragon == 0 )
          return false;
-      if ( *paragon == *value )
+
+      // strings coming from the module tables share their data; compare once.
+      int cmp = value->compare( *paragon );
+      if ( cmp == 0 )
       {
          landing = *reinterpret_cast< int32 *>( pos + sizeof(int32) );
          return true;
       }
 
-      if ( *value > *paragon )
+      if ( cmp > 0 )
          lower = point;
       else
          higher = point;
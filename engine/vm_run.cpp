@@ -41,6 +41,8 @@
 #include <falcon/rangeseq.h>
 #include <falcon/generatorseq.h>
 #include <falcon/garbagepointer.h>
+#include <falcon/livemodule.h>
+#include <falcon/switchindex.h>
 
 #include <math.h>
 #include <errno.h>
@@ -302,7 +304,9 @@ void opcodeHandler_GENA( register VMachine *vm )
    // copy the m-topmost items in the stack into the array
    if( size > 0 )
    {
-      array->items().copyOnto( vm->stack(), vm->stack().length() - size,  size );
+      memcpy( (void*) array->items().elements(), &vm->stack()[ vm->stack().length() - size ],
+            array->items().esize( size ) );
+      array->length( size );
       vm->currentFrame()->pop( size );
    }
 }
@@ -1048,6 +1052,11 @@ void opcodeHandler_SWCH( register VMachine *vm )
    uint16 sw_str = (int16) (sw_count >> 16);
    uint16 sw_obj = (int16) sw_count;
 
+   // large tables are searched through a hashed index
+   const SwitchIndex *index = 0;
+   if ( SwitchIndex::worthIndexing( sw_count ) )
+      index = vm->currentLiveModule()->switchIndex( tableBase, sw_count );
+
    //determine the value type to be checked
    switch( operand2->type() )
    {
@@ -1059,7 +1068,12 @@ void opcodeHandler_SWCH( register VMachine *vm )
       break;
 
       case FLC_ITEM_INT:
-         if ( sw_int > 0 &&
+         if ( index != 0 )
+         {
+            if ( index->findInteger( operand2->asInteger(), vm->m_currentContext->pc_next() ) )
+               return;
+         }
+         else if ( sw_int > 0 &&
                vm->seekInteger( operand2->asInteger(), tableBase + sizeof(uint32), sw_int, vm->m_currentContext->pc_next() ) )
             return;
          if ( sw_rng > 0 &&
@@ -1070,7 +1084,12 @@ void opcodeHandler_SWCH( register VMachine *vm )
       break;
 
       case FLC_ITEM_NUM:
-         if ( sw_int > 0 &&
+         if ( index != 0 )
+         {
+            if ( index->findInteger( operand2->forceInteger(), vm->m_currentContext->pc_next() ) )
+               return;
+         }
+         else if ( sw_int > 0 &&
                vm->seekInteger( operand2->forceInteger(), tableBase + sizeof(uint32), sw_int, vm->m_currentContext->pc_next() ) )
             return;
          if ( sw_rng > 0 &&
@@ -1081,7 +1100,12 @@ void opcodeHandler_SWCH( register VMachine *vm )
       break;
 
       case FLC_ITEM_STRING:
-         if ( sw_str > 0 &&
+         if ( index != 0 )
+         {
+            if ( index->findString( *operand2->asString(), vm->m_currentContext->pc_next() ) )
+               return;
+         }
+         else if ( sw_str > 0 &&
                vm->seekString( operand2->asString(),
                   tableBase + sizeof(uint32) +
                      sw_int * (sizeof(uint64) + sizeof(uint32) )+
@@ -1628,7 +1652,7 @@ void opcodeHandler_CLOS( register VMachine *vm )
       ItemArray* closure = new ItemArray( size );
       Item *data = closure->elements();
       int32 base = vm->stack().length() - size;
-      memcpy( data, &vm->stack()[ base ], sizeof(Item)*size );
+      memcpy( (void*) data, &vm->stack()[ base ], sizeof(Item)*size );
       closure->length( size );
       vm->stack().resize( base );
 
@@ -1969,6 +1993,68 @@ void opcodeHandler_EXEQ( register VMachine *vm )
    Item *operand2 =  vm->getOpcodeParam( 2 );
    vm->regA().setBoolean( operand1->exactlyEqual(*operand2) );
 }
+
+// 0x71
+void opcodeHandler_INSW( register VMachine *vm )
+{
+   bool negate = vm->getNextNTD32() != 0;
+   Item *operand2 =  vm->getOpcodeParam( 2 )->dereference();
+   uint64 sw_count = (uint64) vm->getNextNTD64();
+
+   byte *tableBase =  vm->m_currentContext->code() + vm->m_currentContext->pc_next();
+
+   uint16 sw_int = (int16) (sw_count >> 48);
+   uint16 sw_str = (int16) (sw_count >> 16);
+   byte *intBase = tableBase + sizeof(uint32);
+   byte *strBase = intBase + sw_int * (sizeof(uint64) + sizeof(uint32) );
+
+   // skip the table
+   vm->m_currentContext->pc_next() += sizeof(uint32) +
+         sw_int * (sizeof(uint64) + sizeof(uint32) ) +
+         sw_str * (sizeof(uint32) + sizeof(uint32) );
+
+   const SwitchIndex *index = 0;
+   if ( SwitchIndex::worthIndexing( sw_count ) )
+      index = vm->currentLiveModule()->switchIndex( tableBase, sw_count );
+
+   uint32 landing;
+   bool result = false;
+   switch( operand2->type() )
+   {
+      case FLC_ITEM_INT:
+         if ( index != 0 )
+            result = index->findInteger( operand2->asInteger(), landing );
+         else
+            result = sw_int > 0 && vm->seekInteger( operand2->asInteger(), intBase, sw_int, landing );
+      break;
+
+      case FLC_ITEM_STRING:
+         if ( index != 0 )
+            result = index->findString( *operand2->asString(), landing );
+         else
+            result = sw_str > 0 && vm->seekString( operand2->asString(), strBase, sw_str, landing );
+      break;
+
+      default:
+      {
+         // other types (i.e. numbers) are checked as IN would do on the literal array.
+         for( uint16 i = 0; i < sw_int && ! result; ++i )
+         {
+            Item element( (int64) loadInt64( intBase + i * (sizeof(uint64) + sizeof(uint32)) ) );
+            result = element == *operand2;
+         }
+
+         for( uint16 i = 0; i < sw_str && ! result; ++i )
+         {
+            Item element( vm->currentLiveModule()->getString(
+                  *reinterpret_cast<int32 *>( strBase + i * (sizeof(uint32) + sizeof(uint32)) ) ) );
+            result = element == *operand2;
+         }
+      }
+   }
+
+   vm->regA().setBoolean( result != negate );
+}
    
 
 }
@@ -51,6 +51,7 @@ VMContext::VMContext():
    m_lmodule = 0;
 
    m_frames = allocFrame();
+   m_items.attach( m_frames, 0 );
    // reset stuff for the first frame,
    // as allocFrame doesn't clear everything for performance reasons.
    m_frames->m_param_count = 0;
@@ -76,6 +77,7 @@ VMContext::VMContext( const VMContext& other ):
    m_lmodule = other.m_lmodule;
 
    m_frames = allocFrame();
+   m_items.attach( m_frames, 0 );
    // reset stuff for the first frame,
    // as allocFrame doesn't clear everything for performance reasons.
    m_frames->m_param_count = 0;
@@ -243,6 +245,8 @@ bool VMContext::getTraceStep( uint32 level, const Symbol* &sym, uint32& line, ui
 
 void VMContext::addFrame( StackFrame* frame )
 {
+   // the new frame window starts where the previous one ends.
+   m_items.attach( frame, m_frames );
    frame->prev( m_frames );
    m_frames = frame;
 }
@@ -264,7 +268,6 @@ StackFrame* VMContext::allocFrame()
    {
       StackFrame* ret = m_spareFrames;
       m_spareFrames = m_spareFrames->prev();
-      ret->resizeStack(0);
 
       ret->prev(0);
       ret->m_try_base = VMachine::i_noTryFrame;
@@ -296,12 +299,13 @@ void VMContext::resetFrames()
    if( m_frames == 0 )
    {
       m_frames = allocFrame();
+      m_items.attach( m_frames, 0 );
    }
    else
    {
       StackFrame* top = m_frames->prev();
       m_frames->prev( 0 );
-      m_frames->resizeStack(0);
+      m_items.attach( m_frames, 0 );
 
       if ( top != 0 )
       {
@@ -442,6 +442,14 @@ public:
    void strictMode( bool breq ) { m_strict = breq; }
    bool strictMode() const { return m_strict; }
 
+   /** Describes the settings changing the outcome of a compilation.
+      The description covers the directives set from outside (strict mode
+      and language) and the constants defined in the compiler; the same
+      source compiled under the same description gives the same module.
+      \param target Where the description is appended.
+   */
+   void settingsKey( String &target ) const;
+
    /** Are we parsing a normal file or an escaped template file? */
    bool parsingFtd() const;
    void parsingFtd( bool b );
@@ -106,6 +106,9 @@ private:
    /** Parameters for the bottom frame (safely stored here) */
    ItemArray m_params;
 
+   /** Items of the frames while they are not in the context. */
+   ItemStack m_items;
+
    bool m_bComplete;
 
    int32 m_refCount;
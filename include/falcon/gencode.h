@@ -315,6 +315,12 @@ class FALCON_DYN_CLASS GenCode: public Generator
    void gen_dict_decl( const DictDecl *stmt );
    void gen_array_decl( const ArrayDecl *stmt );
    void gen_range_decl( const RangeDecl *stmt );
+
+   /** Generates an INSW for `item in set` (or notin, if negate is true).
+      \return false if the set holds something else than integer and
+         string literals; in this case, nothing is generated.
+   */
+   bool gen_in_set( const Value *item, const ArrayDecl *set, bool negate );
    /** Geneare a push instruction based on a source value.
       Push is a kinda tricky instruction. Theoretically, if the value holds
       a reference taking expression, one can LDRF on the target and then push A,
@@ -27,6 +27,7 @@ class StringTable;
 class VFSProvider;
 class String;
 class ModuleCache;
+class InternTable;
 
 FALCON_DYN_SYM extern void * (*memAlloc) ( size_t );
 FALCON_DYN_SYM extern void (*memFree) ( void * );
@@ -102,6 +103,18 @@ namespace Engine
    /** Public module cache. */
    FALCON_DYN_SYM ModuleCache* getModuleCache();
 
+   /** Empties the public module cache.
+      The modules will be loaded again from their files the next time
+      they are required.
+      \return Count of the modules removed from the cache (0 if caching is off).
+   */
+   FALCON_DYN_SYM uint32 flushModuleCache();
+
+   /** Engine wide table of immutable strings.
+      \return The intern table, or 0 if the engine is not initialized.
+   */
+   FALCON_DYN_SYM InternTable* getInternTable();
+
    class AutoInit {
    public:
       AutoInit() { Init(); }
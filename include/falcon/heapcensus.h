@@ -0,0 +1,117 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: heapcensus.h
+
+   Snapshot of the live items held by the memory pool.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 19:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Snapshot of the live items held by the memory pool.
+*/
+
+#ifndef FALCON_HEAPCENSUS_H
+#define FALCON_HEAPCENSUS_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/genericmap.h>
+
+namespace Falcon {
+
+class String;
+class GarbageableBase;
+
+/** Count of the live garbageable items, by kind and by allocation site.
+
+   A census is filled by MemPool::census(). Items are grouped by kind:
+   "array", "dict", "string", "membuf", "function", "class", "range",
+   "reference", "module", "pointer" and "other"; objects are grouped by
+   the name of their class, as "object:<class name>", or under "object" if
+   their class is not available anymore.
+
+   The bytes retained by each item are an estimate: the size of the item
+   itself plus the memory directly owned by it (the item vector of an
+   array, the characters of a string and so on). Deep data, as the items
+   stored in a container, is accounted under its own kind.
+
+   When allocation site tracking is active (see MemPool::trackSites()),
+   the items whose allocation was sampled are also grouped by the
+   "module:line" where they were created.
+*/
+class FALCON_DYN_CLASS HeapCensus: public BaseAlloc
+{
+public:
+   /** Count and retained memory of a group of items. */
+   class Entry: public BaseAlloc
+   {
+   public:
+      uint32 m_count;
+      uint64 m_bytes;
+
+      Entry():
+         m_count( 0 ),
+         m_bytes( 0 )
+      {}
+   };
+
+   HeapCensus();
+   ~HeapCensus();
+
+   /** Records the classes and modules still held by the pool.
+      Items that have never been marked stay in the pool even when the
+      classes that generated them have been reclaimed; objects are
+      attributed to their class only if this was recorded here, so all
+      the items must be passed to this method before being accounted.
+   */
+   void prepare( GarbageableBase *item );
+
+   /** Accounts a live item.
+      \param item The item to be classified.
+      \param site The site where the item was allocated, or 0 if unknown.
+   */
+   void account( GarbageableBase *item, const String *site );
+
+   /** Accounts an item that is waiting to be swept. */
+   void accountPending() { m_pending++; }
+
+   /** Total count of the live items. */
+   uint32 items() const { return m_items; }
+
+   /** Total memory retained by the live items. */
+   uint64 bytes() const { return m_bytes; }
+
+   /** Items found dead and waiting for the next sweep. */
+   uint32 pending() const { return m_pending; }
+
+   /** Map of kind names (String) to Entry pointers. */
+   const Map &kinds() const { return m_kinds; }
+
+   /** Map of allocation sites (String) to Entry pointers. */
+   const Map &sites() const { return m_sites; }
+
+private:
+   Map m_kinds;
+   Map m_sites;
+   Map m_classes;
+   Map m_modules;
+   uint32 m_items;
+   uint64 m_bytes;
+   uint32 m_pending;
+
+   static void addTo( Map &map, const String &key, uint32 bytes );
+};
+
+}
+
+#endif
+
+/* end of heapcensus.h */
@@ -0,0 +1,91 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: interntable.h
+
+   Engine wide table of immutable strings.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 20:41:07 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Engine wide table of immutable strings.
+*/
+
+#ifndef FALCON_INTERNTABLE_H
+#define FALCON_INTERNTABLE_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/mt.h>
+
+namespace Falcon {
+
+class String;
+
+/** Engine wide table of immutable strings.
+
+   Each string is stored once; the data of the stored strings is never
+   changed nor released until the table is destroyed (at engine shutdown),
+   so that any number of static strings can share it safely.
+
+   Strings sharing the same data are compared by pointer equality before
+   their characters are scanned, and interned strings carry their hash,
+   so the keys and the symbol names coming from the string tables of the
+   modules (see StringTable::intern()) are found faster in dictionaries,
+   property tables and string switches.
+
+   Strings having the same characters but a different character size are
+   stored separately, so that sharing never changes the representation of
+   a string.
+
+   The table is never cleared, so it should be used only for strings
+   coming from a bounded source, as the string tables of the modules, and
+   not for data coming from the outside world.
+*/
+class FALCON_DYN_CLASS InternTable: public BaseAlloc
+{
+public:
+   InternTable();
+   ~InternTable();
+
+   /** Returns the interned copy of a string.
+      If the string was not in the table, it is added.
+      \param str The string to be interned.
+      \return A static, interned string living as long as this table.
+   */
+   const String *intern( const String &str );
+
+   /** Turns a string into a read-only view of its interned copy.
+      The previous contents of the target are released. The target can be
+      changed later on as any other static string; it just stops being
+      recognized as interned.
+      \param target The string to be shared.
+   */
+   void share( String &target );
+
+   /** Count of strings stored in the table. */
+   uint32 size() const { return m_count; }
+
+private:
+   class Entry;
+
+   Mutex m_mtx;
+   Entry **m_buckets;
+   uint32 m_bucketCount;
+   uint32 m_count;
+
+   void grow();
+};
+
+}
+
+#endif
+
+/* end of interntable.h */
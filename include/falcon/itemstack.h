@@ -0,0 +1,190 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: itemstack.h
+
+   Segmented item stack shared by the frames of a context.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 17:05:22 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Segmented item stack shared by the frames of a context.
+*/
+
+#ifndef FALCON_ITEMSTACK_H_
+#define FALCON_ITEMSTACK_H_
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/item.h>
+#include <falcon/basealloc.h>
+
+#include <string.h>
+
+namespace Falcon
+{
+
+class ItemArray;
+class ItemStack;
+class StackFrame;
+
+/** Window of a stack frame on the item stack of its context.
+
+   Each frame sees its own part of the context stack as an array of
+   items, starting from 0. The window of the topmost frame can grow
+   by just moving the top pointer, as long as there is room in the
+   segment of the stack where it lives; when the segment is exhausted,
+   the window is moved to a larger segment.
+
+   Only the window of the topmost frame can be changed in size; the
+   items of the frames below it are never moved, so that pointers to
+   the parameters of a function stay valid while the function pushes
+   items and calls other functions.
+
+   As for the arrays, pointers to the items of the window are valid
+   until the window itself is enlarged.
+*/
+class FALCON_DYN_CLASS FrameStack
+{
+public:
+   FrameStack():
+      m_base(0),
+      m_size(0),
+      m_alloc(0),
+      m_owner(0),
+      m_segment(0)
+   {}
+
+   Item *elements() const { return m_base; }
+   uint32 length() const { return m_size; }
+   uint32 allocated() const { return m_alloc; }
+   bool empty() const { return m_size == 0; }
+
+   const Item &front() const { return m_base[0]; }
+   const Item &back() const { return m_base[m_size-1]; }
+   Item &back() { return m_base[m_size-1]; }
+
+   inline Item &operator[]( int32 pos ) throw()
+   {
+      return m_base[pos];
+   }
+
+   inline const Item &operator[]( int32 pos ) const throw()
+   {
+      return m_base[pos];
+   }
+
+   /** Changes the size of the window.
+      New items are set to nil.
+   */
+   void resize( uint32 size )
+   {
+      if ( size > m_alloc )
+         relocate( size );
+
+      if ( size > m_size )
+         memset( (void*)(m_base + m_size), 0, sizeof(Item) * (size - m_size) );
+      m_size = size;
+   }
+
+   /** Ensures that the window can grow up to size items without moving. */
+   void reserve( uint32 size )
+   {
+      if ( size > m_alloc )
+         relocate( size );
+   }
+
+   void append( const Item &item )
+   {
+      if ( m_size == m_alloc )
+      {
+         // the item may come from this window.
+         Item copy = item;
+         relocate( m_size + 1 );
+         m_base[ m_size++ ] = copy;
+      }
+      else
+         m_base[ m_size++ ] = item;
+   }
+
+   void clear() { m_size = 0; }
+
+   /** Flat copy of an array of items at a given position.
+      The window is enlarged if necessary.
+   */
+   void copyOnto( uint32 from, const ItemArray& src );
+
+private:
+   Item *m_base;
+   uint32 m_size;
+   uint32 m_alloc;
+   ItemStack *m_owner;
+   void *m_segment;
+
+   void relocate( uint32 size );
+
+   friend class ItemStack;
+};
+
+
+/** Stack of items shared by all the frames of a context.
+
+   The stack is made of large contiguous segments, and each frame
+   has a window (a FrameStack) on one of them; the window of a new
+   frame starts just above the window of the previous frame. The
+   parameters of a call stay in the window of the caller, and the
+   callee refers to them in place.
+
+   Segments are never shrunk nor freed while the stack is alive, so
+   they are reused by subsequent calls.
+*/
+class FALCON_DYN_CLASS ItemStack: public BaseAlloc
+{
+public:
+   ItemStack();
+   ~ItemStack();
+
+   /** Opens the window of a frame above the window of another frame.
+      \param frame The frame receiving a new, empty window.
+      \param below The frame below, or 0 to place the window at the bottom of the stack.
+   */
+   void attach( StackFrame* frame, StackFrame* below );
+
+   /** Moves a chain of frames on this stack.
+
+      The frames from top down to bottom (included) receive new windows
+      on this stack, placed above the window of the frame below (or at
+      the bottom, if below is 0), and their items are copied there.
+
+      The parameters of all the frames in the chain except bottom are
+      set to refer to the new windows; the caller must take care of the
+      parameters of bottom.
+   */
+   void adopt( StackFrame* top, StackFrame* bottom, StackFrame* below );
+
+   /** Number of items allocated in all the segments. */
+   uint32 allocated() const;
+
+private:
+   class Segment;
+
+   Segment* m_first;
+
+   /** Returns a segment above the given one, able to hold at least size items. */
+   Segment* next( Segment* seg, uint32 size );
+   void place( FrameStack& window, Segment* seg, Item* base );
+
+   friend class FrameStack;
+};
+
+}
+
+#endif
+
+/* end of itemstack.h */
@@ -65,8 +65,17 @@ class FALCON_DYN_CLASS LinearDict: public ItemDict
    LinearDictEntry *m_data;
    uint32 m_mark;
 
+   /** True when all the keys are integers. */
+   bool m_bIntKeys;
+
    bool addInternal( uint32 pos, const Item &key, const Item &value );
 
+   /** Search for integer keys in dictionaries having only integer keys.
+      The keys are compared as raw integers, and if they are contiguous,
+      the position of the key is computed directly.
+   */
+   bool findInteger( int64 key, uint32 &ret_pos ) const;
+
    /** Make a search in a standard dictionary.
       This function returns true if the required item is found,
       and false if the item is not found. In the first case ret_pos becomes
@@ -122,6 +131,19 @@ public:
       return findInternal( key, ret_pos );
    }
 
+   /** True if all the keys in this dictionary are integers.
+      Integer keys are searched faster in dictionaries having only integer
+      keys; the dictionary goes back to the generic search as soon as a key
+      of another type is stored.
+   */
+   bool hasIntegerKeys() const { return m_bIntKeys; }
+
+   /** Checks the type of the keys after storing entries directly.
+      Must be called after changing the keys in entries() and setting
+      the length() by hand.
+   */
+   void checkKeys();
+
    //========================================================
    // Iterator implementation.
    //========================================================
@@ -33,6 +33,8 @@
 namespace Falcon
 {
 
+class SwitchIndex;
+
 /** Instance of a live module entity.
 
    The VM sees modules as a closed, read-only entity. Mutable data in a module is actually
@@ -72,6 +74,7 @@ class FALCON_DYN_CLASS LiveModule: public Garbageable
    mutable uint32 m_strCount;
    mutable uint32 m_aacc;
    mutable int32 m_iacc;
+   mutable Map *m_switchIndex;
    ItemArray m_globals;
    ItemArray m_wkitems;
    bool m_bPrivate;
@@ -145,6 +148,14 @@ public:
    /** Return the string in the module with the given ID.
    */
    String* getString( uint32 stringId ) const;
+
+   /** Return the hashed lookup of a switch table in the module code.
+      The index is built the first time it's requested, and is kept
+      as long as this live module.
+      \param table The start of the switch table in the code of the module.
+      \param count The case counts written in the switch instruction.
+   */
+   const SwitchIndex *switchIndex( byte *table, uint64 count ) const;
    
    /** True if this module requires a second link step. */
    bool needsCompleteLink() const { return m_needsCompleteLink; }
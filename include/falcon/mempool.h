@@ -25,12 +25,14 @@
 #include <falcon/basealloc.h>
 #include <falcon/mt.h>
 #include <falcon/rampmode.h>
+#include <falcon/genericmap.h>
 
 namespace Falcon {
 
 class Garbageable;
 class GarbageableBase;
 class GarbageLock;
+class HeapCensus;
 
 /** Storage pit for garbageable data.
    Garbage items can be removed acting directly on them.
@@ -164,12 +166,30 @@ protected:
     */
    uint32 m_lockGen;
 
+   /** Census requested to the GC thread (guarded by m_mtxRequest). */
+   HeapCensus *m_censusTarget;
+   Event m_eCensusDone;
+   /** Serializes the census requests. */
+   Mutex m_mtx_census;
+
+   /** One allocation every m_siteRate is attributed to its site; 0 to disable. */
+   uint32 m_siteRate;
+   volatile int32 m_siteTick;
+
+   /** Allocation sites (String) to their interned String *.
+      Guarded by m_mtx_newitem, as m_itemSites.
+   */
+   Map m_siteNames;
+
+   /** Sampled items to the interned String * of their allocation site. */
+   Map m_itemSites;
+
    //==================================================
    // Private functions
    //==================================================
 
    bool markVM( VMachine *vm );
-   void gcSweep();
+   void gcSweep( uint32 mingen );
 
    /*
    To reimplement this, we need to have anti-recursion checks on item, which are
@@ -187,14 +207,18 @@ protected:
    void removeFromGarbageDeep( const Item &item );
    */
 
-   void clearRing( GarbageableBase *ringRoot );
+   void clearRing( GarbageableBase *ringRoot, uint32 mingen );
    void rollover();
    void remark(uint32 mark);
    void electOlderVM(); // to be called with m_mtx_vms locked
 
    void promote( uint32 oldgen, uint32 curgen );
    void advanceGeneration( VMachine* vm, uint32 oldGeneration );
-   void markLocked();
+   void markLocked( uint32 mingen );
+
+   void takeCensus( HeapCensus &census );
+   void recordSite( GarbageableBase *ptr );
+   void clearSites();
    
    friend class GarbageLock;
    void addGarbageLock( GarbageLock* lock );
@@ -327,6 +351,24 @@ public:
    void accountItems( int itemCount );
 
    void performGC();
+
+   /** Takes a census of the live items.
+      The garbage ring is walked by the GC thread between two collection
+      loops; the creation of new items is blocked while the census is taken.
+      \param census The census to be filled.
+   */
+   void census( HeapCensus &census );
+
+   /** Sets the sampling rate of allocation site tracking.
+      One every rate newly created items is attributed to the module and
+      line of the script creating it; the attribution is then reported
+      by census(). Set to 0 to disable tracking and forget the sites
+      recorded up to date.
+   */
+   void trackSites( uint32 rate );
+
+   /** Returns the sampling rate of allocation site tracking (0 if disabled). */
+   uint32 trackSites() const { return m_siteRate; }
 };
 
 
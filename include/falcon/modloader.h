@@ -79,6 +79,7 @@ protected:
 
    Compiler m_compiler;
    String m_srcEncoding;
+   String m_cacheDir;
    bool m_bSaveIntTemplate;
 
    Module *compile( const String &path );
@@ -86,6 +87,24 @@ protected:
    t_filetype checkForModuleAlreadyThere( String &final_name );
 
 
+   /** Key identifying a source compiled with the current compiler directives.
+      \param path The path of the source.
+      \param key Where the key is stored.
+   */
+   void sourceCacheKey( const String &path, String &key ) const;
+
+   /** Path of the compiled form of a source in the module cache directory.
+      \param path The path of the source.
+      \param target Where the path of the cached module is stored.
+   */
+   void cachedModulePath( const String &path, String &target ) const;
+
+   /** Saves a compiled module in the module cache directory.
+      The module is written under a temporary name and then moved in
+      place, so that concurrent loaders never see a partial module.
+   */
+   bool saveCachedModule( Module *module, const String &path );
+
    /** Required language during load. */
    String m_language;
 
@@ -534,6 +553,22 @@ public:
    void saveModules( bool t ) { m_saveModule = t; }
    bool saveModules() const { return m_saveModule; }
 
+   /** Sets a directory where compiled sources are cached.
+      When set, the modules compiled from sources are saved in this
+      directory instead of besides their source (if saveModules() is true),
+      under a name that depends on the source path and on the settings
+      used to compile it (source encoding, template mode, search path,
+      compiler directives and constants). Sources without an up-to-date
+      .fam are then loaded from the cached module, if it has been saved
+      after the second in which the source was last changed.
+
+      This allows to cache the compiled modules of read-only directories,
+      and to share them across processes loading the same sources.
+      \param dir The cache directory (in Falcon path format), or "" to disable it.
+   */
+   void moduleCacheDir( const String &dir ) { m_cacheDir = dir; }
+   const String &moduleCacheDir() const { return m_cacheDir; }
+
    void sourceEncoding( const String &name ) { m_srcEncoding = name; }
    const String &sourceEncoding() const { return m_srcEncoding; }
 
@@ -44,6 +44,13 @@ public:
    */
    Module* add( const String& muri, Module* module );
 
+   /** Adds a module to the cache under a key different from its path.
+      The modules compiled with different directives from the same source
+      are stored under different keys; the freshness of the entry is
+      checked against the file at \b muri.
+   */
+   Module* add( const String& key, const String& muri, Module* module );
+
    /** Removes a module from the cache.
        If the module is in the cache, it is decreffed.
    */
@@ -54,6 +61,19 @@ public:
    */
    Module* find( const String& muri );
 
+   /** Returns a module stored under the given key, or 0 if not found.
+      The entry is ignored if the file at \b muri changed since it was
+      cached. The returned instance is increffed.
+   */
+   Module* find( const String& key, const String& muri );
+
+   /** Removes all the modules from the cache.
+      The modules are decreffed; the ones still in use are kept alive by
+      their users.
+      \return Count of the removed modules.
+   */
+   uint32 clear();
+
 private:
    Mutex m_mtx;
    int m_refCount;
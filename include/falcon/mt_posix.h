@@ -326,6 +326,11 @@ int32 atomicInc( volatile int32 &data );
 /** Performs an atomic thread safe decrement. */
 int32 atomicDec( volatile int32 &data );
 
+/** Atomically sets data to value if it is equal to expected.
+   \return true if the value was changed.
+*/
+bool atomicCAS( volatile int32 &data, int32 expected, int32 value );
+
 }
 
 #endif
@@ -142,6 +142,15 @@ inline int32 atomicDec( volatile int32 &data )
    return InterlockedDecrement( dp );
 }
 
+/** Atomically sets data to value if it is equal to expected.
+   \return true if the value was changed.
+*/
+inline bool atomicCAS( volatile int32 &data, int32 expected, int32 value )
+{
+   volatile LONG* dp = (volatile LONG*) &data;
+   return InterlockedCompareExchange( dp, value, expected ) == expected;
+}
+
 /**
    Generic event class.
 
@@ -540,7 +540,20 @@ while it will fill OP2 with an integer item containing 15H.
  */
 #define P_EXEQ          0x70
 
-#define FLC_PCODE_COUNT 0x71
+/** INSW: In switch table.
+   INSW \<int32\>, OP, \<int64\>
+   Sets A to true if OP is one of the cases in the table following the
+   instruction, false otherwise; the result is reversed if the first
+   operand is not zero. The table has the same layout of the SWCH table,
+   with integer and string cases only; their landings are not used.
+
+   It's generated for `x in [...]` and `x notin [...]` when the array
+   holds only integer and string literals.
+   \see SWCH
+ */
+#define P_INSW          0x71
+
+#define FLC_PCODE_COUNT 0x72
 
 #endif
 
@@ -24,7 +24,7 @@
 #include <falcon/types.h>
 #include <falcon/item.h>
 #include <falcon/basealloc.h>
-#include <falcon/itemarray.h>
+#include <falcon/itemstack.h>
 
 namespace Falcon {
 
@@ -33,11 +33,6 @@ class Module;
 class StackFrame: public BaseAlloc
 {
 public:
-   enum
-   {
-      pa_default = 8
-   } constants;
-
    bool m_break;
 
    uint32 m_ret_pc;
@@ -57,12 +52,11 @@ public:
    // points to the parameter part in the previous area.
    Item* m_params;
 
-   StackFrame( int preAlloc = pa_default ):
+   StackFrame():
       m_symbol(0),
       m_module(0),
       m_prevTryFrame(0),
-      m_prev(0),
-      m_stack( preAlloc )
+      m_prev(0)
    {}
 
    StackFrame( const StackFrame& other );
@@ -71,9 +65,11 @@ public:
    StackFrame* prev() const { return m_prev; }
    void prev( StackFrame* p ) { m_prev = p; }
 
-   /** Returns the items in the stack. */
-   const ItemArray& stack() const { return m_stack; }
-   ItemArray& stack() { return m_stack; }
+   /** Returns the items in the stack.
+      The frame sees its own window on the stack of the context.
+   */
+   const FrameStack& stack() const { return m_stack; }
+   FrameStack& stack() { return m_stack; }
 
    /** Remvoves N elements from thes stack */
    void pop( uint32 size )  { m_stack.resize( m_stack.length() - size ); }
@@ -106,14 +102,17 @@ public:
    const Item& localItem( uint32 id ) const { return m_stack[id]; }
    Item& localItem( uint32 id ) { return m_stack[id]; }
 
-   /** Copy a whole hierarcy of frames. */
+   /** Copy a whole hierarcy of frames.
+      The copied frames share the stack windows of the original ones;
+      use ItemStack::adopt() to give them their own.
+   */
    StackFrame* copyDeep( StackFrame** bottom );
 
    void gcMark( uint32 mark );
 
 private:
    StackFrame* m_prev;
-   ItemArray m_stack;
+   FrameStack m_stack;
 } ;
 
 
@@ -219,6 +219,22 @@ public:
    */
    virtual bool readString( String &target, uint32 size );
 
+   /** Reads a line of text from the stream.
+      Characters are appended to target up to the next "\n", which is consumed
+      but not stored; a "\r" right before it (or before the end of the stream)
+      is discarded as well.
+
+      This version is implemented by iteratively calling get( uint32 );
+      buffered streams and transcoders may search the line terminator in
+      their buffers.
+
+      \param target The string where the line is appended.
+      \param size Maximum count of characters to be read (0 for no limit).
+      \return true if a line (possibly empty) was read, false if the
+         stream was over or broken before a character could be read.
+   */
+   virtual bool readLine( String &target, uint32 size = 0 );
+
    /** Writes a character on the stream.
       \param chr the character to write.
       \return true success, false on stream error.
@@ -77,6 +77,27 @@ public:
    virtual bool put( uint32 chr );
    virtual int32 read( void *buffer, int32 size );
    virtual int32 write( const void *buffer, int32 size );
+   virtual bool readLine( String &target, uint32 size = 0 );
+
+   /** Gives access to the data available in the buffer.
+
+      If less than count bytes are in the buffer, the buffer is refilled
+      from the underlying stream, keeping the data that wasn't consumed yet.
+      The returned span may be shorter than count if the stream is over,
+      and count is never larger than the buffer size.
+
+      The data stays valid until the next operation on the stream; use
+      consumeSpan() to declare how much of it has been used. Characters
+      pushed back with unget() are not part of the span.
+
+      \param data Will point to the first byte available.
+      \param count Minimum count of bytes that should be available.
+      \return the count of bytes available, 0 at end of stream or -1 on error.
+   */
+   int32 peekSpan( const byte*& data, int32 count = 1 );
+
+   /** Consumes count bytes of a span returned by peekSpan(). */
+   void consumeSpan( int32 count ) { m_bufPos += count; }
 
    virtual bool errorDescription( ::Falcon::String &description ) const {
       return m_stream->errorDescription( description );
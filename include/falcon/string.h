@@ -28,6 +28,11 @@
 
 #define FALCON_STRING_ALLOCATION_BLOCK 32
 
+/** Concatenations at least this long (in bytes) share growable data.
+   \see String::concat()
+*/
+#define FALCON_STRING_SHARE_THRESHOLD 256
+
 namespace Falcon {
 
 class Stream;
@@ -290,6 +295,7 @@ class FALCON_DYN_CLASS String: public GCAlloc
    friend class csh::Buffer16;
    friend class csh::Static32;
    friend class csh::Buffer32;
+   friend class InternTable;
 
 protected:
    const csh::Base *m_class;
@@ -303,18 +309,37 @@ protected:
     */
    bool m_bExported;
 
-   // Reserved for future usage.
+   /** Flags, see t_flags. */
    byte m_bFlags;
 
    bool m_bCore;
 
+   /** Hash of the characters; valid only for interned strings. */
+   uint32 m_hash;
+
+   enum t_flags {
+      /** The data is shared with the engine intern table. */
+      flag_interned = 0x01,
+      /** The data is in a reference counted block shared with other strings. */
+      flag_shared = 0x02
+   };
+
+   /** Releases the reference to the shared data block.
+      The storage is left untouched; the caller must replace it.
+   */
+   void releaseShared();
+
+   /** Drops the shared data block, if this string has one. */
+   void unshare() { if ( (m_bFlags & flag_shared) != 0 ) releaseShared(); }
+
    /**sym
     * Creates the core string.
     *
     * This method is protected. It can be accessed only by subclasses.
     */
    explicit String( csh::Base *cl ) :
-      m_class( cl )
+      m_class( cl ),
+      m_bFlags( 0 )
    {}
 
    void internal_escape( String &strout, bool full ) const;
@@ -438,6 +463,7 @@ public:
    String( const String &other ):
       m_allocated( 0 ),
       m_bExported( false ),
+      m_bFlags( 0 ),
       m_bCore( false )
    {
       copy( other );
@@ -571,7 +597,7 @@ public:
    /** Changes the amount of bytes the string is considered to occupy.
       This is the byte-size of the string, and may or may not be the same as the string length.
    */
-   void size( uint32 s ) { m_size = s; }
+   void size( uint32 s ) { m_size = s; m_bFlags &= flag_shared; }
 
    /** Return the raw storage for this string.
       The raw storage is where the strings byte are stored. For more naive string (i.e. chunked), it
@@ -582,15 +608,17 @@ public:
    /** Changes the raw storage in this string.
       This makes the string to point to a new memory position for its character data.
    */
-   void setRawStorage( byte *b ) { m_storage = b; }
+   void setRawStorage( byte *b ) { unshare(); m_storage = b; m_bFlags = 0; }
 
    /** Changes the raw storage in this string.
       This makes the string to point to a new memory position for its character data.
    */
    void setRawStorage( byte *b, int size ) {
+      unshare();
       m_storage = b;
       m_size = size;
       m_allocated = size;
+      m_bFlags = 0;
    }
 
    /** Return the length of the string in characters.
@@ -708,6 +736,51 @@ public:
    */
    int compare( const String &other ) const;
 
+   /** Checks if this string has the same characters of another one.
+      This is faster than compare() == 0, as strings of different size are
+      found different without scanning them, and strings sharing the same
+      data (as the copies of an interned string) are found equal at once.
+      \param other the other string to be compared
+      \return true if the strings are the same.
+   */
+   bool equals( const String &other ) const;
+
+   /** Hash value of the characters in this string.
+      The value depends on the characters only, and not on the size in
+      bytes of each character, so that equal strings have equal hashes.
+      It's computed once and cached for interned strings.
+   */
+   uint32 hash() const;
+
+   /** True if this string is a read-only view of an interned string.
+      The data of interned strings is shared with the engine intern table,
+      and stays valid and unchanged until the engine is shut down.
+      \see InternTable
+   */
+   bool isInterned() const { return (m_bFlags & flag_interned) != 0 && m_allocated == 0; }
+
+   /** True if the data of this string is shared with other strings.
+      Shared data is read-only, like the data of static strings: the first
+      write operation gives the string a private buffer. Copying a string
+      having shared data just references it.
+      \see concat()
+   */
+   bool isShared() const { return (m_bFlags & flag_shared) != 0; }
+
+   /** Makes this string the concatenation of two strings.
+      Long results are stored in a reference counted block with room to
+      grow. When the head string is a previous concatenation ending at the
+      end of the used part of its block, the tail is written in the free
+      room and the block is shared; so, repeatedly adding to the result of
+      a concatenation costs just the copy of the added characters, and the
+      intermediate results stay valid and unchanged.
+
+      \param head The first part of the result.
+      \param tail The part added to it.
+      \return itself
+   */
+   String &concat( const String &head, const String &tail );
+
    /** Compares a string to another ignoring the case.
       This metod returns -1 if this string is less than the other,
       0 if it's the same and 1 if it's greater.
@@ -1243,10 +1316,10 @@ public:
 
 
 /** Equality operator */
-inline bool operator == ( const String &str1, const String &str2 )  { return str1.compare( str2 ) == 0; }
+inline bool operator == ( const String &str1, const String &str2 )  { return str1.equals( str2 ); }
 inline bool operator == ( const String &str1, const char *str2 )    { return str1.compare( str2 ) == 0; }
 inline bool operator == ( const String &str1, const wchar_t *str2 ) { return str1.compare( str2 ) == 0; }
-inline bool operator != ( const String &str1, const String &str2 )  { return str1.compare( str2 ) != 0; }
+inline bool operator != ( const String &str1, const String &str2 )  { return ! str1.equals( str2 ); }
 inline bool operator != ( const String &str1, const char *str2 )    { return str1.compare( str2 ) != 0; }
 inline bool operator != ( const String &str1, const wchar_t *str2 ) { return str1.compare( str2 ) != 0; }
 inline bool operator >  ( const String &str1, const String &str2 )  { return str1.compare( str2 ) > 0; }
@@ -1301,6 +1374,9 @@ public:
 
    virtual ~StringGarbage();
    virtual bool finalize();
+
+   /** The string owning this garbage hook. */
+   CoreString *str() const { return m_str; }
 };
 
 /** Garbage storage string.
@@ -82,6 +82,18 @@ public:
 
    int32 size() const { return m_vector.size(); }
 
+   /** Makes the strings in this table to share the engine intern table.
+      The short strings in the table (symbol names, property names and
+      literals usable as dictionary keys) are turned into read-only views
+      of the engine interned strings, so that the items created out of
+      them in any module share the same data and are compared faster.
+      Long strings are left alone, as they are seldom used as keys.
+
+      This does nothing if the engine is not initialized.
+      \see InternTable
+   */
+   void intern();
+
    /** Save the string table in a stream.
       The string table is saved as a block, without using the serialization function
       of the Falcon::String objects. The block has a string table specific format,
@@ -0,0 +1,106 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: switchindex.h
+
+   Hashed lookup of the cases of large switch tables.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 22:05:31 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Hashed lookup of the cases of large switch tables.
+*/
+
+#ifndef FALCON_SWITCHINDEX_H
+#define FALCON_SWITCHINDEX_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+
+/** Count of integer or string cases from which a switch table is indexed. */
+#define SWITCH_INDEX_THRESHOLD   8
+
+namespace Falcon {
+
+class String;
+class Module;
+
+/** Hashed lookup of the cases of a switch table.
+
+   The switch tables written by the compiler (for SWCH and INSW) hold their
+   integer and string cases sorted, and the VM finds them with a binary
+   search. When a table has SWITCH_INDEX_THRESHOLD cases or more, the VM
+   builds this index the first time the table is used, and keeps it in the
+   LiveModule owning the code.
+
+   Integer cases spanning a dense range (at least half of the values in the
+   range are cases) are mapped through a direct jump table; sparse integer
+   cases and string cases are kept in open addressing hash tables.
+
+   The table format in the module is left untouched, so modules compiled
+   by previous versions are indexed as well.
+*/
+class FALCON_DYN_CLASS SwitchIndex: public BaseAlloc
+{
+public:
+   /** Indexes a switch table.
+      \param mod The module owning the code and the strings of the table.
+      \param table Start of the table (the landing of the nil case).
+      \param count The case counts, as written in the switch instruction.
+   */
+   SwitchIndex( const Module *mod, byte *table, uint64 count );
+   ~SwitchIndex();
+
+   /** True if it's worth to build an index for a table with these counts. */
+   static bool worthIndexing( uint64 count ) {
+      return (uint16)( count >> 48 ) >= SWITCH_INDEX_THRESHOLD ||
+             (uint16)( count >> 16 ) >= SWITCH_INDEX_THRESHOLD;
+   }
+
+   /** Finds an integer case.
+      \param value The value to be searched.
+      \param landing Will receive the landing of the case, if found.
+      \return true if found.
+   */
+   bool findInteger( int64 value, uint32 &landing ) const;
+
+   /** Finds a string case.
+      \param value The value to be searched.
+      \param landing Will receive the landing of the case, if found.
+      \return true if found.
+   */
+   bool findString( const String &value, uint32 &landing ) const;
+
+private:
+   // dense integer cases
+   int64 m_denseBase;
+   uint32 m_denseSize;
+   uint32 *m_dense;
+
+   // sparse integer cases
+   uint32 m_intMask;
+   int64 *m_intKeys;
+   uint32 *m_intLandings;
+
+   // string cases
+   uint32 m_strMask;
+   const String **m_strKeys;
+   uint32 *m_strHashes;
+   uint32 *m_strLandings;
+
+   void indexIntegers( byte *base, uint16 count );
+   void indexStrings( const Module *mod, byte *base, uint16 count );
+};
+
+}
+
+#endif
+
+/* end of switchindex.h */
@@ -99,6 +99,11 @@ FALCON_DYN_SYM void _enumerateEnvironment( EnvStringCallback cb, void* cbData );
 /** Returns process ID of the current process. */
 FALCON_DYN_SYM int64 _getpid();
 
+/** Returns the count of processors available to this process.
+   Never less than 1.
+*/
+FALCON_DYN_SYM int32 _cpuCount();
+
 
 FALCON_DYN_SYM void _dummy_ctrl_c_handler();
 
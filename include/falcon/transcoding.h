@@ -82,11 +82,25 @@ protected:
    Transcoder( Stream *s, bool bOwn );
    Transcoder( const Transcoder &other );
 
+   /** Moves the characters pushed back in the read-ahead buffer to a string.
+      Used by the bulk readString() of the subclasses.
+      \param target The string where the characters are appended.
+      \param size Maximum number of characters to be moved.
+      \return Number of characters moved.
+   */
+   uint32 readBuffered( String &target, uint32 size );
+
 public:
 
    virtual ~Transcoder();
 
-   virtual t_status status() const { return m_stream->status(); }
+   /** Status of the underlying stream.
+      Characters read ahead or pushed back are still to be read, so the
+      transcoder is not at end of file while there are some.
+   */
+   virtual t_status status() const {
+      return bufferEmpty() ? m_stream->status() : (t_status) (m_stream->status() & ~t_eof);
+   }
    virtual void status( t_status s ) { m_stream->status( s ); }
    
    virtual bool isTranscoder() const { return true; }
@@ -236,6 +250,8 @@ public:
 
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readString( String &target, uint32 size );
+   virtual bool writeString( const String &source, uint32 begin=0, uint32 end = csh::npos );
    virtual const String encoding() const { return "byte"; }
    virtual TranscoderByte *clone() const;
 };
@@ -252,6 +268,14 @@ public:
 
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readString( String &target, uint32 size );
+   virtual bool writeString( const String &source, uint32 begin=0, uint32 end = csh::npos );
+
+   /** Reads a line decoding it straight from the buffer of the underlying stream.
+      This is possible only if the underlying stream is a StreamBuffer;
+      otherwise, the line is read through get().
+   */
+   virtual bool readLine( String &target, uint32 size = 0 );
    virtual const String encoding() const { return "utf-8"; }
    virtual TranscoderUTF8 *clone() const;
 };
@@ -310,6 +334,8 @@ public:
 
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readString( String &target, uint32 size );
+   virtual bool writeString( const String &source, uint32 begin=0, uint32 end = csh::npos );
    virtual const String encoding() const { return "utf-16"; }
    t_endianity endianity() const { return m_streamEndian; }
    virtual TranscoderUTF16 *clone() const;
@@ -185,6 +185,7 @@ void opcodeHandler_EVAL( register VMachine *vm );
 void opcodeHandler_OOB( register VMachine *vm );
 void opcodeHandler_TRDN( register VMachine *vm );
 void opcodeHandler_EXEQ( register VMachine *vm );
+void opcodeHandler_INSW( register VMachine *vm );
 
 
 class VMachine;
@@ -1022,10 +1023,10 @@ public:
    void fillErrorContext( Error *err, bool filltb = true );
 
    /** Returns the current stack as a reference. */
-   ItemArray &stack() { return m_currentContext->stack(); }
+   FrameStack &stack() { return m_currentContext->stack(); }
 
    /** Returns the current stack as a reference (const version). */
-   const ItemArray &stack() const { return m_currentContext->stack(); }
+   const FrameStack &stack() const { return m_currentContext->stack(); }
 
    /** Returns a reference to the nth item in the current stack. */
    Item &stackItem( uint32 pos ) { return stack()[ pos ]; }
@@ -2421,6 +2422,7 @@ public:
    friend void opcodeHandler_OOB( register VMachine *vm );
    friend void opcodeHandler_TRDN( register VMachine *vm );
    friend void opcodeHandler_EXEQ( register VMachine *vm );
+   friend void opcodeHandler_INSW( register VMachine *vm );
 };
 
 
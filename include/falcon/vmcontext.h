@@ -27,6 +27,7 @@
 #include <falcon/basealloc.h>
 #include <falcon/livemodule.h>
 #include <falcon/stackframe.h>
+#include <falcon/itemstack.h>
 
 namespace Falcon {
 
@@ -95,6 +96,9 @@ class FALCON_DYN_CLASS VMContext: public BaseAlloc
    StackFrame *m_frames;
    StackFrame *m_spareFrames;
 
+   /** Items of all the frames in this context. */
+   ItemStack m_items;
+
 public:
    VMContext();
    VMContext( const VMContext& other );
@@ -176,8 +180,11 @@ public:
 
    //===========================================
 
-   const ItemArray& stack() const { return m_frames->stack(); }
-   ItemArray& stack() { return m_frames->stack(); }
+   const FrameStack& stack() const { return m_frames->stack(); }
+   FrameStack& stack() { return m_frames->stack(); }
+
+   /** Returns the item stack where the frames of this context live. */
+   ItemStack& items() { return m_items; }
 
    VMSemaphore *sleepingOn() const { return m_sleepingOn; }
    void sleepOn( VMSemaphore *sl ) { m_sleepingOn = sl; }
@@ -268,11 +268,26 @@
    some information that cannot be easily determined after the automatic Value-to-Item translation, this
    modality may be extremely useful.
 
+   @section dbi_pool Connection pooling and statement cache
+
+   Scripts serving many short requests, as web pages, can avoid connecting to the
+   database at each run by using the @a pconnect function instead of @a connect.
+   The connections are kept in a pool shared by all the virtual machines in the
+   process, and handles closed by a script are handed out again to the next
+   script asking for the same connection string and options.
+
+   The "stmtcache=N" option (see @a Handle.options) asks a handle to keep up to N
+   prepared statements ready for reuse after they are closed; preparing the same
+   SQL text again just picks them from the cache. As the cache belongs to the
+   connection, it is preserved across scripts using pooled connections.
+
    @beginmodule dbi
 */
 
 // Instantiate the loader service
 Falcon::DBILoaderImpl theDBIService;
+// and the process-wide connection pool
+Falcon::DBIPoolImpl theDBIPool;
 
 // the main module
 FALCON_MODULE_DECL
@@ -292,6 +307,11 @@ FALCON_MODULE_DECL
    // main factory function
    self->addExtFunc( "connect", &Falcon::Ext::DBIConnect )->
       addParam("params")->addParam("queryops");
+   self->addExtFunc( "pconnect", &Falcon::Ext::DBIPConnect )->
+      addParam("params")->addParam("queryops");
+   self->addExtFunc( "poolPolicy", &Falcon::Ext::DBIPoolPolicy )->
+      addParam("maxIdle")->addParam("idleTimeout")->addParam("pingAfter");
+   self->addExtFunc( "poolStats", &Falcon::Ext::DBIPoolStats );
 
 
    /*#
@@ -465,6 +485,7 @@ FALCON_MODULE_DECL
 
    // service publication
    self->publishService( &theDBIService );
+   self->publishService( &theDBIPool );
 
    // we're done
    return self;
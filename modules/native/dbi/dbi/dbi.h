@@ -17,7 +17,10 @@
 #define DBI_H
 
 #include <falcon/modloader.h>
+#include <falcon/genericmap.h>
+#include <falcon/mt.h>
 #include <falcon/srv/dbi_service.h>
+#include <falcon/dbi_handle.h>
 
 namespace Falcon
 {
@@ -35,10 +38,114 @@ public:
 
 };
 
+
+/**
+ * Process-wide connection pool.
+ */
+class DBIPoolImpl: public DBIPool
+{
+public:
+   /** A connection living in the pool. */
+   class Slot: public BaseAlloc
+   {
+   public:
+      Slot( const String& key, DBIHandle* handle, const Module* driver );
+      ~Slot();
+
+      String m_key;
+      DBIHandle* m_handle;
+      const Module* m_driver;
+      numeric m_lastUsed;
+   };
+
+   /** Usage statistics. */
+   class Stats
+   {
+   public:
+      uint32 m_nIdle;
+      uint32 m_nBusy;
+      int64 m_nCreated;
+      int64 m_nReused;
+      int64 m_nDiscarded;
+   };
+
+   DBIPoolImpl();
+   virtual ~DBIPoolImpl();
+
+   virtual DBIHandle *acquire( VMachine *vm, const String &params, const String &options );
+   virtual void setPolicy( uint32 maxIdle, numeric idleTimeout, numeric pingAfter );
+   virtual void purge();
+
+   /** Called back by the pooled handles when they are closed. */
+   void release( Slot* slot );
+
+   void getPolicy( uint32 &maxIdle, numeric &idleTimeout, numeric &pingAfter );
+   void getStats( Stats& stats );
+
+private:
+   Slot* popIdle( const String& key, List& expired );
+   void expire( numeric now, List& expired );
+   void disposeAll( List& slots );
+
+   Mutex m_mtx;
+   // key -> List* of idle Slot*, most recently used at the back.
+   Map m_idle;
+   uint32 m_nIdle;
+   uint32 m_nBusy;
+   int64 m_nCreated;
+   int64 m_nReused;
+   int64 m_nDiscarded;
+
+   uint32 m_maxIdle;
+   numeric m_idleTimeout;
+   numeric m_pingAfter;
+};
+
+
+/**
+ * Handle given to the scripts for pooled connections.
+ *
+ * Forwards all the operations to the pooled connection, and gives it back
+ * to the pool on close.
+ */
+class DBIPooledHandle: public DBIHandle
+{
+public:
+   DBIPooledHandle( DBIPoolImpl* pool, DBIPoolImpl::Slot* slot );
+   virtual ~DBIPooledHandle();
+
+   virtual void options( const String& params );
+   virtual const DBISettingParams* options() const;
+
+   virtual void begin();
+   virtual void commit();
+   virtual void rollback();
+
+   virtual void selectLimited( const String& query,
+         int64 nBegin, int64 nCount, String& result );
+
+   virtual DBIRecordset *query( const String &sql, ItemArray* params=0 );
+   virtual void result( const String &sql, Item& res, ItemArray* params=0 );
+   virtual DBIStatement* prepare( const String &query );
+   virtual DBIStatement* prepareCached( const String &query );
+   virtual int64 getLastInsertedId( const String& name = "" );
+   virtual bool ping();
+   virtual void close();
+
+   virtual void sqlExpand( const String& sql, String& tgt, const ItemArray& values );
+
+private:
+   DBIHandle* handle() const;
+
+   DBIPoolImpl* m_pool;
+   DBIPoolImpl::Slot* m_slot;
+};
+
 }
 
-// Singleton instance.
+// Singleton instances.
 extern Falcon::DBILoaderImpl theDBIService;
+extern Falcon::DBIPoolImpl theDBIPool;
 
 #endif
 
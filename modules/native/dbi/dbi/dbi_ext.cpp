@@ -104,6 +104,148 @@ void DBIConnect( VMachine *vm )
 }
 
 
+/*#
+   @function pconnect
+   @brief Gets a connection from the process-wide connection pool.
+   @param conn SQL connection string.
+   @optparam queryops Default transaction options to be applied to
+                 operations performed on the returned handle.
+   @return an instance of @a Handle.
+   @raise DBIError if the connection fails.
+
+   This function works as @a connect, but the connection is taken from
+   a pool shared by all the virtual machines and threads in the process.
+   When the returned handle is closed or garbage collected, the connection
+   is not closed: any pending transaction is rolled back, and the connection
+   goes back to the pool, ready for the next request having the same
+   @b conn and @b queryops parameters. If the options are changed through
+   @a Handle.options, the connection is given only to the requests having
+   the changed options in @b queryops.
+
+   Connections that stayed idle for a while are checked before being handed
+   out again, and are closed after an idle timeout; see @a poolPolicy.
+
+   The returned object is a plain @a Handle; driver-specific methods are
+   not available on pooled connections.
+
+   Used together with the "stmtcache" option, this allows scripts serving
+   many short requests to skip both the connection and the statement
+   preparation:
+
+   @code
+   import from dbi
+   dbh = dbi.pconnect( "sqlite3:db=/var/db/site.db", "stmtcache=16" )
+   stmt = dbh.prepare( "select * from users where id = ?" )
+   @endcode
+*/
+
+void DBIPConnect( VMachine *vm )
+{
+   Item *paramsI = vm->param(0);
+   Item *i_tropts = vm->param(1);
+   if (  paramsI == 0 || ! paramsI->isString()
+         || ( i_tropts != 0 && ! ( i_tropts->isString() || i_tropts->isNil() ) ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+                                         .extra( "S,[S]" ) );
+   }
+
+   String options;
+   if( i_tropts != 0 && i_tropts->isString() )
+      options = *i_tropts->asString();
+
+   DBIHandle *hand = theDBIPool.acquire( vm, *paramsI->asString(), options );
+
+   Item *hclass = vm->findWKI( "%Handle" );
+   fassert( hclass != 0 && hclass->isClass() );
+
+   CoreObject *instance = hclass->asClass()->createInstance();
+   instance->setUserData( hand );
+   vm->retval( instance );
+}
+
+/*#
+   @function poolPolicy
+   @brief Changes the policy of the process-wide connection pool.
+   @optparam maxIdle Maximum count of idle connections kept for each connection string.
+   @optparam idleTimeout Seconds after which idle connections are closed.
+   @optparam pingAfter Seconds of inactivity after which connections are checked before reuse.
+   @return An array with the previous values of the three settings.
+
+   Parameters that are not given (or nil) are left unchanged. Setting @b maxIdle
+   to 0 disables pooling, and closes all the idle connections.
+
+   By default, 8 idle connections are kept for each connection string, for at
+   most 300 seconds, and they are checked when they were unused for more than
+   5 seconds.
+
+   @see pconnect
+*/
+
+void DBIPoolPolicy( VMachine *vm )
+{
+   Item *i_maxIdle = vm->param(0);
+   Item *i_timeout = vm->param(1);
+   Item *i_ping = vm->param(2);
+
+   if (  ( i_maxIdle != 0 && ! ( i_maxIdle->isOrdinal() || i_maxIdle->isNil() ) )
+      || ( i_timeout != 0 && ! ( i_timeout->isOrdinal() || i_timeout->isNil() ) )
+      || ( i_ping != 0 && ! ( i_ping->isOrdinal() || i_ping->isNil() ) ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+                                         .extra( "[N],[N],[N]" ) );
+   }
+
+   uint32 maxIdle;
+   numeric idleTimeout, pingAfter;
+   theDBIPool.getPolicy( maxIdle, idleTimeout, pingAfter );
+
+   CoreArray* ret = new CoreArray( 3 );
+   ret->append( (int64) maxIdle );
+   ret->append( idleTimeout );
+   ret->append( pingAfter );
+
+   if ( i_maxIdle != 0 && i_maxIdle->isOrdinal() )
+      maxIdle = (uint32) i_maxIdle->forceInteger();
+   if ( i_timeout != 0 && i_timeout->isOrdinal() )
+      idleTimeout = i_timeout->forceNumeric();
+   if ( i_ping != 0 && i_ping->isOrdinal() )
+      pingAfter = i_ping->forceNumeric();
+
+   theDBIPool.setPolicy( maxIdle, idleTimeout, pingAfter );
+   vm->retval( ret );
+}
+
+/*#
+   @function poolStats
+   @brief Returns usage statistics of the process-wide connection pool.
+   @return A dictionary with the pool statistics.
+
+   The returned dictionary has the following keys:
+   - idle: connections currently waiting in the pool.
+   - busy: connections currently handed out to the scripts.
+   - created: connections opened by the pool.
+   - reused: requests served with an already open connection.
+   - discarded: connections closed because expired, broken or exceeding the pool size.
+
+   @see pconnect
+*/
+
+void DBIPoolStats( VMachine *vm )
+{
+   DBIPoolImpl::Stats stats;
+   theDBIPool.getStats( stats );
+
+   LinearDict* dict = new LinearDict( 5 );
+   dict->put( new CoreString( "idle" ), (int64) stats.m_nIdle );
+   dict->put( new CoreString( "busy" ), (int64) stats.m_nBusy );
+   dict->put( new CoreString( "created" ), stats.m_nCreated );
+   dict->put( new CoreString( "reused" ), stats.m_nReused );
+   dict->put( new CoreString( "discarded" ), stats.m_nDiscarded );
+   vm->retval( new CoreDict( dict ) );
+}
+
+
 /**********************************************************
    Statement class
  **********************************************************/
@@ -746,6 +888,9 @@ void Handle_expand( VMachine *vm )
   
   Typically, the SQL statement will be a non-query data statement meant
   
+  If the "stmtcache" option is set on this handle (see @a Handle.options),
+  closed statements are kept ready in a cache, and preparing the same SQL
+  text again returns them without involving the database engine.
 */
 
 void Handle_prepare( VMachine *vm )
@@ -760,7 +905,7 @@ void Handle_prepare( VMachine *vm )
 
    CoreObject *self = vm->self().asObject();
    DBIHandle *dbt = static_cast<DBIHandle *>( self->getUserData() );
-   DBIStatement* stmt = dbt->prepare( *i_sql->asString() );
+   DBIStatement* stmt = dbt->prepareCached( *i_sql->asString() );
    internal_stmt_open(vm, stmt);
 }
 
@@ -30,6 +30,9 @@ namespace Ext {
 //=====================
 
 void DBIConnect( VMachine *vm );
+void DBIPConnect( VMachine *vm );
+void DBIPoolPolicy( VMachine *vm );
+void DBIPoolStats( VMachine *vm );
 
 //=====================
 // DBIBaseTrans
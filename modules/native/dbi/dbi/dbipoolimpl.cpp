@@ -0,0 +1,477 @@
+/*
+ * FALCON - The Falcon Programming Language.
+ * FILE: dbipoolimpl.cpp
+ *
+ * Implementation of the process-wide DBI connection pool.
+ * -------------------------------------------------------------------
+ * Author: agent
+ * Begin: Mon, 19 Oct 2026 11:40:05 +0200
+ *
+ * -------------------------------------------------------------------
+ * (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+ *
+ * See LICENSE file for licensing details.
+ */
+
+#include "dbi.h"
+
+#include <falcon/dbi_common.h>
+#include <falcon/livemodule.h>
+#include <falcon/traits.h>
+#include <falcon/sys.h>
+
+namespace Falcon
+{
+
+//============================================================
+// Pool slot
+//============================================================
+
+DBIPoolImpl::Slot::Slot( const String& key, DBIHandle* handle, const Module* driver ):
+   m_key( key ),
+   m_handle( handle ),
+   m_driver( driver ),
+   m_lastUsed( Sys::_seconds() )
+{
+   m_key.bufferize();
+   if( m_driver != 0 )
+      m_driver->incref();
+}
+
+
+DBIPoolImpl::Slot::~Slot()
+{
+   try
+   {
+      m_handle->close();
+   }
+   catch( Error* err )
+   {
+      err->decref();
+   }
+
+   delete m_handle;
+
+   // the driver code must stay around until the handle is gone.
+   if( m_driver != 0 )
+      m_driver->decref();
+}
+
+
+//============================================================
+// Pool
+//============================================================
+
+DBIPoolImpl::DBIPoolImpl():
+   DBIPool( "DBIPOOL" ),
+   m_idle( &traits::t_string(), &traits::t_voidp() ),
+   m_nIdle( 0 ),
+   m_nBusy( 0 ),
+   m_nCreated( 0 ),
+   m_nReused( 0 ),
+   m_nDiscarded( 0 ),
+   m_maxIdle( 8 ),
+   m_idleTimeout( 300.0 ),
+   m_pingAfter( 5.0 )
+{
+}
+
+
+DBIPoolImpl::~DBIPoolImpl()
+{
+   purge();
+}
+
+
+DBIHandle *DBIPoolImpl::acquire( VMachine *vm, const String &params, const String &options )
+{
+   String key = params;
+   key.A( '\n' ).A( options );
+
+   List expired;
+   Slot* slot;
+
+   while( (slot = popIdle( key, expired )) != 0 )
+   {
+      // idle connections may have been dropped by the server meanwhile.
+      if( Sys::_seconds() - slot->m_lastUsed < m_pingAfter || slot->m_handle->ping() )
+      {
+         break;
+      }
+
+      m_mtx.lock();
+      m_nBusy--;
+      m_mtx.unlock();
+      expired.pushBack( slot );
+   }
+   disposeAll( expired );
+
+   if( slot != 0 )
+   {
+      m_mtx.lock();
+      m_nReused++;
+      m_mtx.unlock();
+      return new DBIPooledHandle( this, slot );
+   }
+
+   // We need a new connection.
+   String provName = params;
+   String connString = "";
+   uint32 colonPos = params.find( ":" );
+
+   if ( colonPos != csh::npos )
+   {
+      provName = params.subString( 0, colonPos );
+      connString = params.subString( colonPos + 1 );
+   }
+
+   DBIService *provider = theDBIService.loadDbProvider( vm, provName );
+   fassert( provider != 0 );
+
+   DBIHandle* hand = provider->connect( connString );
+   try
+   {
+      if( options.size() != 0 )
+      {
+         hand->options( options );
+      }
+   }
+   catch( Error* )
+   {
+      delete hand;
+      throw;
+   }
+
+   LiveModule* drvmod = vm->findModule( "dbi." + provName );
+   slot = new Slot( key, hand, drvmod == 0 ? 0 : drvmod->module() );
+
+   m_mtx.lock();
+   m_nCreated++;
+   m_nBusy++;
+   m_mtx.unlock();
+
+   return new DBIPooledHandle( this, slot );
+}
+
+
+DBIPoolImpl::Slot* DBIPoolImpl::popIdle( const String& key, List& expired )
+{
+   numeric now = Sys::_seconds();
+   Slot* slot = 0;
+
+   m_mtx.lock();
+   expire( now, expired );
+
+   List** plist = (List**) m_idle.find( &key );
+   if( plist != 0 )
+   {
+      List* slots = *plist;
+      // most recently used first: it's the one more likely to be alive.
+      slot = (Slot*) slots->back();
+      slots->popBack();
+      if( slots->empty() )
+      {
+         m_idle.erase( &key );
+         delete slots;
+      }
+
+      m_nIdle--;
+      m_nBusy++;
+   }
+   m_mtx.unlock();
+
+   return slot;
+}
+
+
+void DBIPoolImpl::release( Slot* slot )
+{
+   // Pending work of the former owner must not leak to the next one.
+   bool bReusable = true;
+   try
+   {
+      slot->m_handle->rollback();
+   }
+   catch( Error* err )
+   {
+      err->decref();
+      bReusable = false;
+   }
+
+   slot->m_lastUsed = Sys::_seconds();
+
+   List expired;
+
+   m_mtx.lock();
+   m_nBusy--;
+   expire( slot->m_lastUsed, expired );
+
+   List** plist = (List**) m_idle.find( &slot->m_key );
+   List* slots = plist == 0 ? 0 : *plist;
+
+   if( ! bReusable || m_maxIdle == 0 || ( slots != 0 && slots->size() >= m_maxIdle ) )
+   {
+      expired.pushBack( slot );
+   }
+   else
+   {
+      if( slots == 0 )
+      {
+         slots = new List;
+         m_idle.insert( &slot->m_key, slots );
+      }
+      slots->pushBack( slot );
+      m_nIdle++;
+   }
+   m_mtx.unlock();
+
+   disposeAll( expired );
+}
+
+
+void DBIPoolImpl::expire( numeric now, List& expired )
+{
+   // called with the mutex held.
+   MapIterator iter = m_idle.begin();
+   while( iter.hasCurrent() )
+   {
+      List* slots = *(List**) iter.currentValue();
+
+      // the oldest slots are in front.
+      while( ! slots->empty() )
+      {
+         Slot* slot = (Slot*) slots->front();
+         if( now - slot->m_lastUsed < m_idleTimeout && slots->size() <= m_maxIdle )
+            break;
+
+         slots->popFront();
+         expired.pushBack( slot );
+         m_nIdle--;
+      }
+
+      if( slots->empty() )
+      {
+         delete slots;
+         iter = m_idle.erase( iter );
+      }
+      else
+      {
+         iter.next();
+      }
+   }
+}
+
+
+void DBIPoolImpl::disposeAll( List& slots )
+{
+   // closing connections may take time; never do it under the lock.
+   ListElement* elem = slots.begin();
+   while( elem != 0 )
+   {
+      delete (Slot*) elem->data();
+      elem = elem->next();
+   }
+
+   if( ! slots.empty() )
+   {
+      m_mtx.lock();
+      m_nDiscarded += slots.size();
+      m_mtx.unlock();
+   }
+
+   slots.clear();
+}
+
+
+void DBIPoolImpl::setPolicy( uint32 maxIdle, numeric idleTimeout, numeric pingAfter )
+{
+   List expired;
+
+   m_mtx.lock();
+   m_maxIdle = maxIdle;
+   m_idleTimeout = idleTimeout;
+   m_pingAfter = pingAfter;
+   expire( Sys::_seconds(), expired );
+   m_mtx.unlock();
+
+   disposeAll( expired );
+}
+
+
+void DBIPoolImpl::getPolicy( uint32 &maxIdle, numeric &idleTimeout, numeric &pingAfter )
+{
+   m_mtx.lock();
+   maxIdle = m_maxIdle;
+   idleTimeout = m_idleTimeout;
+   pingAfter = m_pingAfter;
+   m_mtx.unlock();
+}
+
+
+void DBIPoolImpl::purge()
+{
+   List expired;
+
+   m_mtx.lock();
+   MapIterator iter = m_idle.begin();
+   while( iter.hasCurrent() )
+   {
+      List* slots = *(List**) iter.currentValue();
+      while( ! slots->empty() )
+      {
+         expired.pushBack( slots->front() );
+         slots->popFront();
+      }
+      delete slots;
+      iter.next();
+   }
+   m_idle.clear();
+   m_nIdle = 0;
+   m_mtx.unlock();
+
+   disposeAll( expired );
+}
+
+
+void DBIPoolImpl::getStats( Stats& stats )
+{
+   m_mtx.lock();
+   stats.m_nIdle = m_nIdle;
+   stats.m_nBusy = m_nBusy;
+   stats.m_nCreated = m_nCreated;
+   stats.m_nReused = m_nReused;
+   stats.m_nDiscarded = m_nDiscarded;
+   m_mtx.unlock();
+}
+
+
+//============================================================
+// Pooled handle
+//============================================================
+
+DBIPooledHandle::DBIPooledHandle( DBIPoolImpl* pool, DBIPoolImpl::Slot* slot ):
+   m_pool( pool ),
+   m_slot( slot )
+{
+}
+
+
+DBIPooledHandle::~DBIPooledHandle()
+{
+   close();
+}
+
+
+DBIHandle* DBIPooledHandle::handle() const
+{
+   if( m_slot == 0 )
+      throw new DBIError( ErrorParam( FALCON_DBI_ERROR_CLOSED_DB, __LINE__ ) );
+
+   return m_slot->m_handle;
+}
+
+
+void DBIPooledHandle::options( const String& params )
+{
+   handle()->options( params );
+
+   // the connection now matches only the requests having the same options.
+   String& key = m_slot->m_key;
+   if( key.getCharAt( key.length() - 1 ) != '\n' )
+      key.A( ';' );
+   key.A( params );
+}
+
+
+const DBISettingParams* DBIPooledHandle::options() const
+{
+   return handle()->options();
+}
+
+
+void DBIPooledHandle::begin()
+{
+   handle()->begin();
+}
+
+
+void DBIPooledHandle::commit()
+{
+   handle()->commit();
+}
+
+
+void DBIPooledHandle::rollback()
+{
+   handle()->rollback();
+}
+
+
+void DBIPooledHandle::selectLimited( const String& query,
+      int64 nBegin, int64 nCount, String& result )
+{
+   handle()->selectLimited( query, nBegin, nCount, result );
+}
+
+
+DBIRecordset *DBIPooledHandle::query( const String &sql, ItemArray* params )
+{
+   DBIHandle* dbh = handle();
+   DBIRecordset* rs = dbh->query( sql, params );
+   m_nLastAffected = dbh->affectedRows();
+   return rs;
+}
+
+
+void DBIPooledHandle::result( const String &sql, Item& res, ItemArray* params )
+{
+   DBIHandle* dbh = handle();
+   dbh->result( sql, res, params );
+   m_nLastAffected = dbh->affectedRows();
+}
+
+
+DBIStatement* DBIPooledHandle::prepare( const String &query )
+{
+   return handle()->prepare( query );
+}
+
+
+DBIStatement* DBIPooledHandle::prepareCached( const String &query )
+{
+   // the cache belongs to the pooled connection, so it survives across owners.
+   return handle()->prepareCached( query );
+}
+
+
+int64 DBIPooledHandle::getLastInsertedId( const String& name )
+{
+   return handle()->getLastInsertedId( name );
+}
+
+
+bool DBIPooledHandle::ping()
+{
+   return handle()->ping();
+}
+
+
+void DBIPooledHandle::sqlExpand( const String& sql, String& tgt, const ItemArray& values )
+{
+   handle()->sqlExpand( sql, tgt, values );
+}
+
+
+void DBIPooledHandle::close()
+{
+   if( m_slot != 0 )
+   {
+      DBIPoolImpl::Slot* slot = m_slot;
+      m_slot = 0;
+      m_pool->release( slot );
+   }
+}
+
+}
+
+/* end of dbipoolimpl.cpp */
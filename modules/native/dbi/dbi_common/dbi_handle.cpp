@@ -16,6 +16,7 @@
 #include <falcon/dbi_handle.h>
 #include <falcon/dbi_error.h>
 #include <falcon/dbi_common.h>
+#include <falcon/dbi_stmtcache.h>
 #include <falcon/itemarray.h>
 #include <falcon/item.h>
 #include <falcon/carray.h>
@@ -24,13 +25,77 @@ namespace Falcon
 {
 
 DBIHandle::DBIHandle():
-   m_nLastAffected(-1)
+   m_nLastAffected(-1),
+   m_stmtCache(0)
 {
 }
 
 
 DBIHandle::~DBIHandle()
 {
+   closeStatementCache();
+}
+
+
+DBIStatement* DBIHandle::prepareCached( const String &query )
+{
+   const DBISettingParams* settings = options();
+   uint32 capacity = settings == 0 ? 0 : (uint32) settings->m_nStmtCache;
+
+   if( m_stmtCache == 0 )
+   {
+      if( capacity == 0 )
+         return prepare( query );
+
+      m_stmtCache = new DBIStatementCache( capacity );
+   }
+   else if( m_stmtCache->capacity() != capacity )
+   {
+      // options may have been changed since the last prepare.
+      m_stmtCache->capacity( capacity );
+   }
+
+   DBIStatement* stmt = m_stmtCache->checkOut( query );
+   if( stmt == 0 )
+   {
+      stmt = prepare( query );
+   }
+
+   return new DBICachedStatement( this, m_stmtCache, query, stmt );
+}
+
+
+void DBIHandle::closeStatementCache()
+{
+   if( m_stmtCache != 0 )
+   {
+      m_stmtCache->close();
+      m_stmtCache->decref();
+      m_stmtCache = 0;
+   }
+}
+
+
+bool DBIHandle::ping()
+{
+   return pingQuery( "SELECT 1" );
+}
+
+
+bool DBIHandle::pingQuery( const String& sql )
+{
+   try
+   {
+      Item dummy;
+      result( sql, dummy );
+   }
+   catch( Error* err )
+   {
+      err->decref();
+      return false;
+   }
+
+   return true;
 }
 
 void DBIHandle::sqlExpand( const String& sql, String& tgt, const ItemArray& params )
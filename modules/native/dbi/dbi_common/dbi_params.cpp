@@ -153,19 +153,22 @@ DBISettingParams::DBISettingParams():
       m_bAutocommit( defaultAutocommit ),
       m_nCursorThreshold( defaultCursor ),
       m_nPrefetch( defaultPrefetch ),
-      m_bFetchStrings( defaultFetchStrings )
+      m_bFetchStrings( defaultFetchStrings ),
+      m_nStmtCache( defaultStmtCache )
 {
    addParameter( "autocommit", m_sAutocommit );
    addParameter( "cursor", m_sCursor );
    addParameter( "prefetch", m_sPrefetch );
    addParameter( "strings", m_sFetchStrings );
+   addParameter( "stmtcache", m_sStmtCache );
 }
 
 DBISettingParams::DBISettingParams( const DBISettingParams & other):
    m_bAutocommit( other.m_bAutocommit ),
    m_nCursorThreshold( other.m_nCursorThreshold ),
    m_nPrefetch( other.m_nPrefetch ),
-   m_bFetchStrings( other.m_bFetchStrings )
+   m_bFetchStrings( other.m_bFetchStrings ),
+   m_nStmtCache( other.m_nStmtCache )
 {
    // we don't care about the parameter parsing during the copy.
 }
@@ -214,6 +217,16 @@ bool DBISettingParams::parse( const String& connStr )
          return false;
    }
 
+   if( m_sStmtCache.compareIgnoreCase("none") == 0 )
+   {
+      m_nStmtCache = 0;
+   }
+   else if ( m_sStmtCache != "" && m_sStmtCache != "\"\"" )
+   {
+      if ( ! m_sStmtCache.parseInt( m_nStmtCache ) || m_nStmtCache < 0 )
+         return false;
+   }
+
    return true;
 }
 
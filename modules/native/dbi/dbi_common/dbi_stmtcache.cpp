@@ -0,0 +1,237 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: dbi_stmtcache.cpp
+
+   Database Interface - Cache of prepared statements.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 10:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/dbi_stmtcache.h>
+#include <falcon/dbi_error.h>
+#include <falcon/traits.h>
+
+namespace Falcon
+{
+
+class DBIStatementCache::Entry: public BaseAlloc
+{
+public:
+   Entry( const String& sql, DBIStatement* stmt ):
+      m_sql( sql ),
+      m_stmt( stmt )
+   {
+      m_sql.bufferize();
+   }
+
+   String m_sql;
+   DBIStatement* m_stmt;
+};
+
+
+DBIStatementCache::DBIStatementCache( uint32 capacity ):
+   m_refCount( 1 ),
+   m_bClosed( false ),
+   m_capacity( capacity ),
+   m_index( &traits::t_string(), &traits::t_voidp() ),
+   m_nHits( 0 ),
+   m_nMisses( 0 )
+{
+}
+
+
+DBIStatementCache::~DBIStatementCache()
+{
+   close();
+}
+
+
+void DBIStatementCache::incref()
+{
+   atomicInc( m_refCount );
+}
+
+
+void DBIStatementCache::decref()
+{
+   if( atomicDec( m_refCount ) == 0 )
+      delete this;
+}
+
+
+DBIStatement* DBIStatementCache::checkOut( const String& sql )
+{
+   m_mtx.lock();
+   ListElement** pelem = (ListElement**) m_index.find( &sql );
+   if( pelem == 0 )
+   {
+      m_nMisses++;
+      m_mtx.unlock();
+      return 0;
+   }
+
+   ListElement* elem = *pelem;
+   Entry* entry = (Entry*) elem->data();
+   m_index.erase( &sql );
+   m_lru.erase( elem );
+   m_nHits++;
+   m_mtx.unlock();
+
+   DBIStatement* stmt = entry->m_stmt;
+   delete entry;
+   return stmt;
+}
+
+
+void DBIStatementCache::checkIn( const String& sql, DBIStatement* stmt )
+{
+   // A statement coming back must be ready for the next user.
+   try
+   {
+      stmt->reset();
+   }
+   catch( Error* err )
+   {
+      err->decref();
+      delete stmt;
+      return;
+   }
+
+   List discarded;
+
+   m_mtx.lock();
+   if( m_bClosed || m_capacity == 0 || m_index.find( &sql ) != 0 )
+   {
+      m_mtx.unlock();
+      delete stmt;
+      return;
+   }
+
+   Entry* entry = new Entry( sql, stmt );
+   m_lru.pushFront( entry );
+   ListElement* elem = m_lru.begin();
+   m_index.insert( &entry->m_sql, elem );
+   trim( discarded );
+   m_mtx.unlock();
+
+   disposeAll( discarded );
+}
+
+
+void DBIStatementCache::capacity( uint32 cap )
+{
+   List discarded;
+
+   m_mtx.lock();
+   m_capacity = cap;
+   trim( discarded );
+   m_mtx.unlock();
+
+   disposeAll( discarded );
+}
+
+
+void DBIStatementCache::close()
+{
+   List discarded;
+
+   m_mtx.lock();
+   m_bClosed = true;
+   m_capacity = 0;
+   trim( discarded );
+   m_mtx.unlock();
+
+   disposeAll( discarded );
+}
+
+
+void DBIStatementCache::trim( List& discarded )
+{
+   // called with the mutex held.
+   while( m_lru.size() > m_capacity )
+   {
+      Entry* entry = (Entry*) m_lru.back();
+      m_index.erase( &entry->m_sql );
+      m_lru.popBack();
+      discarded.pushBack( entry );
+   }
+}
+
+
+void DBIStatementCache::disposeAll( List& discarded )
+{
+   // statements may talk with the server while closing; do it out of the lock.
+   ListElement* elem = discarded.begin();
+   while( elem != 0 )
+   {
+      Entry* entry = (Entry*) elem->data();
+      delete entry->m_stmt;
+      delete entry;
+      elem = elem->next();
+   }
+   discarded.clear();
+}
+
+
+//============================================================
+// Statement wrapper
+//============================================================
+
+DBICachedStatement::DBICachedStatement( DBIHandle* dbh, DBIStatementCache* cache,
+      const String& sql, DBIStatement* stmt ):
+   DBIStatement( dbh ),
+   m_cache( cache ),
+   m_sql( sql ),
+   m_stmt( stmt )
+{
+   m_sql.bufferize();
+   m_cache->incref();
+}
+
+
+DBICachedStatement::~DBICachedStatement()
+{
+   close();
+}
+
+
+DBIRecordset* DBICachedStatement::execute( ItemArray* params )
+{
+   if( m_stmt == 0 )
+      throw new DBIError( ErrorParam( FALCON_DBI_ERROR_CLOSED_STMT, __LINE__ ) );
+
+   DBIRecordset* rs = m_stmt->execute( params );
+   m_nLastAffected = m_stmt->affectedRows();
+   return rs;
+}
+
+
+void DBICachedStatement::reset()
+{
+   if( m_stmt == 0 )
+      throw new DBIError( ErrorParam( FALCON_DBI_ERROR_CLOSED_STMT, __LINE__ ) );
+
+   m_stmt->reset();
+}
+
+
+void DBICachedStatement::close()
+{
+   if( m_stmt != 0 )
+   {
+      m_cache->checkIn( m_sql, m_stmt );
+      m_cache->decref();
+      m_stmt = 0;
+      m_cache = 0;
+   }
+}
+
+}
+
+/* end of dbi_stmtcache.cpp */
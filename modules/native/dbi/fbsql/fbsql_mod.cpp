@@ -1179,8 +1179,17 @@ void DBIHandleFB::selectLimited( const String& query,
 }
 
 
+bool DBIHandleFB::ping()
+{
+   // Firebird has no SELECT without a table.
+   return pingQuery( "SELECT 1 FROM RDB$DATABASE" );
+}
+
+
 void DBIHandleFB::close()
 {
+   closeStatementCache();
+
    if ( m_pTrans != 0 )
    {
       m_pTrans->commit();  // commit decrefs, and eventually throws
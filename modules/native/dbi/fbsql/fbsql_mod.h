@@ -213,6 +213,7 @@ public:
    void result( const String &sql, Item& target, ItemArray* params );
    virtual DBIStatement* prepare( const String &query );
    virtual int64 getLastInsertedId( const String& name = "" );
+   virtual bool ping();
 
    virtual void begin();
    virtual void commit();
@@ -23,6 +23,7 @@ namespace Falcon
 {
 
 class DBIStatement;
+class DBIStatementCache;
 class DBIRecordset;
 class DBISettingParams;
 class ItemArray;
@@ -117,6 +118,32 @@ public:
     */
    virtual DBIStatement* prepare( const String &query )=0;
 
+   /** Prepare a statement, recycling a previously prepared one if possible.
+
+      If the "stmtcache" option is set, the handle keeps the statements
+      closed by the scripts in a LRU cache keyed by their SQL text, and
+      hands them back when the same text is prepared again.
+
+      If the option is not set, this is the same as prepare().
+    */
+   virtual DBIStatement* prepareCached( const String &query );
+
+   /** Destroys the cached statements.
+
+      Drivers must call this in their close() method, before
+      closing the underlying connection.
+   */
+   void closeStatementCache();
+
+   /** Checks if the connection is still alive.
+
+      The base class version performs "SELECT 1"; drivers for engines
+      not accepting it, or having a cheaper native check, override it.
+
+      \return true if the connection can be used.
+   */
+   virtual bool ping();
+
    /** Returns the last inserted ID.
    *
    *  Many engines provide this feature so that the last inserted ID auto-generated
@@ -155,7 +182,17 @@ protected:
     /param res the target item.
     */
    void std_result( DBIRecordset* rs, Item& res );
+
+   /** Performs a query as a connection check.
+      \param sql A query that always succeeds on a working connection.
+      \return true if the query could be performed.
+   */
+   bool pingQuery( const String& sql );
+
    int64 m_nLastAffected;
+
+private:
+   DBIStatementCache* m_stmtCache;
 };
 
 }
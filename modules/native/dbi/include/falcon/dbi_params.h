@@ -119,6 +119,9 @@ public:
                just for dump on an output device. Using this option in this case will
                reduce unneeded transformations into Falcon data and then into the
                external representationss
+    - stmtcache: Number of prepared statements that the handle keeps ready for
+               reuse, keyed by their SQL text. "none" or 0 (the default) disables
+               the cache.
 
     After a complete local prefetch, all the records
     are moved to the client, so it's possible to issue another query returning a different
@@ -145,11 +148,13 @@ private:
    String m_sAutocommit;
    String m_sPrefetch;
    String m_sFetchStrings;
+   String m_sStmtCache;
 
    static const bool defaultAutocommit = true;
    static const int defaultCursor = -1;
    static const int defaultPrefetch = -1;
    static const bool defaultFetchStrings = false;
+   static const int defaultStmtCache = 0;
 
 public:
    DBISettingParams();
@@ -177,6 +182,11 @@ public:
    /** True if the transaction should be autocommit, false otherwise. */
    bool m_bFetchStrings;
 
+   /** Count of prepared statements cached by the handle for reuse.
+      Will be 0 if statements should not be cached.
+   */
+   int64 m_nStmtCache;
+
 };
 
 
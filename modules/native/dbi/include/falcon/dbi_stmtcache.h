@@ -0,0 +1,126 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: dbi_stmtcache.h
+
+   Database Interface - Cache of prepared statements.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 10:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#ifndef FALCON_DBI_STMTCACHE_H_
+#define FALCON_DBI_STMTCACHE_H_
+
+#include <falcon/basealloc.h>
+#include <falcon/string.h>
+#include <falcon/genericmap.h>
+#include <falcon/genericlist.h>
+#include <falcon/mt.h>
+#include <falcon/dbi_stmt.h>
+
+namespace Falcon
+{
+
+/** LRU cache of prepared statements, keyed by their SQL text.
+
+   The cache is owned by a DBIHandle, and holds the statements that are
+   currently not in use by the scripts. A statement is checked out when
+   the script prepares its SQL text, and goes back in the cache when the
+   script closes it (or when it's garbage collected).
+
+   Statements in use are never shared; if the same SQL is prepared twice
+   while the first statement is still out, the second request creates
+   a new statement, and the exceeding copy is discarded at check in.
+
+   The cache is reference counted, as checked out statements may outlive
+   the handle that created them. Once the handle closes the cache,
+   all the statements checked in are destroyed.
+
+   Check in may happen in the garbage collector thread, so all the
+   operations are interlocked.
+*/
+class DBIStatementCache: public BaseAlloc
+{
+public:
+   DBIStatementCache( uint32 capacity );
+
+   void incref();
+   void decref();
+
+   /** Extracts a statement prepared for the given SQL text.
+      \return the statement or 0 if the cache doesn't hold it.
+   */
+   DBIStatement* checkOut( const String& sql );
+
+   /** Returns a statement to the cache.
+      The least recently used statements exceeding the capacity are
+      destroyed; the statement is destroyed immediately if the cache
+      is closed.
+   */
+   void checkIn( const String& sql, DBIStatement* stmt );
+
+   /** Changes the count of statements kept in the cache. */
+   void capacity( uint32 cap );
+   uint32 capacity() const { return m_capacity; }
+
+   /** Destroys all the cached statements and refuses any further check in. */
+   void close();
+
+   uint32 size() const { return m_lru.size(); }
+   int64 hits() const { return m_nHits; }
+   int64 misses() const { return m_nMisses; }
+
+private:
+   class Entry;
+
+   virtual ~DBIStatementCache();
+   void trim( List& discarded );
+   static void disposeAll( List& discarded );
+
+   Mutex m_mtx;
+   volatile int32 m_refCount;
+   bool m_bClosed;
+   uint32 m_capacity;
+
+   // SQL text -> ListElement* in m_lru
+   Map m_index;
+   // Entries, most recently used in front.
+   List m_lru;
+
+   int64 m_nHits;
+   int64 m_nMisses;
+};
+
+
+/** Statement handed to the scripts when the statement cache is active.
+
+   Forwards the operations to the real statement, and returns it to the
+   cache when closed.
+*/
+class DBICachedStatement: public DBIStatement
+{
+public:
+   DBICachedStatement( DBIHandle* dbh, DBIStatementCache* cache,
+         const String& sql, DBIStatement* stmt );
+   virtual ~DBICachedStatement();
+
+   virtual DBIRecordset* execute( ItemArray* params = 0 );
+   virtual void reset();
+   virtual void close();
+
+private:
+   DBIStatementCache* m_cache;
+   String m_sql;
+   DBIStatement* m_stmt;
+};
+
+}
+
+#endif
+
+/* end of dbi_stmtcache.h */
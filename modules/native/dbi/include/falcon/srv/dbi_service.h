@@ -183,6 +183,56 @@ public:
   //virtual void escapeString( const String &value, String &escaped ) = 0;
 };
 
+/**
+ * Process-wide pool of database connections.
+ *
+ * The pool keeps the connections released by the scripts open, and hands
+ * them out again to the next request for the same connection string and
+ * options, from any VM or thread in the process. As the connection string
+ * carries the credentials, a connection is reused only for the very same
+ * user.
+ *
+ * Idle connections are closed after a timeout, and connections that have
+ * been idle for a while are checked through DBIHandle::ping() before being
+ * reused.
+ */
+class DBIPool: public Service
+{
+protected:
+   DBIPool( const String &name ):
+      Service( name )
+   {}
+
+public:
+   /**
+    * Gets a connection from the pool, or opens a new one.
+    *
+    * The returned handle is owned by the caller; closing or destroying it
+    * gives the underlying connection back to the pool, after having rolled
+    * back any pending transaction.
+    *
+    * \param vm The VM used to load the DBI driver, if necessary.
+    * \param params The complete connection string ("provider:parameters").
+    * \param options Default settings to be applied to the connection.
+    * \return A connected DBIHandle.
+    */
+   virtual DBIHandle *acquire( VMachine *vm, const String &params, const String &options )=0;
+
+   /**
+    * Changes the pool policy.
+    *
+    * \param maxIdle Maximum count of idle connections kept for each connection string.
+    * \param idleTimeout Seconds after which an idle connection is closed.
+    * \param pingAfter Seconds of inactivity after which a connection is checked before reuse.
+    */
+   virtual void setPolicy( uint32 maxIdle, numeric idleTimeout, numeric pingAfter )=0;
+
+   /**
+    * Closes all the idle connections.
+    */
+   virtual void purge()=0;
+};
+
 
 }
 
@@ -1336,8 +1336,16 @@ void DBIHandleMySQL::selectLimited( const String& query,
 }
 
 
+bool DBIHandleMySQL::ping()
+{
+   return m_conn != NULL && mysql_ping( m_conn ) == 0;
+}
+
+
 void DBIHandleMySQL::close()
 {
+   closeStatementCache();
+
    if ( m_conn != NULL )
    {
       mysql_query( m_conn, "COMMIT" );
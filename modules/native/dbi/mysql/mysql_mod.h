@@ -190,6 +190,7 @@ public:
 
    virtual DBIStatement* prepare( const String &query );
    virtual int64 getLastInsertedId( const String& name = "" );
+   virtual bool ping();
 
    virtual void begin();
    virtual void commit();
@@ -748,8 +748,24 @@ int64 DBIHandleODBC::getLastInsertedId( const String& sequenceName )
 }
 
 
+bool DBIHandleODBC::ping()
+{
+   if( m_conn == 0 )
+      return false;
+
+   // "SELECT 1" is not valid on every data source; ask the driver first.
+   SQLUINTEGER dead = SQL_CD_FALSE;
+   SQLRETURN ret = SQLGetConnectAttr( m_conn->m_hHdbc, SQL_ATTR_CONNECTION_DEAD, &dead, 0, 0 );
+   if( ret == SQL_SUCCESS || ret == SQL_SUCCESS_WITH_INFO )
+      return dead == SQL_CD_FALSE;
+
+   return pingQuery( "SELECT 1" );
+}
+
 void DBIHandleODBC::close()
 {
+	closeStatementCache();
+
 	if( m_conn )
 	{
 		m_conn->decref();
@@ -210,6 +210,7 @@ public:
    virtual void result( const String &sql, ItemArray* params );
    virtual DBIStatement* prepare( const String &query );
    virtual int64 getLastInsertedId( const String& name = "" );
+   virtual bool ping();
 
    virtual void begin();
    virtual void commit();
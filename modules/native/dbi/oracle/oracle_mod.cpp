@@ -77,6 +77,8 @@ namespace Falcon
 
     void DBIHandleOracle::close()
     {
+        closeStatementCache();
+
         if ( o_conn != NULL )
         {
             //o_pConn->decref();
@@ -86,6 +88,26 @@ namespace Falcon
         }
     }
 
+    bool DBIHandleOracle::ping()
+    {
+        if( o_conn == NULL )
+            return false;
+
+        // Oracle has no SELECT without a table; query() is not available yet.
+        try
+        {
+            oracle::occi::Statement *stmt = o_conn->createStatement( "SELECT 1 FROM DUAL" );
+            stmt->closeResultSet( stmt->executeQuery() );
+            o_conn->terminateStatement( stmt );
+        }
+        catch( oracle::occi::SQLException& )
+        {
+            return false;
+        }
+
+        return true;
+    }
+
     void DBIHandleOracle::commit()
     {
         if( o_conn == NULL )
@@ -112,6 +112,7 @@ namespace Falcon
             //virtual void options( const String& params );     FIXME
             //virtual const DBISettingParams* options() const;
             virtual void close();
+            virtual bool ping();
             
             //virtual DBIRecordset *query( const String &sql, ItemArray* params ); FIXME
             //virtual DBIStatement* prepare( const String &query );
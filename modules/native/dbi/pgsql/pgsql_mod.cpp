@@ -426,6 +426,8 @@ DBIHandlePgSQL::~DBIHandlePgSQL()
 
 void DBIHandlePgSQL::close()
 {
+    closeStatementCache();
+
     if ( m_conn != 0 )
     {
         if ( m_bInTrans )
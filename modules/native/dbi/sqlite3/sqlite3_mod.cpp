@@ -682,6 +682,8 @@ int64 DBIHandleSQLite3::getLastInsertedId( const String& )
 
 void DBIHandleSQLite3::close()
 {
+   closeStatementCache();
+
    if ( m_conn != NULL )
    {
       if( m_bInTrans )
@@ -496,6 +496,14 @@ public:
             _heap_realloc(newbytes);
     }
 
+    // make sure that at least 'bits' bits can be written at wpos without reallocating,
+    // so that a sequence of _appendUnchecked() calls can follow
+    inline void reserve_bits(NUMTYPE bits)
+    {
+        if(wpos_bits() + bits > capacity_bits())
+            _heap_realloc(_maxbytes * 2 + roundToBytes(bits));
+    }
+
     // resize to s bytes
     // will move wpos to the end of the allocated block
     // for efficiency, do not actually shrink the buffer if it is larger
@@ -559,7 +567,7 @@ protected:
             _myheapbuf = true;
         }
 
-        memset( _bufptr+_maxbytes, 0, newsize - _maxbytes );
+        memset( ((uint8*)_bufptr) + _maxbytes, 0, size_t(newsize - _maxbytes) );
         
         _maxbytes = newsize;
     }
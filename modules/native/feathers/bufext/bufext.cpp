@@ -75,6 +75,15 @@ The BitBuf offers more functions, but it slower, and possibly only needed for sp
 @prop LITTLE_ENDIAN
 @prop BIG_ENDIAN
 @prop REVERSE_ENDIAN
+@prop INT8 Signed 8-bit elements, for readArray() and writeArray()
+@prop UINT8 Unsigned 8-bit elements
+@prop INT16 Signed 16-bit elements
+@prop UINT16 Unsigned 16-bit elements
+@prop INT32 Signed 32-bit elements
+@prop UINT32 Unsigned 32-bit elements
+@prop INT64 Signed 64-bit elements
+@prop FLOAT 32-bit floating point elements
+@prop DOUBLE 64-bit floating point elements
 
 A ByteBuf is a growable memory buffer with methods to read and write primitive datatypes and strings.
 It supports streaming data in and out as well as random access.
@@ -122,6 +131,10 @@ Example code for basic usage:
     s = bb.readString()                 // string is null terminated, and char size 1  
     // .. read remaining data ..
 @endcode
+
+Whole arrays of numbers can be written and read at once with writeArray() and readArray(),
+or as variable length integers with writeVarints() and readVarints(); this is much faster than
+calling w16(), r16() and the like once per element.
 */
 
 /*#
@@ -244,6 +257,15 @@ template <typename BUFTYPE> Falcon::Symbol *SimpleRegisterBuf(Falcon::Module *se
     self->addClassMethod(cls, "rf", Falcon::Ext::Buf_rf<BUFTYPE>);
     self->addClassMethod(cls, "rd", Falcon::Ext::Buf_rd<BUFTYPE>);
 
+    self->addClassMethod(cls, "writeArray", Falcon::Ext::Buf_writeArray<BUFTYPE>).asSymbol()
+        ->addParam("array")->addParam("type");
+    self->addClassMethod(cls, "readArray", Falcon::Ext::Buf_readArray<BUFTYPE>).asSymbol()
+        ->addParam("count")->addParam("type")->addParam("array");
+    self->addClassMethod(cls, "writeVarints", Falcon::Ext::Buf_writeVarints<BUFTYPE>).asSymbol()
+        ->addParam("array")->addParam("zigzag");
+    self->addClassMethod(cls, "readVarints", Falcon::Ext::Buf_readVarints<BUFTYPE>).asSymbol()
+        ->addParam("count")->addParam("zigzag")->addParam("array");
+
     cls->setWKS(true);
 
     if(parent)
@@ -277,6 +299,16 @@ Falcon::Module *bufext_module_init(void)
    self->addClassProperty( baseSym, "BIG_ENDIAN")   .setInteger( (Falcon::int64)Falcon::ENDIANMODE_BIG );
    self->addClassProperty( baseSym, "REVERSE_ENDIAN").setInteger( (Falcon::int64)Falcon::ENDIANMODE_REVERSE );
 
+   self->addClassProperty( baseSym, "INT8")  .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_INT8 );
+   self->addClassProperty( baseSym, "UINT8") .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_UINT8 );
+   self->addClassProperty( baseSym, "INT16") .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_INT16 );
+   self->addClassProperty( baseSym, "UINT16").setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_UINT16 );
+   self->addClassProperty( baseSym, "INT32") .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_INT32 );
+   self->addClassProperty( baseSym, "UINT32").setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_UINT32 );
+   self->addClassProperty( baseSym, "INT64") .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_INT64 );
+   self->addClassProperty( baseSym, "FLOAT") .setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_FLOAT );
+   self->addClassProperty( baseSym, "DOUBLE").setInteger( (Falcon::int64)Falcon::Ext::BUFARRAY_DOUBLE );
+
    SimpleRegisterBuf<Falcon::ByteBufNativeEndian>  (self, "ByteBufNativeEndian", new Falcon::InheritDef(baseSym));
    SimpleRegisterBuf<Falcon::ByteBufLittleEndian>  (self, "ByteBufLittleEndian", new Falcon::InheritDef(baseSym));
    SimpleRegisterBuf<Falcon::ByteBufBigEndian>     (self, "ByteBufBigEndian"   , new Falcon::InheritDef(baseSym));
@@ -286,6 +318,10 @@ Falcon::Module *bufext_module_init(void)
    self->addClassMethod(bitcls, "bitCount", Falcon::Ext::BitBuf_bitCount);
    self->addClassMethod(bitcls, "writeBits", Falcon::Ext::BitBuf_writeBits);
    self->addClassMethod(bitcls, "readBits", Falcon::Ext::BitBuf_readBits);
+   self->addClassMethod(bitcls, "writeBitsArray", Falcon::Ext::BitBuf_writeBitsArray).asSymbol()
+      ->addParam("array");
+   self->addClassMethod(bitcls, "readBitsArray", Falcon::Ext::BitBuf_readBitsArray).asSymbol()
+      ->addParam("count")->addParam("neg")->addParam("array");
    self->addClassMethod(bitcls, "sizeBits", Falcon::Ext::BitBuf_sizeBits);
    self->addClassMethod(bitcls, "rposBits", Falcon::Ext::BitBuf_rposBits);
    self->addClassMethod(bitcls, "wposBits", Falcon::Ext::BitBuf_wposBits);
@@ -157,6 +157,108 @@ FALCON_FUNC BitBuf_readBits( ::Falcon::VMachine *vm )
     vm->retval(val);
 }
 
+/*#
+@method writeBitsArray BitBuf
+@brief Packs a whole array of integers with a fixed bit width
+@param array An array of integers
+@return The BitBuf itself.
+
+Writes the lowest @i n bits of all the elements of @i array, where @i n = bitCount(),
+exactly as writeBits() would do if called with all the elements as parameters.
+The space for the whole array is reserved at once, so this is the fastest way to
+pack many small integers.
+
+@code
+    bb = BitBuf().bitCount(3).writeBitsArray([1, 2, 3, 4, 5, 6, 7])
+    > bb.sizeBits()   // 21
+@endcode
+*/
+FALCON_FUNC BitBuf_writeBitsArray( ::Falcon::VMachine *vm )
+{
+    Item *i_arr = vm->param(0);
+    if(i_arr == NULL || !i_arr->isArray())
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( "A" ) );
+    }
+
+    BitBuf& buf = vmGetBuf<BitBuf>(vm);
+    const ItemArray& items = i_arr->asArray()->items();
+    uint32 count = items.length();
+    BitBuf::NUMTYPE bits = buf.bitcount();
+
+    if(bits)
+    {
+        buf.reserve_bits(bits * count);
+        for(uint32 i = 0; i < count; i++)
+            buf._appendUnchecked<int64>(items[i].dereference()->forceInteger(), bits);
+    }
+
+    vm->retval(vm->self());
+}
+
+/*#
+@method readBitsArray BitBuf
+@brief Unpacks a whole array of integers with a fixed bit width
+@param count The amount of integers to read
+@optparam neg If true, restore negative numbers, as readBits(true) does
+@optparam array An array where to append the integers
+@raise BufferError if less than @i count integers can be read
+@return The array holding the integers
+
+Reads @i count integers of @i bitCount() bits each, exactly as calling readBits()
+@i count times would do. The integers are appended to @i array if given,
+otherwise a new array is returned. If the buffer has not enough bits, nothing is read.
+*/
+FALCON_FUNC BitBuf_readBitsArray( ::Falcon::VMachine *vm )
+{
+    Item *i_count = vm->param(0);
+    Item *i_neg = vm->param(1);
+    Item *i_arr = vm->param(2);
+    if(i_count == NULL || !i_count->isOrdinal()
+        || (i_arr != NULL && !i_arr->isArray() && !i_arr->isNil()))
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( "N, [B], [A]" ) );
+    }
+    int64 icount = i_count->forceInteger();
+    bool neg = i_neg != NULL && i_neg->isTrue();
+
+    BitBuf& buf = vmGetBuf<BitBuf>(vm);
+    BitBuf::NUMTYPE bits = buf.bitcount();
+    // check the count before multiplying it, so that it can't overflow
+    int64 maxcount = bits ? int64((buf.size_bits() - buf.rpos_bits()) / bits) : int64(0xFFFFFFFF);
+    if(icount > maxcount)
+    {
+        throw new BufferError( ErrorParam(e_io_error, __LINE__)
+            .desc(FAL_STR_bufext_inv_read) );
+    }
+    uint32 count = icount > 0 ? (uint32)icount : 0;
+
+    bool append = i_arr != NULL && i_arr->isArray();
+    if(append && i_arr->asArray()->length() > 0xFFFFFFFF - count)
+    {
+        throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .origin( e_orig_mod ).extra( "N" ) );
+    }
+    CoreArray *arr = append ? i_arr->asArray() : new CoreArray(count);
+    ItemArray& items = arr->items();
+    uint32 oldLen = items.length();
+    items.resize(oldLen + count);
+    Item *dst = items.elements() + oldLen;
+
+    uint64 negMask = bits < 64 ? uint64(-1) << bits : 0;
+    for(uint32 i = 0; i < count; i++)
+    {
+        int64 val = bits ? buf._readUnchecked<int64>(bits) : 0;
+        if(neg)
+            val |= negMask;
+        dst[i].setInteger(val);
+    }
+
+    vm->retval(arr);
+}
+
 /*#
 @method sizeBits BitBuf
 @brief Returns the buffer size, in bits
@@ -47,6 +47,21 @@
 namespace Falcon { namespace Ext {
 
 
+// element types for the bulk array methods (readArray, writeArray)
+enum BufArrayType
+{
+    BUFARRAY_INT8,
+    BUFARRAY_UINT8,
+    BUFARRAY_INT16,
+    BUFARRAY_UINT16,
+    BUFARRAY_INT32,
+    BUFARRAY_UINT32,
+    BUFARRAY_INT64,
+    BUFARRAY_FLOAT,
+    BUFARRAY_DOUBLE,
+    BUFARRAY_MAX // not used
+};
+
 template <typename BUFTYPE> class BufCarrier : public FalconData
 {
 public:
@@ -107,6 +122,8 @@ CoreString *ByteArrayToHex(byte *arr, uint32 size);
 FALCON_FUNC BitBuf_bitCount( ::Falcon::VMachine *vm );
 FALCON_FUNC BitBuf_readBits( ::Falcon::VMachine *vm );
 FALCON_FUNC BitBuf_writeBits( ::Falcon::VMachine *vm );
+FALCON_FUNC BitBuf_readBitsArray( ::Falcon::VMachine *vm );
+FALCON_FUNC BitBuf_writeBitsArray( ::Falcon::VMachine *vm );
 FALCON_FUNC BitBuf_sizeBits( ::Falcon::VMachine *vm );
 FALCON_FUNC BitBuf_rposBits( ::Falcon::VMachine *vm );
 FALCON_FUNC BitBuf_wposBits( ::Falcon::VMachine *vm );
@@ -1237,4 +1237,406 @@ template <typename BUFTYPE> FALCON_FUNC Buf_readString( ::Falcon::VMachine *vm )
     vm->retval(str);
 }
 
+// ---------------------- Bulk methods -----------------------
+
+// amount of values converted at once when reading arrays or writing varints
+#define BUFBULK_CHUNK 256
+
+// the longest varint (64 bits, 7 per byte)
+#define BUFBULK_VARINT_MAX 10
+
+template <typename TY> inline TY BufBulkFromItem(const Item& itm) { return (TY)itm.dereference()->forceInteger(); }
+template <> inline float BufBulkFromItem<float>(const Item& itm) { return (float)itm.dereference()->forceNumeric(); }
+template <> inline numeric BufBulkFromItem<numeric>(const Item& itm) { return itm.dereference()->forceNumeric(); }
+
+template <typename TY> inline void BufBulkToItem(Item& itm, TY val) { itm.setInteger((int64)val); }
+template <> inline void BufBulkToItem<float>(Item& itm, float val) { itm.setNumeric(numeric(val)); }
+template <> inline void BufBulkToItem<numeric>(Item& itm, numeric val) { itm.setNumeric(val); }
+
+inline uint32 BufVarintEncode(uint8 *dst, int64 n, bool zigzag)
+{
+    uint64 v = zigzag ? (uint64(n) << 1) ^ uint64(n >> 63) : uint64(n);
+    uint32 pos = 0;
+    while(v >= 0x80)
+    {
+        dst[pos++] = uint8(v) | 0x80;
+        v >>= 7;
+    }
+    dst[pos++] = uint8(v);
+    return pos;
+}
+
+inline int64 BufVarintFinish(uint64 v, bool zigzag)
+{
+    return zigzag ? int64((v >> 1) ^ (~(v & 1) + 1)) : int64(v);
+}
+
+// generic case: bytewise buffers, accessing the memory directly
+template <typename BUFTYPE> struct BufBulkHelper
+{
+    template <typename TY> static void writeArray(BUFTYPE& buf, const Item *src, uint32 count)
+    {
+        uint32 bytes = count * sizeof(TY);
+        uint8 *dst = buf._wptr(bytes);
+        for(uint32 i = 0; i < count; ++i)
+        {
+            TY val = BufBulkFromItem<TY>(src[i]);
+            memcpy(dst + i * sizeof(TY), &val, sizeof(TY));
+        }
+        buf.convertBlock((TY*)dst, count);
+        buf._wskip(bytes);
+    }
+
+    template <typename TY> static void readArray(BUFTYPE& buf, Item *dst, uint32 count)
+    {
+        const uint8 *src = buf._rptr(count * sizeof(TY));
+        TY vals[BUFBULK_CHUNK];
+        for(uint32 done = 0; done < count; )
+        {
+            uint32 n = count - done < BUFBULK_CHUNK ? count - done : BUFBULK_CHUNK;
+            memcpy(vals, src + done * sizeof(TY), n * sizeof(TY));
+            buf.convertBlock(vals, n);
+            for(uint32 i = 0; i < n; ++i)
+                BufBulkToItem<TY>(dst[done + i], vals[i]);
+            done += n;
+        }
+        buf._rskip(count * sizeof(TY));
+    }
+
+    static void writeVarints(BUFTYPE& buf, const Item *src, uint32 count, bool zigzag)
+    {
+        for(uint32 done = 0; done < count; )
+        {
+            uint32 n = count - done < BUFBULK_CHUNK ? count - done : BUFBULK_CHUNK;
+            uint8 *dst = buf._wptr(n * BUFBULK_VARINT_MAX);
+            uint32 pos = 0;
+            for(uint32 i = 0; i < n; ++i)
+                pos += BufVarintEncode(dst + pos, src[done + i].dereference()->forceInteger(), zigzag);
+            buf._wskip(pos);
+            done += n;
+        }
+    }
+
+    static void readVarints(BUFTYPE& buf, Item *dst, uint32 count, bool zigzag)
+    {
+        uint32 avail = buf.readable();
+        const uint8 *src = buf._rptr(0);
+        uint32 pos = 0;
+        for(uint32 i = 0; i < count; ++i)
+        {
+            uint64 v = 0;
+            uint32 shift = 0;
+            uint8 b;
+            do
+            {
+                if(pos >= avail)
+                {
+                    throw new BufferError( ErrorParam(e_io_error, __LINE__)
+                        .desc(FAL_STR_bufext_inv_read) );
+                }
+                if(shift >= BUFBULK_VARINT_MAX * 7)
+                {
+                    throw new BufferError( ErrorParam(e_io_error, __LINE__)
+                        .desc(FAL_STR_bufext_inv_varint) );
+                }
+                b = src[pos++];
+                v |= uint64(b & 0x7F) << shift;
+                shift += 7;
+            }
+            while(b & 0x80);
+            dst[i].setInteger(BufVarintFinish(v, zigzag));
+        }
+        buf._rskip(pos);
+    }
+};
+
+// special case: BitBuf may not be byte-aligned, and has no endianity
+template <> struct BufBulkHelper<BitBuf>
+{
+    template <typename TY> static void writeArray(BitBuf& buf, const Item *src, uint32 count)
+    {
+        buf.reserve_bits(count * sizeof(TY) * 8);
+        for(uint32 i = 0; i < count; ++i)
+            buf.append<TY>(BufBulkFromItem<TY>(src[i]));
+    }
+
+    template <typename TY> static void readArray(BitBuf& buf, Item *dst, uint32 count)
+    {
+        if(!buf.can_read(count * sizeof(TY) * 8))
+        {
+            throw new BufferError( ErrorParam(e_io_error, __LINE__)
+                .desc(FAL_STR_bufext_inv_read) );
+        }
+        for(uint32 i = 0; i < count; ++i)
+        {
+            TY t = buf.read<TY>();
+            BufBulkToItem<TY>(dst[i], t);
+        }
+    }
+
+    static void writeVarints(BitBuf& buf, const Item *src, uint32 count, bool zigzag)
+    {
+        uint8 tmp[BUFBULK_VARINT_MAX];
+        for(uint32 i = 0; i < count; ++i)
+            buf.append(tmp, BufVarintEncode(tmp, src[i].dereference()->forceInteger(), zigzag));
+    }
+
+    static void readVarints(BitBuf& buf, Item *dst, uint32 count, bool zigzag)
+    {
+        uint32 rpos = buf.rpos_bits();
+        for(uint32 i = 0; i < count; ++i)
+        {
+            uint64 v = 0;
+            uint32 shift = 0;
+            uint8 b;
+            do
+            {
+                if(!buf.can_read(8) || shift >= BUFBULK_VARINT_MAX * 7)
+                {
+                    bool eob = !buf.can_read(8);
+                    buf.rpos_bits(rpos);
+                    throw new BufferError( ErrorParam(e_io_error, __LINE__)
+                        .desc(eob ? FAL_STR_bufext_inv_read : FAL_STR_bufext_inv_varint) );
+                }
+                b = buf._readUnchecked<uint8>();
+                v |= uint64(b & 0x7F) << shift;
+                shift += 7;
+            }
+            while(b & 0x80);
+            dst[i].setInteger(BufVarintFinish(v, zigzag));
+        }
+    }
+};
+
+// checks that icount items of at least elemSize bytes each can be read, then grows
+// the target array (or a new one) by that many items, and returns the first new item
+template <typename BUFTYPE> inline Item *BufBulkTarget(BUFTYPE& buf, int64 icount, uint32 elemSize,
+    Item *i_arr, uint32& count, CoreArray *&arr, uint32& oldLen)
+{
+    if(icount > int64(buf.readable() / elemSize))
+    {
+        throw new BufferError( ErrorParam(e_io_error, __LINE__)
+            .desc(FAL_STR_bufext_inv_read) );
+    }
+    count = icount > 0 ? (uint32)icount : 0;
+
+    bool append = i_arr != NULL && i_arr->isArray();
+    if(append && i_arr->asArray()->length() > 0xFFFFFFFF - count)
+    {
+        throw new ParamError(ErrorParam(e_param_range, __LINE__)
+            .extra("N"));
+    }
+    arr = append ? i_arr->asArray() : new CoreArray(count);
+    ItemArray& items = arr->items();
+    oldLen = items.length();
+    items.resize(oldLen + count);
+    return items.elements() + oldLen;
+}
+
+/*#
+@method writeArray ByteBuf
+@brief Writes a whole array of numbers with a fixed width
+@param array An array of numbers
+@param type The type of the elements, one of the ByteBuf.INT8 ... ByteBuf.DOUBLE constants
+@raise BufferError if the end of the buffer is reached and the buffer is not growable
+@raise ParamError if @i type is not valid
+@return The buffer itself
+
+Writes all the elements of @i array to the buffer at wpos(), as w8() ... wd() would do
+for each of them, and advances the write position by the size of the whole block.
+
+The elements are stored directly in the buffer memory and converted to the
+buffer endianity in a single pass, so this is much faster than writing the
+elements one by one.
+The signed and unsigned types are written in the same way; the distinction is
+relevant only for readArray().
+
+@code
+    bb = ByteBufBigEndian().writeArray([1, 2, 3, 4], ByteBuf.INT16)
+    > bb.size()   // 8
+@endcode
+*/
+
+/*#
+@method readArray ByteBuf
+@brief Reads a whole array of numbers with a fixed width
+@param count The amount of numbers to read
+@param type The type of the elements, one of the ByteBuf.INT8 ... ByteBuf.DOUBLE constants
+@optparam array An array where to append the numbers
+@raise BufferError if less than @i count numbers can be read
+@raise ParamError if @i type is not valid
+@return The array holding the numbers
+
+Reads @i count numbers from the buffer at rpos(), as r8() ... rd() would do
+for each of them, and advances the read position by the size of the whole block.
+
+The numbers are appended to @i array if given, otherwise a new array is returned.
+ByteBuf.INT8, ByteBuf.INT16 and ByteBuf.INT32 read signed numbers, while the UINT types
+read unsigned ones; ByteBuf.INT64 always reads signed numbers.
+If the buffer has not enough data, nothing is read and the array is left untouched.
+*/
+
+template <typename BUFTYPE> FALCON_FUNC Buf_writeArray( ::Falcon::VMachine *vm )
+{
+    Item *i_arr = vm->param(0);
+    Item *i_type = vm->param(1);
+    if(i_arr == NULL || !i_arr->isArray() || i_type == NULL || !i_type->isOrdinal())
+    {
+        throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+            .extra("A, I"));
+    }
+    BUFTYPE& buf = vmGetBuf<BUFTYPE>(vm);
+    const ItemArray& items = i_arr->asArray()->items();
+    const Item *src = items.elements();
+    uint32 count = items.length();
+
+    switch(i_type->forceInteger())
+    {
+        case BUFARRAY_INT8:
+        case BUFARRAY_UINT8:  BufBulkHelper<BUFTYPE>::template writeArray<uint8>(buf, src, count); break;
+        case BUFARRAY_INT16:
+        case BUFARRAY_UINT16: BufBulkHelper<BUFTYPE>::template writeArray<uint16>(buf, src, count); break;
+        case BUFARRAY_INT32:
+        case BUFARRAY_UINT32: BufBulkHelper<BUFTYPE>::template writeArray<uint32>(buf, src, count); break;
+        case BUFARRAY_INT64:  BufBulkHelper<BUFTYPE>::template writeArray<uint64>(buf, src, count); break;
+        case BUFARRAY_FLOAT:  BufBulkHelper<BUFTYPE>::template writeArray<float>(buf, src, count); break;
+        case BUFARRAY_DOUBLE: BufBulkHelper<BUFTYPE>::template writeArray<numeric>(buf, src, count); break;
+        default:
+            throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+                .extra(FAL_STR(bufext_inv_arraytype)));
+    }
+    vm->retval(vm->self());
+}
+
+template <typename BUFTYPE> FALCON_FUNC Buf_readArray( ::Falcon::VMachine *vm )
+{
+    Item *i_count = vm->param(0);
+    Item *i_type = vm->param(1);
+    Item *i_arr = vm->param(2);
+    if(i_count == NULL || !i_count->isOrdinal() || i_type == NULL || !i_type->isOrdinal()
+        || (i_arr != NULL && !i_arr->isArray() && !i_arr->isNil()))
+    {
+        throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+            .extra("N, I, [A]"));
+    }
+    int64 type = i_type->forceInteger();
+    if(type < 0 || type >= BUFARRAY_MAX)
+    {
+        throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+            .extra(FAL_STR(bufext_inv_arraytype)));
+    }
+    // bytes taken by each type
+    static const uint32 typeSizes[BUFARRAY_MAX] = { 1, 1, 2, 2, 4, 4, 8, sizeof(float), sizeof(numeric) };
+
+    BUFTYPE& buf = vmGetBuf<BUFTYPE>(vm);
+    CoreArray *arr;
+    uint32 count, oldLen;
+    Item *dst = BufBulkTarget(buf, i_count->forceInteger(), typeSizes[type], i_arr, count, arr, oldLen);
+
+    try
+    {
+        switch(type)
+        {
+            case BUFARRAY_INT8:   BufBulkHelper<BUFTYPE>::template readArray<int8>(buf, dst, count); break;
+            case BUFARRAY_UINT8:  BufBulkHelper<BUFTYPE>::template readArray<uint8>(buf, dst, count); break;
+            case BUFARRAY_INT16:  BufBulkHelper<BUFTYPE>::template readArray<int16>(buf, dst, count); break;
+            case BUFARRAY_UINT16: BufBulkHelper<BUFTYPE>::template readArray<uint16>(buf, dst, count); break;
+            case BUFARRAY_INT32:  BufBulkHelper<BUFTYPE>::template readArray<int32>(buf, dst, count); break;
+            case BUFARRAY_UINT32: BufBulkHelper<BUFTYPE>::template readArray<uint32>(buf, dst, count); break;
+            case BUFARRAY_INT64:  BufBulkHelper<BUFTYPE>::template readArray<int64>(buf, dst, count); break;
+            case BUFARRAY_FLOAT:  BufBulkHelper<BUFTYPE>::template readArray<float>(buf, dst, count); break;
+            case BUFARRAY_DOUBLE: BufBulkHelper<BUFTYPE>::template readArray<numeric>(buf, dst, count); break;
+        }
+    }
+    catch(Error *)
+    {
+        arr->items().resize(oldLen);
+        throw;
+    }
+    vm->retval(arr);
+}
+
+/*#
+@method writeVarints ByteBuf
+@brief Writes a whole array of integers as varints
+@param array An array of integers
+@optparam zigzag If true, use the zigzag encoding
+@raise BufferError if the end of the buffer is reached and the buffer is not growable
+@return The buffer itself
+
+Writes all the elements of @i array to the buffer at wpos() as variable length integers,
+7 bits per byte starting from the lowest ones, with the highest bit of each byte
+set if more bytes follow (the LEB128 format used by many binary protocols).
+Small numbers take less space; a number takes at most 10 bytes.
+
+Negative numbers always take 10 bytes, unless @i zigzag is true: then they are
+interleaved with the positive ones (0, -1, 1, -2, 2 ...), so that numbers with a
+small absolute value always take little space.
+
+This method is not affected by the buffer endianity.
+*/
+
+/*#
+@method readVarints ByteBuf
+@brief Reads a whole array of varint integers
+@param count The amount of integers to read
+@optparam zigzag If true, decode the zigzag encoding
+@optparam array An array where to append the integers
+@raise BufferError if less than @i count integers can be read, or if an integer is malformed
+@return The array holding the integers
+
+Reads @i count integers written by writeVarints() at rpos(), and advances the read position
+past the last one. The integers are appended to @i array if given, otherwise a new array is returned.
+In case of error, nothing is read and the array is left untouched.
+*/
+
+template <typename BUFTYPE> FALCON_FUNC Buf_writeVarints( ::Falcon::VMachine *vm )
+{
+    Item *i_arr = vm->param(0);
+    Item *i_zigzag = vm->param(1);
+    if(i_arr == NULL || !i_arr->isArray())
+    {
+        throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+            .extra("A, [B]"));
+    }
+    BUFTYPE& buf = vmGetBuf<BUFTYPE>(vm);
+    const ItemArray& items = i_arr->asArray()->items();
+    BufBulkHelper<BUFTYPE>::writeVarints(buf, items.elements(), items.length(),
+        i_zigzag != NULL && i_zigzag->isTrue());
+    vm->retval(vm->self());
+}
+
+template <typename BUFTYPE> FALCON_FUNC Buf_readVarints( ::Falcon::VMachine *vm )
+{
+    Item *i_count = vm->param(0);
+    Item *i_zigzag = vm->param(1);
+    Item *i_arr = vm->param(2);
+    if(i_count == NULL || !i_count->isOrdinal()
+        || (i_arr != NULL && !i_arr->isArray() && !i_arr->isNil()))
+    {
+        throw new ParamError(ErrorParam(e_inv_params, __LINE__)
+            .extra("N, [B], [A]"));
+    }
+    BUFTYPE& buf = vmGetBuf<BUFTYPE>(vm);
+    CoreArray *arr;
+    uint32 count, oldLen;
+    // each varint takes at least a byte
+    Item *dst = BufBulkTarget(buf, i_count->forceInteger(), 1, i_arr, count, arr, oldLen);
+
+    try
+    {
+        BufBulkHelper<BUFTYPE>::readVarints(buf, dst, count, i_zigzag != NULL && i_zigzag->isTrue());
+    }
+    catch(Error *)
+    {
+        arr->items().resize(oldLen);
+        throw;
+    }
+    vm->retval(arr);
+}
+
+#undef BUFBULK_CHUNK
+#undef BUFBULK_VARINT_MAX
+
+
 }} // namespace Falcon::Ext
@@ -49,6 +49,7 @@
 #define FAL_STR_bufext_inv_read "Tried to read beyond valid buffer space"
 #define FAL_STR_bufext_inv_write "Tried to write beyond valid buffer space"
 #define FAL_STR_bufext_buf_full "Buffer is full; can't write more data"
+#define FAL_STR_bufext_inv_varint "Malformed varint"
 
 FAL_MODSTR( bufext_inv_endian,            "Invalid endian ID" );
 FAL_MODSTR( bufext_bytebuf_fixed_endian,  "This ByteBuf has a fixed endian, can not be changed" );
@@ -58,5 +59,7 @@ FAL_MODSTR( bufext_bitbuf_nofloat,        "BitBuf does not support reading/writi
 FAL_MODSTR( bufext_inv_read,              FAL_STR_bufext_inv_read);
 FAL_MODSTR( bufext_inv_write,             FAL_STR_bufext_inv_write );
 FAL_MODSTR( bufext_buf_full,              FAL_STR_bufext_buf_full );
+FAL_MODSTR( bufext_inv_arraytype,         "Invalid array element type" );
+FAL_MODSTR( bufext_inv_varint,            FAL_STR_bufext_inv_varint );
 
 /* end of bufext_st.h */
@@ -286,6 +286,46 @@ template<ByteBufEndianMode ENDIANMODE> class ByteBufTemplate
             *((T*)(_buf + pos)) = value;
         }
 
+        // ---------------------- Bulk access -----------------------
+
+        // returns the memory at wpos, with room for at least 'bytes' bytes.
+        // fill it, then call _wskip() with the amount of bytes actually written.
+        uint8 *_wptr(uint32 bytes)
+        {
+            _enlargeIfReq(_wpos + bytes);
+            return _buf + _wpos;
+        }
+
+        void _wskip(uint32 bytes)
+        {
+            _wpos += bytes;
+            if(_size < _wpos)
+                _size = _wpos;
+        }
+
+        // returns the memory at rpos, checking that 'bytes' bytes can be read.
+        // after reading, call _rskip() with the amount of bytes actually consumed.
+        const uint8 *_rptr(uint32 bytes) const
+        {
+            if(_rpos + bytes > size())
+            {
+                throw new BufferError( ErrorParam(e_io_error, __LINE__)
+                    .desc(FAL_STR_bufext_inv_read) );
+            }
+            return _buf + _rpos;
+        }
+
+        inline void _rskip(uint32 bytes)
+        {
+            _rpos += bytes;
+        }
+
+        // converts a block of values from or to the buffer endianity in one pass
+        template <typename T> inline void convertBlock(T *vals, uint32 count) const
+        {
+            EndianConvertBlockHelper(vals, count);
+        }
+
         inline void setEndian(ByteBufEndianMode en)
         {
             _endian = en == ENDIANMODE_MANUAL ? ENDIANMODE_NATIVE : en;
@@ -346,6 +386,7 @@ template<ByteBufEndianMode ENDIANMODE> class ByteBufTemplate
     private:
 
         template<typename T> inline void EndianConvertHelper(T& val) const;
+        template<typename T> inline void EndianConvertBlockHelper(T *vals, uint32 count) const;
         
 
         // this code compiles with MSVC, but not with GCC - it is not required to have this class working, just a small optimization
@@ -373,6 +414,23 @@ template<typename T> inline void ByteBufTemplate<ENDIANMODE>::EndianConvertHelpe
     }
 }
 
+template <> template <typename T> inline void ByteBufTemplate<ENDIANMODE_NATIVE>::EndianConvertBlockHelper(T *vals, uint32 count) const {}
+template <> template <typename T> inline void ByteBufTemplate<ENDIANMODE_LITTLE>::EndianConvertBlockHelper(T *vals, uint32 count) const { ToLittleEndianBlock(vals, count); }
+template <> template <typename T> inline void ByteBufTemplate<ENDIANMODE_BIG>::EndianConvertBlockHelper(T *vals, uint32 count) const { ToBigEndianBlock(vals, count); }
+template <> template <typename T> inline void ByteBufTemplate<ENDIANMODE_REVERSE>::EndianConvertBlockHelper(T *vals, uint32 count) const { ToOtherEndianBlock(vals, count); }
+
+template<ByteBufEndianMode ENDIANMODE>
+template<typename T> inline void ByteBufTemplate<ENDIANMODE>::EndianConvertBlockHelper(T *vals, uint32 count) const
+{
+    switch(_endian)
+    {
+        case ENDIANMODE_LITTLE:  ToLittleEndianBlock(vals, count); break;
+        case ENDIANMODE_BIG:     ToBigEndianBlock(vals, count);    break;
+        case ENDIANMODE_REVERSE: ToOtherEndianBlock(vals, count);  break;
+        // ENDIANMODE_NATIVE and ENDIANMODE_MANUAL do nothing
+    }
+}
+
 
 template <> inline void ByteBufTemplate<ENDIANMODE_NATIVE>::setEndian(ByteBufEndianMode en) {}
 template <> inline void ByteBufTemplate<ENDIANMODE_LITTLE>::setEndian(ByteBufEndianMode en) {}
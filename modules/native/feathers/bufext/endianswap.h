@@ -1,6 +1,8 @@
 #ifndef ENDIANSWAP_H
 #define ENDIANSWAP_H
 
+#include <string.h>
+
 namespace Falcon {
 
 // swapping function specialized for integer types
@@ -25,6 +27,82 @@ template <typename T> inline void endianswap(T& val)
     endianswap_recursive<sizeof(T)>((char*)(&val));
 }
 
+// swapping a whole block of values of the same size in one pass.
+// the values may be unaligned, so they are copied in and out of a register;
+// the loop is simple enough to be vectorized by the compiler.
+template <size_t T> struct endianswap_block_helper
+{
+    static inline void swap(char *vals, uint32 count)
+    {
+        for(uint32 i = 0; i < count; ++i, vals += T)
+            endianswap_recursive<T>(vals);
+    }
+};
+
+template <> struct endianswap_block_helper<1>
+{
+    static inline void swap(char *, uint32) {}
+};
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+template <> struct endianswap_block_helper<2>
+{
+    static inline void swap(char *vals, uint32 count)
+    {
+        for(uint32 i = 0; i < count; ++i, vals += 2)
+        {
+            uint16 v;
+            memcpy(&v, vals, 2);
+            v = __builtin_bswap16(v);
+            memcpy(vals, &v, 2);
+        }
+    }
+};
+
+template <> struct endianswap_block_helper<4>
+{
+    static inline void swap(char *vals, uint32 count)
+    {
+        for(uint32 i = 0; i < count; ++i, vals += 4)
+        {
+            uint32 v;
+            memcpy(&v, vals, 4);
+            v = __builtin_bswap32(v);
+            memcpy(vals, &v, 4);
+        }
+    }
+};
+
+template <> struct endianswap_block_helper<8>
+{
+    static inline void swap(char *vals, uint32 count)
+    {
+        for(uint32 i = 0; i < count; ++i, vals += 8)
+        {
+            uint64 v;
+            memcpy(&v, vals, 8);
+            v = __builtin_bswap64(v);
+            memcpy(vals, &v, 8);
+        }
+    }
+};
+#endif
+
+template <typename T> inline void endianswap_block(T *vals, uint32 count)
+{
+    endianswap_block_helper<sizeof(T)>::swap((char*)vals, count);
+}
+
+#if FALCON_LITTLE_ENDIAN == 1
+template<typename T> inline void ToBigEndianBlock(T *vals, uint32 count) { endianswap_block<T>(vals, count); }
+template<typename T> inline void ToLittleEndianBlock(T *, uint32) { }
+#else
+template<typename T> inline void ToBigEndianBlock(T *, uint32) { }
+template<typename T> inline void ToLittleEndianBlock(T *vals, uint32 count) { endianswap_block<T>(vals, count); }
+#endif
+
+template<typename T> inline void ToOtherEndianBlock(T *vals, uint32 count) { endianswap_block<T>(vals, count); }
+
 #if FALCON_LITTLE_ENDIAN == 1
 template<typename T> inline void ToBigEndian(T& val) { endianswap<T>(val); }
 template<typename T> inline void ToLittleEndian(T&) { }
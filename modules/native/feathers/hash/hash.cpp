@@ -333,8 +333,17 @@ Falcon::Module *hash_module_init(void)
     self->addExtFunc("hmac", Falcon::Ext::Func_hmac)
         ->addParam("raw")->addParam("which")->addParam("key")->addParam("data");
 
+    self->addExtFunc("hashStream", Falcon::Ext::Func_hashStream)
+        ->addParam("which")->addParam("stream")->addParam("chunk")->addParam("raw");
+
     self->addExtFunc("getSupportedHashes", Falcon::Ext::Func_GetSupportedHashes);
 
+    Falcon::Symbol *poolCls = self->addClass("HashPool", Falcon::Ext::HashPool_init)
+        ->addParam("threads")->addParam("chunk");
+    self->addClassMethod(poolCls, "threads", Falcon::Ext::HashPool_threads);
+    self->addClassMethod(poolCls, "hashFiles", Falcon::Ext::HashPool_hashFiles)
+        .asSymbol()->addParam("which")->addParam("files")->addParam("raw");
+
     // generate CRC32 table
     Falcon::Mod::CRC32::GenTab();
 
@@ -171,6 +171,131 @@ FALCON_FUNC Func_hash( ::Falcon::VMachine *vm )
         delete carrier;
 }
 
+/*#
+@function hashStream
+@brief Calculates the hash of all the data that can be read from a stream.
+@param which Hash that should be used
+@param stream The stream to be read
+@optparam chunk Size of the reads on the stream, in bytes (defaults to 64K).
+@optparam raw If set to true, return a raw MemBuf instead of a string.
+@return A lowercase hexadecimal string with the output of the chosen hash if @i raw is false, or a 1-byte wide MemBuf if true.
+@raise ParamError in case @i which is a string and a hash with that name was not found; or if @i which is not a hash object.
+@raise AccessError if @i which is a hash object that was already finalized.
+@raise IoError in case of read errors on the stream.
+
+The stream is read from its current position up to its end, and the data is fed
+to the hash natively, through a single buffer of @i chunk bytes. This is
+the preferred way to hash big files, as the data never goes through script strings.
+
+Param @i which is treated as in hash().
+
+@note When the hash is a native algorithm, other coroutines and threads are
+allowed to proceed while the stream is read.
+@note If @i which is a hash object, it will be finalized by calling this function.
+*/
+FALCON_FUNC Func_hashStream( ::Falcon::VMachine *vm )
+{
+    Item *i_which = vm->param(0);
+    Item *i_stream = vm->param(1);
+    Item *i_chunk = vm->param(2);
+    if( !(i_which && i_stream)
+        || !(i_stream->isObject() && i_stream->asObject()->derivedFrom("Stream"))
+        || (i_chunk && !(i_chunk->isNil() || i_chunk->isOrdinal())) )
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( "X, Stream, [N], [B]" ) );
+    }
+
+    int64 chunk = i_chunk && !i_chunk->isNil() ? i_chunk->forceInteger() : HASH_DEFAULT_CHUNK_SIZE;
+    if(chunk <= 0 || chunk > 0x40000000)
+    {
+        throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .origin( e_orig_mod ).extra( "chunk" ) );
+    }
+    bool raw = vm->paramCount() > 3 && vm->param(3)->asBoolean();
+    Stream *stream = (Stream *) i_stream->asObject()->getUserData();
+
+    Item which = *i_which;
+    Mod::HashCarrier<Mod::HashBase> *carrier = NULL;
+
+    while(which.isCallable())
+    {
+        vm->callItemAtomic(which, 0);
+        which = vm->regA();
+    }
+
+    bool ownCarrier = false;
+
+    if(which.isString())
+    {
+        carrier = (Mod::HashCarrier<Mod::HashBase>*)(Mod::GetHashByName(which.asString()));
+        ownCarrier = true;
+    }
+    else if(which.isObject())
+    {
+        CoreObject *co = which.asObject();
+        if(co->derivedFrom("HashBase"))
+            carrier = (Mod::HashCarrier<Mod::HashBase>*)(co->getUserData());
+    }
+
+    if(!carrier)
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( FAL_STR(hash_not_found) ) );
+    }
+
+    Mod::HashBase *hash = carrier->GetHash();
+    if(hash->IsFinalized())
+    {
+        if(ownCarrier)
+            delete carrier;
+        throw new Falcon::AccessError(
+            Falcon::ErrorParam( e_acc_forbidden, __LINE__ )
+            .extra(FAL_STR(hash_err_finalized)));
+    }
+
+    byte *buf = (byte *) memAlloc((uint32) chunk);
+    bool success;
+    // script defined hashes need the VM at each update
+    if(dynamic_cast<Mod::HashBaseFalcon *>(hash) != NULL)
+    {
+        success = Mod::HashStreamData(hash, stream, buf, (uint32) chunk);
+    }
+    else
+    {
+        VMachine::Pauser pauser(vm);
+        success = Mod::HashStreamData(hash, stream, buf, (uint32) chunk);
+    }
+    memFree(buf);
+
+    if(!success)
+    {
+        if(ownCarrier)
+            delete carrier;
+        throw new IoError( ErrorParam( e_io_error, __LINE__ )
+            .origin( e_orig_mod ).sysError( (uint32) stream->lastError() ) );
+    }
+
+    hash->Finalize();
+
+    uint32 size = hash->DigestSize();
+    byte *digest = hash->GetDigest();
+
+    if(raw)
+    {
+        Falcon::MemBuf_1 *mb = new Falcon::MemBuf_1(size);
+        memcpy(mb->data(), digest, size);
+        vm->retval(mb);
+    }
+    else
+    {
+        vm->retval(Mod::ByteArrayToHex(digest, size));
+    }
+
+    if(ownCarrier)
+        delete carrier;
+}
+
 /*#
 @function makeHash
 @brief Creates a hash object based on the algorithm name
@@ -395,6 +520,129 @@ FALCON_FUNC Func_hmac( ::Falcon::VMachine *vm )
 
 
 
+/*#
+@class HashPool
+@brief Hashes many files in parallel.
+@optparam threads Number of worker threads (defaults to the number of processors).
+@optparam chunk Size of the reads on the files, in bytes (defaults to 64K).
+@raise ParamError if @i threads or @i chunk are out of range.
+
+The files are read and hashed natively by a set of worker threads, each
+using its own read buffer; the calling VM is allowed to proceed with other
+threads while the work is performed.
+
+@code
+    pool = HashPool()
+    digests = pool.hashFiles( "sha256", ["a.iso", "b.iso", "c.iso"] )
+@endcode
+*/
+FALCON_FUNC HashPool_init( ::Falcon::VMachine *vm )
+{
+    Item *i_threads = vm->param(0);
+    Item *i_chunk = vm->param(1);
+    if( (i_threads && !(i_threads->isNil() || i_threads->isOrdinal()))
+        || (i_chunk && !(i_chunk->isNil() || i_chunk->isOrdinal())) )
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( "[N], [N]" ) );
+    }
+
+    int64 threads = i_threads && !i_threads->isNil() ? i_threads->forceInteger() : 0;
+    int64 chunk = i_chunk && !i_chunk->isNil() ? i_chunk->forceInteger() : 0;
+    if(threads < 0 || threads > 1024 || chunk < 0 || chunk > 0x40000000)
+    {
+        throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .origin( e_orig_mod ).extra( "[N], [N]" ) );
+    }
+
+    vm->self().asObject()->setUserData(new Mod::HashPool((uint32) threads, (uint32) chunk));
+}
+
+/*#
+@method threads HashPool
+@brief Returns the number of worker threads used by this pool.
+@return The number of threads.
+*/
+FALCON_FUNC HashPool_threads( ::Falcon::VMachine *vm )
+{
+    Mod::HashPool *pool = (Mod::HashPool *) vm->self().asObject()->getUserData();
+    vm->retval((int64) pool->Threads());
+}
+
+/*#
+@method hashFiles HashPool
+@brief Hashes a set of files.
+@param which Name of the hash to be used.
+@param files An array of file names.
+@optparam raw If set to true, return raw MemBufs instead of strings.
+@return An array with the hash of each file, in the same order of @i files.
+@raise ParamError if the hash named @i which is not supported.
+
+Only the native hashes can be used, so @i which must be one of the names
+returned by getSupportedHashes().
+
+The files that cannot be opened or read have a @b nil in the
+corresponding position of the returned array.
+*/
+FALCON_FUNC HashPool_hashFiles( ::Falcon::VMachine *vm )
+{
+    Item *i_which = vm->param(0);
+    Item *i_files = vm->param(1);
+    if( !(i_which && i_files) || !i_which->isString() || !i_files->isArray() )
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).extra( "S, A, [B]" ) );
+    }
+    bool raw = vm->paramCount() > 2 && vm->param(2)->asBoolean();
+
+    Mod::HashPool *pool = (Mod::HashPool *) vm->self().asObject()->getUserData();
+    if(!pool->Prepare(*i_which->asString()))
+    {
+        throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .origin( e_orig_mod ).desc( FAL_STR(hash_not_found) ).extra(*i_which->asString()) );
+    }
+
+    CoreArray *files = i_files->asArray();
+    for(uint32 i = 0; i < files->length(); ++i)
+    {
+        Item &file = files->at(i);
+        if(!file.isString())
+        {
+            throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+                .origin( e_orig_mod ).extra( "S, A, [B]" ) );
+        }
+        pool->AddFile(*file.asString());
+    }
+
+    {
+        VMachine::Pauser pauser(vm);
+        pool->Run();
+    }
+
+    CoreArray *res = new CoreArray(pool->JobCount());
+    for(uint32 i = 0; i < pool->JobCount(); ++i)
+    {
+        const Mod::HashPool::Job *job = pool->GetJob(i);
+        if(!job->done)
+        {
+            res->append(Item());
+        }
+        else if(raw)
+        {
+            Falcon::MemBuf_1 *buf = new Falcon::MemBuf_1(job->digestSize);
+            memcpy(buf->data(), job->digest, job->digestSize);
+            res->append(buf);
+        }
+        else
+        {
+            res->append(Mod::ByteArrayToHex((byte *) job->digest, job->digestSize));
+        }
+    }
+
+    vm->retval(res);
+}
+
+
 // updateItem is a helper function to process the individual items passed to update()
 void Hash_updateItem_internal(Item *what, Mod::HashBase *hash, ::Falcon::VMachine *vm, uint32 stackDepth)
 {
@@ -44,6 +44,11 @@ FALCON_FUNC Func_GetSupportedHashes( ::Falcon::VMachine *vm );
 FALCON_FUNC Func_hash( ::Falcon::VMachine *vm );
 FALCON_FUNC Func_makeHash( ::Falcon::VMachine *vm );
 FALCON_FUNC Func_hmac( ::Falcon::VMachine *vm );
+FALCON_FUNC Func_hashStream( ::Falcon::VMachine *vm );
+
+FALCON_FUNC HashPool_init( ::Falcon::VMachine *vm );
+FALCON_FUNC HashPool_threads( ::Falcon::VMachine *vm );
+FALCON_FUNC HashPool_hashFiles( ::Falcon::VMachine *vm );
 
 void Hash_updateItem_internal(Item *what, Mod::HashBase *hash, ::Falcon::VMachine *vm, uint32 stackDepth);
 
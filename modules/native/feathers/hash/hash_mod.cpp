@@ -34,6 +34,9 @@
 
 #include <falcon/engine.h>
 #include <falcon/autocstring.h>
+#include <falcon/fstream.h>
+#include <falcon/mt.h>
+#include <falcon/sys.h>
 #include <string.h>
 #include "hash_mod.h"
 #include "hash_st.h"
@@ -101,6 +104,157 @@ CoreString *ByteArrayToHex(byte *arr, uint32 size)
     return str;
 }
 
+// feeds a stream into a hash, until the end of the stream is reached
+bool HashStreamData(HashBase *hash, Stream *stream, byte *buf, uint32 bufSize)
+{
+    while(true)
+    {
+        int32 len = stream->read(buf, bufSize);
+        if(len < 0)
+            return false;
+        if(len == 0)
+            return true;
+        hash->UpdateData(buf, (uint32) len);
+    }
+}
+
+
+class HashPool::Worker : public Runnable
+{
+public:
+    Worker(HashPool *pool): _pool(pool) {}
+    virtual ~Worker() {}
+
+    virtual void *run()
+    {
+        byte *buf = (byte *) memAlloc(_pool->_chunkSize);
+        Job *job;
+        while((job = _pool->NextJob()) != NULL)
+            HashFile(job, buf);
+        memFree(buf);
+        return NULL;
+    }
+
+private:
+    void HashFile(Job *job, byte *buf)
+    {
+        HashCarrier<HashBase> *carrier = (HashCarrier<HashBase>*) GetHashByName(&_pool->_algo);
+        HashBase *hash = carrier->GetHash();
+
+        FileStream fs;
+        if(!fs.open(job->path, BaseFileStream::e_omReadOnly, BaseFileStream::e_smShareRead))
+        {
+            job->error = fs.lastError();
+        }
+        else if(!HashStreamData(hash, &fs, buf, _pool->_chunkSize))
+        {
+            job->error = fs.lastError();
+            fs.close();
+        }
+        else
+        {
+            fs.close();
+            hash->Finalize();
+            job->digestSize = hash->DigestSize();
+            memcpy(job->digest, hash->GetDigest(), job->digestSize);
+            job->done = true;
+        }
+
+        delete carrier;
+    }
+
+    HashPool *_pool;
+};
+
+
+HashPool::HashPool(uint32 threads, uint32 chunkSize):
+    _threads(threads == 0 ? (uint32) Sys::_cpuCount() : threads),
+    _chunkSize(chunkSize == 0 ? HASH_DEFAULT_CHUNK_SIZE : chunkSize),
+    _jobs(&traits::t_voidp()),
+    _next(0)
+{}
+
+HashPool::~HashPool()
+{
+    Clear();
+}
+
+void HashPool::Clear(void)
+{
+    for(uint32 i = 0; i < _jobs.size(); ++i)
+        delete *(Job **) _jobs.at(i);
+    _jobs.resize(0);
+    _next = 0;
+}
+
+bool HashPool::Prepare(const String &algo)
+{
+    Clear();
+
+    // check that the algorithm is known before starting the workers
+    _algo.bufferize(algo);
+    FalconData *carrier = GetHashByName(&_algo);
+    if(!carrier)
+        return false;
+    delete carrier;
+    return true;
+}
+
+void HashPool::AddFile(const String &path)
+{
+    Job *job = new Job;
+    job->path.bufferize(path);
+    job->digestSize = 0;
+    job->error = 0;
+    job->done = false;
+    _jobs.push(job);
+}
+
+HashPool::Job *HashPool::NextJob(void)
+{
+    int32 pos = atomicInc(_next) - 1;
+    if(pos >= (int32) _jobs.size())
+        return NULL;
+    return *(Job **) _jobs.at(pos);
+}
+
+void HashPool::Run(void)
+{
+    _next = 0;
+    uint32 count = _threads < _jobs.size() ? _threads : _jobs.size();
+    if(count == 0)
+        return;
+
+    // the calling thread takes its share of the work too
+    Worker **workers = (Worker **) memAlloc(sizeof(Worker*) * count);
+    SysThread **threads = (SysThread **) memAlloc(sizeof(SysThread*) * count);
+    for(uint32 i = 1; i < count; ++i)
+    {
+        workers[i] = new Worker(this);
+        threads[i] = new SysThread(workers[i]);
+        if(!threads[i]->start())
+        {
+            // the other workers will take over its share
+            threads[i]->disengage();
+            threads[i] = NULL;
+        }
+    }
+
+    Worker self(this);
+    self.run();
+
+    for(uint32 i = 1; i < count; ++i)
+    {
+        void *dummy;
+        if(threads[i])
+            threads[i]->join(dummy);
+        delete workers[i];
+    }
+
+    memFree(workers);
+    memFree(threads);
+}
+
 
 void HashBase::UpdateData(MemBuf *buf)
 {
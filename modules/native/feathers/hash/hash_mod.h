@@ -38,6 +38,7 @@
 #include <falcon/types.h>
 #include <falcon/membuf.h>
 #include <falcon/falcondata.h>
+#include <falcon/genericvector.h>
 #include "adler32.h"
 #include "sha1.h"
 #include "sha256_sha224.h"
@@ -69,6 +70,12 @@
 // should there be any hash that has a greater block size don't forget to change this!!
 #define MAX_USED_BLOCKSIZE 128
 
+// should there be any hash that has a greater digest size don't forget to change this!!
+#define MAX_DIGEST_SIZE 64
+
+// default read size for stream hashing
+#define HASH_DEFAULT_CHUNK_SIZE 65536
+
 namespace Falcon {
 namespace Mod {
 
@@ -394,6 +401,59 @@ namespace Mod {
 
     FalconData *GetHashByName(String *whichStr);
     CoreString *ByteArrayToHex(byte *arr, uint32 size);
+
+    // feeds everything that can be read from stream into the hash, using buf (of bufSize bytes) for reading.
+    // returns false on read errors; the error is left in the stream.
+    bool HashStreamData(HashBase *hash, Stream *stream, byte *buf, uint32 bufSize);
+
+    // hashes a set of files on parallel worker threads.
+    // Workers only use native hashes (selected by name), so they never need the VM.
+    class HashPool : public FalconData
+    {
+    public:
+        // result of the hashing of a single file
+        struct Job
+        {
+            String path;
+            byte digest[MAX_DIGEST_SIZE];
+            uint32 digestSize;
+            int64 error; // 0 if the file was hashed, system error otherwise
+            bool done;
+        };
+
+        // threads == 0 means one thread per available processor
+        HashPool(uint32 threads = 0, uint32 chunkSize = 0);
+        virtual ~HashPool();
+
+        inline uint32 Threads(void) const { return _threads; }
+        inline uint32 ChunkSize(void) const { return _chunkSize; }
+
+        // prepares a new set of files to be hashed with the given algorithm; false if the algorithm is unknown.
+        bool Prepare(const String &algo);
+        void AddFile(const String &path);
+
+        // hashes all the files added since Prepare(), returning when all the workers are done.
+        void Run(void);
+
+        inline uint32 JobCount(void) const { return _jobs.size(); }
+        inline const Job *GetJob(uint32 i) const { return *(Job **) _jobs.at(i); }
+
+        virtual HashPool *clone() const { return NULL; } // not cloneable
+        virtual void gcMark( uint32 mark ) {}
+
+    private:
+        class Worker;
+        friend class Worker;
+
+        void Clear(void);
+        Job *NextJob(void);
+
+        uint32 _threads;
+        uint32 _chunkSize;
+        String _algo;
+        GenericVector _jobs; // of Job*
+        volatile int32 _next;
+    };
 }
 }
 
@@ -33,6 +33,7 @@ effort (for example the reengineering of a great many Capstone chips).
 
 #include <string.h>
 #include "sha1.h"
+#include "sha_accel.h"
 
 void sha_copy(struct sha_ctx *dest, struct sha_ctx *src)
 {
@@ -284,6 +285,19 @@ void sha_update(struct sha_ctx *ctx, const byte *buffer, word32 len)
 			len -= left;
 		}
 	}
+	if (len >= SHA_DATASIZE && sha_accel_available())
+	{
+		word32 nblocks = len / SHA_DATASIZE;
+		sha1_accel_blocks(ctx->digest, buffer, nblocks);
+		/* Update block count */
+		ctx->count_l += nblocks;
+		if (ctx->count_l < nblocks)
+		{
+			++ctx->count_h;
+		}
+		buffer += nblocks * SHA_DATASIZE;
+		len -= nblocks * SHA_DATASIZE;
+	}
 	while (len >= SHA_DATASIZE)
 	{
 		sha_block(ctx, buffer);
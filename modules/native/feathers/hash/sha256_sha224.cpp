@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include "sha256_sha224.h"
+#include "sha_accel.h"
 
 /* A block, treated as a sequence of 32-bit words. */
 #define SHA256_SHA224_DATA_LENGTH 16
@@ -262,6 +263,14 @@ sha256_sha224_update(struct sha256_sha224_ctx *ctx, const byte *buffer, word32 l
 			length -= left;
 		}
 	}
+	if (length >= SHA256_SHA224_DATA_SIZE && sha_accel_available()) {
+		word32 nblocks = length / SHA256_SHA224_DATA_SIZE;
+		sha256_accel_blocks(ctx->state, buffer, nblocks);
+		/* Update block count */
+		ctx->bitcount += (word64) nblocks * 512;
+		buffer += nblocks * SHA256_SHA224_DATA_SIZE;
+		length -= nblocks * SHA256_SHA224_DATA_SIZE;
+	}
 	while (length >= SHA256_SHA224_DATA_SIZE) {
 		sha256_sha224_block(ctx, buffer);
 		buffer += SHA256_SHA224_DATA_SIZE;
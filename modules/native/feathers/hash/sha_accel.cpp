@@ -0,0 +1,300 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: sha_accel.cpp
+
+   Hardware accelerated SHA-1 and SHA-256 block functions.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 14:02:37 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Hardware accelerated SHA-1 and SHA-256 block functions.
+*/
+
+#include "sha_accel.h"
+
+#ifdef FALCON_HASH_SHA_NI
+
+#include <immintrin.h>
+#include <cpuid.h>
+
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+/* -1 = still unknown; concurrent first calls just compute it twice. */
+static volatile int s_sha_ni = -1;
+
+static int sha_ni_detect(void)
+{
+   unsigned int a, b, c, d;
+
+   if ( ! __get_cpuid( 1, &a, &b, &c, &d ) )
+      return 0;
+
+   /* SSSE3 and SSE4.1 are needed for the byte shuffles. */
+   if ( ( c & (1u << 9) ) == 0 || ( c & (1u << 19) ) == 0 )
+      return 0;
+
+   if ( __get_cpuid_max( 0, 0 ) < 7 )
+      return 0;
+
+   __cpuid_count( 7, 0, a, b, c, d );
+   return ( b & (1u << 29) ) != 0;
+}
+
+int sha_accel_available(void)
+{
+   if ( s_sha_ni < 0 )
+      s_sha_ni = sha_ni_detect();
+   return s_sha_ni;
+}
+
+
+/*=======================================================
+ * SHA-1
+ */
+
+/* Four rounds after the first 16; k is the 4-rounds group index. */
+#define SHA1_ROUNDS4( EA, EB, M0, M1, M2, M3, F ) \
+   EA = _mm_sha1nexte_epu32( EA, M0 ); \
+   EB = abcd; \
+   M1 = _mm_sha1msg2_epu32( M1, M0 ); \
+   abcd = _mm_sha1rnds4_epu32( abcd, EA, F ); \
+   M3 = _mm_sha1msg1_epu32( M3, M0 ); \
+   M2 = _mm_xor_si128( M2, M0 );
+
+SHA_NI_TARGET
+void sha1_accel_blocks(word32 *state, const byte *data, word32 nblocks)
+{
+   __m128i abcd, e0, e1, msg0, msg1, msg2, msg3, abcd_save, e0_save;
+   const __m128i mask = _mm_set_epi64x( 0x0001020304050607LL, 0x08090a0b0c0d0e0fLL );
+
+   abcd = _mm_loadu_si128( (const __m128i*) state );
+   e0 = _mm_set_epi32( (int) state[4], 0, 0, 0 );
+   abcd = _mm_shuffle_epi32( abcd, 0x1B );
+
+   while( nblocks-- > 0 )
+   {
+      abcd_save = abcd;
+      e0_save = e0;
+
+      /* Rounds 0-3 */
+      msg0 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) data ), mask );
+      e0 = _mm_add_epi32( e0, msg0 );
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 0 );
+
+      /* Rounds 4-7 */
+      msg1 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 16) ), mask );
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 0 );
+      msg0 = _mm_sha1msg1_epu32( msg0, msg1 );
+
+      /* Rounds 8-11 */
+      msg2 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 32) ), mask );
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 0 );
+      msg1 = _mm_sha1msg1_epu32( msg1, msg2 );
+      msg0 = _mm_xor_si128( msg0, msg2 );
+
+      /* Rounds 12-15 */
+      msg3 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 48) ), mask );
+      SHA1_ROUNDS4( e1, e0, msg3, msg0, msg1, msg2, 0 );
+
+      /* Rounds 16-63 */
+      SHA1_ROUNDS4( e0, e1, msg0, msg1, msg2, msg3, 0 );
+      SHA1_ROUNDS4( e1, e0, msg1, msg2, msg3, msg0, 1 );
+      SHA1_ROUNDS4( e0, e1, msg2, msg3, msg0, msg1, 1 );
+      SHA1_ROUNDS4( e1, e0, msg3, msg0, msg1, msg2, 1 );
+      SHA1_ROUNDS4( e0, e1, msg0, msg1, msg2, msg3, 1 );
+      SHA1_ROUNDS4( e1, e0, msg1, msg2, msg3, msg0, 1 );
+      SHA1_ROUNDS4( e0, e1, msg2, msg3, msg0, msg1, 2 );
+      SHA1_ROUNDS4( e1, e0, msg3, msg0, msg1, msg2, 2 );
+      SHA1_ROUNDS4( e0, e1, msg0, msg1, msg2, msg3, 2 );
+      SHA1_ROUNDS4( e1, e0, msg1, msg2, msg3, msg0, 2 );
+      SHA1_ROUNDS4( e0, e1, msg2, msg3, msg0, msg1, 2 );
+      SHA1_ROUNDS4( e1, e0, msg3, msg0, msg1, msg2, 3 );
+
+      /* Rounds 64-67 */
+      SHA1_ROUNDS4( e0, e1, msg0, msg1, msg2, msg3, 3 );
+
+      /* Rounds 68-71 */
+      e1 = _mm_sha1nexte_epu32( e1, msg1 );
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32( msg2, msg1 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+      msg3 = _mm_xor_si128( msg3, msg1 );
+
+      /* Rounds 72-75 */
+      e0 = _mm_sha1nexte_epu32( e0, msg2 );
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32( msg3, msg2 );
+      abcd = _mm_sha1rnds4_epu32( abcd, e0, 3 );
+
+      /* Rounds 76-79 */
+      e1 = _mm_sha1nexte_epu32( e1, msg3 );
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+
+      /* Combine state */
+      e0 = _mm_sha1nexte_epu32( e0, e0_save );
+      abcd = _mm_add_epi32( abcd, abcd_save );
+
+      data += 64;
+   }
+
+   abcd = _mm_shuffle_epi32( abcd, 0x1B );
+   _mm_storeu_si128( (__m128i*) state, abcd );
+   state[4] = (word32) _mm_extract_epi32( e0, 3 );
+}
+
+
+/*=======================================================
+ * SHA-256
+ */
+
+static const word32 s_k256[64] = {
+   0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
+   0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+   0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL,
+   0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+   0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+   0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+   0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL,
+   0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+   0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL,
+   0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+   0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL,
+   0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+   0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL,
+   0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+   0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+   0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/* Two double rounds with the message words in M0 and the constants of group K. */
+#define SHA256_ROUNDS4_BEGIN( M0, K ) \
+   msg = _mm_add_epi32( M0, _mm_loadu_si128( (const __m128i*) (s_k256 + 4*(K)) ) ); \
+   state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+
+#define SHA256_ROUNDS4_END() \
+   msg = _mm_shuffle_epi32( msg, 0x0E ); \
+   state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+/* Rounds using M0 while preparing the schedule in M1 and M3. */
+#define SHA256_ROUNDS4( M0, M1, M3, K ) \
+   SHA256_ROUNDS4_BEGIN( M0, K ) \
+   tmp = _mm_alignr_epi8( M0, M3, 4 ); \
+   M1 = _mm_add_epi32( M1, tmp ); \
+   M1 = _mm_sha256msg2_epu32( M1, M0 ); \
+   SHA256_ROUNDS4_END() \
+   M3 = _mm_sha256msg1_epu32( M3, M0 );
+
+SHA_NI_TARGET
+void sha256_accel_blocks(word32 *state, const byte *data, word32 nblocks)
+{
+   __m128i state0, state1, msg, tmp, msg0, msg1, msg2, msg3, abef_save, cdgh_save;
+   const __m128i mask = _mm_set_epi64x( 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL );
+
+   tmp = _mm_loadu_si128( (const __m128i*) state );
+   state1 = _mm_loadu_si128( (const __m128i*) (state + 4) );
+
+   tmp = _mm_shuffle_epi32( tmp, 0xB1 );            /* CDAB */
+   state1 = _mm_shuffle_epi32( state1, 0x1B );      /* EFGH */
+   state0 = _mm_alignr_epi8( tmp, state1, 8 );      /* ABEF */
+   state1 = _mm_blend_epi16( state1, tmp, 0xF0 );   /* CDGH */
+
+   while( nblocks-- > 0 )
+   {
+      abef_save = state0;
+      cdgh_save = state1;
+
+      /* Rounds 0-3 */
+      msg0 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) data ), mask );
+      SHA256_ROUNDS4_BEGIN( msg0, 0 )
+      SHA256_ROUNDS4_END()
+
+      /* Rounds 4-7 */
+      msg1 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 16) ), mask );
+      SHA256_ROUNDS4_BEGIN( msg1, 1 )
+      SHA256_ROUNDS4_END()
+      msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+      /* Rounds 8-11 */
+      msg2 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 32) ), mask );
+      SHA256_ROUNDS4_BEGIN( msg2, 2 )
+      SHA256_ROUNDS4_END()
+      msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+      /* Rounds 12-51 */
+      msg3 = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) (data + 48) ), mask );
+      SHA256_ROUNDS4( msg3, msg0, msg2, 3 )
+      SHA256_ROUNDS4( msg0, msg1, msg3, 4 )
+      SHA256_ROUNDS4( msg1, msg2, msg0, 5 )
+      SHA256_ROUNDS4( msg2, msg3, msg1, 6 )
+      SHA256_ROUNDS4( msg3, msg0, msg2, 7 )
+      SHA256_ROUNDS4( msg0, msg1, msg3, 8 )
+      SHA256_ROUNDS4( msg1, msg2, msg0, 9 )
+      SHA256_ROUNDS4( msg2, msg3, msg1, 10 )
+      SHA256_ROUNDS4( msg3, msg0, msg2, 11 )
+      SHA256_ROUNDS4( msg0, msg1, msg3, 12 )
+
+      /* Rounds 52-55 */
+      SHA256_ROUNDS4_BEGIN( msg1, 13 )
+      tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+      msg2 = _mm_add_epi32( msg2, tmp );
+      msg2 = _mm_sha256msg2_epu32( msg2, msg1 );
+      SHA256_ROUNDS4_END()
+
+      /* Rounds 56-59 */
+      SHA256_ROUNDS4_BEGIN( msg2, 14 )
+      tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+      msg3 = _mm_add_epi32( msg3, tmp );
+      msg3 = _mm_sha256msg2_epu32( msg3, msg2 );
+      SHA256_ROUNDS4_END()
+
+      /* Rounds 60-63 */
+      SHA256_ROUNDS4_BEGIN( msg3, 15 )
+      SHA256_ROUNDS4_END()
+
+      /* Combine state */
+      state0 = _mm_add_epi32( state0, abef_save );
+      state1 = _mm_add_epi32( state1, cdgh_save );
+
+      data += 64;
+   }
+
+   tmp = _mm_shuffle_epi32( state0, 0x1B );         /* FEBA */
+   state1 = _mm_shuffle_epi32( state1, 0xB1 );      /* DCHG */
+   state0 = _mm_blend_epi16( tmp, state1, 0xF0 );   /* DCBA */
+   state1 = _mm_alignr_epi8( state1, tmp, 8 );      /* ABEF */
+
+   _mm_storeu_si128( (__m128i*) state, state0 );
+   _mm_storeu_si128( (__m128i*) (state + 4), state1 );
+}
+
+#else
+
+int sha_accel_available(void)
+{
+   return 0;
+}
+
+void sha1_accel_blocks(word32 *, const byte *, word32)
+{
+}
+
+void sha256_accel_blocks(word32 *, const byte *, word32)
+{
+}
+
+#endif
+
+/* end of sha_accel.cpp */
@@ -0,0 +1,46 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: sha_accel.h
+
+   Hardware accelerated SHA-1 and SHA-256 block functions.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 14:02:37 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Hardware accelerated SHA-1 and SHA-256 block functions.
+
+   The functions use the x86 SHA extensions (SHA-NI) when the compiler
+   supports them and the CPU running the code provides them; the check
+   is performed once at runtime. When the acceleration is not available,
+   the portable code in sha1.cpp and sha256_sha224.cpp is used.
+*/
+
+#ifndef _SHA_ACCEL_H
+#define _SHA_ACCEL_H
+
+#include "hash_defs.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+   ( defined(__clang__) || ( defined(__GNUC__) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+#  define FALCON_HASH_SHA_NI
+#endif
+
+/* Returns nonzero if the accelerated block functions can be used. */
+int sha_accel_available(void);
+
+/* Processes nblocks 64 bytes blocks, updating the 5 words SHA-1 state. */
+void sha1_accel_blocks(word32 *state, const byte *data, word32 nblocks);
+
+/* Processes nblocks 64 bytes blocks, updating the 8 words SHA-256/224 state. */
+void sha256_accel_blocks(word32 *state, const byte *data, word32 nblocks);
+
+#endif
+
+/* end of sha_accel.h */
@@ -102,6 +102,7 @@ FALCON_MODULE_DECL
                  privileges not owned by the process.
       - @b accept: The network system failed while accepting an incoming connection.
                  This usually means that the accepting thread has become unavailable.
+      - @b poll: The system failed while waiting on a @a Poller.
    */
    Falcon::Symbol *c_errcode = self->addClass( "NetErrorCode" );
    self->addClassProperty( c_errcode, "generic").setInteger( FALSOCK_ERR_GENERIC );
@@ -112,6 +113,7 @@ FALCON_MODULE_DECL
    self->addClassProperty( c_errcode, "close").setInteger( FALSOCK_ERR_CLOSE );
    self->addClassProperty( c_errcode, "bind").setInteger( FALSOCK_ERR_BIND );
    self->addClassProperty( c_errcode, "accept").setInteger( FALSOCK_ERR_ACCEPT );
+   self->addClassProperty( c_errcode, "poll").setInteger( FALSOCK_ERR_POLL );
 
 
    //====================================
@@ -194,6 +196,27 @@ FALCON_MODULE_DECL
       addParam("timeout");
    self->addClassProperty( tcpserver, "lastError" );
 
+   //====================================
+   // Poller
+   Falcon::Symbol *c_pollev = self->addClass( "PollEvent" );
+   self->addClassProperty( c_pollev, "read").setInteger( Falcon::Sys::Poller::e_read );
+   self->addClassProperty( c_pollev, "write").setInteger( Falcon::Sys::Poller::e_write );
+   self->addClassProperty( c_pollev, "error").setInteger( Falcon::Sys::Poller::e_error );
+   self->addClassProperty( c_pollev, "hangup").setInteger( Falcon::Sys::Poller::e_hangup );
+   self->addClassProperty( c_pollev, "edge").setInteger( Falcon::Sys::Poller::e_edge );
+   self->addClassProperty( c_pollev, "oneshot").setInteger( Falcon::Sys::Poller::e_oneshot );
+
+   Falcon::Symbol *poller = self->addClass( "Poller", Falcon::Ext::Poller_init );
+   self->addClassMethod( poller, "add", Falcon::Ext::Poller_add ).asSymbol()->
+      addParam("object")->addParam("events");
+   self->addClassMethod( poller, "modify", Falcon::Ext::Poller_modify ).asSymbol()->
+      addParam("object")->addParam("events");
+   self->addClassMethod( poller, "remove", Falcon::Ext::Poller_remove ).asSymbol()->
+      addParam("object");
+   self->addClassMethod( poller, "wait", Falcon::Ext::Poller_wait ).asSymbol()->
+      addParam("timeout");
+   self->addClassMethod( poller, "count", Falcon::Ext::Poller_count );
+
    //==================================================
    // Error class
 
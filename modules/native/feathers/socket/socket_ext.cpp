@@ -1650,6 +1650,264 @@ FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
 }
 
 
+/*#
+   @class Poller
+   @brief Waits for readiness of many sockets at once.
+   @raise NetError if the system resources for the poller can't be created.
+
+   A Poller holds a set of @a TCPSocket, @a UDPSocket, @a TCPServer instances,
+   and of file based streams (as the pipes of a child process opened through
+   the process module), and waits for some of them to be ready for reading or
+   writing. This allows a single script to serve many connections without
+   checking them one by one.
+
+   On Linux, the poller is based on epoll, and it can handle any number of
+   objects; the cost of a wait depends on the count of ready objects, not on
+   the count of the registered ones. On other systems, poll() or select()
+   are used; on MS-Windows only sockets can be added, and at most 64 of them.
+
+   The events an object is registered for are a combination of the values
+   of the @a PollEvent enumeration. When @b PollEvent.edge is given, the
+   object is reported only when it becomes ready (the data must be read
+   until the operation would block before the object is reported again).
+   When @b PollEvent.oneshot is given, the object is reported only once, and
+   must be rearmed through @a Poller.modify.
+
+   @code
+      load socket
+
+      srv = TCPServer()
+      srv.bind( "8080" )
+      poller = Poller()
+      poller.add( srv, PollEvent.read )
+
+      loop
+         for entry in poller.wait()
+            obj, events = entry
+            if obj == srv
+               poller.add( srv.accept(), PollEvent.read )
+            elif events && (PollEvent.hangup || PollEvent.error)
+               poller.remove( obj )
+               obj.close()
+            else
+               data = obj.recv( 4096 )
+               ...
+            end
+         end
+      end
+   @endcode
+
+   Objects must be removed from the poller before they are closed, or
+   they will be kept alive by the poller. A socket disposed while registered
+   is not reported anymore, and the system descriptor it had can be
+   registered again for another object.
+*/
+
+/*#
+   @enum PollEvent
+   @brief Events and modes for @a Poller.
+
+   - @b read: The object has data to be read (or a connection to be accepted).
+   - @b write: The object can be written without blocking.
+   - @b error: An error condition is pending on the object (reported only).
+   - @b hangup: The remote side has closed the connection (reported only).
+   - @b edge: Edge triggered mode (registration only).
+   - @b oneshot: One-shot mode (registration only).
+*/
+
+FALCON_FUNC  Poller_init( ::Falcon::VMachine *vm )
+{
+   Sys::Poller *poller = new Sys::Poller;
+   CoreObject *self = vm->self().asObject();
+   self->setUserData( poller );
+
+   if ( poller->lastError() != 0 )
+   {
+      throw  new NetError( ErrorParam( FALSOCK_ERR_CREATE, __LINE__ )
+         .desc( FAL_STR( sk_msg_errcreate ) )
+         .sysError( (uint32) poller->lastError() ) );
+   }
+}
+
+static void s_pollerUpdate( ::Falcon::VMachine *vm, bool bAdd )
+{
+   Item *i_obj = vm->param( 0 );
+   Item *i_events = vm->param( 1 );
+
+   if ( i_obj == 0 || ! i_obj->isObject()
+      || ( i_events != 0 && ! ( i_events->isNil() || i_events->isOrdinal() ) ) )
+   {
+      throw  new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "O, [N]" ) );
+   }
+
+   int32 events = i_events == 0 || i_events->isNil() ?
+         (int32) Sys::Poller::e_read : (int32) i_events->forceInteger();
+
+   Sys::Poller *poller = (Sys::Poller *) vm->self().asObject()->getUserData();
+   CoreObject *obj = i_obj->asObject();
+
+   // servers must be listening to be reported ready.
+   Sys::ServerSocket *srv = dynamic_cast<Sys::ServerSocket *>( obj->getFalconData() );
+   if ( srv != 0 && ! srv->listen() )
+   {
+      obj->setProperty( "lastError", srv->lastError() );
+      throw  new NetError( ErrorParam( FALSOCK_ERR_ACCEPT, __LINE__ )
+         .desc( FAL_STR( sk_msg_erraccept ) )
+         .sysError( (uint32) srv->lastError() ) );
+   }
+
+   bool bDone = bAdd ? poller->add( obj, events ) : poller->modify( obj, events );
+
+   if ( ! bDone )
+   {
+      if ( poller->lastError() == 0 )
+      {
+         throw  new ParamError( ErrorParam( e_param_type, __LINE__ ).
+            desc( FAL_STR( sk_msg_notpollable ) ) );
+      }
+
+      throw  new NetError( ErrorParam( FALSOCK_ERR_POLL, __LINE__ )
+         .desc( FAL_STR( sk_msg_errpoll ) )
+         .sysError( (uint32) poller->lastError() ) );
+   }
+}
+
+/*#
+   @method add Poller
+   @brief Registers an object in the poller.
+   @param object A socket, a server or a file based stream.
+   @optparam events Events to wait for (defaults to PollEvent.read).
+   @raise ParamError if the object can't be polled or it's already registered.
+   @raise NetError on system error.
+
+   @see PollEvent
+*/
+FALCON_FUNC  Poller_add( ::Falcon::VMachine *vm )
+{
+   s_pollerUpdate( vm, true );
+}
+
+/*#
+   @method modify Poller
+   @brief Changes the events an object is registered for.
+   @param object A registered object.
+   @optparam events Events to wait for (defaults to PollEvent.read).
+   @raise ParamError if the object is not registered in this poller.
+   @raise NetError on system error.
+
+   This is also used to rearm objects registered in one-shot mode.
+*/
+FALCON_FUNC  Poller_modify( ::Falcon::VMachine *vm )
+{
+   s_pollerUpdate( vm, false );
+}
+
+/*#
+   @method remove Poller
+   @brief Removes an object from the poller.
+   @param object The object to be removed.
+   @return True if the object was registered, false otherwise.
+   @raise NetError on system error.
+*/
+FALCON_FUNC  Poller_remove( ::Falcon::VMachine *vm )
+{
+   Item *i_obj = vm->param( 0 );
+   if ( i_obj == 0 || ! i_obj->isObject() )
+   {
+      throw  new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "O" ) );
+   }
+
+   Sys::Poller *poller = (Sys::Poller *) vm->self().asObject()->getUserData();
+   if ( poller->remove( i_obj->asObject() ) )
+   {
+      vm->regA().setBoolean( true );
+      return;
+   }
+
+   if ( poller->lastError() != 0 )
+   {
+      throw  new NetError( ErrorParam( FALSOCK_ERR_POLL, __LINE__ )
+         .desc( FAL_STR( sk_msg_errpoll ) )
+         .sysError( (uint32) poller->lastError() ) );
+   }
+
+   vm->regA().setBoolean( false );
+}
+
+/*#
+   @method wait Poller
+   @brief Waits for some of the registered objects to be ready.
+   @optparam timeout Maximum wait in seconds or fractions; wait forever if not given or negative.
+   @return An array of pairs [object, events]; empty on timeout.
+   @raise NetError on system error.
+   @raise InterruptedError in case of asynchronous interruption.
+
+   The events in each pair are a combination of @a PollEvent values.
+   Other threads can proceed while the VM is waiting.
+*/
+FALCON_FUNC  Poller_wait( ::Falcon::VMachine *vm )
+{
+   Item *to = vm->param( 0 );
+   if ( to != 0 && ! ( to->isNil() || to->isOrdinal() ) )
+   {
+      throw  new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "[N]" ) );
+   }
+
+   int64 timeout = to == 0 || to->isNil() ? -1 : int64(to->forceNumeric() * 1000.0);
+   if ( timeout < 0 )
+      timeout = -1;
+
+   Sys::Poller *poller = (Sys::Poller *) vm->self().asObject()->getUserData();
+
+   if ( timeout != 0 ) vm->idle();
+   int32 count = poller->wait( (int32) timeout, &vm->systemData() );
+   if ( timeout != 0 ) vm->unidle();
+
+   if ( count == -2 )
+   {
+      vm->interrupted( true, true, true );
+      return;
+   }
+
+   if ( count < 0 )
+   {
+      throw  new NetError( ErrorParam( FALSOCK_ERR_POLL, __LINE__ )
+         .desc( FAL_STR( sk_msg_errpoll ) )
+         .sysError( (uint32) poller->lastError() ) );
+   }
+
+   CoreArray *res = new CoreArray( count );
+   for ( int32 i = 0; i < count; ++i )
+   {
+      int32 events;
+      CoreObject *obj = poller->ready( i, events );
+      if ( obj == 0 )
+         continue;
+
+      CoreArray *pair = new CoreArray( 2 );
+      pair->append( obj );
+      pair->append( (int64) events );
+      res->append( pair );
+   }
+
+   vm->retval( res );
+}
+
+/*#
+   @method count Poller
+   @brief Returns the number of objects registered in the poller.
+   @return Count of registered objects.
+*/
+FALCON_FUNC  Poller_count( ::Falcon::VMachine *vm )
+{
+   Sys::Poller *poller = (Sys::Poller *) vm->self().asObject()->getUserData();
+   vm->retval( (int64) poller->size() );
+}
+
+
 /*#
    @class NetError
    @brief Error generated by network related system failures.
@@ -39,6 +39,7 @@
 #define FALSOCK_ERR_CLOSE  (FALCON_SOCKET_ERROR_BASE + 6)
 #define FALSOCK_ERR_BIND  (FALCON_SOCKET_ERROR_BASE + 7)
 #define FALSOCK_ERR_ACCEPT  (FALCON_SOCKET_ERROR_BASE + 8)
+#define FALSOCK_ERR_POLL  (FALCON_SOCKET_ERROR_BASE + 9)
 
 #if WITH_OPENSSL
 #define FALSOCK_ERR_SSLCONFIG (FALCON_SOCKET_ERROR_BASE + 10)
@@ -103,6 +104,17 @@ FALCON_FUNC  TCPServer_dispose( ::Falcon::VMachine *vm );
 FALCON_FUNC  TCPServer_bind( ::Falcon::VMachine *vm );
 FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm );
 
+// ==============================================
+// Class Poller
+// ==============================================
+
+FALCON_FUNC  Poller_init( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_add( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_modify( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_remove( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_wait( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_count( ::Falcon::VMachine *vm );
+
 class NetError: public ::Falcon::Error
 {
 public:
@@ -23,6 +23,7 @@
 
 #include <falcon/string.h>
 #include <falcon/falcondata.h>
+#include <falcon/genericmap.h>
 #include <falcon/vm_sys.h>
 
 #if WITH_OPENSSL
@@ -32,6 +33,9 @@
 #endif // WITH_OPENSSL
 
 namespace Falcon {
+
+class CoreObject;
+
 namespace Sys {
 
 //================================================
@@ -79,6 +83,7 @@ class Address
    int64 m_lastError;
 
    friend class Socket;
+   friend class Poller;
    friend class TCPSocket;
    friend class UDPSocket;
    friend class ServerSocket;
@@ -183,6 +188,8 @@ protected:
    int32 m_boundFamily;
    volatile int32 *m_refcount;
 
+   friend class Poller;
+   friend class ServerSocket;
 
    Socket():
       m_lastError(0),
@@ -455,12 +462,96 @@ public:
    ServerSocket( bool ipv6 = true );
    ~ServerSocket();
 
+   /** Starts listening for incoming connections, if not listening yet.
+      This is done by the first accept(), but pollers need it before.
+   */
+   bool listen();
+
    /** Accepts incoming calls.
       Returns a TCP socket on success, null if no new incoming data is arriving.
    */
    TCPSocket *accept();
 };
 
+//================================================
+// Poller
+//================================================
+/** Waits for readiness of many sockets and streams at once.
+
+   The poller keeps a set of script objects (sockets, servers or file
+   based streams, as the pipes of child processes) and reports which of
+   them are ready for the operations they have been registered for.
+
+   Where available (Linux), the poller is backed by epoll, and has no
+   limit on the number of descriptors; each wait costs proportionally
+   to the number of ready descriptors, not to the registered ones. Other
+   systems use poll() or select(); there, edge triggered mode is
+   reported as level triggered, and one-shot mode is emulated.
+
+   The registered objects are kept alive by the poller until removed.
+   Objects closed while registered are not reported anymore, and their
+   descriptor can be registered again for another object.
+*/
+class Poller: public Falcon::FalconData
+{
+public:
+   typedef enum {
+      e_read = 1,
+      e_write = 2,
+      e_error = 4,
+      e_hangup = 8,
+      /** Report only transitions to readiness. */
+      e_edge = 16,
+      /** Disarm the object after it is reported ready; modify() rearms it. */
+      e_oneshot = 32
+   } t_events;
+
+   Poller();
+   virtual ~Poller();
+
+   /** Registers an object for the given events.
+      \return false on error; if lastError() is 0, the object can't be polled
+         (it's not a socket or a file based stream, or it's already registered).
+   */
+   bool add( CoreObject *owner, int32 events );
+
+   /** Changes the events an object is registered for, rearming one-shot objects. */
+   bool modify( CoreObject *owner, int32 events );
+
+   /** Removes an object from the poller. */
+   bool remove( CoreObject *owner );
+
+   /** Waits for some of the registered objects to be ready.
+      \return The count of ready objects, 0 on timeout, -1 on error and -2
+         if the wait has been interrupted.
+   */
+   int32 wait( int32 msec, const Sys::SystemData *sysData = 0 );
+
+   /** Returns the pos-th object found ready by the last wait() and its events. */
+   CoreObject *ready( int32 pos, int32 &events ) const;
+
+   uint32 size() const { return m_owners.size(); }
+   int64 lastError() const { return m_lastError; }
+
+   virtual void gcMark( uint32 mark );
+   virtual FalconData *clone() const;
+
+private:
+   void *m_sysData;
+   Map m_owners; // descriptor -> CoreObject*
+   int64 m_lastError;
+
+   /** Gets the system descriptor of a pollable object. */
+   static bool descriptor( CoreObject *owner, int32 &fd );
+   CoreObject *owner( int32 fd ) const;
+
+   /** Checks if the object registered for a descriptor has been closed
+      without being removed, so that the descriptor may now belong to
+      another object.
+   */
+   bool stale( int32 fd ) const;
+};
+
 }
 }
 
@@ -18,6 +18,7 @@
  */
 
 #include <falcon/module.h>
+#include <falcon/coreobject.h>
 #include "socket_ext.h"
 #include "socket_sys.h"
 #include "socket_st.h"
@@ -70,6 +71,43 @@ FalconData* TCPSocket::clone() const
    return new TCPSocket(*this);
 }
 
+// =================================================
+// Poller.
+
+CoreObject *Poller::owner( int32 fd ) const
+{
+   CoreObject **pobj = (CoreObject **) m_owners.find( &fd );
+   return pobj == 0 ? 0 : *pobj;
+}
+
+
+bool Poller::stale( int32 fd ) const
+{
+   CoreObject *obj = owner( fd );
+   int32 ownFd;
+   return obj != 0 && ( ! descriptor( obj, ownFd ) || ownFd != fd );
+}
+
+
+void Poller::gcMark( uint32 mark )
+{
+   MapIterator iter = m_owners.begin();
+   while( iter.hasCurrent() )
+   {
+      CoreObject *obj = *(CoreObject **) iter.currentValue();
+      if ( obj->mark() != mark )
+         obj->gcMark( mark );
+      iter.next();
+   }
+}
+
+
+FalconData *Poller::clone() const
+{
+   // the system resources of the poller can't be shared.
+   return 0;
+}
+
 } // namespace Sys
 } // namespace Falcon
 
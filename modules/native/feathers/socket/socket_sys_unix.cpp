@@ -25,6 +25,8 @@
 #include <unistd.h>
 #include <falcon/autocstring.h>
 #include <falcon/vm_sys_posix.h>
+#include <falcon/fstream_sys_unix.h>
+#include <falcon/coreobject.h>
 
 #include <netdb.h>
 #include <errno.h>
@@ -32,6 +34,14 @@
 #include <string.h>
 #include "socket_sys.h"
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#define FALCON_SOCKET_EPOLL
+#endif
+
+// maximum count of events retrieved by a single poller wait.
+#define POLLER_MAX_EVENTS 4096
+
 // Sun doesn't provide strerror_r
 #if ( defined (__SUNPRO_CC) && __SUNPRO_CC <= 0x580 )
 static int strerror_r(int errnum, char * buf, unsigned n)
@@ -978,18 +988,26 @@ ServerSocket::~ServerSocket()
 {
 }
 
-TCPSocket *ServerSocket::accept()
+bool ServerSocket::listen()
 {
-   int srv = (int) d.m_iSystemData;
-
    if ( ! m_bListening ) {
-      if ( ::listen( srv, SOMAXCONN ) != 0 ) {
+      if ( ::listen( (int) d.m_iSystemData, SOMAXCONN ) != 0 ) {
          m_lastError = errno;
-         return 0;
+         return false;
       }
       m_bListening = true;
    }
 
+   return true;
+}
+
+TCPSocket *ServerSocket::accept()
+{
+   int srv = (int) d.m_iSystemData;
+
+   if ( ! listen() )
+      return 0;
+
    if ( s_select( srv, m_timeout, 0 ) ) {
       socklen_t addrlen;
       struct sockaddr *address;
@@ -1006,7 +1024,8 @@ TCPSocket *ServerSocket::accept()
       }
 
       int skt = ::accept( srv, address, &addrlen );
-      TCPSocket *s = new TCPSocket( (void *) &skt );
+      TCPSocket *s = new TCPSocket( (void *) 0 );
+      s->d.m_iSystemData = skt;
 
       char hostName[64];
       char servName[64];
@@ -1143,6 +1162,487 @@ int32 UDPSocket::sendTo( byte *buffer, int32 size, Address &where )
    return retsize;
 }
 
+//================================================
+// Poller
+//================================================
+
+bool Poller::descriptor( CoreObject *owner, int32 &fd )
+{
+   FalconData *data = owner->getFalconData();
+   if ( data == 0 )
+      return false;
+
+   Socket *skt = dynamic_cast<Socket *>( data );
+   if ( skt != 0 )
+   {
+      fd = skt->d.m_iSystemData;
+      return fd != 0;
+   }
+
+   BaseFileStream *fs = dynamic_cast<BaseFileStream *>( data );
+   // closed streams keep the number of their former descriptor.
+   if ( fs != 0 && fs->getFileSysData() != 0 && ( fs->open() || ! fs->good() ) )
+   {
+      fd = static_cast<const UnixFileSysData *>( fs->getFileSysData() )->m_handle;
+      return fd >= 0;
+   }
+
+   return false;
+}
+
+#ifdef FALCON_SOCKET_EPOLL
+
+struct PollerData
+{
+   int epfd;
+   // interrupt pipe of the VM currently registered, or -1.
+   int intrFd;
+   struct epoll_event *events;
+   int32 allocated;
+   int32 readyCount;
+};
+
+static uint32 s_toEpoll( int32 events )
+{
+   uint32 ev = 0;
+   if ( events & Poller::e_read ) ev |= EPOLLIN;
+   if ( events & Poller::e_write ) ev |= EPOLLOUT;
+   if ( events & Poller::e_edge ) ev |= EPOLLET;
+   if ( events & Poller::e_oneshot ) ev |= EPOLLONESHOT;
+   return ev;
+}
+
+static int32 s_fromEpoll( uint32 ev )
+{
+   int32 events = 0;
+   if ( ev & EPOLLIN ) events |= Poller::e_read;
+   if ( ev & EPOLLOUT ) events |= Poller::e_write;
+   if ( ev & EPOLLERR ) events |= Poller::e_error;
+   if ( ev & EPOLLHUP ) events |= Poller::e_hangup;
+   return events;
+}
+
+Poller::Poller():
+   m_owners( &traits::t_int(), &traits::t_voidp() ),
+   m_lastError( 0 )
+{
+   PollerData *pd = new PollerData;
+   pd->epfd = epoll_create( 64 );
+   pd->intrFd = -1;
+   pd->events = 0;
+   pd->allocated = 0;
+   pd->readyCount = 0;
+   m_sysData = pd;
+
+   if ( pd->epfd == -1 )
+      m_lastError = errno;
+   else
+      fcntl( pd->epfd, F_SETFD, FD_CLOEXEC );
+}
+
+Poller::~Poller()
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   if ( pd->epfd != -1 )
+      ::close( pd->epfd );
+   if ( pd->events != 0 )
+      memFree( pd->events );
+   delete pd;
+}
+
+bool Poller::add( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( pd->epfd == -1 || ! descriptor( obj, fd ) || owner( fd ) == obj )
+      return false;
+
+   struct epoll_event ev;
+   memset( &ev, 0, sizeof( ev ) );
+   ev.events = s_toEpoll( events );
+   ev.data.fd = fd;
+   if ( epoll_ctl( pd->epfd, EPOLL_CTL_ADD, fd, &ev ) != 0 )
+   {
+      // EEXIST: another object sharing the descriptor is registered.
+      if ( errno != EEXIST )
+         m_lastError = errno;
+      return false;
+   }
+
+   // The system forgets closed descriptors by itself; if the descriptor
+   // is still in the map, its former object was closed without being removed.
+   m_owners.erase( &fd );
+   m_owners.insert( &fd, obj );
+   return true;
+}
+
+bool Poller::modify( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+      return false;
+
+   struct epoll_event ev;
+   memset( &ev, 0, sizeof( ev ) );
+   ev.events = s_toEpoll( events );
+   ev.data.fd = fd;
+   if ( epoll_ctl( pd->epfd, EPOLL_CTL_MOD, fd, &ev ) != 0 )
+   {
+      m_lastError = errno;
+      return false;
+   }
+
+   return true;
+}
+
+bool Poller::remove( CoreObject *obj )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+   {
+      // the object may have been closed in the meanwhile; the system
+      // has already forgot its descriptor.
+      MapIterator iter = m_owners.begin();
+      while( iter.hasCurrent() )
+      {
+         if ( *(CoreObject **) iter.currentValue() == obj )
+         {
+            m_owners.erase( iter );
+            return true;
+         }
+         iter.next();
+      }
+      return false;
+   }
+
+   struct epoll_event ev;
+   if ( epoll_ctl( pd->epfd, EPOLL_CTL_DEL, fd, &ev ) != 0 && errno != EBADF && errno != ENOENT )
+   {
+      m_lastError = errno;
+      return false;
+   }
+
+   m_owners.erase( &fd );
+   return true;
+}
+
+int32 Poller::wait( int32 msec, const Sys::SystemData *sysData )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+   pd->readyCount = 0;
+
+   // The interrupt pipe stays registered as long as the same VM waits on us.
+   int intrFd = sysData == 0 ? -1 : sysData->m_sysData->interruptPipe[0];
+   if ( intrFd != pd->intrFd )
+   {
+      struct epoll_event ev;
+      memset( &ev, 0, sizeof( ev ) );
+      if ( pd->intrFd != -1 )
+         epoll_ctl( pd->epfd, EPOLL_CTL_DEL, pd->intrFd, &ev );
+      pd->intrFd = -1;
+
+      if ( intrFd != -1 )
+      {
+         ev.events = EPOLLIN;
+         ev.data.fd = intrFd;
+         if ( epoll_ctl( pd->epfd, EPOLL_CTL_ADD, intrFd, &ev ) != 0 )
+         {
+            m_lastError = errno;
+            return -1;
+         }
+         pd->intrFd = intrFd;
+      }
+   }
+
+   int32 maxEvents = (int32) m_owners.size() + 1;
+   if ( maxEvents > POLLER_MAX_EVENTS )
+      maxEvents = POLLER_MAX_EVENTS;
+   if ( maxEvents > pd->allocated )
+   {
+      pd->events = (struct epoll_event *) memRealloc( pd->events, maxEvents * sizeof( struct epoll_event ) );
+      pd->allocated = maxEvents;
+   }
+
+   int count;
+   while( ( count = epoll_wait( pd->epfd, pd->events, maxEvents, msec ) ) == -1 && errno == EINTR );
+
+   if ( count < 0 )
+   {
+      m_lastError = errno;
+      return -1;
+   }
+
+   bool bInterrupted = false;
+   int32 ready = 0;
+   for ( int i = 0; i < count; ++i )
+   {
+      if ( pd->events[i].data.fd == pd->intrFd )
+         bInterrupted = true;
+      else
+         pd->events[ready++] = pd->events[i];
+   }
+
+   // ready objects are reported first; the interruption will be seen at next wait.
+   pd->readyCount = ready;
+   if ( ready == 0 && bInterrupted )
+      return -2;
+
+   return ready;
+}
+
+CoreObject *Poller::ready( int32 pos, int32 &events ) const
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   if ( pos < 0 || pos >= pd->readyCount )
+      return 0;
+
+   events = s_fromEpoll( pd->events[pos].events );
+   return owner( pd->events[pos].data.fd );
+}
+
+#else
+
+// poll() based poller, for systems without epoll.
+// Entry 0 is reserved for the interrupt pipe; disarmed one-shot entries
+// have a negative descriptor, that poll() ignores.
+struct PollerData
+{
+   struct pollfd *fds;
+   int *descs;
+   int32 *modes;
+   int32 count;
+   int32 allocated;
+
+   int *readyDescs;
+   int32 *readyEvents;
+   int32 readyCount;
+};
+
+static short s_toPoll( int32 events )
+{
+   short ev = 0;
+   if ( events & Poller::e_read ) ev |= POLLIN;
+   if ( events & Poller::e_write ) ev |= POLLOUT;
+   return ev;
+}
+
+static int32 s_fromPoll( short ev )
+{
+   int32 events = 0;
+   if ( ev & POLLIN ) events |= Poller::e_read;
+   if ( ev & POLLOUT ) events |= Poller::e_write;
+   if ( ev & ( POLLERR | POLLNVAL ) ) events |= Poller::e_error;
+   if ( ev & POLLHUP ) events |= Poller::e_hangup;
+   return events;
+}
+
+static int32 s_findDesc( PollerData *pd, int fd )
+{
+   for ( int32 i = 1; i <= pd->count; ++i )
+   {
+      if ( pd->descs[i] == fd )
+         return i;
+   }
+   return -1;
+}
+
+Poller::Poller():
+   m_owners( &traits::t_int(), &traits::t_voidp() ),
+   m_lastError( 0 )
+{
+   PollerData *pd = new PollerData;
+   pd->allocated = 16;
+   pd->fds = (struct pollfd *) memAlloc( pd->allocated * sizeof( struct pollfd ) );
+   pd->descs = (int *) memAlloc( pd->allocated * sizeof( int ) );
+   pd->modes = (int32 *) memAlloc( pd->allocated * sizeof( int32 ) );
+   pd->readyDescs = (int *) memAlloc( pd->allocated * sizeof( int ) );
+   pd->readyEvents = (int32 *) memAlloc( pd->allocated * sizeof( int32 ) );
+   pd->count = 0;
+   pd->readyCount = 0;
+   pd->fds[0].fd = -1;
+   pd->fds[0].events = POLLIN;
+   m_sysData = pd;
+}
+
+Poller::~Poller()
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   memFree( pd->fds );
+   memFree( pd->descs );
+   memFree( pd->modes );
+   memFree( pd->readyDescs );
+   memFree( pd->readyEvents );
+   delete pd;
+}
+
+bool Poller::add( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) == obj )
+      return false;
+
+   if ( owner( fd ) != 0 )
+   {
+      if ( ! stale( fd ) )
+         return false;
+
+      // take the entry of the object closed without being removed.
+      int32 pos = s_findDesc( pd, fd );
+      pd->fds[pos].fd = fd;
+      pd->fds[pos].events = s_toPoll( events );
+      pd->fds[pos].revents = 0;
+      pd->modes[pos] = events;
+
+      m_owners.erase( &fd );
+      m_owners.insert( &fd, obj );
+      return true;
+   }
+
+   if ( pd->count + 1 == pd->allocated )
+   {
+      pd->allocated *= 2;
+      pd->fds = (struct pollfd *) memRealloc( pd->fds, pd->allocated * sizeof( struct pollfd ) );
+      pd->descs = (int *) memRealloc( pd->descs, pd->allocated * sizeof( int ) );
+      pd->modes = (int32 *) memRealloc( pd->modes, pd->allocated * sizeof( int32 ) );
+      pd->readyDescs = (int *) memRealloc( pd->readyDescs, pd->allocated * sizeof( int ) );
+      pd->readyEvents = (int32 *) memRealloc( pd->readyEvents, pd->allocated * sizeof( int32 ) );
+   }
+
+   int32 pos = ++pd->count;
+   pd->fds[pos].fd = fd;
+   pd->fds[pos].events = s_toPoll( events );
+   pd->fds[pos].revents = 0;
+   pd->descs[pos] = fd;
+   pd->modes[pos] = events;
+
+   m_owners.insert( &fd, obj );
+   return true;
+}
+
+bool Poller::modify( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+      return false;
+
+   int32 pos = s_findDesc( pd, fd );
+   pd->fds[pos].fd = fd;
+   pd->fds[pos].events = s_toPoll( events );
+   pd->modes[pos] = events;
+   return true;
+}
+
+bool Poller::remove( CoreObject *obj )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd = -1;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+   {
+      // the object may have been closed in the meanwhile; search it.
+      fd = -1;
+      MapIterator iter = m_owners.begin();
+      while( iter.hasCurrent() )
+      {
+         if ( *(CoreObject **) iter.currentValue() == obj )
+         {
+            fd = *(int32 *) iter.currentKey();
+            break;
+         }
+         iter.next();
+      }
+
+      if ( fd == -1 )
+         return false;
+   }
+
+   int32 pos = s_findDesc( pd, fd );
+   if ( pos != pd->count )
+   {
+      pd->fds[pos] = pd->fds[pd->count];
+      pd->descs[pos] = pd->descs[pd->count];
+      pd->modes[pos] = pd->modes[pd->count];
+   }
+   pd->count--;
+
+   m_owners.erase( &fd );
+   return true;
+}
+
+int32 Poller::wait( int32 msec, const Sys::SystemData *sysData )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+   pd->readyCount = 0;
+
+   pd->fds[0].fd = sysData == 0 ? -1 : sysData->m_sysData->interruptPipe[0];
+   pd->fds[0].revents = 0;
+
+   // the descriptors of closed objects may have been given to other objects.
+   for ( int32 i = 1; i <= pd->count; ++i )
+   {
+      if ( pd->fds[i].fd >= 0 && stale( pd->descs[i] ) )
+         pd->fds[i].fd = -1;
+   }
+
+   int count;
+   while( ( count = poll( pd->fds, pd->count + 1, msec ) ) == -1 && errno == EINTR );
+
+   if ( count < 0 )
+   {
+      m_lastError = errno;
+      return -1;
+   }
+
+   for ( int32 i = 1; i <= pd->count && count > 0; ++i )
+   {
+      if ( pd->fds[i].revents == 0 || pd->fds[i].fd < 0 )
+         continue;
+
+      count--;
+      pd->readyDescs[pd->readyCount] = pd->descs[i];
+      pd->readyEvents[pd->readyCount] = s_fromPoll( pd->fds[i].revents );
+      pd->readyCount++;
+
+      // emulate one-shot mode by disarming the entry.
+      if ( pd->modes[i] & e_oneshot )
+         pd->fds[i].fd = -1;
+   }
+
+   if ( pd->readyCount == 0 && ( pd->fds[0].revents & POLLIN ) != 0 )
+      return -2;
+
+   return pd->readyCount;
+}
+
+CoreObject *Poller::ready( int32 pos, int32 &events ) const
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   if ( pos < 0 || pos >= pd->readyCount )
+      return 0;
+
+   events = pd->readyEvents[pos];
+   return owner( pd->readyDescs[pos] );
+}
+
+#endif
+
 } // namespace
 }
 
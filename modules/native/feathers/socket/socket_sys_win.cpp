@@ -34,6 +34,7 @@
 
 
 
+#include <falcon/coreobject.h>
 #include "socket_sys.h"
 
 namespace Falcon {
@@ -677,18 +678,26 @@ ServerSocket::~ServerSocket()
 {
 }
 
-TCPSocket *ServerSocket::accept()
+bool ServerSocket::listen()
 {
-   SOCKET srv = (SOCKET) d.m_iSystemData;
-
    if ( ! m_bListening ) {
-      if ( ::listen( srv, SOMAXCONN ) != 0 ) {
+      if ( ::listen( (SOCKET) d.m_iSystemData, SOMAXCONN ) != 0 ) {
          m_lastError = WSAGetLastError();
-         return 0;
+         return false;
       }
       m_bListening = true;
    }
 
+   return true;
+}
+
+TCPSocket *ServerSocket::accept()
+{
+   SOCKET srv = (SOCKET) d.m_iSystemData;
+
+   if ( ! listen() )
+      return 0;
+
    if ( s_select( srv, m_timeout, 0 ) ) {
       int addrlen;
       struct sockaddr *address;
@@ -843,6 +852,260 @@ int32 UDPSocket::sendTo( byte *buffer, int32 size, Address &where )
    return retsize;
 }
 
+//================================================
+// Poller
+//================================================
+
+// select() based poller; at most FD_SETSIZE sockets can be waited at once.
+// Disarmed one-shot entries are skipped.
+struct PollerData
+{
+   SOCKET *socks;
+   int32 *modes;
+   bool *armed;
+   int32 count;
+   int32 allocated;
+
+   SOCKET *readySocks;
+   int32 *readyEvents;
+   int32 readyCount;
+};
+
+static int32 s_findSocket( PollerData *pd, SOCKET skt )
+{
+   for ( int32 i = 0; i < pd->count; ++i )
+   {
+      if ( pd->socks[i] == skt )
+         return i;
+   }
+   return -1;
+}
+
+bool Poller::descriptor( CoreObject *owner, int32 &fd )
+{
+   // only sockets can be selected on MS-Windows.
+   Socket *skt = dynamic_cast<Socket *>( owner->getFalconData() );
+   if ( skt == 0 || skt->d.m_iSystemData == 0 )
+      return false;
+
+   fd = (int32) skt->d.m_iSystemData;
+   return true;
+}
+
+Poller::Poller():
+   m_owners( &traits::t_int(), &traits::t_voidp() ),
+   m_lastError( 0 )
+{
+   PollerData *pd = new PollerData;
+   pd->allocated = 16;
+   pd->socks = (SOCKET *) memAlloc( pd->allocated * sizeof( SOCKET ) );
+   pd->modes = (int32 *) memAlloc( pd->allocated * sizeof( int32 ) );
+   pd->armed = (bool *) memAlloc( pd->allocated * sizeof( bool ) );
+   pd->readySocks = (SOCKET *) memAlloc( pd->allocated * sizeof( SOCKET ) );
+   pd->readyEvents = (int32 *) memAlloc( pd->allocated * sizeof( int32 ) );
+   pd->count = 0;
+   pd->readyCount = 0;
+   m_sysData = pd;
+}
+
+Poller::~Poller()
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   memFree( pd->socks );
+   memFree( pd->modes );
+   memFree( pd->armed );
+   memFree( pd->readySocks );
+   memFree( pd->readyEvents );
+   delete pd;
+}
+
+bool Poller::add( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) == obj )
+      return false;
+
+   if ( owner( fd ) != 0 )
+   {
+      if ( ! stale( fd ) )
+         return false;
+
+      // take the entry of the object closed without being removed.
+      int32 pos = s_findSocket( pd, (SOCKET) fd );
+      pd->modes[pos] = events;
+      pd->armed[pos] = true;
+
+      m_owners.erase( &fd );
+      m_owners.insert( &fd, obj );
+      return true;
+   }
+
+   if ( pd->count >= FD_SETSIZE )
+   {
+      m_lastError = WSAENOBUFS;
+      return false;
+   }
+
+   if ( pd->count == pd->allocated )
+   {
+      pd->allocated *= 2;
+      pd->socks = (SOCKET *) memRealloc( pd->socks, pd->allocated * sizeof( SOCKET ) );
+      pd->modes = (int32 *) memRealloc( pd->modes, pd->allocated * sizeof( int32 ) );
+      pd->armed = (bool *) memRealloc( pd->armed, pd->allocated * sizeof( bool ) );
+      pd->readySocks = (SOCKET *) memRealloc( pd->readySocks, pd->allocated * sizeof( SOCKET ) );
+      pd->readyEvents = (int32 *) memRealloc( pd->readyEvents, pd->allocated * sizeof( int32 ) );
+   }
+
+   pd->socks[pd->count] = (SOCKET) fd;
+   pd->modes[pd->count] = events;
+   pd->armed[pd->count] = true;
+   pd->count++;
+
+   m_owners.insert( &fd, obj );
+   return true;
+}
+
+bool Poller::modify( CoreObject *obj, int32 events )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+      return false;
+
+   int32 pos = s_findSocket( pd, (SOCKET) fd );
+   pd->modes[pos] = events;
+   pd->armed[pos] = true;
+   return true;
+}
+
+bool Poller::remove( CoreObject *obj )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+
+   int32 fd = 0;
+   if ( ! descriptor( obj, fd ) || owner( fd ) != obj )
+   {
+      // the object may have been closed in the meanwhile; search it.
+      fd = 0;
+      MapIterator iter = m_owners.begin();
+      while( iter.hasCurrent() )
+      {
+         if ( *(CoreObject **) iter.currentValue() == obj )
+         {
+            fd = *(int32 *) iter.currentKey();
+            break;
+         }
+         iter.next();
+      }
+
+      if ( fd == 0 )
+         return false;
+   }
+
+   int32 pos = s_findSocket( pd, (SOCKET) fd );
+   pd->count--;
+   if ( pos != pd->count )
+   {
+      pd->socks[pos] = pd->socks[pd->count];
+      pd->modes[pos] = pd->modes[pd->count];
+      pd->armed[pos] = pd->armed[pd->count];
+   }
+
+   m_owners.erase( &fd );
+   return true;
+}
+
+int32 Poller::wait( int32 msec, const Sys::SystemData * )
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   m_lastError = 0;
+   pd->readyCount = 0;
+
+   fd_set rset, wset, eset;
+   FD_ZERO( &rset );
+   FD_ZERO( &wset );
+   FD_ZERO( &eset );
+
+   int armed = 0;
+   for ( int32 i = 0; i < pd->count; ++i )
+   {
+      // select() fails on closed sockets.
+      if ( pd->armed[i] && stale( (int32) pd->socks[i] ) )
+         pd->armed[i] = false;
+
+      if ( ! pd->armed[i] )
+         continue;
+      if ( pd->modes[i] & e_read )
+         FD_SET( pd->socks[i], &rset );
+      if ( pd->modes[i] & e_write )
+         FD_SET( pd->socks[i], &wset );
+      FD_SET( pd->socks[i], &eset );
+      armed++;
+   }
+
+   TIMEVAL tv, *tvp;
+   if ( msec >= 0 ) {
+      tvp = &tv;
+      tv.tv_sec = msec / 1000;
+      tv.tv_usec = (msec % 1000 ) * 1000;
+   }
+   else
+      tvp = 0;
+
+   // select() refuses to wait on empty sets.
+   if ( armed == 0 )
+   {
+      Sleep( msec < 0 ? INFINITE : msec );
+      return 0;
+   }
+
+   int count = select( 0, &rset, &wset, &eset, tvp );
+   if ( count == SOCKET_ERROR )
+   {
+      m_lastError = WSAGetLastError();
+      return -1;
+   }
+
+   for ( int32 i = 0; i < pd->count && count > 0; ++i )
+   {
+      if ( ! pd->armed[i] )
+         continue;
+
+      int32 events = 0;
+      if ( FD_ISSET( pd->socks[i], &rset ) ) events |= e_read;
+      if ( FD_ISSET( pd->socks[i], &wset ) ) events |= e_write;
+      if ( FD_ISSET( pd->socks[i], &eset ) ) events |= e_error;
+      if ( events == 0 )
+         continue;
+
+      pd->readySocks[pd->readyCount] = pd->socks[i];
+      pd->readyEvents[pd->readyCount] = events;
+      pd->readyCount++;
+
+      // emulate one-shot mode by disarming the entry.
+      if ( pd->modes[i] & e_oneshot )
+         pd->armed[i] = false;
+   }
+
+   return pd->readyCount;
+}
+
+CoreObject *Poller::ready( int32 pos, int32 &events ) const
+{
+   PollerData *pd = (PollerData *) m_sysData;
+   if ( pos < 0 || pos >= pd->readyCount )
+      return 0;
+
+   events = pd->readyEvents[pos];
+   return owner( (int32) pd->readySocks[pos] );
+}
+
 } // namespace
 }
 
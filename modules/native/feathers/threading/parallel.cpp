@@ -0,0 +1,419 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: parallel.cpp
+
+   Threading module - parallel map, filter and reduce.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 23:42:18 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Threading module - parallel map, filter and reduce.
+*/
+
+#include <falcon/setup.h>
+#include <falcon/fassert.h>
+#include <falcon/carray.h>
+#include <falcon/garbagelock.h>
+#include <falcon/runtime.h>
+#include <falcon/stringstream.h>
+#include <falcon/rosstream.h>
+
+#include "parallel.h"
+#include "threading_ext.h"
+#include "threading_mod.h"
+#include "threading_st.h"
+
+namespace Falcon {
+namespace Ext {
+
+//========================================================
+// Worker thread
+//
+
+class ParallelWorker: public Runnable, public BaseAlloc
+{
+public:
+   ParallelWorker( ParallelTask* task, VMachine* origin );
+   virtual ~ParallelWorker();
+
+   VMachine& vm() { return *m_vm; }
+
+   bool start();
+   void join();
+
+   virtual void* run();
+
+private:
+   void process( uint32 chunk, CoreArray* holder );
+
+   ParallelTask* m_task;
+   VMachine* m_vm;
+   SysThread* m_sth;
+};
+
+
+ParallelWorker::ParallelWorker( ParallelTask* task, VMachine* origin ):
+   m_task( task ),
+   m_vm( new VMachine ),
+   m_sth( 0 )
+{
+   m_vm->appSearchPath( origin->appSearchPath() );
+}
+
+
+ParallelWorker::~ParallelWorker()
+{
+   join();
+   m_vm->finalize();
+}
+
+
+bool ParallelWorker::start()
+{
+   fassert( m_sth == 0 );
+   m_sth = new SysThread( this );
+   if ( ! m_sth->start() )
+   {
+      // a SysThread can be disposed only through join() or detach(),
+      // that are not possible if the thread was never started.
+      m_sth = 0;
+      return false;
+   }
+
+   return true;
+}
+
+
+void ParallelWorker::join()
+{
+   if ( m_sth != 0 )
+   {
+      void* data;
+      m_sth->join( data );
+      m_sth = 0;
+   }
+}
+
+
+void* ParallelWorker::run()
+{
+   // The items we work on are not visible to the VM; lock them here.
+   // 0: the function, 1: the current item, 2: the outcome of the chunk.
+   CoreArray* holder = new CoreArray( 3 );
+   holder->resize( 3 );
+   Item i_holder( holder );
+   GarbageLock holderLock( i_holder );
+
+   ROStringStream fs( m_task->function() );
+   if ( holder->at(0).deserialize( &fs, m_vm ) != Item::sc_ok )
+   {
+      m_task->fail( 0, new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ) ) );
+      return 0;
+   }
+
+   int32 chunk;
+   while( ( chunk = m_task->nextChunk() ) >= 0 )
+   {
+      try
+      {
+         process( (uint32) chunk, holder );
+      }
+      catch( Error* err )
+      {
+         m_task->fail( (uint32) chunk, err );
+      }
+   }
+
+   return 0;
+}
+
+
+void ParallelWorker::process( uint32 chunk, CoreArray* holder )
+{
+   const Item& func = holder->at(0);
+   Item& current = holder->at(1);
+   Item& outcome = holder->at(2);
+
+   const uint32 size = m_task->chunkSize( chunk );
+   ROStringStream input( m_task->input( chunk ) );
+
+   CoreArray* results = 0;
+   if ( m_task->mode() != ParallelTask::e_reduce )
+   {
+      results = new CoreArray( size );
+      outcome = results;
+   }
+
+   for ( uint32 i = 0; i < size; ++i )
+   {
+      if ( current.deserialize( &input, m_vm ) != Item::sc_ok )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ) );
+      }
+
+      switch( m_task->mode() )
+      {
+         case ParallelTask::e_map:
+            m_vm->pushParam( current );
+            m_vm->callItem( func, 1 );
+            results->append( m_vm->regA() );
+            break;
+
+         case ParallelTask::e_filter:
+            m_vm->pushParam( current );
+            m_vm->callItem( func, 1 );
+            if ( m_vm->regA().isTrue() )
+               results->append( (int64) i );
+            break;
+
+         case ParallelTask::e_reduce:
+            if ( i == 0 )
+            {
+               outcome = current;
+            }
+            else
+            {
+               m_vm->pushParam( outcome );
+               m_vm->pushParam( current );
+               m_vm->callItem( func, 2 );
+               outcome = m_vm->regA();
+            }
+            break;
+      }
+   }
+
+   StringStream output( 512 );
+   if ( outcome.serialize( &output, true ) != Item::sc_ok )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_SERIALIZE, __LINE__ ) );
+   }
+
+   current.setNil();
+   outcome.setNil();
+   m_task->output( chunk, output );
+}
+
+//========================================================
+// Parallel task
+//
+
+ParallelTask::ParallelTask( t_mode mode, uint32 count, uint32 workers ):
+   m_mode( mode ),
+   m_count( count ),
+   m_evPublished( false, false ),
+   m_published( 0 ),
+   m_next( 0 ),
+   m_bAborted( false ),
+   m_error( 0 ),
+   m_errorChunk( 0 ),
+   m_vm( 0 )
+{
+   fassert( count > 0 );
+
+   // a few chunks for each worker balance functions of uneven cost.
+   m_chunks = workers * 4;
+   if ( m_chunks > count )
+      m_chunks = count;
+   m_workers = workers > m_chunks ? m_chunks : workers;
+
+   m_input = new String[ m_chunks ];
+   m_output = new String[ m_chunks ];
+   m_worker = new ParallelWorker*[ m_workers ];
+   for ( uint32 i = 0; i < m_workers; ++i )
+      m_worker[i] = 0;
+}
+
+
+ParallelTask::~ParallelTask()
+{
+   abort();
+   for ( uint32 i = 0; i < m_workers; ++i )
+      delete m_worker[i];
+   delete[] m_worker;
+
+   delete[] m_input;
+   delete[] m_output;
+
+   if ( m_error != 0 )
+      m_error->decref();
+}
+
+
+uint32 ParallelTask::chunkStart( uint32 chunk ) const
+{
+   return (uint32) ( (uint64) m_count * chunk / m_chunks );
+}
+
+
+uint32 ParallelTask::chunkSize( uint32 chunk ) const
+{
+   return chunkStart( chunk + 1 ) - chunkStart( chunk );
+}
+
+
+void ParallelTask::prepare( VMachine* vm, const Item& func )
+{
+   m_vm = vm;
+
+   StringStream fs( 512 );
+   if ( func.serialize( &fs, true ) != Item::sc_ok )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_SERIALIZE, __LINE__ ).
+         desc( FAL_STR( th_msg_errser ) ) );
+   }
+   fs.closeToString( m_function );
+
+   // the workers share the modules of this vm.
+   Runtime rt;
+   prepareRuntime( vm, rt );
+
+   for ( uint32 i = 0; i < m_workers; ++i )
+   {
+      m_worker[i] = new ParallelWorker( this, vm );
+
+      // Do not set error handler; errors will emerge in the module.
+      if ( ! m_worker[i]->vm().link( &rt ) )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_PREPARE, __LINE__ ).
+            desc( FAL_STR( th_msg_errlink ) ) );
+      }
+
+      if ( ! m_worker[i]->start() )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_START, __LINE__ ).
+            desc( FAL_STR( th_msg_errstart ) ) );
+      }
+   }
+}
+
+
+bool ParallelTask::publish( const ItemArray& source )
+{
+   if ( m_published == m_chunks )
+      return false;
+
+   const uint32 first = chunkStart( m_published );
+   const uint32 last = first + chunkSize( m_published );
+
+   StringStream data( 512 );
+   for ( uint32 i = first; i < last; ++i )
+   {
+      if ( source[i].serialize( &data, true ) != Item::sc_ok )
+      {
+         VMachine* vm = m_vm;
+         throw new ThreadError( ErrorParam( FALTH_ERR_SERIALIZE, __LINE__ ).
+            desc( FAL_STR( th_msg_errser ) ) );
+      }
+   }
+   data.closeToString( m_input[ m_published ] );
+
+   m_mtx.lock();
+   ++m_published;
+   m_evPublished.set();
+   m_mtx.unlock();
+
+   return true;
+}
+
+
+void ParallelTask::wait()
+{
+   m_vm->idle();
+   for ( uint32 i = 0; i < m_workers; ++i )
+   {
+      if ( m_worker[i] != 0 )
+         m_worker[i]->join();
+   }
+   m_vm->unidle();
+
+   if ( m_error != 0 )
+   {
+      VMachine* vm = m_vm;
+      ThreadError* therr = new ThreadError( ErrorParam( FALTH_ERR_PARALLEL, __LINE__ ).
+         desc( FAL_STR( th_msg_parallelerr ) ) );
+      therr->appendSubError( m_error );
+      throw therr;
+   }
+}
+
+
+bool ParallelTask::result( uint32 chunk, Item& target, VMachine* vm ) const
+{
+   ROStringStream data( m_output[ chunk ] );
+   return target.deserialize( &data, vm ) == Item::sc_ok;
+}
+
+
+void ParallelTask::output( uint32 chunk, StringStream& data )
+{
+   // each chunk is processed by one worker only.
+   data.closeToString( m_output[ chunk ] );
+}
+
+
+int32 ParallelTask::nextChunk()
+{
+   m_mtx.lock();
+   while( true )
+   {
+      if ( m_bAborted || m_next == m_chunks )
+      {
+         m_mtx.unlock();
+         return -1;
+      }
+
+      if ( m_next < m_published )
+      {
+         int32 chunk = (int32) m_next++;
+         m_mtx.unlock();
+         return chunk;
+      }
+
+      // wait for a publish; it can't happen before the reset, as we hold the lock.
+      m_evPublished.reset();
+      m_mtx.unlock();
+      m_evPublished.wait();
+      m_mtx.lock();
+   }
+}
+
+
+void ParallelTask::fail( uint32 chunk, Error* error )
+{
+   m_mtx.lock();
+   if ( m_error == 0 || chunk < m_errorChunk )
+   {
+      if ( m_error != 0 )
+         m_error->decref();
+      m_error = error;
+      m_errorChunk = chunk;
+   }
+   else
+   {
+      error->decref();
+   }
+   m_bAborted = true;
+   m_evPublished.set();
+   m_mtx.unlock();
+}
+
+
+void ParallelTask::abort()
+{
+   m_mtx.lock();
+   m_bAborted = true;
+   m_evPublished.set();
+   m_mtx.unlock();
+}
+
+}
+}
+
+/* end of parallel.cpp */
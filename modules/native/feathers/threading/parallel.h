@@ -0,0 +1,127 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: parallel.h
+
+   Threading module - parallel map, filter and reduce.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 23:42:18 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Threading module - parallel map, filter and reduce.
+*/
+
+#ifndef FLC_THREADING_PARALLEL
+#define FLC_THREADING_PARALLEL
+
+#include <falcon/setup.h>
+#include <falcon/string.h>
+#include <falcon/item.h>
+#include <falcon/error.h>
+#include <falcon/vm.h>
+#include <falcon/mt.h>
+
+namespace Falcon {
+namespace Ext {
+
+class ParallelWorker;
+
+/** Parallel application of a function to the items of an array.
+
+   The array is split in chunks, which are serialized and processed in
+   order of availability by a set of worker threads, each running its own
+   VM linked with the same modules of the calling VM. Each worker
+   sends back the serialized outcome of a chunk:
+   - the array of the results for e_map;
+   - the array of the positions of the accepted items for e_filter;
+   - the chunk reduced to a single value for e_reduce.
+
+   The caller uses the object from a single thread: prepare() and
+   publish() each chunk, then wait(), and finally read the results.
+*/
+class ParallelTask: public BaseAlloc
+{
+public:
+   typedef enum {
+      e_map,
+      e_filter,
+      e_reduce
+   } t_mode;
+
+   ParallelTask( t_mode mode, uint32 count, uint32 workers );
+   ~ParallelTask();
+
+   /** Creates and starts the workers.
+      \param vm The VM whose modules must be linked in the workers.
+      \param func The function to be applied.
+      \throw ThreadError if the function can't be transferred or the workers can't be started.
+   */
+   void prepare( VMachine* vm, const Item& func );
+
+   /** Serializes the next chunk and makes it available to the workers.
+      \return false if all the chunks have been published.
+      \throw ThreadError if an item can't be transferred.
+   */
+   bool publish( const ItemArray& source );
+
+   /** Waits for all the workers to be done.
+      \throw ThreadError if the function raised an error in a worker.
+   */
+   void wait();
+
+   t_mode mode() const { return m_mode; }
+   uint32 chunks() const { return m_chunks; }
+   uint32 chunkStart( uint32 chunk ) const;
+   uint32 chunkSize( uint32 chunk ) const;
+
+   /** Deserializes the outcome of a chunk in the given VM. */
+   bool result( uint32 chunk, Item& target, VMachine* vm ) const;
+
+private:
+   friend class ParallelWorker;
+
+   // Functions used by the workers
+   const String& function() const { return m_function; }
+   const String& input( uint32 chunk ) const { return m_input[chunk]; }
+   void output( uint32 chunk, StringStream& data );
+   int32 nextChunk();
+   void fail( uint32 chunk, Error* error );
+   void abort();
+
+   t_mode m_mode;
+   uint32 m_count;
+   uint32 m_chunks;
+   uint32 m_workers;
+
+   String m_function;
+   String* m_input;
+   String* m_output;
+
+   Mutex m_mtx;
+   // manual reset; set when a chunk is published or the task is aborted.
+   Falcon::Event m_evPublished;
+   uint32 m_published;
+   uint32 m_next;
+   bool m_bAborted;
+
+   // error in the lowest failed chunk.
+   Error* m_error;
+   uint32 m_errorChunk;
+
+   VMachine* m_vm;
+
+   ParallelWorker** m_worker;
+};
+
+}
+}
+
+#endif
+
+/* end of parallel.h */
@@ -0,0 +1,588 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: pool.cpp
+
+   Threading module - pool of persistent worker threads.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Tue, 20 Oct 2026 01:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Threading module - pool of persistent worker threads.
+*/
+
+#include <falcon/setup.h>
+#include <falcon/fassert.h>
+#include <falcon/genericlist.h>
+#include <falcon/garbagelock.h>
+#include <falcon/runtime.h>
+#include <falcon/stringstream.h>
+#include <falcon/rosstream.h>
+
+#include "pool.h"
+#include "threading_ext.h"
+#include "threading_mod.h"
+#include "threading_st.h"
+
+namespace Falcon {
+namespace Ext {
+
+//========================================================
+// Queued task
+//
+
+class PoolTask: public BaseAlloc
+{
+public:
+   PoolTask( StringStream& call, Future* future ):
+      m_future( future )
+   {
+      call.closeToString( m_call );
+      m_future->incref();
+   }
+
+   ~PoolTask()
+   {
+      m_future->decref();
+   }
+
+   const String& call() const { return m_call; }
+   Future* future() const { return m_future; }
+
+private:
+   String m_call;
+   Future* m_future;
+};
+
+//========================================================
+// Worker thread
+//
+
+class PoolWorker: public Runnable, public BaseAlloc
+{
+public:
+   PoolWorker( ThreadPool* pool, uint32 id, VMachine* origin );
+   virtual ~PoolWorker();
+
+   VMachine& vm() { return *m_vm; }
+
+   bool start();
+   void join();
+   void detach();
+
+   virtual void* run();
+
+   // The owner takes the tasks from the front of its queue,
+   // while the other workers steal them from the back.
+   void push( PoolTask* task );
+   PoolTask* pop();
+   PoolTask* steal();
+
+   // Both controlled by the pool under its idle mutex.
+   bool m_bIdle;
+   Falcon::Event m_evWork;
+
+private:
+   void execute( PoolTask* task, Item& call );
+
+   ThreadPool* m_pool;
+   uint32 m_id;
+   VMachine* m_vm;
+   SysThread* m_sth;
+
+   Mutex m_mtx;
+   List m_tasks;
+};
+
+
+PoolWorker::PoolWorker( ThreadPool* pool, uint32 id, VMachine* origin ):
+   m_bIdle( false ),
+   m_evWork( true, false ),
+   m_pool( pool ),
+   m_id( id ),
+   m_vm( new VMachine ),
+   m_sth( 0 )
+{
+   m_vm->appSearchPath( origin->appSearchPath() );
+}
+
+
+PoolWorker::~PoolWorker()
+{
+   // the pool disposes of the workers only after they are terminated.
+   fassert( m_sth == 0 );
+
+   // a worker that never ran still owns its VM.
+   if ( m_vm != 0 )
+      m_vm->finalize();
+
+   ListElement *e = m_tasks.begin();
+   while( e != 0 )
+   {
+      delete (PoolTask*) e->data();
+      e = e->next();
+   }
+}
+
+
+bool PoolWorker::start()
+{
+   fassert( m_sth == 0 );
+   m_sth = new SysThread( this );
+   if ( ! m_sth->start() )
+   {
+      // a SysThread can be disposed only through join() or detach(),
+      // that are not possible if the thread was never started.
+      m_sth = 0;
+      return false;
+   }
+
+   return true;
+}
+
+
+void PoolWorker::join()
+{
+   if ( m_sth != 0 )
+   {
+      void* data;
+      m_sth->join( data );
+      m_sth = 0;
+   }
+}
+
+
+void PoolWorker::detach()
+{
+   if ( m_sth != 0 )
+   {
+      m_sth->detach();
+      m_sth = 0;
+   }
+}
+
+
+void* PoolWorker::run()
+{
+   // The item being called is not visible to the VM; lock it here.
+   GarbageLock callLock;
+
+   PoolTask* task;
+   while( ( task = m_pool->nextTask( m_id ) ) != 0 )
+   {
+      execute( task, callLock.item() );
+      delete task;
+   }
+
+   m_vm->finalize();
+   m_vm = 0;
+
+   // this may destroy the pool and this worker.
+   m_pool->decref();
+   return 0;
+}
+
+
+void PoolWorker::execute( PoolTask* task, Item& call )
+{
+   bool bError = false;
+
+   try
+   {
+      ROStringStream input( task->call() );
+      if ( call.deserialize( &input, m_vm ) != Item::sc_ok )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ) );
+      }
+
+      m_vm->callItem( call, 0 );
+
+      StringStream result( 512 );
+      if ( m_vm->regA().serialize( &result, true ) != Item::sc_ok )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_SERIALIZE, __LINE__ ) );
+      }
+      task->future()->complete( result );
+   }
+   catch( Error* err )
+   {
+      task->future()->fail( err );
+      bError = true;
+   }
+
+   call.setNil();
+   m_vm->regA().setNil();
+   m_pool->taskDone( bError );
+}
+
+
+void PoolWorker::push( PoolTask* task )
+{
+   m_mtx.lock();
+   m_tasks.pushBack( task );
+   m_mtx.unlock();
+}
+
+
+PoolTask* PoolWorker::pop()
+{
+   PoolTask* task = 0;
+   m_mtx.lock();
+   if ( ! m_tasks.empty() )
+   {
+      task = (PoolTask*) m_tasks.front();
+      m_tasks.popFront();
+   }
+   m_mtx.unlock();
+   return task;
+}
+
+
+PoolTask* PoolWorker::steal()
+{
+   PoolTask* task = 0;
+   m_mtx.lock();
+   if ( ! m_tasks.empty() )
+   {
+      task = (PoolTask*) m_tasks.back();
+      m_tasks.popBack();
+   }
+   m_mtx.unlock();
+   return task;
+}
+
+//========================================================
+// Pools of the running VMs
+//
+
+// pools still accepting tasks, shut down when the VM creating them terminates.
+static Mutex s_mtxPools;
+static List s_pools;
+
+void shutdownPools( VMachine* vm )
+{
+   List owned;
+
+   s_mtxPools.lock();
+   ListElement *e = s_pools.begin();
+   while( e != 0 )
+   {
+      ThreadPool* pool = (ThreadPool*) e->data();
+      if ( pool->owner() == vm )
+      {
+         owned.pushBack( pool );
+         e = s_pools.erase( e );
+      }
+      else
+         e = e->next();
+   }
+   s_mtxPools.unlock();
+
+   // the workers' VMs would otherwise prevent the final collection.
+   while( ! owned.empty() )
+   {
+      ThreadPool* pool = (ThreadPool*) owned.front();
+      owned.popFront();
+      pool->shutdown( false );
+      pool->decref();
+   }
+}
+
+//========================================================
+// Thread pool
+//
+
+ThreadPool::ThreadPool( uint32 workers ):
+   m_workers( workers ),
+   m_owner( 0 ),
+   m_refCount( 1 ),
+   m_users( 0 ),
+   m_next( 0 ),
+   m_bShutdown( false ),
+   m_bJoined( false ),
+   m_submitted( 0 ),
+   m_completed( 0 ),
+   m_failed( 0 ),
+   m_stolen( 0 ),
+   m_pending( 0 ),
+   m_active( 0 )
+{
+   fassert( workers > 0 );
+
+   m_worker = new PoolWorker*[ m_workers ];
+   for ( uint32 i = 0; i < m_workers; ++i )
+      m_worker[i] = 0;
+}
+
+
+ThreadPool::~ThreadPool()
+{
+   for ( uint32 i = 0; i < m_workers; ++i )
+      delete m_worker[i];
+   delete[] m_worker;
+}
+
+
+void ThreadPool::start( VMachine* vm )
+{
+   // the workers share the modules of this vm.
+   Runtime rt;
+   prepareRuntime( vm, rt );
+
+   m_owner = vm;
+   incref();
+   s_mtxPools.lock();
+   s_pools.pushBack( this );
+   s_mtxPools.unlock();
+
+   // all the workers must exist before any of them looks for tasks to steal.
+   for ( uint32 i = 0; i < m_workers; ++i )
+      m_worker[i] = new PoolWorker( this, i, vm );
+
+   for ( uint32 i = 0; i < m_workers; ++i )
+   {
+      // Do not set error handler; errors will emerge in the module.
+      if ( ! m_worker[i]->vm().link( &rt ) )
+      {
+         throw new ThreadError( ErrorParam( FALTH_ERR_PREPARE, __LINE__ ).
+            desc( FAL_STR( th_msg_errlink ) ) );
+      }
+
+      // each running worker holds the pool.
+      incref();
+      if ( ! m_worker[i]->start() )
+      {
+         decref();
+         throw new ThreadError( ErrorParam( FALTH_ERR_START, __LINE__ ).
+            desc( FAL_STR( th_msg_errstart ) ) );
+      }
+   }
+}
+
+
+bool ThreadPool::submit( StringStream& call, Future* future )
+{
+   PoolTask* task = new PoolTask( call, future );
+
+   m_mtxIdle.lock();
+   if ( m_bShutdown )
+   {
+      m_mtxIdle.unlock();
+      delete task;
+      return false;
+   }
+
+   PoolWorker* target = m_worker[ m_next ];
+   m_next = ( m_next + 1 ) % m_workers;
+   target->push( task );
+   atomicInc( m_pending );
+   atomicInc( m_submitted );
+
+   // wake the owner of the queue, or any idle worker that can steal the task.
+   if ( ! target->m_bIdle )
+   {
+      for ( uint32 i = 0; i < m_workers; ++i )
+      {
+         if ( m_worker[i]->m_bIdle )
+         {
+            target = m_worker[i];
+            break;
+         }
+      }
+   }
+
+   if ( target->m_bIdle )
+   {
+      target->m_bIdle = false;
+      target->m_evWork.set();
+   }
+   m_mtxIdle.unlock();
+
+   return true;
+}
+
+
+PoolTask* ThreadPool::nextTask( uint32 worker )
+{
+   PoolWorker* self = m_worker[ worker ];
+
+   while( true )
+   {
+      PoolTask* task = self->pop();
+      if ( task == 0 )
+      {
+         // try the other queues, starting from the next worker.
+         for ( uint32 i = 1; i < m_workers && task == 0; ++i )
+            task = m_worker[ ( worker + i ) % m_workers ]->steal();
+
+         if ( task != 0 )
+            atomicInc( m_stolen );
+      }
+
+      if ( task != 0 )
+      {
+         atomicDec( m_pending );
+         atomicInc( m_active );
+         return task;
+      }
+
+      // Tasks are queued under this lock, so we can't miss a wake up.
+      m_mtxIdle.lock();
+      if ( m_pending == 0 )
+      {
+         if ( m_bShutdown )
+         {
+            m_mtxIdle.unlock();
+            return 0;
+         }
+
+         self->m_bIdle = true;
+         m_mtxIdle.unlock();
+         self->m_evWork.wait();
+      }
+      else
+      {
+         // a task is being taken by another worker.
+         m_mtxIdle.unlock();
+      }
+   }
+}
+
+
+void ThreadPool::taskDone( bool bError )
+{
+   atomicDec( m_active );
+   if ( bError )
+      atomicInc( m_failed );
+   else
+      atomicInc( m_completed );
+}
+
+
+void ThreadPool::shutdown( bool bWait )
+{
+   m_mtxIdle.lock();
+   // only the first request can join or detach the workers.
+   bool bFirst = ! m_bJoined;
+   m_bShutdown = true;
+   m_bJoined = true;
+
+   for ( uint32 i = 0; i < m_workers; ++i )
+   {
+      if ( m_worker[i]->m_bIdle )
+      {
+         m_worker[i]->m_bIdle = false;
+         m_worker[i]->m_evWork.set();
+      }
+   }
+   m_mtxIdle.unlock();
+
+   if ( ! bFirst )
+      return;
+
+   // no need to be shut down by the owner anymore.
+   bool bRegistered = false;
+   s_mtxPools.lock();
+   ListElement *e = s_pools.begin();
+   while( e != 0 )
+   {
+      if ( e->data() == this )
+      {
+         s_pools.erase( e );
+         bRegistered = true;
+         break;
+      }
+      e = e->next();
+   }
+   s_mtxPools.unlock();
+
+   for ( uint32 i = 0; i < m_workers; ++i )
+   {
+      if ( bWait )
+         m_worker[i]->join();
+      else
+         m_worker[i]->detach();
+   }
+
+   if ( bRegistered )
+      decref();
+}
+
+
+bool ThreadPool::isShutdown() const
+{
+   m_mtxIdle.lock();
+   bool bStatus = m_bShutdown;
+   m_mtxIdle.unlock();
+   return bStatus;
+}
+
+
+void ThreadPool::incref()
+{
+   atomicInc( m_refCount );
+}
+
+
+void ThreadPool::decref()
+{
+   if ( atomicDec( m_refCount ) == 0 )
+      delete this;
+}
+
+
+void ThreadPool::attach()
+{
+   atomicInc( m_users );
+}
+
+
+void ThreadPool::detach()
+{
+   // the workers will terminate after the queued tasks.
+   if ( atomicDec( m_users ) == 0 )
+      shutdown( false );
+}
+
+//========================================================
+// Pool carrier
+//
+
+PoolCarrier::PoolCarrier( ThreadPool* pool ):
+   m_pool( pool )
+{
+   m_pool->incref();
+   m_pool->attach();
+}
+
+
+PoolCarrier::PoolCarrier( const PoolCarrier& other ):
+   m_pool( other.m_pool )
+{
+   m_pool->incref();
+   m_pool->attach();
+}
+
+
+PoolCarrier::~PoolCarrier()
+{
+   m_pool->detach();
+   m_pool->decref();
+}
+
+
+FalconData *PoolCarrier::clone() const
+{
+   return new PoolCarrier( *this );
+}
+
+}
+}
+
+/* end of pool.cpp */
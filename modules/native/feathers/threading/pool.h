@@ -0,0 +1,152 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: pool.h
+
+   Threading module - pool of persistent worker threads.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Tue, 20 Oct 2026 01:12:40 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Threading module - pool of persistent worker threads.
+*/
+
+#ifndef FLC_THREADING_POOL
+#define FLC_THREADING_POOL
+
+#include <falcon/setup.h>
+#include <falcon/string.h>
+#include <falcon/vm.h>
+#include <falcon/mt.h>
+#include <falcon/falcondata.h>
+#include <falcon/stringstream.h>
+
+namespace Falcon {
+namespace Ext {
+
+class Future;
+class PoolTask;
+class PoolWorker;
+
+/** Set of long lived worker threads running the tasks submitted by scripts.
+
+   Each worker runs its own VM, linked once with the modules of the VM
+   creating the pool, and a queue of serialized tasks. Tasks are spread
+   among the queues in turn; a worker having nothing to do steals the
+   tasks from the queues of the busy workers, and sleeps only when all
+   the queues are empty.
+
+   The pool is reference counted: it is held by the carriers of the
+   script objects and by each running worker, so that the workers can
+   drain their queues after the script objects are gone. When the last
+   script object is collected, or when the VM that started the pool is
+   finalized, the pool is shut down.
+*/
+class ThreadPool: public BaseAlloc
+{
+public:
+   ThreadPool( uint32 workers );
+
+   /** Links the workers with the modules of the given VM and starts them.
+      \throw ThreadError if the workers can't be started.
+   */
+   void start( VMachine* vm );
+
+   /** Queues a task.
+      \param call The serialized callable item to be run; the stream is closed.
+      \param future The future receiving the outcome of the call.
+      \return false if the pool has been shut down.
+   */
+   bool submit( StringStream& call, Future* future );
+
+   /** Stops accepting new tasks.
+      The workers terminate after having run all the queued tasks.
+      \param bWait true to wait for the workers to terminate.
+   */
+   void shutdown( bool bWait );
+
+   bool isShutdown() const;
+
+   void incref();
+   void decref();
+
+   /** Accounts for a script object using the pool. */
+   void attach();
+   /** Releases a script object; the pool is shut down when none is left. */
+   void detach();
+
+   /** The VM that started the pool. */
+   VMachine* owner() const { return m_owner; }
+
+   uint32 workers() const { return m_workers; }
+   int32 submitted() const { return m_submitted; }
+   int32 completed() const { return m_completed; }
+   int32 failed() const { return m_failed; }
+   int32 stolen() const { return m_stolen; }
+   int32 pending() const { return m_pending; }
+   int32 active() const { return m_active; }
+
+private:
+   friend class PoolWorker;
+   ~ThreadPool();
+
+   // Functions used by the workers
+   PoolTask* nextTask( uint32 worker );
+   void taskDone( bool bError );
+
+   uint32 m_workers;
+   PoolWorker** m_worker;
+   VMachine* m_owner;
+   volatile int32 m_refCount;
+   volatile int32 m_users;
+
+   // held while queueing tasks and while workers go idle.
+   mutable Mutex m_mtxIdle;
+   uint32 m_next;
+   bool m_bShutdown;
+   bool m_bJoined;
+
+   // statistics
+   volatile int32 m_submitted;
+   volatile int32 m_completed;
+   volatile int32 m_failed;
+   volatile int32 m_stolen;
+   volatile int32 m_pending;
+   volatile int32 m_active;
+};
+
+
+/** Carrier of a ThreadPool in script objects. */
+class PoolCarrier: public FalconData
+{
+   ThreadPool* m_pool;
+
+public:
+   PoolCarrier( ThreadPool* pool );
+   PoolCarrier( const PoolCarrier& other );
+   virtual ~PoolCarrier();
+
+   virtual FalconData *clone() const;
+   virtual void gcMark( ::Falcon::uint32 ) {}
+
+   ThreadPool* pool() const { return m_pool; }
+};
+
+/** Shuts down the pools started by a VM that is terminating.
+   Idle workers would otherwise keep their VMs alive, preventing the
+   final collection.
+*/
+void shutdownPools( VMachine* vm );
+
+}
+}
+
+#endif
+
+/* end of pool.h */
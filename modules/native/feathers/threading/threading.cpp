@@ -356,6 +356,12 @@ FALCON_MODULE_DECL
       addParam("thread");
    self->addClassMethod( c_threading, "start", Falcon::Ext::Threading_start ).asSymbol()->
       addParam("callable");
+   self->addClassMethod( c_threading, "pmap", Falcon::Ext::Threading_pmap ).asSymbol()->
+      addParam("func")->addParam("array")->addParam("workers");
+   self->addClassMethod( c_threading, "pfilter", Falcon::Ext::Threading_pfilter ).asSymbol()->
+      addParam("func")->addParam("array")->addParam("workers");
+   self->addClassMethod( c_threading, "preduce", Falcon::Ext::Threading_preduce ).asSymbol()->
+      addParam("func")->addParam("array")->addParam("initial")->addParam("workers");
 
    //=================================================================
    // Waitable class.
@@ -437,6 +443,44 @@ FALCON_MODULE_DECL
    self->addClassMethod( c_synq, "empty", Falcon::Ext::SyncQueue_empty );
    self->addClassMethod( c_synq, "size", Falcon::Ext::SyncQueue_size );
 
+   //=================================================================
+   // RingQueue class.
+   //
+   Falcon::Symbol *c_ringq = self->addClass( "RingQueue", Falcon::Ext::RingQueue_init );
+   c_ringq->getClassDef()->addInheritance( new Falcon::InheritDef( c_waitable ) );
+   self->addClassMethod( c_ringq, "push", Falcon::Ext::RingQueue_push ).asSymbol()->
+      addParam("item")->addParam("timeout");
+   self->addClassMethod( c_ringq, "pushMany", Falcon::Ext::RingQueue_pushMany ).asSymbol()->
+      addParam("items")->addParam("timeout");
+   self->addClassMethod( c_ringq, "pop", Falcon::Ext::RingQueue_pop ).asSymbol()->
+      addParam("timeout");
+   self->addClassMethod( c_ringq, "popMany", Falcon::Ext::RingQueue_popMany ).asSymbol()->
+      addParam("count")->addParam("timeout");
+   self->addClassMethod( c_ringq, "empty", Falcon::Ext::RingQueue_empty );
+   self->addClassMethod( c_ringq, "size", Falcon::Ext::RingQueue_size );
+   self->addClassMethod( c_ringq, "capacity", Falcon::Ext::RingQueue_capacity );
+
+   //=================================================================
+   // ThreadPool class.
+   //
+   Falcon::Symbol *c_pool = self->addClass( "ThreadPool", Falcon::Ext::ThreadPool_init );
+   self->addClassMethod( c_pool, "submit", Falcon::Ext::ThreadPool_submit ).asSymbol()->
+      addParam("callable");
+   self->addClassMethod( c_pool, "shutdown", Falcon::Ext::ThreadPool_shutdown ).asSymbol()->
+      addParam("wait");
+   self->addClassMethod( c_pool, "stats", Falcon::Ext::ThreadPool_stats );
+
+   //=================================================================
+   // Future class.
+   //
+   Falcon::Symbol *c_future = self->addClass( "Future" );
+   c_future->getClassDef()->addInheritance( new Falcon::InheritDef( c_waitable ) );
+   c_future->setWKS( true );
+   self->addClassMethod( c_future, "get", Falcon::Ext::Future_get );
+   self->addClassMethod( c_future, "done", Falcon::Ext::Future_done );
+   self->addClassMethod( c_future, "hadError", Falcon::Ext::Future_hadError );
+   self->addClassMethod( c_future, "getError", Falcon::Ext::Future_getError );
+
    //============================================================
    // Thread Error class
    Falcon::Symbol *error_class = self->addExternalRef( "Error" ); // it's external
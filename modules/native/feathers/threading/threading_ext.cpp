@@ -22,10 +22,16 @@
 #include <falcon/stringstream.h>
 #include <falcon/rosstream.h>
 #include <falcon/garbagepointer.h>
+#include <falcon/carray.h>
+#include <falcon/lineardict.h>
+#include <falcon/garbagelock.h>
+#include <falcon/sys.h>
 
 #include "threading_ext.h"
 #include "threading_mod.h"
 #include "threading_st.h"
+#include "parallel.h"
+#include "pool.h"
 
 /*#
    @beginmodule feathers.threading
@@ -36,6 +42,8 @@ namespace Ext {
 
 static void onMainOver( VMachine* vm )
 {
+   shutdownPools( vm );
+
    ThreadImpl* impl = getRunningThread();
    if ( impl != 0 )
    {
@@ -59,6 +67,25 @@ static ThreadImpl* checkMainThread( VMachine* vm )
    return self_th;
 }
 
+// Worker count from an optional parameter; defaults to the CPU count.
+static uint32 parallelWorkers( Item* i_workers )
+{
+   if ( i_workers == 0 || i_workers->isNil() )
+   {
+      int32 cpus = Sys::_cpuCount();
+      return cpus > 0 ? (uint32) cpus : 1;
+   }
+
+   int64 workers = i_workers->forceInteger();
+   if ( workers < 1 )
+   {
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ ).
+         extra( "workers < 1" ) );
+   }
+   return (uint32) workers;
+}
+
+
 /*#
    @group waiting_funcs Waitings
    @brief Wating functions and methods.
@@ -233,33 +260,9 @@ FALCON_FUNC Thread_start( VMachine *vm )
          desc( FAL_STR( th_msg_running ) ) );
    }
 
-   // First link in falcon.core module.
+   // Prepare the modules to be linked in the new VM.
    Runtime rt;
-   LiveModule *fc = vm->findModule( "falcon.core" );
-   if ( 0 != fc )
-      rt.addModule( const_cast<Module *>(fc->module()) );
-
-   // The main module goes after.
-   LiveModule* mainMod = vm->mainModule();
-
-   // Prelink the modules into the new VM
-   const LiveModuleMap &mods = vm->liveModules();
-   MapIterator iter = mods.begin();
-   while( iter.hasCurrent() )
-   {
-      LiveModule *lmod = *(LiveModule **) iter.currentValue();
-      if( lmod != fc && lmod != mainMod )
-      {
-         Module *mod = const_cast<Module*>(lmod->module());
-         rt.addModule( mod, lmod->isPrivate() );
-      }
-
-      iter.next();
-   }
-
-   // finally, insert the main module
-   if ( mainMod != 0 )
-      rt.addModule( const_cast<Module*>(mainMod->module()), mainMod->isPrivate() );
+   prepareRuntime( vm, rt );
 
 
    // Do not set error handler; errors will emerge in the module.
@@ -1310,21 +1313,15 @@ FALCON_FUNC SyncQueue_init( VMachine *vm )
    synq->decref();
 }
 
-static void internal_SyncQueue_push( VMachine *vm, bool front )
+// Serializes an item in a buffer prefixed by its size, as stored in the queues.
+static void *queue_serialize( const Item &item )
 {
-   if( vm->paramCount() != 1 )
-   {
-      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
-         extra( "X" ) );
-
-   }
-
    StringStream ss;
    // reserve a bit of space
    uint32 written = 0;
    ss.write( &written, sizeof( written ) );
 
-   if ( vm->param(0)->serialize( &ss, true ) != Item::sc_ok )
+   if ( item.serialize( &ss, true ) != Item::sc_ok )
    {
       throw new CodeError( ErrorParam( e_inv_params, __LINE__ ).
          extra( "not serializable" ) );
@@ -1335,13 +1332,44 @@ static void internal_SyncQueue_push( VMachine *vm, bool front )
    written = ss.length() - sizeof( written );
    ss.write( &written, sizeof( written ) );
 
+   return ss.closeToBuffer();
+}
+
+// Deserializes and frees a buffer created by queue_serialize.
+static void queue_deserialize( VMachine *vm, void *data, Item &retreived )
+{
+   uint32 *written = (uint32 *) data;
+   ROStringStream ss( ((char*)data)+sizeof( uint32 ), *written );
+
+   if ( retreived.deserialize( &ss, vm ) != Item::sc_ok )
+   {
+      memFree( data );
+      throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ).
+         desc( FAL_STR( th_msg_errdes ) ) );
+   }
+
+   memFree( data );
+}
+
+
+static void internal_SyncQueue_push( VMachine *vm, bool front )
+{
+   if( vm->paramCount() != 1 )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "X" ) );
+
+   }
+
+   void *data = queue_serialize( *vm->param(0) );
+
    WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
    SyncQueue *synq = static_cast< SyncQueue *>( wc->waitable() );
 
    if ( front )
-      synq->pushFront( ss.closeToBuffer() );
+      synq->pushFront( data );
    else
-      synq->pushBack( ss.closeToBuffer() );
+      synq->pushBack( data );
 }
 
 
@@ -1359,18 +1387,8 @@ static void internal_SyncQueue_pop( VMachine *vm, bool front )
          desc( FAL_STR( th_msg_qempty ) ) );
    }
 
-   uint32 *written = (uint32 *) data;
-   ROStringStream ss( ((char*)data)+sizeof( uint32 ), *written );
-
    Item retreived;
-   if ( retreived.deserialize( &ss, vm ) != Item::sc_ok )
-   {
-      memFree( data );
-      throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ).
-         desc( FAL_STR( th_msg_errdes ) ) );
-   }
-
-   memFree( data );
+   queue_deserialize( vm, data, retreived );
    vm->retval( retreived );
 }
 
@@ -1470,6 +1488,700 @@ FALCON_FUNC SyncQueue_size( VMachine *vm )
    vm->retval( (int64) synq->size() );
 }
 
+//=====================================================
+// RingQueue
+//
+
+/*#
+   @class RingQueue
+   @from Waitable
+   @optparam capacity Maximum count of items in the queue (defaults to 1024).
+   @optparam spin Count of retries before parking a waiting thread (defaults to 0).
+   @brief Bounded lock-free queue for many producers and consumers.
+   @raise ParamError if the capacity is not in the range 1 - 16777216.
+
+   This class implements a FIFO queue of Falcon items with a fixed
+   capacity, that is rounded up to the next power of 2. Pushing and popping
+   items doesn't lock the queue; producers and consumers running at the
+   same time don't wait for each other.
+
+   The queue can be waited on for non-empty status as the other @a Waitable
+   objects; differently from @a SyncQueue, it is not held by the acquiring
+   thread, and other consumers may empty it before the acquiring thread
+   pops an item. The @a RingQueue.pop and @a RingQueue.popMany methods
+   take care of this, waiting for an item to be available.
+
+   When the queue is full, @a RingQueue.push and @a RingQueue.pushMany wait
+   for the consumers to make room for the new items, so that fast producers
+   can't exhaust the memory.
+
+   Waiting threads retry their operation @b spin times before parking;
+   on multi-processor systems, a small spin count saves the cost of putting
+   to sleep and waking threads when the queue is busy.
+
+   @a RingQueue.pushMany and @a RingQueue.popMany transfer many items
+   with a single call, and wake the waiting threads once for all the items.
+
+   @note As for @a SyncQueue, the items in the queue are serialized copies
+   of the pushed items.
+*/
+
+FALCON_FUNC RingQueue_init( VMachine *vm )
+{
+   Item *i_capacity = vm->param( 0 );
+   Item *i_spin = vm->param( 1 );
+   if ( ( i_capacity != 0 && ! i_capacity->isNil() && ! i_capacity->isOrdinal() )
+      || ( i_spin != 0 && ! i_spin->isNil() && ! i_spin->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "[N],[N]" ) );
+   }
+
+   int64 capacity = i_capacity == 0 || i_capacity->isNil() ? 1024 : i_capacity->forceInteger();
+   int64 spin = i_spin == 0 || i_spin->isNil() ? 0 : i_spin->forceInteger();
+   if ( capacity < 1 || capacity > 0x1000000 || spin < 0 )
+   {
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ ).
+         extra( "[N],[N]" ) );
+   }
+
+   RingQueue *ring = new RingQueue( (uint32) capacity, (uint32) spin );
+   WaitableCarrier *wc = new WaitableCarrier( ring );
+   vm->self().asObject()->setUserData( wc );
+   ring->decref();
+}
+
+
+// Absolute time limit from an optional timeout in seconds; -1 for no limit.
+static numeric ring_deadline( VMachine *vm, Item *i_timeout )
+{
+   if ( i_timeout == 0 || i_timeout->isNil() )
+      return -1.0;
+
+   if ( ! i_timeout->isOrdinal() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "N" ) );
+   }
+
+   numeric timeout = i_timeout->forceNumeric();
+   return timeout < 0 ? -1.0 : Sys::_seconds() + timeout;
+}
+
+// Parks the thread until the waitable is acquired; returns false on timeout.
+static bool ring_park( VMachine *vm, Waitable *waitable, numeric deadline )
+{
+   int64 microsecs = -1;
+   if ( deadline >= 0 )
+   {
+      numeric left = deadline - Sys::_seconds();
+      if ( left <= 0 )
+         return false;
+      microsecs = (int64)( left * 1000000.0 );
+   }
+
+   ThreadImpl *self_th = checkMainThread( vm );
+   Waitable *waited[ 1 ];
+   waited[0] = waitable;
+   int64 res = self_th->waitForObjects( 1, waited, microsecs );
+
+   // if the res value is -2, then we have been interrupted.
+   if ( res == -2 )
+      vm->interrupted( true, true, true );
+
+   return res == 0;
+}
+
+// Pushes the items, spinning and parking while the queue is full.
+// Stops at the timeout; done is the count of pushed items even if interrupted.
+static void ring_push( VMachine *vm, RingQueue *ring, void **data, uint32 count, uint32 &done, numeric deadline )
+{
+   while( true )
+   {
+      uint32 spin = ring->spin();
+      do {
+         done += ring->pushMany( data + done, count - done );
+         if ( done == count )
+            return;
+      } while( spin-- > 0 );
+
+      if ( ! ring_park( vm, ring->space(), deadline ) )
+         return;
+   }
+}
+
+// Pops up to count items, spinning and parking while the queue is empty.
+// Returns the count of popped items; 0 on timeout.
+static uint32 ring_pop( VMachine *vm, RingQueue *ring, void **data, uint32 count, numeric deadline )
+{
+   while( true )
+   {
+      uint32 spin = ring->spin();
+      do {
+         uint32 done = ring->popMany( data, count );
+         if ( done > 0 )
+            return done;
+      } while( spin-- > 0 );
+
+      if ( ! ring_park( vm, ring, deadline ) )
+         return 0;
+   }
+}
+
+/*#
+   @method push RingQueue
+   @param item The item to be pushed.
+   @optparam timeout Maximum time to wait for room in the queue, in seconds.
+   @return True if the item was pushed, false if the timeout expired.
+   @raise CodeError if the @b item is not serializable.
+   @raise InterruptedError in case the thread receives a stop request.
+
+   This method adds an item at the end of the queue. If the queue
+   is full, it waits for the consumers to remove some items, forever if
+   @b timeout is not given, or at most for the given time. A timeout of
+   zero returns immediately.
+*/
+FALCON_FUNC RingQueue_push( VMachine *vm )
+{
+   Item *i_item = vm->param( 0 );
+   if ( i_item == 0 )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "X,[N]" ) );
+   }
+
+   numeric deadline = ring_deadline( vm, vm->param( 1 ) );
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+
+   void *data = queue_serialize( *i_item );
+   uint32 done = 0;
+   try
+   {
+      ring_push( vm, ring, &data, 1, done, deadline );
+   }
+   catch( Error* )
+   {
+      memFree( data );
+      throw;
+   }
+
+   if ( done == 0 )
+      memFree( data );
+   vm->regA().setBoolean( done == 1 );
+}
+
+/*#
+   @method pushMany RingQueue
+   @param items An array of items to be pushed.
+   @optparam timeout Maximum time to wait for room in the queue, in seconds.
+   @return The count of pushed items.
+   @raise CodeError if one of the @b items is not serializable.
+   @raise InterruptedError in case the thread receives a stop request.
+
+   This method adds all the items in the array at the end of the queue,
+   in order, waiting for room in the queue as @a RingQueue.push does.
+   If the timeout expires, the returned count is smaller than the size of
+   the array, and the items past that count are not in the queue.
+
+   The items are all serialized before pushing the first; if one of them
+   can't be serialized, no item is pushed.
+*/
+FALCON_FUNC RingQueue_pushMany( VMachine *vm )
+{
+   Item *i_items = vm->param( 0 );
+   if ( i_items == 0 || ! i_items->isArray() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "A,[N]" ) );
+   }
+
+   numeric deadline = ring_deadline( vm, vm->param( 1 ) );
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+
+   const ItemArray &items = i_items->asArray()->items();
+   uint32 count = items.length();
+   if ( count == 0 )
+   {
+      vm->retval( (int64) 0 );
+      return;
+   }
+
+   void **data = (void **) memAlloc( sizeof( void * ) * count );
+   uint32 done = 0;
+   try
+   {
+      for ( uint32 i = 0; i < count; ++i )
+      {
+         data[i] = queue_serialize( items[i] );
+         ++done;
+      }
+   }
+   catch( Error* )
+   {
+      for ( uint32 i = 0; i < done; ++i )
+         memFree( data[i] );
+      memFree( data );
+      throw;
+   }
+
+   done = 0;
+   try
+   {
+      ring_push( vm, ring, data, count, done, deadline );
+   }
+   catch( Error* )
+   {
+      for ( uint32 i = done; i < count; ++i )
+         memFree( data[i] );
+      memFree( data );
+      throw;
+   }
+
+   for ( uint32 i = done; i < count; ++i )
+      memFree( data[i] );
+   memFree( data );
+
+   vm->retval( (int64) done );
+}
+
+/*#
+   @method pop RingQueue
+   @optparam timeout Maximum time to wait for an item, in seconds.
+   @return The item that was in front of the queue.
+   @raise ThreadError if the queue is still empty when the timeout expires.
+   @raise InterruptedError in case the thread receives a stop request.
+
+   This method removes the item in front of the queue and returns it.
+   If the queue is empty, it waits for an item to be pushed, forever if
+   @b timeout is not given, or at most for the given time. A timeout of
+   zero returns immediately.
+*/
+FALCON_FUNC RingQueue_pop( VMachine *vm )
+{
+   numeric deadline = ring_deadline( vm, vm->param( 0 ) );
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+
+   void *data;
+   if ( ring_pop( vm, ring, &data, 1, deadline ) == 0 )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_QEMPTY, __LINE__ ).
+         desc( FAL_STR( th_msg_qempty ) ) );
+   }
+
+   Item retreived;
+   queue_deserialize( vm, data, retreived );
+   vm->retval( retreived );
+}
+
+/*#
+   @method popMany RingQueue
+   @param count Maximum count of items to be removed.
+   @optparam timeout Maximum time to wait for an item, in seconds.
+   @return An array with the items removed from the front of the queue.
+   @raise InterruptedError in case the thread receives a stop request.
+
+   This method removes up to @b count items from the front of the queue,
+   and returns them in order. If the queue is empty, it waits for at
+   least one item to be pushed, as @a RingQueue.pop does; if the timeout
+   expires, an empty array is returned.
+*/
+FALCON_FUNC RingQueue_popMany( VMachine *vm )
+{
+   Item *i_count = vm->param( 0 );
+   if ( i_count == 0 || ! i_count->isOrdinal() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "N,[N]" ) );
+   }
+
+   numeric deadline = ring_deadline( vm, vm->param( 1 ) );
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+
+   int64 count = i_count->forceInteger();
+   if ( count < 1 )
+   {
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ ).
+         extra( "N,[N]" ) );
+   }
+   // we can't get more than the queue can hold.
+   if ( count > (int64) ring->capacity() )
+      count = ring->capacity();
+
+   void **data = (void **) memAlloc( sizeof( void * ) * (uint32) count );
+   uint32 done;
+   try
+   {
+      done = ring_pop( vm, ring, data, (uint32) count, deadline );
+   }
+   catch( Error* )
+   {
+      memFree( data );
+      throw;
+   }
+
+   CoreArray *items = new CoreArray( done );
+   uint32 pos = 0;
+   try
+   {
+      while( pos < done )
+      {
+         Item retreived;
+         queue_deserialize( vm, data[pos++], retreived );
+         items->append( retreived );
+      }
+   }
+   catch( Error* )
+   {
+      while( pos < done )
+         memFree( data[pos++] );
+      memFree( data );
+      throw;
+   }
+
+   memFree( data );
+   vm->retval( items );
+}
+
+/*#
+   @method size RingQueue
+   @brief Returns the count of items currently stored in the queue.
+   @return Number of items currently held in the queue.
+
+   As the queue is not held by any thread, the count can be changed by
+   other threads right after this method returns.
+*/
+FALCON_FUNC RingQueue_size( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+   vm->retval( (int64) ring->size() );
+}
+
+/*#
+   @method empty RingQueue
+   @brief Returns true if the queue is empty.
+   @return True if the queue is empty.
+*/
+FALCON_FUNC RingQueue_empty( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+   vm->regA().setBoolean( ring->empty() );
+}
+
+/*#
+   @method capacity RingQueue
+   @brief Returns the maximum count of items that the queue can hold.
+   @return The capacity of the queue.
+*/
+FALCON_FUNC RingQueue_capacity( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   RingQueue *ring = static_cast< RingQueue *>( wc->waitable() );
+   vm->retval( (int64) ring->capacity() );
+}
+
+//=====================================================
+// ThreadPool
+//
+
+/*#
+   @class ThreadPool
+   @optparam workers Number of worker threads (defaults to the CPU count).
+   @brief Set of persistent threads running submitted tasks.
+   @raise ThreadError if the worker threads can't be started.
+
+   Starting a @a Thread requires a new system thread and a new Virtual
+   Machine, which must be linked with all the modules of the calling
+   one. For short tasks, that setup costs more than the task itself.
+
+   A ThreadPool starts its worker threads and links their Virtual
+   Machines once, when it's created. Tasks are then given to the pool
+   through @a ThreadPool.submit, which returns immediately a @a Future
+   that can be waited with the other @a waiting_funcs.
+
+   Each worker has a queue of tasks; submitted tasks are spread among
+   the queues in turn, and workers having nothing to do take the tasks
+   waiting in the queues of the busy workers.
+
+   As for @a Threading.start, the submitted callable items and their
+   return values are copied through serialization; the workers don't
+   see the global variables of the calling VM, and they keep their
+   own global state across the tasks they run.
+
+   The pool can be shared with other threads. It is shut down when it is
+   not referenced anymore, when the Virtual Machine that created it
+   terminates, or through @a ThreadPool.shutdown.
+
+   @code
+      load threading
+
+      function fib( n )
+         if n < 2: return n
+         return fib( n - 1 ) + fib( n - 2 )
+      end
+
+      pool = ThreadPool( 4 )
+      futures = []
+      for i in [15:25]: futures += pool.submit( .[fib i] )
+      for f in futures: > f.get()
+      pool.shutdown()
+   @endcode
+*/
+FALCON_FUNC ThreadPool_init( VMachine *vm )
+{
+   Item *i_workers = vm->param( 0 );
+   if ( i_workers != 0 && ! i_workers->isNil() && ! i_workers->isOrdinal() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "[N]" ) );
+   }
+
+   // the pools are shut down when the main VM terminates.
+   checkMainThread( vm );
+
+   ThreadPool *pool = new ThreadPool( parallelWorkers( i_workers ) );
+   try
+   {
+      pool->start( vm );
+   }
+   catch( Error* )
+   {
+      pool->shutdown( true );
+      pool->decref();
+      throw;
+   }
+
+   vm->self().asObject()->setUserData( new PoolCarrier( pool ) );
+   pool->decref();
+}
+
+/*#
+   @method submit ThreadPool
+   @brief Queues a task for execution in one of the workers.
+   @param callable The function or callable item to be run.
+   @return A @a Future receiving the outcome of the task.
+   @raise ThreadError if the pool has been shut down, or if @b callable
+      can't be transferred to the workers.
+
+   The @b callable item is called without parameters; to pass parameters,
+   use a callable array, as in @a Threading.start.
+*/
+FALCON_FUNC ThreadPool_submit( VMachine *vm )
+{
+   Item *i_callable = vm->param( 0 );
+   if ( i_callable == 0 || ! i_callable->isCallable() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "C" ) );
+   }
+
+   ThreadPool *pool = static_cast<PoolCarrier *>( vm->self().asObject()->getUserData() )->pool();
+
+   StringStream call( 512 );
+   if ( i_callable->serialize( &call, true ) != Item::sc_ok )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_SERIALIZE, __LINE__ ).
+         desc( FAL_STR( th_msg_errser ) ) );
+   }
+
+   Item *fut_class = vm->findWKI( "Future" );
+   fassert( fut_class != 0 && fut_class->isClass() );
+   CoreObject *objFuture = fut_class->asClass()->createInstance();
+
+   Future *future = new Future;
+   objFuture->setUserData( new WaitableCarrier( future ) );
+   future->decref();
+
+   if ( ! pool->submit( call, future ) )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_POOLDOWN, __LINE__ ).
+         desc( FAL_STR( th_msg_pooldown ) ) );
+   }
+
+   vm->retval( objFuture );
+}
+
+/*#
+   @method shutdown ThreadPool
+   @brief Stops accepting new tasks and terminates the workers.
+   @optparam wait If false, return without waiting for the workers (defaults to true).
+
+   The workers terminate after having run all the tasks that were already
+   submitted. After this call, @a ThreadPool.submit raises a ThreadError.
+
+   Only the first call can wait for the workers to terminate; the
+   @a Future objects can still be used to wait for the single tasks.
+*/
+FALCON_FUNC ThreadPool_shutdown( VMachine *vm )
+{
+   Item *i_wait = vm->param( 0 );
+   bool bWait = i_wait == 0 || i_wait->isTrue();
+
+   ThreadPool *pool = static_cast<PoolCarrier *>( vm->self().asObject()->getUserData() )->pool();
+
+   if ( bWait )
+   {
+      vm->idle();
+      pool->shutdown( true );
+      vm->unidle();
+   }
+   else
+      pool->shutdown( false );
+}
+
+/*#
+   @method stats ThreadPool
+   @brief Returns the usage figures of the pool.
+   @return A dictionary with the figures.
+
+   The returned dictionary contains the following keys:
+   - @b workers: number of worker threads.
+   - @b submitted: tasks submitted so far.
+   - @b completed: tasks that returned a value.
+   - @b failed: tasks that raised an error.
+   - @b stolen: tasks run by a worker other than the one they were queued to.
+   - @b pending: tasks waiting in the queues.
+   - @b active: tasks being currently run.
+   - @b shutdown: true if the pool has been shut down.
+
+   The figures are read while the workers run, so they may be slightly
+   inconsistent with each other.
+*/
+FALCON_FUNC ThreadPool_stats( VMachine *vm )
+{
+   ThreadPool *pool = static_cast<PoolCarrier *>( vm->self().asObject()->getUserData() )->pool();
+
+   LinearDict *stats = new LinearDict( 8 );
+   stats->put( new CoreString( "workers" ), (int64) pool->workers() );
+   stats->put( new CoreString( "submitted" ), (int64) pool->submitted() );
+   stats->put( new CoreString( "completed" ), (int64) pool->completed() );
+   stats->put( new CoreString( "failed" ), (int64) pool->failed() );
+   stats->put( new CoreString( "stolen" ), (int64) pool->stolen() );
+   stats->put( new CoreString( "pending" ), (int64) pool->pending() );
+   stats->put( new CoreString( "active" ), (int64) pool->active() );
+   Item down;
+   down.setBoolean( pool->isShutdown() );
+   stats->put( new CoreString( "shutdown" ), down );
+   vm->retval( new CoreDict( stats ) );
+}
+
+//=====================================================
+// Future
+//
+
+/*#
+   @class Future
+   @from Waitable
+   @brief Outcome of a task submitted to a @a ThreadPool.
+
+   Instances of this class are returned by @a ThreadPool.submit. A future
+   can be acquired by the @a waiting_funcs as soon as its task is complete,
+   and it stays acquirable afterwards; release is a no-op.
+
+   The value returned by the task, or the error it raised, can then be
+   retreived with @a Future.get.
+
+   @code
+      f1 = pool.submit( .[work "a"] )
+      f2 = pool.submit( .[work "b"] )
+      first = Threading.wait( f1, f2, queue )
+   @endcode
+*/
+
+/*#
+   @method get Future
+   @brief Waits for the task to complete and returns its result.
+   @return A local copy of the value returned by the task.
+   @raise ThreadError if the task raised an error.
+   @raise InterruptedError in case the thread receives a stop request.
+
+   If the task terminated with an error, a ThreadError is raised, having
+   the original error as sub-error.
+*/
+FALCON_FUNC Future_get( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   Future *future = static_cast< Future *>( wc->waitable() );
+
+   if ( ! future->acquire() )
+   {
+      ThreadImpl *self_th = checkMainThread( vm );
+      Waitable *waited[ 1 ];
+      waited[0] = future;
+      int64 res = self_th->waitForObjects( 1, waited, -1 );
+
+      // if the res value is -2, then we have been interrupted.
+      if ( res == -2 )
+      {
+         vm->interrupted( true, true, true );
+         return;
+      }
+   }
+
+   if ( future->error() != 0 )
+   {
+      ThreadError *therr = new ThreadError( ErrorParam( FALTH_ERR_TASK, __LINE__ ).
+         desc( FAL_STR( th_msg_taskerr ) ) );
+      therr->appendSubError( future->error() );
+      throw therr;
+   }
+
+   ROStringStream sstream( future->result() );
+   Item result;
+   if ( result.deserialize( &sstream, vm ) != Item::sc_ok )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ).
+         desc( FAL_STR( th_msg_errdes ) ) );
+   }
+   vm->retval( result );
+}
+
+/*#
+   @method done Future
+   @brief Checks if the task is complete.
+   @return True if the task returned a value or raised an error.
+*/
+FALCON_FUNC Future_done( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   Future *future = static_cast< Future *>( wc->waitable() );
+   vm->regA().setBoolean( future->isDone() );
+}
+
+/*#
+   @method hadError Future
+   @brief Checks if the task terminated with an error.
+   @return True if the task is complete and raised an error.
+*/
+FALCON_FUNC Future_hadError( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   Future *future = static_cast< Future *>( wc->waitable() );
+   vm->regA().setBoolean( future->isDone() && future->error() != 0 );
+}
+
+/*#
+   @method getError Future
+   @brief Returns the error raised by the task.
+   @return The error raised by the task, or nil if the task is not complete
+      or terminated correctly.
+*/
+FALCON_FUNC Future_getError( VMachine *vm )
+{
+   WaitableCarrier *wc = static_cast< WaitableCarrier *>( vm->self().asObject()->getUserData() );
+   Future *future = static_cast< Future *>( wc->waitable() );
+
+   if ( future->isDone() && future->error() != 0 )
+      vm->retval( future->error()->scriptize( vm ) );
+   else
+      vm->retnil();
+}
+
 //=====================================================
 // Generic threading class
 //
@@ -1638,33 +2350,9 @@ FALCON_FUNC Threading_start( VMachine *vm )
          desc( FAL_STR( th_msg_running ) ) );
    }
 
-   // First link in falcon.core module.
+   // Prepare the modules to be linked in the new VM.
    Runtime rt;
-   LiveModule *fc = vm->findModule( "falcon.core" );
-   if ( 0 != fc )
-      rt.addModule( const_cast<Module *>(fc->module()) );
-
-   // The main module goes after.
-   LiveModule* mainMod = vm->mainModule();
-
-   // Prelink the modules into the new VM
-   const LiveModuleMap &mods = vm->liveModules();
-   MapIterator iter = mods.begin();
-   while( iter.hasCurrent() )
-   {
-      LiveModule *lmod = *(LiveModule **) iter.currentValue();
-      if( lmod != fc && lmod != mainMod )
-      {
-         Module *mod = const_cast<Module*>(lmod->module());
-         rt.addModule( mod, lmod->isPrivate() );
-      }
-
-      iter.next();
-   }
-
-   // finally, insert the main module
-   if ( mainMod != 0 )
-      rt.addModule( const_cast<Module*>(mainMod->module()), mainMod->isPrivate() );
+   prepareRuntime( vm, rt );
 
 
    // Do not set error handler; errors will emerge in the module.
@@ -1707,6 +2395,240 @@ FALCON_FUNC Threading_start( VMachine *vm )
 }
 
 
+static void runParallel( VMachine* vm, ParallelTask& task, const Item& func, const ItemArray& source )
+{
+   task.prepare( vm, func );
+   while( task.publish( source ) )
+   {
+      // workers start on the first chunks while the others are published.
+   }
+   task.wait();
+}
+
+
+static void parallelResult( VMachine* vm, const ParallelTask& task, uint32 chunk, Item& target )
+{
+   if ( ! task.result( chunk, target, vm ) )
+   {
+      throw new ThreadError( ErrorParam( FALTH_ERR_DESERIAL, __LINE__ ).
+         desc( FAL_STR( th_msg_errdes ) ) );
+   }
+}
+
+/*#
+   @method pmap Threading
+   @brief Applies a function to all the items of an array using parallel threads.
+   @param func The function to be applied.
+   @param array The array of items to be processed.
+   @optparam workers Number of threads to be used (defaults to the CPU count).
+   @return A new array containing the results of the function.
+   @raise ThreadError if the items can't be transferred, or if @b func raised an error.
+
+   This method works as the core @b map function, except that @b array is split
+   in chunks which are processed by a set of worker threads. Each worker runs
+   in a separate VM linked with the same modules of the caller, so @b func can
+   call any function or class visible to the calling module.
+
+   The function and the items are transferred to the workers by value, as with
+   @a Threading.start; the results are transferred back in the same way, and
+   are returned in the same order of the original items. Items that can't be
+   serialized (as open streams or live objects of binary modules) can't be
+   processed this way.
+
+   If @b func raises an error while processing an item, the other workers are
+   stopped as soon as they are done with their current chunk, and a
+   ThreadError is raised, having the error raised by @b func as sub-error.
+
+   As the transfer has a cost, this method is useful only when @b func
+   performs a relevant amount of work on each item.
+
+   @code
+      load threading
+
+      function slow_square( x )
+         for i in [0:100000]: x += 0
+         return x * x
+      end
+
+      > Threading.pmap( slow_square, [1:20] ).describe()
+   @endcode
+*/
+FALCON_FUNC Threading_pmap( VMachine *vm )
+{
+   Item *i_func = vm->param( 0 );
+   Item *i_array = vm->param( 1 );
+   Item *i_workers = vm->param( 2 );
+   if ( i_func == 0 || ! i_func->isCallable()
+        || i_array == 0 || ! i_array->isArray()
+        || ( i_workers != 0 && ! i_workers->isNil() && ! i_workers->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "C,A,[N]" ) );
+   }
+
+   uint32 workers = parallelWorkers( i_workers );
+   const ItemArray& source = i_array->asArray()->items();
+   if ( source.length() == 0 )
+   {
+      vm->retval( new CoreArray );
+      return;
+   }
+
+   ParallelTask task( ParallelTask::e_map, source.length(), workers );
+   runParallel( vm, task, *i_func, source );
+
+   CoreArray* result = new CoreArray( source.length() );
+   for ( uint32 c = 0; c < task.chunks(); ++c )
+   {
+      Item chunk;
+      parallelResult( vm, task, c, chunk );
+      result->merge( *chunk.asArray() );
+   }
+
+   vm->retval( result );
+}
+
+/*#
+   @method pfilter Threading
+   @brief Filters the items of an array using parallel threads.
+   @param func The function deciding which items are accepted.
+   @param array The array of items to be filtered.
+   @optparam workers Number of threads to be used (defaults to the CPU count).
+   @return A new array containing the items for which @b func returned true.
+   @raise ThreadError if the items can't be transferred, or if @b func raised an error.
+
+   This method works as the core @b filter function, but the items are checked
+   by a set of worker threads, as described in @a Threading.pmap.
+
+   Only the items are transferred to the workers; the returned array contains
+   the original items of @b array, in their original order.
+*/
+FALCON_FUNC Threading_pfilter( VMachine *vm )
+{
+   Item *i_func = vm->param( 0 );
+   Item *i_array = vm->param( 1 );
+   Item *i_workers = vm->param( 2 );
+   if ( i_func == 0 || ! i_func->isCallable()
+        || i_array == 0 || ! i_array->isArray()
+        || ( i_workers != 0 && ! i_workers->isNil() && ! i_workers->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "C,A,[N]" ) );
+   }
+
+   uint32 workers = parallelWorkers( i_workers );
+   const ItemArray& source = i_array->asArray()->items();
+   if ( source.length() == 0 )
+   {
+      vm->retval( new CoreArray );
+      return;
+   }
+
+   ParallelTask task( ParallelTask::e_filter, source.length(), workers );
+   runParallel( vm, task, *i_func, source );
+
+   CoreArray* result = new CoreArray;
+   for ( uint32 c = 0; c < task.chunks(); ++c )
+   {
+      Item chunk;
+      parallelResult( vm, task, c, chunk );
+
+      // the workers send back the positions of the accepted items.
+      const ItemArray& accepted = chunk.asArray()->items();
+      const uint32 start = task.chunkStart( c );
+      for ( uint32 i = 0; i < accepted.length(); ++i )
+         result->append( source[ start + (uint32) accepted[i].asInteger() ] );
+   }
+
+   vm->retval( result );
+}
+
+/*#
+   @method preduce Threading
+   @brief Reduces an array to a single value using parallel threads.
+   @param func A function receiving two values and returning their combination.
+   @param array The array of items to be reduced.
+   @optparam initial Optional startup value for the reduction.
+   @optparam workers Number of threads to be used (defaults to the CPU count).
+   @return The reduced result.
+   @raise ThreadError if the items can't be transferred, or if @b func raised an error.
+
+   This method works as the core @b reduce function, but @b array is split in
+   chunks which are reduced separately by a set of worker threads, as described
+   in @a Threading.pmap. The partial results are then reduced in order by the
+   calling thread, starting from @b initial if given.
+
+   For this reason, @b func must be associative: the result must not depend on
+   how the items are grouped (as it happens for sums, products, minimum and
+   maximum). The order of the items is preserved, so @b func needs not to be
+   commutative.
+
+   If @b array is empty, @b initial is returned, or nil if not given. A nil
+   @b initial is the same as no initial value, so that @b workers can be given
+   alone.
+
+   @code
+      load threading
+      > Threading.preduce( {a, b => a + b}, [1:1001] )    // 500500
+   @endcode
+*/
+FALCON_FUNC Threading_preduce( VMachine *vm )
+{
+   Item *i_func = vm->param( 0 );
+   Item *i_array = vm->param( 1 );
+   Item *i_initial = vm->param( 2 );
+   Item *i_workers = vm->param( 3 );
+   if ( i_func == 0 || ! i_func->isCallable()
+        || i_array == 0 || ! i_array->isArray()
+        || ( i_workers != 0 && ! i_workers->isNil() && ! i_workers->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "C,A,[X],[N]" ) );
+   }
+
+   if ( i_initial != 0 && i_initial->isNil() )
+      i_initial = 0;
+
+   uint32 workers = parallelWorkers( i_workers );
+   const ItemArray& source = i_array->asArray()->items();
+   if ( source.length() == 0 )
+   {
+      if ( i_initial != 0 )
+         vm->retval( *i_initial );
+      else
+         vm->retnil();
+      return;
+   }
+
+   ParallelTask task( ParallelTask::e_reduce, source.length(), workers );
+   runParallel( vm, task, *i_func, source );
+
+   // partials are kept in a locked array, as the reductions may run the GC.
+   CoreArray* partials = new CoreArray( task.chunks() + 1 );
+   Item i_partials( partials );
+   GarbageLock partialsLock( i_partials );
+   if ( i_initial != 0 )
+      partials->append( *i_initial );
+
+   for ( uint32 c = 0; c < task.chunks(); ++c )
+   {
+      Item partial;
+      parallelResult( vm, task, c, partial );
+      partials->append( partial );
+   }
+
+   Item acc = partials->at( 0 );
+   for ( uint32 i = 1; i < partials->length(); ++i )
+   {
+      vm->pushParam( acc );
+      vm->pushParam( partials->at( i ) );
+      vm->callItemAtomic( *vm->param( 0 ), 2 );
+      acc = vm->regA();
+   }
+
+   vm->retval( acc );
+}
+
 //=====================================================
 // ThreadError class
 //
@@ -39,6 +39,10 @@
 #define FALTH_ERR_JOINE       (FALCON_THREADING_ERROR_BASE + 7)
 #define FALTH_ERR_QEMPTY      (FALCON_THREADING_ERROR_BASE + 8)
 #define FALTH_ERR_DESERIAL    (FALCON_THREADING_ERROR_BASE + 9)
+#define FALTH_ERR_SERIALIZE   (FALCON_THREADING_ERROR_BASE + 10)
+#define FALTH_ERR_PARALLEL    (FALCON_THREADING_ERROR_BASE + 11)
+#define FALTH_ERR_POOLDOWN    (FALCON_THREADING_ERROR_BASE + 12)
+#define FALTH_ERR_TASK        (FALCON_THREADING_ERROR_BASE + 13)
 
 namespace Falcon {
 namespace Ext {
@@ -53,6 +57,9 @@ FALCON_FUNC Threading_getCurrentID( VMachine *vm );
 FALCON_FUNC Threading_getCurrent( VMachine *vm );
 FALCON_FUNC Threading_sameThread( VMachine *vm );
 FALCON_FUNC Threading_start( VMachine *vm );
+FALCON_FUNC Threading_pmap( VMachine *vm );
+FALCON_FUNC Threading_pfilter( VMachine *vm );
+FALCON_FUNC Threading_preduce( VMachine *vm );
 
 //=====================================================
 // Thread class
@@ -119,6 +126,34 @@ FALCON_FUNC SyncQueue_popFront( VMachine *vm );
 FALCON_FUNC SyncQueue_empty( VMachine *vm );
 FALCON_FUNC SyncQueue_size( VMachine *vm );
 
+//=====================================================
+// RingQueue
+//
+FALCON_FUNC RingQueue_init( VMachine *vm );
+FALCON_FUNC RingQueue_push( VMachine *vm );
+FALCON_FUNC RingQueue_pushMany( VMachine *vm );
+FALCON_FUNC RingQueue_pop( VMachine *vm );
+FALCON_FUNC RingQueue_popMany( VMachine *vm );
+FALCON_FUNC RingQueue_empty( VMachine *vm );
+FALCON_FUNC RingQueue_size( VMachine *vm );
+FALCON_FUNC RingQueue_capacity( VMachine *vm );
+
+//=====================================================
+// ThreadPool
+//
+FALCON_FUNC ThreadPool_init( VMachine *vm );
+FALCON_FUNC ThreadPool_submit( VMachine *vm );
+FALCON_FUNC ThreadPool_shutdown( VMachine *vm );
+FALCON_FUNC ThreadPool_stats( VMachine *vm );
+
+//=====================================================
+// Future
+//
+FALCON_FUNC Future_get( VMachine *vm );
+FALCON_FUNC Future_done( VMachine *vm );
+FALCON_FUNC Future_hadError( VMachine *vm );
+FALCON_FUNC Future_getError( VMachine *vm );
+
 //=====================================================
 // ThreadError
 //
@@ -22,8 +22,10 @@
 #include <falcon/coreobject.h>
 #include <falcon/vm.h>
 #include <falcon/garbagelock.h>
+#include <falcon/runtime.h>
 
 #include "threading_mod.h"
+#include "pool.h"
 
 namespace Falcon {
 namespace Ext {
@@ -53,6 +55,36 @@ ThreadImpl* getRunningThread()
    return static_cast<ThreadImpl*>( m_curthread.get() );
 }
 
+void prepareRuntime( VMachine* vm, Runtime& rt )
+{
+   // First link in falcon.core module.
+   LiveModule *fc = vm->findModule( "falcon.core" );
+   if ( 0 != fc )
+      rt.addModule( const_cast<Module *>(fc->module()) );
+
+   // The main module goes after.
+   LiveModule* mainMod = vm->mainModule();
+
+   // Prelink the modules into the new VM
+   const LiveModuleMap &mods = vm->liveModules();
+   MapIterator iter = mods.begin();
+   while( iter.hasCurrent() )
+   {
+      LiveModule *lmod = *(LiveModule **) iter.currentValue();
+      if( lmod != fc && lmod != mainMod )
+      {
+         Module *mod = const_cast<Module*>(lmod->module());
+         rt.addModule( mod, lmod->isPrivate() );
+      }
+
+      iter.next();
+   }
+
+   // finally, insert the main module
+   if ( mainMod != 0 )
+      rt.addModule( const_cast<Module*>(mainMod->module()), mainMod->isPrivate() );
+}
+
 //========================================================
 // Thread carrier
 //
@@ -181,6 +213,7 @@ void *ThreadImpl::run()
       m_lastError = err;
    }
 
+   shutdownPools( m_vm );
    m_vm->finalize();  // and we won't use it anymore
    m_thstatus.terminated();
 
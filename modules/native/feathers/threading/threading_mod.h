@@ -29,6 +29,9 @@
 #include <waitable.h>
 
 namespace Falcon {
+
+class Runtime;
+
 namespace Ext{
 
 class ThreadImpl: public Runnable, public BaseAlloc
@@ -204,6 +207,12 @@ public:
 extern void setRunningThread( ThreadImpl* th );
 extern ThreadImpl* getRunningThread();
 
+/** Fills a runtime with the modules linked in a VM.
+   Linking the runtime in a new VM readies it to run the same code,
+   sharing the modules with the original VM.
+*/
+extern void prepareRuntime( VMachine* vm, Runtime& rt );
+
 }
 }
 
@@ -30,5 +30,9 @@ FAL_MODSTR( th_msg_joinwitherr, "Joined thread terminated with error" );
 
 FAL_MODSTR( th_msg_qempty, "Queue is empty" );
 FAL_MODSTR( th_msg_errdes, "Error in deserializing an item" );
+FAL_MODSTR( th_msg_errser, "Item cannot be transferred to another thread" );
+FAL_MODSTR( th_msg_parallelerr, "Parallel function terminated with error" );
+FAL_MODSTR( th_msg_pooldown, "Thread pool has been shut down" );
+FAL_MODSTR( th_msg_taskerr, "Task terminated with error" );
 
 /* threading_st.h */
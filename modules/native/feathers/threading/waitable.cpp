@@ -24,6 +24,7 @@
 #include <falcon/basealloc.h>
 #include <falcon/genericlist.h>
 #include <falcon/memory.h>
+#include <falcon/stringstream.h>
 #include <waitable.h>
 
 #include <systhread.h>
@@ -310,6 +311,66 @@ void SyncCounter::post( int count )
 
 }
 
+//=====================================
+// Future
+//
+
+Future::Future():
+   m_bDone( false ),
+   m_error( 0 )
+{}
+
+Future::~Future()
+{
+   if ( m_error != 0 )
+      m_error->decref();
+}
+
+bool Future::acquire()
+{
+   m_mtx.lock();
+   bool bStatus = m_bDone;
+   m_mtx.unlock();
+   return bStatus;
+}
+
+
+bool Future::acquireInternal()
+{
+   return m_bDone;
+}
+
+void Future::release()
+{
+   // no-op
+}
+
+void Future::complete( StringStream& result )
+{
+   m_mtx.lock();
+   result.closeToString( m_result );
+   m_bDone = true;
+   broadcast();
+   m_mtx.unlock();
+}
+
+void Future::fail( Error* error )
+{
+   m_mtx.lock();
+   m_error = error;
+   m_bDone = true;
+   broadcast();
+   m_mtx.unlock();
+}
+
+bool Future::isDone() const
+{
+   m_mtx.lock();
+   bool bStatus = m_bDone;
+   m_mtx.unlock();
+   return bStatus;
+}
+
 //=====================================
 // Thread statatus
 //
@@ -583,6 +644,258 @@ uint32 SyncQueue::size() const
    return nSize;
 }
 
+//=========================================================
+// RingQueue
+//
+
+// Sequence numbers wrap around; compare them through their difference.
+static inline int32 ring_add( int32 seq, uint32 count )
+{
+   return (int32) ( (uint32) seq + count );
+}
+
+static inline int32 ring_diff( int32 a, int32 b )
+{
+   return (int32) ( (uint32) a - (uint32) b );
+}
+
+
+RingSpace::RingSpace( RingQueue* queue ):
+   m_queue( queue ),
+   m_waiters( 0 )
+{}
+
+
+RingSpace::~RingSpace()
+{}
+
+
+bool RingSpace::acquire()
+{
+   return m_queue->canPush();
+}
+
+
+bool RingSpace::acquireInternal()
+{
+   // Called under the mutex before parking: the producers seeing the flag
+   // after having freed a cell will wake us, or we'll see the free cell.
+   atomicCAS( m_waiters, 0, 1 );
+   return m_queue->canPush();
+}
+
+
+void RingSpace::release()
+{
+   // the space is not held.
+}
+
+
+void RingSpace::wake()
+{
+   if ( m_waiters != 0 )
+   {
+      m_mtx.lock();
+      m_waiters = 0;
+      broadcast();
+      m_mtx.unlock();
+   }
+}
+
+
+RingQueue::RingQueue( uint32 capacity, uint32 spin ):
+   m_spin( spin ),
+   m_head( 0 ),
+   m_tail( 0 ),
+   m_waiters( 0 )
+{
+   uint32 size = 2;
+   while( size < capacity )
+      size <<= 1;
+
+   m_mask = size - 1;
+   m_cells = (Cell *) memAlloc( sizeof( Cell ) * size );
+   for ( uint32 i = 0; i < size; ++i )
+   {
+      m_cells[i].m_seq = (int32) i;
+      m_cells[i].m_data = 0;
+   }
+
+   m_space = new RingSpace( this );
+}
+
+
+RingQueue::~RingQueue()
+{
+   void *data;
+   while( popCell( data ) )
+      memFree( data );
+
+   memFree( m_cells );
+   m_space->decref();
+}
+
+
+bool RingQueue::pushCell( void *data )
+{
+   int32 pos = m_head;
+   Cell *cell;
+
+   while( true )
+   {
+      cell = m_cells + ( (uint32) pos & m_mask );
+      int32 dif = ring_diff( cell->m_seq, pos );
+
+      // is the cell free for this turn?
+      if ( dif == 0 )
+      {
+         if ( atomicCAS( m_head, pos, ring_add( pos, 1 ) ) )
+            break;
+      }
+      // the cell of the previous turn has not been read yet.
+      else if ( dif < 0 )
+         return false;
+
+      pos = m_head;
+   }
+
+   cell->m_data = data;
+   // publishes the data; can't fail, as the cell is reserved to us.
+   atomicCAS( cell->m_seq, pos, ring_add( pos, 1 ) );
+   return true;
+}
+
+
+bool RingQueue::popCell( void *&data )
+{
+   int32 pos = m_tail;
+   Cell *cell;
+
+   while( true )
+   {
+      cell = m_cells + ( (uint32) pos & m_mask );
+      int32 dif = ring_diff( cell->m_seq, ring_add( pos, 1 ) );
+
+      // has the cell been written in this turn?
+      if ( dif == 0 )
+      {
+         if ( atomicCAS( m_tail, pos, ring_add( pos, 1 ) ) )
+            break;
+      }
+      else if ( dif < 0 )
+         return false;
+
+      pos = m_tail;
+   }
+
+   data = cell->m_data;
+   // gives the cell to the writer of the next turn.
+   atomicCAS( cell->m_seq, ring_add( pos, 1 ), ring_add( pos, m_mask + 1 ) );
+   return true;
+}
+
+
+bool RingQueue::canPush() const
+{
+   int32 pos = m_head;
+   return ring_diff( m_cells[ (uint32) pos & m_mask ].m_seq, pos ) >= 0;
+}
+
+
+bool RingQueue::canPop() const
+{
+   int32 pos = m_tail;
+   return ring_diff( m_cells[ (uint32) pos & m_mask ].m_seq, ring_add( pos, 1 ) ) >= 0;
+}
+
+
+void RingQueue::wake()
+{
+   if ( m_waiters != 0 )
+   {
+      m_mtx.lock();
+      m_waiters = 0;
+      broadcast();
+      m_mtx.unlock();
+   }
+}
+
+
+bool RingQueue::acquire()
+{
+   return canPop();
+}
+
+
+bool RingQueue::acquireInternal()
+{
+   // see RingSpace::acquireInternal
+   atomicCAS( m_waiters, 0, 1 );
+   return canPop();
+}
+
+
+void RingQueue::release()
+{
+   // the queue is not held.
+}
+
+
+bool RingQueue::push( void *data )
+{
+   if ( ! pushCell( data ) )
+      return false;
+
+   wake();
+   return true;
+}
+
+
+bool RingQueue::pop( void *&data )
+{
+   if ( ! popCell( data ) )
+      return false;
+
+   m_space->wake();
+   return true;
+}
+
+
+uint32 RingQueue::pushMany( void **data, uint32 count )
+{
+   uint32 done = 0;
+   while( done < count && pushCell( data[done] ) )
+      ++done;
+
+   // a single wake up for the whole batch.
+   if ( done > 0 )
+      wake();
+   return done;
+}
+
+
+uint32 RingQueue::popMany( void **data, uint32 count )
+{
+   uint32 done = 0;
+   while( done < count && popCell( data[done] ) )
+      ++done;
+
+   if ( done > 0 )
+      m_space->wake();
+   return done;
+}
+
+
+uint32 RingQueue::size() const
+{
+   int32 size = ring_diff( m_head, m_tail );
+   if ( size < 0 )
+      return 0;
+   if ( (uint32) size > capacity() )
+      return capacity();
+   return (uint32) size;
+}
+
 }
 }
 
@@ -34,6 +34,7 @@
 namespace Falcon {
 
 class Item;
+class StringStream;
 
 namespace Ext {
 
@@ -157,6 +158,102 @@ public:
    virtual uint32 size() const;
 };
 
+class RingQueue;
+
+/** Waitable acquired when a RingQueue has room for more items. */
+class RingSpace: public Waitable
+{
+   friend class RingQueue;
+   RingQueue* m_queue;
+   volatile int32 m_waiters;
+
+   RingSpace( RingQueue* queue );
+   void wake();
+
+protected:
+   virtual bool acquireInternal();
+
+public:
+   virtual ~RingSpace();
+
+   virtual bool acquire();
+   virtual void release();
+};
+
+/** Bounded lock-free multi-producer, multi-consumer queue.
+
+   The items are stored in a ring of cells, each one carrying a sequence
+   number telling if it can be written or read in the current turn.
+   Producers and consumers reserve the cells by moving the head and the
+   tail of the ring with a compare-and-swap, so that they never wait for
+   each other.
+
+   The queue is acquired when it is not empty, and space() is acquired
+   when it is not full; neither is held by the acquiring thread, which
+   must be ready to find the queue emptied or filled again by the others.
+   The mutexes of the waitables are used only when there are threads
+   parked on them.
+*/
+class RingQueue: public Waitable
+{
+   friend class RingSpace;
+
+   typedef struct {
+      volatile int32 m_seq;
+      void *m_data;
+   } Cell;
+
+   Cell *m_cells;
+   uint32 m_mask;
+   uint32 m_spin;
+
+   // producers and consumers work on different cache lines.
+   char m_padHead[64];
+   volatile int32 m_head;
+   char m_padTail[64];
+   volatile int32 m_tail;
+   char m_padWaiters[64];
+   volatile int32 m_waiters;
+
+   RingSpace *m_space;
+
+   bool pushCell( void *data );
+   bool popCell( void *&data );
+   bool canPush() const;
+   bool canPop() const;
+   void wake();
+
+protected:
+   virtual bool acquireInternal();
+
+public:
+   /** Creates the queue.
+      \param capacity Minimum count of items; rounded up to a power of 2.
+      \param spin Count of retries before parking a thread waiting on the queue.
+   */
+   RingQueue( uint32 capacity, uint32 spin = 0 );
+   virtual ~RingQueue();
+
+   virtual bool acquire();
+   virtual void release();
+
+   /** Adds an item at the end of the queue; returns false if the queue is full. */
+   bool push( void *data );
+   /** Removes the item in front of the queue; returns false if the queue is empty. */
+   bool pop( void *&data );
+   /** Adds items until the queue is full; returns the count of added items. */
+   uint32 pushMany( void **data, uint32 count );
+   /** Removes up to count items; returns the count of removed items. */
+   uint32 popMany( void **data, uint32 count );
+
+   uint32 capacity() const { return m_mask + 1; }
+   uint32 spin() const { return m_spin; }
+   uint32 size() const;
+   bool empty() const { return ! canPop(); }
+
+   Waitable *space() const { return m_space; }
+};
+
 /** Counter (semaphore). */
 class SyncCounter: public Waitable
 {
@@ -175,6 +272,39 @@ public:
 };
 
 
+/** Outcome of a task run by a ThreadPool.
+   Once the task is complete, the future can be acquired by any number
+   of threads, and the result or the error it holds doesn't change anymore.
+*/
+class Future: public Waitable
+{
+   bool m_bDone;
+   String m_result;
+   Error* m_error;
+
+protected:
+   virtual bool acquireInternal();
+
+public:
+   Future();
+   virtual ~Future();
+
+   virtual bool acquire();
+   virtual void release();
+
+   /** Stores the serialized value returned by the task, and wakes the waiters. */
+   void complete( StringStream& result );
+   /** Stores the error raised by the task, and wakes the waiters. */
+   void fail( Error* error );
+
+   bool isDone() const;
+
+   /** Serialized value returned by the task; valid once done. */
+   const String& result() const { return m_result; }
+   /** Error raised by the task, or 0; valid once done. */
+   Error* error() const { return m_error; }
+};
+
 /** Thread status. */
 class ThreadStatus: public Waitable
 {
@@ -24,6 +24,7 @@
 
 #include <falcon/module.h>
 #include "zlib_ext.h"
+#include "zlib_mod.h"
 #include "zlib.h"
 #include "zlib_st.h"
 
@@ -119,6 +120,49 @@ FALCON_MODULE_DECL
       addParam("buffer");
    self->addClassMethod( c_zlib, "getVersion", Falcon::Ext::ZLib_getVersion );
 
+   //====================================
+   // Incremental compression
+
+   Falcon::Symbol *c_zformat = self->addClass( "ZLibFormat" );
+   self->addClassProperty( c_zformat, "zlib")
+      .setInteger( Falcon::ZLibCodec::e_fmt_zlib );
+   self->addClassProperty( c_zformat, "gzip")
+      .setInteger( Falcon::ZLibCodec::e_fmt_gzip );
+   self->addClassProperty( c_zformat, "raw")
+      .setInteger( Falcon::ZLibCodec::e_fmt_raw );
+   self->addClassProperty( c_zformat, "auto")
+      .setInteger( Falcon::ZLibCodec::e_fmt_auto );
+
+   Falcon::Symbol *c_deflater = self->addClass( "Deflater", Falcon::Ext::Deflater_init )
+      ->addParam( "level" )->addParam( "format" );
+   self->addClassMethod( c_deflater, "update", Falcon::Ext::Deflater_update ).asSymbol()->
+      addParam("data");
+   self->addClassMethod( c_deflater, "flush", Falcon::Ext::Deflater_flush );
+   self->addClassMethod( c_deflater, "finish", Falcon::Ext::Deflater_finish ).asSymbol()->
+      addParam("data");
+   self->addClassMethod( c_deflater, "reset", Falcon::Ext::ZCodec_reset );
+   self->addClassMethod( c_deflater, "totalIn", Falcon::Ext::ZCodec_totalIn );
+   self->addClassMethod( c_deflater, "totalOut", Falcon::Ext::ZCodec_totalOut );
+
+   Falcon::Symbol *c_inflater = self->addClass( "Inflater", Falcon::Ext::Inflater_init )
+      ->addParam( "format" );
+   self->addClassMethod( c_inflater, "update", Falcon::Ext::Inflater_update ).asSymbol()->
+      addParam("data");
+   self->addClassMethod( c_inflater, "finished", Falcon::Ext::Inflater_finished );
+   self->addClassMethod( c_inflater, "reset", Falcon::Ext::ZCodec_reset );
+   self->addClassMethod( c_inflater, "totalIn", Falcon::Ext::ZCodec_totalIn );
+   self->addClassMethod( c_inflater, "totalOut", Falcon::Ext::ZCodec_totalOut );
+
+   //====================================
+   // ZStream class
+
+   Falcon::Symbol *stream_class = self->addExternalRef( "Stream" ); // it's external
+   Falcon::Symbol *c_zstream = self->addClass( "ZStream", Falcon::Ext::ZStream_init )
+      ->addParam( "stream" )->addParam( "compress" )->addParam( "level" )
+      ->addParam( "format" )->addParam( "bufsize" );
+   c_zstream->getClassDef()->addInheritance( new Falcon::InheritDef( stream_class ) );
+   self->addClassMethod( c_zstream, "finish", Falcon::Ext::ZStream_finish );
+
    //============================================================
    // ZlibError class
    Falcon::Symbol *error_class = self->addExternalRef( "Error" ); // it's external
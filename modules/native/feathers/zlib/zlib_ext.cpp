@@ -18,6 +18,8 @@
 
 #include "zlib.h"
 #include "zlib_ext.h"
+#include "zlib_mod.h"
+#include "zlibstream.h"
 #include "zlib_st.h"
 
 /*#
@@ -378,6 +380,463 @@ FALCON_FUNC ZLib_uncompressText( ::Falcon::VMachine *vm )
 }
 
 
+//=============================================================
+// Incremental compression
+//
+
+static void s_getData( Item *dataI, const byte *&data, uint32 &size )
+{
+   if ( dataI->isString() )
+   {
+      data = dataI->asString()->getRawStorage();
+      size = dataI->asString()->size();
+   }
+   else {
+      data = dataI->asMemBuf()->data();
+      size = dataI->asMemBuf()->size();
+   }
+}
+
+static ZLibCodec::t_format s_getFormat( Item *i_format )
+{
+   if ( i_format == 0 || i_format->isNil() )
+      return ZLibCodec::e_fmt_zlib;
+
+   int64 fmt = i_format->forceInteger();
+   if ( fmt < ZLibCodec::e_fmt_zlib || fmt > ZLibCodec::e_fmt_auto )
+   {
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+            .extra( "format" ) );
+   }
+
+   return (ZLibCodec::t_format) fmt;
+}
+
+static void s_raise( VMachine *vm, int err )
+{
+   throw new ZLibError(
+         ErrorParam( FALCON_ZLIB_ERROR_BASE - err, __LINE__ )
+         .desc( internal_getErrorMsg( vm, err ) ) );
+}
+
+/*
+   Runs the codec on the given data (or on what it has pending)
+   and returns all the output it can produce in a MemBuf.
+*/
+static MemBuf *s_process( VMachine *vm, ZLibCodec *codec, Item *dataI, int flush )
+{
+   const byte *data = 0;
+   uint32 dataLen = 0;
+   if ( dataI != 0 )
+      s_getData( dataI, data, dataLen );
+
+   // zlib would silently ignore data after the end of the stream.
+   if ( codec->isDeflate() && codec->finished() && dataLen != 0 )
+      s_raise( vm, Z_STREAM_ERROR );
+
+   codec->input( data, dataLen );
+
+   uint32 allocLen = dataLen < 512 ? 512 : dataLen;
+   uint32 used = 0;
+   byte *out = (byte *) memAlloc( allocLen );
+
+   while( true )
+   {
+      if ( allocLen - used < 256 )
+      {
+         allocLen *= 2;
+         out = (byte *) memRealloc( out, allocLen );
+      }
+
+      uint32 avail = allocLen - used;
+      uint32 outSize = avail;
+      int err = codec->step( out + used, outSize, flush );
+      used += outSize;
+
+      if ( err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR )
+      {
+         memFree( out );
+         s_raise( vm, err );
+      }
+
+      if ( err == Z_STREAM_END || ( outSize < avail && ! codec->hasInput() ) )
+         break;
+   }
+
+   // eventually shrink a bit if we're using too much memory.
+   if ( used != 0 && used + 512 < allocLen )
+      out = (byte *) memRealloc( out, used );
+
+   return new MemBuf_1( out, used, memFree );
+}
+
+/*#
+   @enum ZLibFormat
+   @brief Formats of the compressed data for incremental compression.
+
+   - @b zlib: Data wrapped in zlib header and trailer (the default).
+   - @b gzip: Data wrapped in gzip header and trailer, as in .gz files
+     and in the HTTP "gzip" content encoding.
+   - @b raw: Raw deflate data, with no header and no checksum.
+   - @b auto: Recognize zlib or gzip headers (for uncompression only).
+*/
+
+/*#
+   @class Deflater
+   @brief Incremental compressor.
+   @optparam level Compression level, 0 (none) to 9 (best); defaults to zlib default (6).
+   @optparam format One of the @a ZLibFormat values; defaults to ZLibFormat.zlib.
+   @raise ZLibError if the compressor can't be initialized.
+
+   The deflater receives the data to be compressed a bit at a time
+   through @a Deflater.update, and returns the compressed data produced
+   so far. When all the data has been fed, @a Deflater.finish must
+   be called to get the last part of the compressed data.
+
+   The memory used is independent from the size of the overall data,
+   so this class can be used to compress data of any length.
+
+   @code
+   load zlib
+
+   d = Deflater( 9, ZLibFormat.gzip )
+   out = OutputStream( "data.gz" )
+   for chunk in chunks
+      out.write( d.update( chunk ) )
+   end
+   out.write( d.finish() )
+   out.close()
+   @endcode
+*/
+FALCON_FUNC Deflater_init( ::Falcon::VMachine *vm )
+{
+   Item *i_level = vm->param( 0 );
+   Item *i_format = vm->param( 1 );
+
+   if ( ( i_level != 0 && ! i_level->isNil() && ! i_level->isOrdinal() )
+      || ( i_format != 0 && ! i_format->isNil() && ! i_format->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "[N],[N]" ) );
+   }
+
+   int level = ( i_level == 0 || i_level->isNil() ) ?
+         Z_DEFAULT_COMPRESSION : (int) i_level->forceInteger();
+
+   ZLibCodec *codec = new ZLibCodec( true, level, s_getFormat( i_format ) );
+   if ( codec->lastError() != Z_OK )
+   {
+      int err = codec->lastError();
+      delete codec;
+      s_raise( vm, err );
+   }
+
+   vm->self().asObject()->setUserData( codec );
+}
+
+/*#
+   @method update Deflater
+   @brief Compresses some data.
+   @param data A string or MemBuf to be compressed.
+   @return The compressed data produced so far (in a byte-wide MemBuf).
+   @raise ZLibError on compression error.
+
+   The returned MemBuf may be empty, as zlib accumulates data
+   internally until it has enough to produce a compressed block.
+
+   As for @a ZLib.compress, strings are considered for their raw
+   memory content.
+*/
+FALCON_FUNC Deflater_update( ::Falcon::VMachine *vm )
+{
+   Item *dataI = vm->param( 0 );
+   if ( dataI == 0 || ( ! dataI->isString() && ! dataI->isMemBuf() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "S|M" ) );
+   }
+
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( s_process( vm, codec, dataI, Z_NO_FLUSH ) );
+}
+
+/*#
+   @method flush Deflater
+   @brief Forces the output of all the data compressed so far.
+   @return The compressed data pending in the compressor.
+   @raise ZLibError on compression error.
+
+   The returned data, added to the previously returned one, can be
+   uncompressed up to the last byte fed so far. Flushing too often
+   reduces the compression ratio.
+*/
+FALCON_FUNC Deflater_flush( ::Falcon::VMachine *vm )
+{
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( s_process( vm, codec, 0, Z_SYNC_FLUSH ) );
+}
+
+/*#
+   @method finish Deflater
+   @brief Terminates the compressed data.
+   @optparam data Last data to be compressed.
+   @return The last part of the compressed data.
+   @raise ZLibError on compression error.
+
+   After this call, the deflater won't accept any more data
+   until @a Deflater.reset is called.
+*/
+FALCON_FUNC Deflater_finish( ::Falcon::VMachine *vm )
+{
+   Item *dataI = vm->param( 0 );
+   if ( dataI != 0 && ! dataI->isNil() && ! dataI->isString() && ! dataI->isMemBuf() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "[S|M]" ) );
+   }
+
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( s_process( vm, codec, dataI != 0 && dataI->isNil() ? 0 : dataI, Z_FINISH ) );
+}
+
+/*#
+   @class Inflater
+   @brief Incremental uncompressor.
+   @optparam format One of the @a ZLibFormat values; defaults to ZLibFormat.zlib.
+   @raise ZLibError if the uncompressor can't be initialized.
+
+   The inflater receives compressed data a bit at a time through
+   @a Inflater.update, and returns the uncompressed data produced
+   so far. The @a Inflater.finished method tells when the end of the
+   compressed data has been met; any data after that is ignored.
+*/
+FALCON_FUNC Inflater_init( ::Falcon::VMachine *vm )
+{
+   Item *i_format = vm->param( 0 );
+   if ( i_format != 0 && ! i_format->isNil() && ! i_format->isOrdinal() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "[N]" ) );
+   }
+
+   ZLibCodec *codec = new ZLibCodec( false, Z_DEFAULT_COMPRESSION, s_getFormat( i_format ) );
+   if ( codec->lastError() != Z_OK )
+   {
+      int err = codec->lastError();
+      delete codec;
+      s_raise( vm, err );
+   }
+
+   vm->self().asObject()->setUserData( codec );
+}
+
+/*#
+   @method update Inflater
+   @brief Uncompresses some data.
+   @param data A string or MemBuf containing compressed data.
+   @return The uncompressed data produced so far (in a byte-wide MemBuf).
+   @raise ZLibError on decompression error.
+*/
+FALCON_FUNC Inflater_update( ::Falcon::VMachine *vm )
+{
+   Item *dataI = vm->param( 0 );
+   if ( dataI == 0 || ( ! dataI->isString() && ! dataI->isMemBuf() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "S|M" ) );
+   }
+
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( s_process( vm, codec, dataI, Z_NO_FLUSH ) );
+}
+
+/*#
+   @method finished Inflater
+   @brief Checks if the end of the compressed data has been reached.
+   @return True if the whole compressed data has been uncompressed.
+*/
+FALCON_FUNC Inflater_finished( ::Falcon::VMachine *vm )
+{
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->regA().setBoolean( codec->finished() );
+}
+
+/*#
+   @method reset Deflater
+   @brief Prepares the deflater for a new compressed stream.
+
+   The settings given in the constructor are kept.
+*/
+
+/*#
+   @method reset Inflater
+   @brief Prepares the inflater for a new compressed stream.
+
+   The settings given in the constructor are kept.
+*/
+FALCON_FUNC ZCodec_reset( ::Falcon::VMachine *vm )
+{
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   codec->reset();
+}
+
+/*#
+   @method totalIn Deflater
+   @brief Returns the count of bytes fed to the deflater so far.
+   @return Count of uncompressed bytes.
+*/
+
+/*#
+   @method totalIn Inflater
+   @brief Returns the count of bytes fed to the inflater so far.
+   @return Count of compressed bytes.
+*/
+FALCON_FUNC ZCodec_totalIn( ::Falcon::VMachine *vm )
+{
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( (int64) codec->totalIn() );
+}
+
+/*#
+   @method totalOut Deflater
+   @brief Returns the count of bytes produced by the deflater so far.
+   @return Count of compressed bytes.
+*/
+
+/*#
+   @method totalOut Inflater
+   @brief Returns the count of bytes produced by the inflater so far.
+   @return Count of uncompressed bytes.
+*/
+FALCON_FUNC ZCodec_totalOut( ::Falcon::VMachine *vm )
+{
+   ZLibCodec *codec = dyncast<ZLibCodec *>( vm->self().asObject()->getFalconData() );
+   vm->retval( (int64) codec->totalOut() );
+}
+
+//=============================================================
+// Compressed streams
+//
+
+/*#
+   @class ZStream
+   @from Stream
+   @brief Stream compressing or uncompressing data on the fly.
+   @param stream The underlying stream.
+   @param compress True to compress data written on this stream, false to
+          uncompress data read from it.
+   @optparam level Compression level, 0 (none) to 9 (best).
+   @optparam format One of the @a ZLibFormat values; defaults to ZLibFormat.zlib.
+   @optparam bufsize Size of the buffer used for I/O on the underlying stream.
+   @raise ZLibError if the compressor can't be initialized.
+
+   A ZStream can be used wherever a @a Stream is expected. When
+   compressing, it's write-only, and the data written is compressed
+   and sent to the underlying @b stream in blocks; when uncompressing,
+   it's read-only and the data read is taken from the underlying
+   @b stream and uncompressed.
+
+   Text oriented methods (writeText, readLine and so on) can be used
+   as well; setting an encoding on the underlying stream is pointless,
+   as it sees only compressed data, but it's possible to get a transcoder
+   on the ZStream itself.
+
+   When compressing, the compressed data must be terminated through
+   @a ZStream.finish, or by closing the stream. Closing a ZStream closes
+   also the underlying stream.
+
+   @code
+   load zlib
+
+   out = ZStream( OutputStream( "log.gz" ), true, 6, ZLibFormat.gzip )
+   for line in lines: out.writeText( line + "\n" )
+   out.close()
+
+   inp = ZStream( InputStream( "log.gz" ), false, nil, ZLibFormat.gzip )
+   line = ""
+   while inp.readLine( line ): > line
+   inp.close()
+   @endcode
+*/
+FALCON_FUNC ZStream_init( ::Falcon::VMachine *vm )
+{
+   Item *i_stream = vm->param( 0 );
+   Item *i_compress = vm->param( 1 );
+   Item *i_level = vm->param( 2 );
+   Item *i_format = vm->param( 3 );
+   Item *i_bufsize = vm->param( 4 );
+
+   if ( i_stream == 0 || ! i_stream->isObject() || ! i_stream->asObject()->derivedFrom( "Stream" )
+      || i_compress == 0
+      || ( i_level != 0 && ! i_level->isNil() && ! i_level->isOrdinal() )
+      || ( i_format != 0 && ! i_format->isNil() && ! i_format->isOrdinal() )
+      || ( i_bufsize != 0 && ! i_bufsize->isNil() && ! i_bufsize->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "Stream,B,[N],[N],[N]" ) );
+   }
+
+   int level = ( i_level == 0 || i_level->isNil() ) ?
+         Z_DEFAULT_COMPRESSION : (int) i_level->forceInteger();
+
+   uint32 bufSize = 32768;
+   if ( i_bufsize != 0 && ! i_bufsize->isNil() )
+   {
+      int64 size = i_bufsize->forceInteger();
+      if ( size <= 0 )
+      {
+         throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+               .extra( "bufsize" ) );
+      }
+      bufSize = (uint32) size;
+   }
+
+   CoreObject *source = i_stream->asObject();
+   ZLibStream *zs = new ZLibStream( dyncast<Stream *>( source->getFalconData() ), false,
+         i_compress->isTrue(), level, s_getFormat( i_format ), bufSize );
+
+   if ( zs->lastError() != Z_OK )
+   {
+      int err = (int) zs->lastError();
+      delete zs;
+      s_raise( vm, err );
+   }
+
+   // the underlying stream must stay alive as long as we use it.
+   zs->dependant( source );
+   vm->self().asObject()->setUserData( zs );
+}
+
+/*#
+   @method finish ZStream
+   @brief Terminates the compressed data, leaving the underlying stream open.
+   @raise IoError on write error on the underlying stream.
+   @raise ZLibError on compression error.
+
+   After this call, the ZStream won't accept any more data. This is useful
+   when more data must be written on the underlying stream after the
+   compressed part. It does nothing on streams opened for uncompression.
+*/
+FALCON_FUNC ZStream_finish( ::Falcon::VMachine *vm )
+{
+   ZLibStream *zs = dyncast<ZLibStream *>( vm->self().asObject()->getFalconData() );
+
+   // declaring the VM idle from now on.
+   VMachine::Pauser pauser( vm );
+
+   if ( ! zs->finish() )
+   {
+      if ( zs->source()->bad() )
+      {
+         throw new IoError( ErrorParam( e_io_error, __LINE__ )
+               .sysError( (uint32) zs->lastError() ) );
+      }
+
+      s_raise( vm, (int) zs->lastError() );
+   }
+}
+
+
 //=============================================================
 // Zlib error
 //
@@ -27,6 +27,20 @@ FALCON_FUNC ZLib_uncompress( ::Falcon::VMachine *vm );
 FALCON_FUNC ZLib_compressText( ::Falcon::VMachine *vm );
 FALCON_FUNC ZLib_uncompressText( ::Falcon::VMachine *vm );
 
+FALCON_FUNC Deflater_init( ::Falcon::VMachine *vm );
+FALCON_FUNC Deflater_update( ::Falcon::VMachine *vm );
+FALCON_FUNC Deflater_flush( ::Falcon::VMachine *vm );
+FALCON_FUNC Deflater_finish( ::Falcon::VMachine *vm );
+FALCON_FUNC Inflater_init( ::Falcon::VMachine *vm );
+FALCON_FUNC Inflater_update( ::Falcon::VMachine *vm );
+FALCON_FUNC Inflater_finished( ::Falcon::VMachine *vm );
+FALCON_FUNC ZCodec_reset( ::Falcon::VMachine *vm );
+FALCON_FUNC ZCodec_totalIn( ::Falcon::VMachine *vm );
+FALCON_FUNC ZCodec_totalOut( ::Falcon::VMachine *vm );
+
+FALCON_FUNC ZStream_init( ::Falcon::VMachine *vm );
+FALCON_FUNC ZStream_finish( ::Falcon::VMachine *vm );
+
 class ZLibError: public ::Falcon::Error
 {
 public:
@@ -0,0 +1,127 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: zlib_mod.cpp
+
+   ZLib module - incremental compression support.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 13:05:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   ZLib module - incremental compression support.
+*/
+
+#include <string.h>
+#include "zlib_mod.h"
+
+namespace Falcon {
+
+static int s_windowBits( bool bDeflate, ZLibCodec::t_format fmt )
+{
+   switch( fmt )
+   {
+      case ZLibCodec::e_fmt_gzip: return MAX_WBITS + 16;
+      case ZLibCodec::e_fmt_raw: return -MAX_WBITS;
+      case ZLibCodec::e_fmt_auto: return bDeflate ? MAX_WBITS : MAX_WBITS + 32;
+      default: break;
+   }
+
+   return MAX_WBITS;
+}
+
+
+ZLibCodec::ZLibCodec( bool bDeflate, int level, t_format fmt ):
+   m_bDeflate( bDeflate ),
+   m_bInit( false ),
+   m_bFinished( false ),
+   m_totalIn( 0 ),
+   m_totalOut( 0 )
+{
+   memset( &m_zs, 0, sizeof( m_zs ) );
+
+   if ( bDeflate )
+      m_lastError = deflateInit2( &m_zs, level, Z_DEFLATED, s_windowBits( true, fmt ),
+            8, Z_DEFAULT_STRATEGY );
+   else
+      m_lastError = inflateInit2( &m_zs, s_windowBits( false, fmt ) );
+
+   m_bInit = m_lastError == Z_OK;
+}
+
+
+ZLibCodec::~ZLibCodec()
+{
+   if ( m_bInit )
+   {
+      if ( m_bDeflate )
+         deflateEnd( &m_zs );
+      else
+         inflateEnd( &m_zs );
+   }
+}
+
+
+void ZLibCodec::input( const byte* data, uint32 size )
+{
+   m_zs.next_in = (Bytef*) data;
+   m_zs.avail_in = size;
+}
+
+
+int ZLibCodec::step( byte* out, uint32& outSize, int flush )
+{
+   if ( ! m_bInit )
+   {
+      outSize = 0;
+      return m_lastError;
+   }
+
+   if ( m_bFinished )
+   {
+      // Whatever comes after the end of the stream is not ours.
+      outSize = 0;
+      return Z_STREAM_END;
+   }
+
+   uInt availIn = m_zs.avail_in;
+   m_zs.next_out = (Bytef*) out;
+   m_zs.avail_out = outSize;
+
+   int res = m_bDeflate ? deflate( &m_zs, flush ) : inflate( &m_zs, flush );
+
+   m_totalIn += availIn - m_zs.avail_in;
+   outSize -= m_zs.avail_out;
+   m_totalOut += outSize;
+
+   if ( res == Z_STREAM_END )
+      m_bFinished = true;
+   else if ( res != Z_OK && res != Z_BUF_ERROR )
+      m_lastError = res;
+
+   return res;
+}
+
+
+void ZLibCodec::reset()
+{
+   if ( m_bInit )
+   {
+      m_lastError = m_bDeflate ? deflateReset( &m_zs ) : inflateReset( &m_zs );
+      m_zs.next_in = 0;
+      m_zs.avail_in = 0;
+   }
+
+   m_bFinished = false;
+   m_totalIn = 0;
+   m_totalOut = 0;
+}
+
+}
+
+/* end of zlib_mod.cpp */
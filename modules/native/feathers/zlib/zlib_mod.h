@@ -0,0 +1,104 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: zlib_mod.h
+
+   ZLib module - incremental compression support.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 13:05:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   ZLib module - incremental compression support.
+*/
+
+#ifndef flc_zlib_mod_H
+#define flc_zlib_mod_H
+
+#include <falcon/falcondata.h>
+#include "zlib.h"
+
+namespace Falcon {
+
+/** Incremental deflate or inflate engine.
+
+   This object wraps a zlib z_stream, and is used both as the carrier
+   of the Deflater and Inflater script classes and as the engine
+   of the ZLibStream.
+
+   The input is set through input(), and then step() is called
+   repeatedly to get the output in caller provided buffers, until
+   the input is exhausted and step() doesn't fill the output buffer
+   anymore.
+*/
+class ZLibCodec: public FalconData
+{
+public:
+   typedef enum {
+      e_fmt_zlib = 0,
+      e_fmt_gzip = 1,
+      e_fmt_raw = 2,
+      /** Recognizes zlib or gzip headers; valid for inflate only. */
+      e_fmt_auto = 3
+   } t_format;
+
+   /** Creates the codec.
+      \param bDeflate true to compress, false to uncompress.
+      \param level compression level (ignored when uncompressing).
+      \param fmt Format of the compressed data.
+
+      The constructor doesn't throw; check lastError() for Z_OK
+      to know if the initialization was successful.
+   */
+   ZLibCodec( bool bDeflate, int level = Z_DEFAULT_COMPRESSION, t_format fmt = e_fmt_zlib );
+   virtual ~ZLibCodec();
+
+   /** Sets the data to be processed by the next steps.
+      The data is not copied; it must stay valid until hasInput()
+      returns false or the next call to input().
+   */
+   void input( const byte* data, uint32 size );
+   bool hasInput() const { return m_zs.avail_in != 0; }
+
+   /** Processes the pending input.
+      \param out The buffer where to write the output.
+      \param outSize In: size of the out buffer; out: bytes written.
+      \param flush one of the zlib flush modes (Z_NO_FLUSH, Z_SYNC_FLUSH, Z_FINISH).
+      \return the zlib status code; Z_BUF_ERROR just means no progress was possible.
+   */
+   int step( byte* out, uint32& outSize, int flush );
+
+   /** True when the end of the compressed stream has been reached. */
+   bool finished() const { return m_bFinished; }
+
+   /** Prepares the codec for a new stream, keeping the settings. */
+   void reset();
+
+   bool isDeflate() const { return m_bDeflate; }
+   int lastError() const { return m_lastError; }
+   uint64 totalIn() const { return m_totalIn; }
+   uint64 totalOut() const { return m_totalOut; }
+
+   virtual void gcMark( uint32 ) {}
+   virtual FalconData *clone() const { return 0; }
+
+private:
+   z_stream m_zs;
+   bool m_bDeflate;
+   bool m_bInit;
+   bool m_bFinished;
+   int m_lastError;
+   uint64 m_totalIn;
+   uint64 m_totalOut;
+};
+
+}
+
+#endif
+
+/* end of zlib_mod.h */
@@ -18,98 +18,391 @@
  * Implementation of ZLibStream.
  */
 
+#include <string.h>
+#include <falcon/memory.h>
+#include <falcon/garbageable.h>
 #include "zlibstream.h"
 
+#define ZLIBSTREAM_CHRBUF_SIZE 4096
+
 namespace Falcon {
 
-ZLibStream::ZLibStream( int32 size )
-   : Stream( t_membuf )
+ZLibStream::ZLibStream( Stream* source, bool bOwn, bool bDeflate,
+      int level, ZLibCodec::t_format fmt, uint32 bufSize ):
+   Stream( t_proxy ),
+   m_source( source ),
+   m_bOwn( bOwn ),
+   m_codec( bDeflate, level, fmt ),
+   m_bufSize( bufSize < 512 ? 512 : bufSize ),
+   m_chrPos( 0 ),
+   m_chrLen( 0 ),
+   m_bFinished( false ),
+   m_bSourceError( false ),
+   m_lastError( Z_OK ),
+   m_dependant( 0 )
 {
-}
+   m_buffer = (byte*) memAlloc( m_bufSize );
+   m_chrBuf = (byte*) memAlloc( ZLIBSTREAM_CHRBUF_SIZE );
 
-ZLibStream::ZLibStream( const ZLibStream &zlibstream )
-   : Stream( t_membuf )
-{
+   if ( m_codec.lastError() != Z_OK )
+      setError( m_codec.lastError() );
+   else
+      m_status = t_open;
 }
 
+
 ZLibStream::~ZLibStream()
 {
+   memFree( m_buffer );
+   memFree( m_chrBuf );
+
+   if ( m_bOwn )
+      delete m_source;
 }
 
-bool ZLibStream::errorDescription( String &desciption ) const
+
+bool ZLibStream::setError( int zerr )
 {
+   m_lastError = zerr;
+   m_bSourceError = false;
+   m_status = m_status | t_error;
    return false;
 }
 
-bool ZLibStream::close()
+
+bool ZLibStream::setSourceError()
 {
+   m_bSourceError = true;
+   m_status = m_status | t_error;
    return false;
 }
 
-int32 ZLibStream::read( void *buffer, int32 size )
+
+bool ZLibStream::writeOut( uint32 size )
 {
-   return -1;
+   uint32 done = 0;
+   while( done < size )
+   {
+      int32 w = m_source->write( m_buffer + done, size - done );
+      if ( w <= 0 )
+         return setSourceError();
+      done += w;
+   }
+
+   return true;
 }
 
-bool ZLibStream::readString( String &target, uint32 size )
+
+bool ZLibStream::deflateData( const byte* data, uint32 size, int flush )
 {
-   return false;
+   m_codec.input( data, size );
+
+   uint32 outSize;
+   do
+   {
+      outSize = m_bufSize;
+      int res = m_codec.step( m_buffer, outSize, flush );
+      if ( res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR )
+         return setError( res );
+
+      if ( outSize != 0 && ! writeOut( outSize ) )
+         return false;
+
+      if ( res == Z_STREAM_END )
+         break;
+   }
+   // a full output buffer means that zlib may have more to say.
+   while( outSize == m_bufSize || m_codec.hasInput() );
+
+   return true;
 }
 
-int32 ZLibStream::write( const void *buffer, int32 size )
+
+bool ZLibStream::flushChrBuf()
 {
-   return -1;
+   if ( m_chrLen == 0 )
+      return true;
+
+   uint32 len = m_chrLen;
+   m_chrLen = 0;
+   return deflateData( m_chrBuf, len, Z_NO_FLUSH );
 }
 
-bool ZLibStream::writeString( const String &source, uint32 begin, uint32 end )
+
+int32 ZLibStream::inflateData( byte* data, uint32 size )
 {
-   return false;
+   while( true )
+   {
+      // try first with what's pending in zlib.
+      uint32 outSize = size;
+      int res = m_codec.step( data, outSize, Z_NO_FLUSH );
+      if ( res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR )
+      {
+         setError( res );
+         return -1;
+      }
+
+      if ( outSize != 0 )
+         return (int32) outSize;
+
+      if ( res == Z_STREAM_END )
+      {
+         m_status = m_status | t_eof;
+         return 0;
+      }
+
+      if ( ! m_codec.hasInput() )
+      {
+         int32 r = m_source->read( m_buffer, m_bufSize );
+         if ( r < 0 )
+         {
+            setSourceError();
+            return -1;
+         }
+
+         if ( r == 0 )
+         {
+            // the source is over before the end of the compressed stream.
+            setError( Z_DATA_ERROR );
+            return -1;
+         }
+
+         m_codec.input( m_buffer, (uint32) r );
+      }
+   }
 }
 
+
+int32 ZLibStream::write( const void *buffer, int32 size )
+{
+   if ( ! m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return -1;
+   }
+
+   if ( m_bFinished )
+   {
+      m_status = m_status | t_invalid;
+      return -1;
+   }
+
+   if ( ! flushChrBuf() || ! deflateData( (const byte*) buffer, (uint32) size, Z_NO_FLUSH ) )
+      return -1;
+
+   m_lastMoved = size;
+   return size;
+}
+
+
 bool ZLibStream::put( uint32 chr )
 {
-   return false;
+   if ( ! m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return false;
+   }
+
+   if ( m_bFinished )
+   {
+      m_status = m_status | t_invalid;
+      return false;
+   }
+
+   // going through zlib for each character would be a waste.
+   if ( m_chrLen == ZLIBSTREAM_CHRBUF_SIZE && ! flushChrBuf() )
+      return false;
+
+   m_chrBuf[ m_chrLen++ ] = (byte) chr;
+   return true;
+}
+
+
+int32 ZLibStream::read( void *buffer, int32 size )
+{
+   if ( m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return -1;
+   }
+
+   if ( size <= 0 )
+      return 0;
+
+   int32 r;
+   if ( m_chrPos < m_chrLen )
+   {
+      r = m_chrLen - m_chrPos;
+      if ( r > size )
+         r = size;
+      memcpy( buffer, m_chrBuf + m_chrPos, r );
+      m_chrPos += r;
+   }
+   else
+   {
+      r = inflateData( (byte*) buffer, (uint32) size );
+   }
+
+   if ( r >= 0 )
+      m_lastMoved = r;
+   return r;
 }
 
+
 bool ZLibStream::get( uint32 &chr )
 {
-   return false;
+   if ( popBuffer( chr ) )
+      return true;
+
+   if ( m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return false;
+   }
+
+   if ( m_chrPos == m_chrLen )
+   {
+      int32 r = inflateData( m_chrBuf, ZLIBSTREAM_CHRBUF_SIZE );
+      if ( r <= 0 )
+         return false;
+
+      m_chrPos = 0;
+      m_chrLen = (uint32) r;
+   }
+
+   chr = m_chrBuf[ m_chrPos++ ];
+   return true;
+}
+
+
+bool ZLibStream::flush()
+{
+   if ( ! m_codec.isDeflate() || m_bFinished )
+      return m_source->flush();
+
+   if ( ! flushChrBuf() || ! deflateData( 0, 0, Z_SYNC_FLUSH ) )
+      return false;
+
+   return m_source->flush();
+}
+
+
+bool ZLibStream::finish()
+{
+   if ( ! m_codec.isDeflate() || m_bFinished )
+      return true;
+
+   if ( ! flushChrBuf() || ! deflateData( 0, 0, Z_FINISH ) )
+      return false;
+
+   m_bFinished = true;
+   return m_source->flush();
 }
 
-int64 ZLibStream::seek( int64 pos, Stream::e_whence w )
+
+bool ZLibStream::close()
 {
+   bool bOk = finish();
+   m_bFinished = true;
+
+   if ( ! m_source->close() )
+   {
+      if ( bOk )
+         setSourceError();
+      return false;
+   }
+
+   m_status = t_none;
+   return bOk;
+}
+
+
+int32 ZLibStream::readAvailable( int32 msecs, const Sys::SystemData *sysData )
+{
+   if ( m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return -1;
+   }
+
+   if ( m_chrPos < m_chrLen || m_codec.hasInput() || m_codec.finished() )
+      return 1;
+
+   return m_source->readAvailable( msecs, sysData );
+}
+
+
+int32 ZLibStream::writeAvailable( int32 msecs, const Sys::SystemData *sysData )
+{
+   if ( ! m_codec.isDeflate() )
+   {
+      m_status = m_status | t_unsupported;
+      return -1;
+   }
+
+   return m_source->writeAvailable( msecs, sysData );
+}
+
+
+int64 ZLibStream::seek( int64, Stream::e_whence )
+{
+   m_status = m_status | t_unsupported;
    return -1;
 }
 
+
 int64 ZLibStream::tell()
 {
-   return -1;
+   // position in the uncompressed data.
+   if ( m_codec.isDeflate() )
+      return (int64) m_codec.totalIn() + m_chrLen;
+
+   return (int64) m_codec.totalOut() - ( m_chrLen - m_chrPos );
 }
 
-bool ZLibStream::truncate( int64 pos )
+
+bool ZLibStream::truncate( int64 )
 {
+   m_status = m_status | t_unsupported;
    return false;
 }
 
-int32 ZLibStream::readAvailable( int32 )
+
+bool ZLibStream::errorDescription( ::Falcon::String &description ) const
 {
-   return -1;
+   if ( m_bSourceError )
+      return m_source->errorDescription( description );
+
+   if ( m_lastError == Z_OK )
+      return false;
+
+   description.bufferize( zError( m_lastError ) );
+   return true;
 }
 
-int32 ZLibStream::writeAvailable( int32 )
+
+int64 ZLibStream::lastError() const
 {
-   return -1;
+   if ( m_bSourceError )
+      return m_source->lastError();
+
+   return m_lastError;
 }
 
-int64 ZLibStream::lastError() const
+
+void ZLibStream::gcMark( uint32 mark )
 {
-   return (int64) m_lastError;
+   if( m_dependant != 0 && m_dependant->mark() != mark )
+   {
+      m_dependant->gcMark( mark );
+   }
 }
 
-FalconData *ZLibStream::clone() const
+
+Stream *ZLibStream::clone() const
 {
-   ZLibStream *zstr = new ZLibStream( *this );
-   return zstr;
+   // the state of zlib streams can't be shared.
+   return 0;
 }
 
 }
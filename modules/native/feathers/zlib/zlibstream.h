@@ -19,45 +19,101 @@
 #include <falcon/string.h>
 #include <falcon/stream.h>
 
-#include "zlib.h"
+#include "zlib_mod.h"
 
 namespace Falcon {
 
-class FALCON_DYN_CLASS ZLibStream: public Stream
-{
-protected:
-   int64 m_lastError;
+class Garbageable;
 
-   virtual int64 seek( int64 pos, e_whence whence );
+/** Proxy stream compressing or uncompressing data on the fly.
 
+   The stream wraps another stream (the source). When compressing,
+   the data written on this stream is deflated and written on the
+   source; when uncompressing, the data read from this stream is
+   read from the source and inflated.
+
+   Memory usage is bounded by the size of the I/O buffer and of the
+   zlib state, whatever the size of the data.
+
+   The compressed stream is terminated by finish() or close(); the first
+   one leaves the source open.
+*/
+class FALCON_DYN_CLASS ZLibStream: public Stream
+{
 public:
-   ZLibStream( int32 size=0 );
-   ZLibStream( const ZLibStream &zlibstream );
+   /** Creates the stream.
+      \param source The stream where compressed data is written to or read from.
+      \param bOwn if true, the source stream is destroyed with this stream.
+      \param bDeflate true to compress, false to uncompress.
+      \param level Compression level (ignored when uncompressing).
+      \param fmt Format of the compressed data.
+      \param bufSize Size of the I/O buffer on the source stream.
+   */
+   ZLibStream( Stream* source, bool bOwn, bool bDeflate,
+         int level = Z_DEFAULT_COMPRESSION,
+         ZLibCodec::t_format fmt = ZLibCodec::e_fmt_zlib,
+         uint32 bufSize = 32768 );
 
    virtual ~ZLibStream();
 
    virtual bool close();
    virtual int32 read( void *buffer, int32 size );
-   virtual bool readString( String &dest, uint32 size );
    virtual int32 write( const void *buffer, int32 size );
-   virtual bool writeString( const String &source, uint32 begin = 0, uint32 end = csh::npos );
    virtual bool put( uint32 chr );
    virtual bool get( uint32 &chr );
-   virtual int32 readAvailable( int32 msecs );
-   virtual int32 writeAvailable( int32 msecs );
+   virtual int32 readAvailable( int32 msecs, const Sys::SystemData *sysData = 0 );
+   virtual int32 writeAvailable( int32 msecs, const Sys::SystemData *sysData = 0 );
+   virtual bool flush();
 
+   virtual int64 seek( int64 pos, e_whence whence );
    virtual int64 tell();
    virtual bool truncate( int64 pos=-1 );
 
-   //uint32 length() const { return m_length; }
-   //uint32 allocated() const { return m_allocated; }
-   //byte *data() const { return m_membuf; }
-
    virtual bool errorDescription( ::Falcon::String &description ) const;
-   virtual int64 lastError(void) const;
-
-   virtual FalconData *clone() const;
+   virtual int64 lastError() const;
+
+   virtual void gcMark( uint32 mark );
+   virtual Stream *clone() const;
+
+   /** Writes the trailer of the compressed data, leaving the source open.
+      When uncompressing, it does nothing.
+   */
+   bool finish();
+
+   Stream* source() const { return m_source; }
+   const ZLibCodec& codec() const { return m_codec; }
+
+   /** Garbage collected object holding the source stream, if any. */
+   Garbageable *dependant() const { return m_dependant; }
+   void dependant( Garbageable *obj ) { m_dependant = obj; }
+
+private:
+   Stream* m_source;
+   bool m_bOwn;
+   ZLibCodec m_codec;
+
+   // I/O buffer on the source stream
+   byte* m_buffer;
+   uint32 m_bufSize;
+
+   // Buffer for character level operations.
+   byte* m_chrBuf;
+   uint32 m_chrPos;
+   uint32 m_chrLen;
+
+   bool m_bFinished;
+   bool m_bSourceError;
+   int m_lastError;
+   Garbageable* m_dependant;
+
+   bool setError( int zerr );
+   bool setSourceError();
+   bool writeOut( uint32 size );
+   bool deflateData( const byte* data, uint32 size, int flush );
+   bool flushChrBuf();
+   int32 inflateData( byte* data, uint32 size );
 };
+
 }
 
 
@@ -856,6 +856,11 @@ FALCON_FUNC MongoBSON_append( VMachine* vm )
     @method asDict BSON
     @brief Return a dictionary representing the BSON object.
 	@return A dictionary
+
+    The fields of the BSON object are decoded as they are accessed, so
+    that reading a few fields of a large document is cheap; the whole
+    dictionary is decoded as soon as it is iterated or changed.
+    Sub-documents are returned as dictionaries working the same way.
  */
 FALCON_FUNC MongoBSON_asDict( VMachine* vm )
 {
@@ -907,11 +912,9 @@ FALCON_FUNC MongoBSON_value( VMachine* vm )
     CoreObject* self = vm->self().asObjectSafe();
     MongoDB::BSONObj* bobj = static_cast<MongoDB::BSONObj*>( self->getUserData() );
     AutoCString key( *i_key );
-    Item* it = bobj->value( key.c_str() );
-    if ( it )
-        vm->retval( *it );
-    else
-        vm->retnil();
+    Item it;
+    bobj->value( key.c_str(), it );
+    vm->retval( it );
 }
 
 /*******************************************************************************
@@ -998,11 +1001,9 @@ FALCON_FUNC MongoBSONIter_value( VMachine* vm )
 {
     CoreObject* self = vm->self().asObjectSafe();
     MongoDB::BSONIter* iter = static_cast<MongoDB::BSONIter*>( self->getUserData() );
-    Item* v = iter->currentValue();
-    if ( v )
-        vm->retval( *v );
-    else
-        vm->retnil();
+    Item v;
+    iter->currentValue( v );
+    vm->retval( v );
 }
 
 
@@ -778,17 +778,7 @@ BSONObj::append( const char* nm,
     if ( !buf )
         buf = &mBuf;
 
-    TimeStamp epoch( 1970, 1, 1, 0, 0, 0, 0, tz_UTC );
-    epoch.distance( ts );
-
-    const bson_date_t t =
-        (int64) epoch.m_msec +
-        ( (int64) epoch.m_second * 1000 ) +
-        ( (int64) epoch.m_minute * 60 * 1000 ) +
-        ( (int64) epoch.m_hour * 60 * 60 * 1000 ) +
-        ( (int64) epoch.m_day * 24 * 60 * 60 * 1000 );
-
-    bson_append_date( buf, nm, t );
+    bson_append_date( buf, nm, toDate( ts ) );
     if ( mFinalized ) mFinalized = false;
     return this;
 }
@@ -806,121 +796,253 @@ BSONObj::append( const char* nm,
     return this;
 }
 
-BSONObj*
-BSONObj::append( const char* nm,
-                 const CoreArray& array,
-                 bson_buffer* parentBuf )
+bson_date_t
+BSONObj::toDate( const Falcon::TimeStamp& ts )
 {
-    // we need to check items validity before changing the buffer!
-    // that's why this is not public
-
-    if ( parentBuf == 0 )
-        parentBuf = &mBuf;
+    TimeStamp epoch( 1970, 1, 1, 0, 0, 0, 0, tz_UTC );
+    epoch.distance( ts );
 
-    const uint32 sz = array.length();
-    bson_buffer* sub = bson_append_start_array( parentBuf, nm );
+    return
+        (int64) epoch.m_msec +
+        ( (int64) epoch.m_second * 1000 ) +
+        ( (int64) epoch.m_minute * 60 * 1000 ) +
+        ( (int64) epoch.m_hour * 60 * 60 * 1000 ) +
+        ( (int64) epoch.m_day * 24 * 60 * 60 * 1000 );
+}
 
-    if ( sz == 0 ) // empty array
-    {
-        bson_append_finish_object( sub );
-        if ( mFinalized ) mFinalized = false;
-        return this;
-    }
+/*
+ *  Raw writers for the direct serializer.
+ *  Positions are kept as offsets, as bson_ensure_space() may move the buffer.
+ */
 
-    for ( uint32 i=0; i < sz; ++i )
-    {
-        Item it = array.at( i );
-        append( "0", it, sub );
-    }
+static inline void
+bsonWrite( bson_buffer* buf,
+           const void* data,
+           const int size )
+{
+    bson_ensure_space( buf, size );
+    memcpy( buf->cur, data, size );
+    buf->cur += size;
+}
 
-    bson_append_finish_object( sub );
-    if ( mFinalized ) mFinalized = false;
-    return this;
+static inline void
+bsonWrite32( bson_buffer* buf,
+             const int32 i )
+{
+    bson_ensure_space( buf, 4 );
+    bson_little_endian32( buf->cur, &i );
+    buf->cur += 4;
 }
 
-BSONObj*
-BSONObj::append( const char* nm,
-                 const CoreDict& dict,
-                 bson_buffer* parentBuf )
+static inline void
+bsonWrite64( bson_buffer* buf,
+             const void* data )
 {
-    // we need to check items validity before changing the buffer!
-    // that's why this is not public
+    bson_ensure_space( buf, 8 );
+    bson_little_endian64( buf->cur, data );
+    buf->cur += 8;
+}
 
-    if ( parentBuf == 0 )
-        parentBuf = &mBuf;
+static inline int
+bsonReserve32( bson_buffer* buf )
+{
+    bson_ensure_space( buf, 4 );
+    const int pos = buf->cur - buf->buf;
+    buf->cur += 4;
+    return pos;
+}
 
-    bson_buffer* sub = bson_append_start_object( parentBuf, nm );
+static inline void
+bsonPatch32( bson_buffer* buf,
+             const int pos,
+             const int32 i )
+{
+    bson_little_endian32( buf->buf + pos, &i );
+}
 
-    if ( dict.length() == 0 ) // empty dict
-    {
-        bson_append_finish_object( sub );
-        if ( mFinalized ) mFinalized = false;
-        return this;
-    }
+void
+BSONObj::encodeCString( bson_buffer* buf,
+                        const Falcon::String& str )
+{
+    const uint32 maxSize = str.length() * 4 + 1;
+    bson_ensure_space( buf, maxSize );
+    const uint32 sz = str.toCString( buf->cur, maxSize );
+    fassert( sz != String::npos );
+    buf->cur += sz + 1;
+}
 
-    Iterator iter( (Sequence*) &dict.items() );
+bool
+BSONObj::encodeElement( bson_buffer* buf,
+                        const char* nm,
+                        const Falcon::Item& item )
+{
+    const int sz = strlen( nm ) + 1;
+    bson_ensure_space( buf, 1 + sz );
+    const int tpos = buf->cur - buf->buf;
+    *buf->cur++ = 0; // type, patched below
+    memcpy( buf->cur, nm, sz );
+    buf->cur += sz;
+
+    const bson_type tp = encodeValue( buf, item );
+    if ( tp == bson_eoo )
+        return false;
+    buf->buf[tpos] = (char) tp;
+    return true;
+}
 
-    while ( iter.hasCurrent() )
-    {
-        Item key = iter.getCurrentKey();
-        Item val = iter.getCurrent();
-        AutoCString k( key );
-        append( k.c_str(), val, sub );
-        iter.next();
-    }
+bool
+BSONObj::encodeElement( bson_buffer* buf,
+                        const Falcon::String& nm,
+                        const Falcon::Item& item )
+{
+    bson_ensure_space( buf, 1 );
+    const int tpos = buf->cur - buf->buf;
+    *buf->cur++ = 0; // type, patched below
+    encodeCString( buf, nm );
 
-    bson_append_finish_object( sub );
-    if ( mFinalized ) mFinalized = false;
-    return this;
+    const bson_type tp = encodeValue( buf, item );
+    if ( tp == bson_eoo )
+        return false;
+    buf->buf[tpos] = (char) tp;
+    return true;
 }
 
-bool
-BSONObj::append( const char* nm,
-                 const Falcon::Item& item,
-                 bson_buffer* buf,
-                 const bool doCheck )
+bson_type
+BSONObj::encodeValue( bson_buffer* buf,
+                      const Falcon::Item& item )
 {
     switch ( item.type() )
     {
     case FLC_ITEM_NIL:
-        return append( nm, buf );
+        return bson_null;
     case FLC_ITEM_INT:
-        return append( nm, (int64_t) item.asInteger(), buf );
+    {
+        const int64 i = item.asInteger();
+        bsonWrite64( buf, &i );
+        return bson_long;
+    }
     case FLC_ITEM_BOOL:
-        return append( nm, item.asBoolean(), buf );
+    {
+        const char b = item.asBoolean() ? 1 : 0;
+        bsonWrite( buf, &b, 1 );
+        return bson_bool;
+    }
     case FLC_ITEM_NUM:
-        return append( nm, item.asNumeric(), buf );
+    {
+        const double d = item.asNumeric();
+        bsonWrite64( buf, &d );
+        return bson_double;
+    }
     case FLC_ITEM_STRING:
-        return append( nm, *item.asString(), buf );
+    {
+        const int pos = bsonReserve32( buf );
+        encodeCString( buf, *item.asString() );
+        bsonPatch32( buf, pos, ( buf->cur - buf->buf ) - pos - 4 );
+        return bson_string;
+    }
     case FLC_ITEM_MEMBUF:
-        return append( nm, *item.asMemBuf(), buf );
+    {
+        // same layout as bson_append_binary(), word size as subtype.
+        const MemBuf* mem = item.asMemBuf();
+        const int32 sz = mem->length() * mem->wordSize();
+        const char subtype = (char) mem->wordSize();
+        bsonWrite32( buf, sz );
+        bsonWrite( buf, &subtype, 1 );
+        bsonWrite( buf, mem->data(), sz );
+        return bson_bindata;
+    }
     case FLC_ITEM_ARRAY:
-        if ( doCheck && !arrayIsSupported( *item.asArray() ) )
-            return false;
-        return append( nm, *item.asArray(), buf );
+        return encodeArray( buf, *item.asArray() ) ? bson_array : bson_eoo;
     case FLC_ITEM_DICT:
-        if ( doCheck && !dictIsSupported( *item.asDict() ) )
-            return false;
-        return append( nm, *item.asDict(), buf );
+        return encodeDict( buf, *item.asDict() ) ? bson_object : bson_eoo;
     case FLC_ITEM_OBJECT:
     {
         CoreObject* obj = item.asObjectSafe();
         if ( obj->derivedFrom( "ObjectID" ) )
         {
             ObjectID* oid = static_cast<ObjectID*>( obj );
-            return append( nm, oid->oid() );
+            bsonWrite( buf, oid->oid(), 12 );
+            return bson_oid;
         }
         else
         if ( obj->derivedFrom( "TimeStamp" ) )
         {
             TimeStamp* ts = static_cast<TimeStamp*>( obj->getUserData() );
-            return append( nm, *ts );
+            const bson_date_t t = toDate( *ts );
+            bsonWrite64( buf, &t );
+            return bson_date;
         }
-        return false;
+        return bson_eoo;
     }
     default: // unsupported type
+        return bson_eoo;
+    }
+}
+
+bool
+BSONObj::encodeArray( bson_buffer* buf,
+                      const CoreArray& array )
+{
+    const int pos = bsonReserve32( buf );
+    const uint32 sz = array.length();
+    char key[16];
+
+    for ( uint32 i=0; i < sz; ++i )
+    {
+        bson_numstr( key, i );
+        if ( !encodeElement( buf, key, array.at( i ) ) )
+            return false;
+    }
+
+    bson_ensure_space( buf, 1 );
+    *buf->cur++ = 0;
+    bsonPatch32( buf, pos, ( buf->cur - buf->buf ) - pos );
+    return true;
+}
+
+bool
+BSONObj::encodeDict( bson_buffer* buf,
+                     const CoreDict& dict )
+{
+    const int pos = bsonReserve32( buf );
+
+    if ( dict.length() != 0 )
+    {
+        Iterator iter( (Sequence*) &dict.items() );
+
+        while ( iter.hasCurrent() )
+        {
+            const Item& key = iter.getCurrentKey();
+            if ( !key.isString()
+                || !encodeElement( buf, *key.asString(), iter.getCurrent() ) )
+                return false;
+            iter.next();
+        }
+    }
+
+    bson_ensure_space( buf, 1 );
+    *buf->cur++ = 0;
+    bsonPatch32( buf, pos, ( buf->cur - buf->buf ) - pos );
+    return true;
+}
+
+bool
+BSONObj::append( const char* nm,
+                 const Falcon::Item& item,
+                 bson_buffer* buf,
+                 const bool )
+{
+    if ( !buf )
+        buf = &mBuf;
+
+    const int pos = buf->cur - buf->buf;
+    if ( !encodeElement( buf, nm, item ) )
+    {
+        buf->cur = buf->buf + pos;
         return false;
     }
+    if ( mFinalized ) mFinalized = false;
+    return true;
 }
 
 int
@@ -929,33 +1051,30 @@ BSONObj::appendMany( const CoreDict& dict )
     if ( dict.length() == 0 ) // nothing to append
         return 0;
 
-    // we want to check data before updating bson buffer
+    // data is checked while encoded; on errors the buffer is rewound.
+    const int pos = mBuf.cur - mBuf.buf;
     Iterator iter( (Sequence*) &dict.items() );
-    Item* k, *v;
 
     while ( iter.hasCurrent() )
     {
-        k = &iter.getCurrentKey();
-        if ( !k->isString() ) // bad key
+        const Item& k = iter.getCurrentKey();
+        if ( !k.isString() ) // bad key
+        {
+            mBuf.cur = mBuf.buf + pos;
             return 1;
-        v = &iter.getCurrent();
-        if ( !itemIsSupported( *v ) ) // bad value
+        }
+        if ( !encodeElement( &mBuf, *k.asString(), iter.getCurrent() ) ) // bad value
+        {
+            mBuf.cur = mBuf.buf + pos;
             return 2;
+        }
         iter.next();
     }
-    // really appending data
-    iter.goTop();
-    while ( iter.hasCurrent() )
-    {
-        k = &iter.getCurrentKey();
-        v = &iter.getCurrent();
-        AutoCString key( *k );
-        append( key.c_str(), *v, 0, false ); // not checking
-        iter.next();
-    }
+    if ( mFinalized ) mFinalized = false;
     return 0;
 }
 
+
 int
 BSONObj::createFromDict( const CoreDict& dict,
                          BSONObj** bobj )
@@ -1013,46 +1132,30 @@ BSONObj::hasKey( const char* key )
     return false;
 }
 
-Falcon::Item*
-BSONObj::value( const char* key )
+bool
+BSONObj::value( const char* key,
+                Falcon::Item& it )
 {
     if ( !key || key[0] == '\0' )
-        return 0;
+        return false;
 
     bson_iterator iter;
-    bson_iterator_init( &iter, finalize()->data );
-    bson_type tp;
+    const bson_type tp = bson_find( &iter, finalize(), key );
+    if ( tp == bson_eoo )
+        return false;
 
-    while ( ( tp = bson_iterator_next( &iter ) ) != bson_eoo )
-    {
-        if ( !strcmp( key, bson_iterator_key( &iter ) ) )
-        {
-            return BSONIter::makeItem( tp, &iter );
-        }
-    }
-    return 0;
+    BSONIter::makeItem( tp, &iter, it );
+    return true;
 }
 
 Falcon::CoreDict*
 BSONObj::asDict()
 {
-    bson_iterator iter;
-    bson_iterator_init( &iter, finalize()->data );
-    CoreDict* dict = new CoreDict( new LinearDict );
-    bson_type tp;
-    const char* k;
-    Item* v;
-
-    while ( ( tp = bson_iterator_next( &iter ) ) != bson_eoo )
-    {
-        k = bson_iterator_key( &iter );
-        v = BSONIter::makeItem( tp, &iter );
-        dict->put( String( k ), *v );
-    }
-
-    return dict;
+    // fields are decoded on demand
+    return new CoreDict( new BSONDict( finalize() ) );
 }
 
+
 bool
 BSONObj::itemIsSupported( const Falcon::Item& item )
 {
@@ -1186,92 +1289,88 @@ BSONIter::currentKey()
     return mCurrentType > 0 ? bson_iterator_key( &mIter ): 0;
 }
 
-Falcon::Item*
-BSONIter::currentValue()
+bool
+BSONIter::currentValue( Falcon::Item& it )
 {
     if ( mCurrentType <= 0 )
-        return 0;
+        return false;
 
-    return makeItem( (bson_type) mCurrentType, &mIter );
+    makeItem( (bson_type) mCurrentType, &mIter, it );
+    return true;
 }
 
-Falcon::Item*
-BSONIter::makeItem( const bson_type tp,
-                    bson_iterator* iter )
+void
+BSONIter::makeString( const char* str,
+                      Falcon::Item& it )
 {
-    Item* it = 0;
+    CoreString* s = new CoreString;
+    s->fromUTF8( str );
+    it = s;
+}
 
+bool
+BSONIter::makeItem( const bson_type tp,
+                    bson_iterator* iter,
+                    Falcon::Item& it )
+{
     switch ( tp )
     {
     case bson_double:
-        it = new Item( bson_iterator_double_raw( iter ) );
+        it = bson_iterator_double_raw( iter );
         break;
     case bson_string:
-        it = new Item( bson_iterator_string( iter ) );
+    case bson_symbol:
+        makeString( bson_iterator_string( iter ), it );
         break;
     case bson_object:
-    {
-        bson_iterator iter2;
-        bson_iterator_subiterator( iter, &iter2 );
-        it = makeObject( &iter2 );
+        makeObject( iter, it );
         break;
-    }
     case bson_array:
     {
         bson_iterator iter2;
         bson_iterator_subiterator( iter, &iter2 );
-        it = makeArray( &iter2 );
+        makeArray( &iter2, it );
         break;
     }
     case bson_bindata:
     {
+        // the length is in bytes, the subtype is the word size.
         const byte* ptr = (byte*) bson_iterator_bin_data( iter );
         const uint32 sz = bson_iterator_bin_len( iter );
-        byte* data;
+        int ws = bson_iterator_bin_type( iter );
+        if ( ws < 1 || ws > 4 || sz % ws != 0 )
+            ws = 1;
+        byte* data = (byte*) memAlloc( sz );
+        memcpy( data, ptr, sz );
         MemBuf* mb = 0;
-        switch ( bson_iterator_bin_type( iter ) )
+        switch ( ws )
         {
         case 4:
-            data = (byte*) memAlloc( sz * 4 );
-            memcpy( data, ptr, sz * 4 );
-            mb = new MemBuf_4( data, sz, memFree );
+            mb = new MemBuf_4( data, sz / 4, memFree );
             break;
         case 3:
-            data = (byte*) memAlloc( sz * 3 );
-            memcpy( data, ptr, sz * 3 );
-            mb = new MemBuf_3( data, sz, memFree );
+            mb = new MemBuf_3( data, sz / 3, memFree );
             break;
         case 2:
-            data = (byte*) memAlloc( sz * 2 );
-            memcpy( data, ptr, sz * 2 );
-            mb = new MemBuf_2( data, sz, memFree );
-            break;
-        case 1:
-            data = (byte*) memAlloc( sz * 1 );
-            memcpy( data, ptr, sz * 1 );
-            mb = new MemBuf_1( data, sz, memFree );
+            mb = new MemBuf_2( data, sz / 2, memFree );
             break;
         default:
+            mb = new MemBuf_1( data, sz, memFree );
             break;
         }
-        fassert( mb );
-        it = new Item( mb );
+        it = mb;
         break;
     }
-    case bson_undefined:
-        it = new Item( bson_iterator_value( iter ) );
-        break;
     case bson_oid:
     {
         VMachine* vm = VMachine::getCurrent();
         ObjectID* oid = new ObjectID( vm->findWKI( "ObjectID" )->asClass(),
                                       bson_iterator_oid( iter ) );
-        it = new Item( oid );
+        it = oid;
         break;
     }
     case bson_bool:
-        it = new Item();
-        it->setBoolean( (bool) bson_iterator_bool_raw( iter ) );
+        it.setBoolean( (bool) bson_iterator_bool_raw( iter ) );
         break;
     case bson_date:
     {
@@ -1296,68 +1395,261 @@ BSONIter::makeItem( const bson_type tp,
         TimeStamp* ts = new TimeStamp( 1970, 1, 1, 0, 0, 0, 0, tz_UTC );
         ts->add( tmp );
         obj->setUserData( ts );
-        it = new Item( obj );
+        it = obj;
         break;
     }
-    case bson_null:
-        it = new Item();
-        break;
-    case bson_regex:
-        //...
-        break;
-    case bson_dbref: // deprecated
-        //...
-        break;
-    case bson_symbol:
-        it = new Item( bson_iterator_string( iter ) );
-        break;
     case bson_codewscope:
-        it = new Item( bson_iterator_code( iter ) );
+        makeString( bson_iterator_code( iter ), it );
         break;
     case bson_int:
-        it = new Item( bson_iterator_int_raw( iter ) );
-        break;
-    case bson_timestamp:
-        //...
+        it = (int64) bson_iterator_int_raw( iter );
         break;
     case bson_long:
-        it = new Item( (int64) bson_iterator_long_raw( iter ) );
+        it = (int64) bson_iterator_long_raw( iter );
         break;
+    case bson_undefined:
+    case bson_null:
+        it.setNil();
+        break;
+    case bson_regex:
+    case bson_dbref: // deprecated
+    case bson_timestamp:
     case bson_eoo:
-    default:
-        return it;
+    default: // unsupported
+        it.setNil();
+        return false;
     }
 
-    return it;
+    return true;
 }
 
-Falcon::Item*
-BSONIter::makeArray( bson_iterator* iter )
+void
+BSONIter::makeArray( bson_iterator* iter,
+                     Falcon::Item& it )
 {
     CoreArray* arr = new CoreArray;
+    bson_type tp;
+
+    while ( ( tp = bson_iterator_next( iter ) ) != bson_eoo )
+    {
+        Item v;
+        makeItem( tp, iter, v );
+        arr->append( v );
+    }
+
+    it = arr;
+}
+
+void
+BSONIter::makeObject( bson_iterator* iter,
+                      Falcon::Item& it )
+{
+    bson sub;
+    bson_iterator_subobject( iter, &sub );
+    it = new CoreDict( new BSONDict( &sub ) );
+}
+
+/*******************************************************************************
+    BSONDict class
+*******************************************************************************/
+
+BSONDict::BSONDict( const bson* data )
+    :
+    mFields( 0 )
+{
+    bson_copy( &mData, data );
+
+    // count the fields without decoding them.
+    bson_iterator iter;
+    bson_iterator_init( &iter, mData.data );
+    while ( bson_iterator_next( &iter ) != bson_eoo )
+        ++mFields;
+
+    if ( mFields == 0 )
+        bson_destroy( &mData );
+}
+
+BSONDict::~BSONDict()
+{
+    bson_destroy( &mData );
+}
+
+void
+BSONDict::decodeAll() const
+{
+    if ( isDecoded() )
+        return;
 
-    while ( bson_iterator_next( iter ) != bson_eoo )
+    BSONDict* self = const_cast<BSONDict*>( this );
+    const bool partial = LinearDict::length() != 0;
+    bson_iterator iter;
+    bson_iterator_init( &iter, mData.data );
+    bson_type tp;
+
+    while ( ( tp = bson_iterator_next( &iter ) ) != bson_eoo )
     {
-        Item* v = makeItem( bson_iterator_type( iter ), iter );
-        arr->append( *v );
+        Item k;
+        BSONIter::makeString( bson_iterator_key( &iter ), k );
+        if ( partial && LinearDict::find( k ) != 0 ) // already decoded
+            continue;
+        Item v;
+        BSONIter::makeItem( tp, &iter, v );
+        self->LinearDict::put( k, v );
     }
 
-    return new Item( arr );
+    bson_destroy( &mData );
+}
+
+void
+BSONDict::decoded() const
+{
+    // drop the raw data as soon as all the fields are decoded.
+    if ( LinearDict::length() == mFields )
+        bson_destroy( &mData );
 }
 
-Falcon::Item*
-BSONIter::makeObject( bson_iterator* iter )
+void
+BSONDict::gcMark( uint32 gen )
 {
-    CoreDict* dict = new CoreDict( new LinearDict );
+    // LinearDict::gcMark() would scan up to our virtual length().
+    Sequence::gcMark( gen );
 
-    while( bson_iterator_next( iter ) != bson_eoo )
+    const LinearDictEntry* entry = entries();
+    for ( uint32 i=0; i < LinearDict::length(); ++i )
     {
-        Item* k = new Item( bson_iterator_key( iter ) );
-        Item* v = makeItem( bson_iterator_type( iter ), iter );
-        dict->put( *k, *v );
+        memPool->markItem( entry[i].key() );
+        memPool->markItem( entry[i].value() );
     }
+}
+
+LinearDict*
+BSONDict::clone() const
+{
+    decodeAll();
+    return LinearDict::clone();
+}
+
+uint32
+BSONDict::length() const
+{
+    return isDecoded() ? LinearDict::length() : mFields;
+}
+
+Item*
+BSONDict::find( const Item& key ) const
+{
+    Item* found = LinearDict::find( key );
+    if ( found || isDecoded() || !key.isString() )
+        return found;
 
-    return new Item( dict );
+    AutoCString k( *key.asString() );
+    bson_iterator iter;
+    const bson_type tp = bson_find( &iter, &mData, k.c_str() );
+    if ( tp == bson_eoo )
+        return 0;
+
+    Item v;
+    BSONIter::makeItem( tp, &iter, v );
+    BSONDict* self = const_cast<BSONDict*>( this );
+    self->LinearDict::put( Item( *key.asString() ), v );
+    decoded();
+    return LinearDict::find( key );
+}
+
+bool
+BSONDict::findIterator( const Item& key,
+                        Iterator& iter )
+{
+    decodeAll();
+    return LinearDict::findIterator( key, iter );
+}
+
+const Item&
+BSONDict::front() const
+{
+    decodeAll();
+    return LinearDict::front();
+}
+
+const Item&
+BSONDict::back() const
+{
+    decodeAll();
+    return LinearDict::back();
+}
+
+void
+BSONDict::append( const Item& item )
+{
+    decodeAll();
+    LinearDict::append( item );
+}
+
+void
+BSONDict::prepend( const Item& item )
+{
+    decodeAll();
+    LinearDict::prepend( item );
+}
+
+bool
+BSONDict::remove( const Item& key )
+{
+    decodeAll();
+    return LinearDict::remove( key );
+}
+
+void
+BSONDict::put( const Item& key,
+               const Item& value )
+{
+    decodeAll();
+    LinearDict::put( key, value );
+}
+
+void
+BSONDict::smartInsert( const Iterator& iter,
+                       const Item& key,
+                       const Item& value )
+{
+    decodeAll();
+    LinearDict::smartInsert( iter, key, value );
+}
+
+void
+BSONDict::merge( const ItemDict& dict )
+{
+    decodeAll();
+    LinearDict::merge( dict );
+}
+
+void
+BSONDict::clear()
+{
+    bson_destroy( &mData );
+    LinearDict::clear();
+}
+
+bool
+BSONDict::empty() const
+{
+    return length() == 0;
+}
+
+void
+BSONDict::getIterator( Iterator& tgt,
+                       bool tail ) const
+{
+    decodeAll();
+    LinearDict::getIterator( tgt, tail );
+}
+
+void
+BSONDict::copyIterator( Iterator& tgt,
+                        const Iterator& source ) const
+{
+    decodeAll();
+    LinearDict::copyIterator( tgt, source );
 }
 
 
@@ -8,6 +8,7 @@
 #include <falcon/carray.h>
 #include <falcon/coreobject.h>
 #include <falcon/falcondata.h>
+#include <falcon/lineardict.h>
 #include <falcon/string.h>
 #include <falcon/timestamp.h>
 
@@ -176,7 +177,9 @@ public:
     void reset( const int bytesNeeded=0 );
 
     bool hasKey( const char* key );
-    Falcon::Item* value( const char* key );
+    // Return false if key is not found.
+    bool value( const char* key,
+                Falcon::Item& it );
 
     BSONObj* genOID( const char* nm="_id" );
     BSONObj* append( const char* nm,
@@ -212,10 +215,12 @@ public:
                      bson_buffer* buf=0 );
 
     // Return true if item was successfuly appended.
+    // Items are checked while being encoded, and the buffer is left
+    // untouched on failure; doCheck is kept for compatibility.
     bool append( const char* nm,
                  const Falcon::Item& item,
                  bson_buffer* buf=0,
-                 const bool doCheck=true ); // unless you know what you're doing
+                 const bool doCheck=true );
 
     int appendMany( const CoreDict& dict );
 
@@ -233,15 +238,30 @@ public:
 
     static bson* empty(); // helper
 
+    static bson_date_t toDate( const Falcon::TimeStamp& ts );
+
 protected:
 
-    BSONObj* append( const char* nm,
-                     const CoreArray& array,
-                     bson_buffer* parentBuf=0 );
-
-    BSONObj* append( const char* nm,
-                     const CoreDict& dict,
-                     bson_buffer* parentBuf=0 );
+    /*
+     *  Direct serializer.
+     *  Items are written in place in the buffer, checking them on the way.
+     *  These return false (or bson_eoo) on unsupported items, leaving
+     *  partial data in the buffer: the caller must rewind it.
+     */
+    static bool encodeElement( bson_buffer* buf,
+                               const char* nm,
+                               const Falcon::Item& item );
+    static bool encodeElement( bson_buffer* buf,
+                               const Falcon::String& nm,
+                               const Falcon::Item& item );
+    static bson_type encodeValue( bson_buffer* buf,
+                                  const Falcon::Item& item );
+    static bool encodeArray( bson_buffer* buf,
+                             const CoreArray& array );
+    static bool encodeDict( bson_buffer* buf,
+                            const CoreDict& dict );
+    static void encodeCString( bson_buffer* buf,
+                               const Falcon::String& str );
 
     bson_buffer mBuf;
     bson        mObj;
@@ -257,6 +277,7 @@ class BSONIter
 
 friend class Connection;
 friend class BSONObj;
+friend class BSONDict;
 
 public:
 
@@ -272,14 +293,21 @@ public:
     bool find( const char* nm );
 
     const char* currentKey();
-    Falcon::Item* currentValue();
+    // Return false if there is no current value.
+    bool currentValue( Falcon::Item& it );
 
 protected:
 
-    static Falcon::Item* makeItem( const bson_type tp,
-                                   bson_iterator* iter );
-    static Falcon::Item* makeArray( bson_iterator* iter );
-    static Falcon::Item* makeObject( bson_iterator* iter );
+    // Return false (and set a nil item) on unsupported types.
+    static bool makeItem( const bson_type tp,
+                          bson_iterator* iter,
+                          Falcon::Item& it );
+    static void makeArray( bson_iterator* iter,
+                           Falcon::Item& it );
+    static void makeObject( bson_iterator* iter,
+                            Falcon::Item& it );
+    static void makeString( const char* str,
+                            Falcon::Item& it );
 
     bson            mData;
     bson_iterator   mIter;
@@ -288,6 +316,59 @@ protected:
 };
 
 
+/*
+ *  Dictionary decoding the fields of a BSON object on demand.
+ *  Lookups decode only the required field; the whole object is decoded
+ *  as soon as the dictionary is iterated or changed.
+ */
+class BSONDict
+    :
+    public Falcon::LinearDict
+{
+public:
+
+    BSONDict( const bson* data ); // data is copied not owned
+    virtual ~BSONDict();
+
+    virtual LinearDict* clone() const;
+    virtual void gcMark( uint32 gen );
+    virtual uint32 length() const;
+    virtual Item* find( const Item& key ) const;
+    using LinearDict::find;
+    virtual bool findIterator( const Item& key,
+                               Iterator& iter );
+    virtual const Item& front() const;
+    virtual const Item& back() const;
+    virtual void append( const Item& item );
+    virtual void prepend( const Item& item );
+    virtual bool remove( const Item& key );
+    virtual void put( const Item& key,
+                      const Item& value );
+    virtual void smartInsert( const Iterator& iter,
+                              const Item& key,
+                              const Item& value );
+    virtual void merge( const ItemDict& dict );
+    virtual void clear();
+    virtual bool empty() const;
+
+    bool isDecoded() const { return mData.data == 0; }
+
+protected:
+
+    virtual void getIterator( Iterator& tgt,
+                              bool tail=false ) const;
+    virtual void copyIterator( Iterator& tgt,
+                               const Iterator& source ) const;
+
+    void decodeAll() const;
+    void decoded() const;
+
+    mutable bson    mData;
+    uint32          mFields;
+
+};
+
+
 } // !namespace MongoDB
 } // !namespace Falcon
 
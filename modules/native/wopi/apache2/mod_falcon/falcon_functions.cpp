@@ -16,6 +16,7 @@
 
 #include <falcon/wopi/mem_sm.h>
 #include <falcon/wopi/file_sm.h>
+#include <falcon/wopi/shm_sm.h>
 #include <falcon/wopi/wopi_ext.h>
 #include <falcon/wopi/wopi.h>
 #include <falcon/wopi/replystream.h>
@@ -185,7 +186,23 @@ static int falcon_handler(request_rec *request)
    // prepare the session manager for this process.
    if ( s_session == 0 )
    {
-      if ( the_falcon_config->sessionMode == FM_DEFAULT_SESSION_MODE )
+      if ( the_falcon_config->sessionMode == 2 )
+      {
+         // shared across all the apache processes.
+         try
+         {
+            s_session = new Falcon::WOPI::ShmSessionManager( "SESSIONS" );
+         }
+         catch( Falcon::Error* error )
+         {
+            Falcon::AutoCString cmsg( error->toString() );
+            ap_log_rerror( APLOG_MARK, APLOG_ERR, 0, request,
+               "Cannot open the shared session store, using files: %s", cmsg.c_str() );
+            error->decref();
+            s_session = new Falcon::WOPI::FileSessionManager( the_falcon_config->uploadDir );
+         }
+      }
+      else if ( the_falcon_config->sessionMode == FM_DEFAULT_SESSION_MODE )
       {
          s_session = new Falcon::WOPI::FileSessionManager( the_falcon_config->uploadDir );
       }
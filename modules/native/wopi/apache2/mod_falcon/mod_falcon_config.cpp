@@ -366,6 +366,8 @@ int falcon_mod_load_config( falcon_mod_config *cfg )
                cfg->sessionMode = 1;
             else if (apr_strnatcasecmp( token, "Memory" ) == 0 )
                cfg->sessionMode = 0;
+            else if (apr_strnatcasecmp( token, "Shared" ) == 0 )
+               cfg->sessionMode = 2;
             else
                correct = false;
          }
@@ -18,6 +18,7 @@
 #include "cgi_options.h"
 #include <falcon/setup.h>
 #include <falcon/path.h>
+#include <falcon/sys.h>
 
 CGIOptions::CGIOptions():
    m_smgr( 0 )
@@ -25,6 +26,8 @@ CGIOptions::CGIOptions():
    // provide some defaults
    m_maxUpload = 20000000;
    m_maxMemUpload = 5000;
+   m_nThreads = 4;
+   m_nVMs = 0;
 #ifdef FALCON_SYSTEM_WIN
    m_sUploadPath = "/C:/TEMP";
 #else
@@ -46,6 +49,17 @@ bool CGIOptions::init( int argc, char* argv[] )
    Falcon::Path ps( m_sScritpName );
    m_sMainScript = ps.getFile();
 
+   Falcon::String sVal;
+   Falcon::int64 nVal;
+   if( Falcon::Sys::_getEnv( "FALCON_FCGI_THREADS", sVal ) && sVal.parseInt( nVal ) && nVal > 0 )
+      m_nThreads = (Falcon::uint32) nVal;
+
+   // as many VMs as threads, unless otherwise specified.
+   if( Falcon::Sys::_getEnv( "FALCON_FCGI_VMS", sVal ) && sVal.parseInt( nVal ) && nVal > 0 )
+      m_nVMs = (Falcon::uint32) nVal;
+   else
+      m_nVMs = m_nThreads;
+
    return true;
 }
 
@@ -35,6 +35,11 @@ public:
    Falcon::String m_sScritpName;
    Falcon::String m_sMainScript;
 
+   /** Threads serving FastCGI requests concurrently (FALCON_FCGI_THREADS). */
+   Falcon::uint32 m_nThreads;
+   /** Virtual machines kept ready to run the script (FALCON_FCGI_VMS). */
+   Falcon::uint32 m_nVMs;
+
    Falcon::WOPI::SessionManager* m_smgr;
 };
 
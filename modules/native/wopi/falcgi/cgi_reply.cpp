@@ -19,7 +19,8 @@
 
 CGIReply::CGIReply( const Falcon::CoreClass* cls ):
    Reply( cls ),
-   m_output( 0 )
+   m_output( 0 ),
+   m_target( 0 )
 {
 }
 
@@ -27,8 +28,22 @@ CGIReply::~CGIReply()
 {
 }
 
-void CGIReply::init( )
+void CGIReply::init( Falcon::Stream* output )
 {
+   m_target = output;
+}
+
+void CGIReply::release()
+{
+   // once committed, the reply output owns the target (possibly through a transcoder).
+   if( Falcon::WOPI::Reply::m_output != 0 )
+      delete Falcon::WOPI::Reply::m_output;
+   else
+      delete m_target;
+
+   Falcon::WOPI::Reply::m_output = 0;
+   m_output = 0;
+   m_target = 0;
 }
 
 
@@ -43,7 +58,7 @@ void CGIReply::startCommit()
 
 Falcon::Stream* CGIReply::makeOutputStream()
 {
-   m_output = ::makeOutputStream();
+   m_output = m_target != 0 ? m_target : ::makeOutputStream();
    return m_output;
 }
 
@@ -27,7 +27,14 @@ public:
    CGIReply( const Falcon::CoreClass* cls );
    virtual ~CGIReply();
 
-   void init();
+   /** Prepares the reply.
+      \param output The stream where the reply is written; if 0, the
+         stream provided by makeOutputStream() is used.
+   */
+   void init( Falcon::Stream* output = 0 );
+
+   /** Destroys the stream given to init(), once the reply is complete. */
+   void release();
 
    static Falcon::CoreObject* factory( const Falcon::CoreClass* cls, void* ud, bool bDeser );
 
@@ -39,6 +46,7 @@ protected:
 
 private:
    Falcon::Stream* m_output;
+   Falcon::Stream* m_target;
 };
 
 #endif /* CGI_REPLY_H_ */
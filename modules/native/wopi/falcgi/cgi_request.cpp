@@ -47,12 +47,30 @@ CGIRequest::~CGIRequest()
 }
 
 
-void CGIRequest::init( Falcon::Stream* input, Falcon::CoreClass* upld_cls, Falcon::WOPI::Reply* r, Falcon::WOPI::SessionManager* sm )
+void CGIRequest::init( Falcon::Stream* input, Falcon::CoreClass* upld_cls, Falcon::WOPI::Reply* r, Falcon::WOPI::SessionManager* sm,
+      char** envp )
 {
    CoreRequest::init( upld_cls, r, sm );
 
    // First; suck all the environment variables that we need.
-   Falcon::Sys::_enumerateEnvironment( &handleEnvStr, this );
+   if( envp == 0 )
+   {
+      Falcon::Sys::_enumerateEnvironment( &handleEnvStr, this );
+   }
+   else
+   {
+      // FastCGI requests carry their own variables.
+      for( ; *envp != 0; ++envp )
+      {
+         Falcon::String sVar;
+         sVar.fromUTF8( *envp );
+         Falcon::uint32 pos = sVar.find( "=" );
+         if( pos != Falcon::String::npos )
+         {
+            handleEnvStr( sVar.subString( 0, pos ), sVar.subString( pos + 1 ), this );
+         }
+      }
+   }
 
    // a bit of post-processing
    if ( m_base->parsedUri().port() == "443" || m_base->parsedUri().port() == "https" )
@@ -98,9 +116,13 @@ void CGIRequest::handleEnvStr( const Falcon::String& key, const Falcon::String&
    else if( key == "CONTENT_LENGTH" )
    {
       Falcon::int64 tgt;
-      value.parseInt(tgt);
-      r->m_content_length = (int) tgt;
-      self->m_post_length = (int) tgt;
+      if( value.parseInt(tgt) )
+      {
+         r->m_content_length = tgt;
+         self->m_post_length = tgt;
+         // the server is not required to close the input at the end of the body.
+         r->m_MainPart.setBodySize( tgt );
+      }
    }
    else if( key == "DOCUMENT_ROOT" )
    {
@@ -26,7 +26,12 @@ public:
    CGIRequest( const Falcon::CoreClass* cls );
    virtual ~CGIRequest();
 
-   void init( Falcon::Stream* input, Falcon::CoreClass* upld_cls, Falcon::WOPI::Reply* r, Falcon::WOPI::SessionManager* sm );
+   /** Reads the request.
+      \param envp The CGI variables of the request, as a null terminated
+         array of "NAME=value" strings; if 0, the process environment is used.
+   */
+   void init( Falcon::Stream* input, Falcon::CoreClass* upld_cls, Falcon::WOPI::Reply* r, Falcon::WOPI::SessionManager* sm,
+         char** envp = 0 );
 
    static Falcon::CoreObject* factory( const Falcon::CoreClass* cls, void* ud, bool bDeser );
 
@@ -43,7 +48,7 @@ private:
    void readMultipartFields( Falcon::Stream* input );
    bool readSinglePart( const Falcon::String& sBoundary, Falcon::Stream* input  );
 
-   int m_post_length;
+   Falcon::int64 m_post_length;
    Falcon::String m_post_type;
 
    Falcon::VMachine* m_vmOwner;
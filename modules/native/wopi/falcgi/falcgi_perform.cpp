@@ -43,6 +43,13 @@ void configure_loader( CGIOptions& opts, Falcon::ModuleLoader& ml )
 
    Falcon::Engine::setSearchPath( ml.getSearchPath() );
 
+   // compiled scripts are shared through this directory across the processes.
+   Falcon::String cacheDir;
+   if( Falcon::Sys::_getEnv( "FALCON_MODULE_CACHE", cacheDir ) && cacheDir != "" )
+   {
+      ml.moduleCacheDir( cacheDir );
+   }
+
    ml.sourceEncoding("utf-8");
    Falcon::Engine::setEncodings( "utf-8", "utf-8" );
 }
@@ -17,6 +17,7 @@
 #ifndef CGI_PERFORM_H_
 #define CGI_PERFORM_H_
 
+void configure_loader( CGIOptions& opts, Falcon::ModuleLoader& ml );
 void* perform( CGIOptions& options, int argc, char* argv[] );
 
 #endif /* CGI_PERFORM_H_ */
@@ -35,6 +35,7 @@
 #endif
 
 FalhttpdApp* FalhttpdApp::m_theApp = 0;
+volatile sig_atomic_t FalhttpdApp::m_bFlushModules = 0;
 
 FalhttpdApp::FalhttpdApp():
    m_logModule(0),
@@ -122,6 +123,11 @@ bool FalhttpdApp::init( int argc, char* argv[] )
       m_loader->setSearchPath( m_hopts.m_loadPath );
    }
 
+#ifndef FALCON_SYSTEM_WIN
+   // SIGHUP invalidates the compiled modules held in memory.
+   signal( SIGHUP, &FalhttpdApp::onHangup );
+#endif
+
    return readyNet();
 }
 
@@ -263,6 +269,24 @@ void FalhttpdApp::usage()
    );
 }
 
+void FalhttpdApp::onHangup( int )
+{
+   m_bFlushModules = 1;
+}
+
+
+void FalhttpdApp::checkModuleCache()
+{
+   if( m_bFlushModules )
+   {
+      m_bFlushModules = 0;
+      Falcon::String sCount;
+      sCount.N( (Falcon::int64) Falcon::Engine::flushModuleCache() );
+      logi( "Module cache flushed (" + sCount + " modules)" );
+   }
+}
+
+
 int FalhttpdApp::run()
 {
    // accept.
@@ -296,6 +320,8 @@ int FalhttpdApp::run()
          sRemote = "unknown";
       }
 
+      checkModuleCache();
+
       FalhttpdClient* cli = new FalhttpdClient( m_hopts, m_log, sIncoming, sRemote );
       cli->serve();
       delete cli;
@@ -26,6 +26,8 @@
 #define SOCKET int
 #endif
 
+#include <signal.h>
+
 #include <falcon/engine.h>
 #include "falhttpd_options.h"
 
@@ -66,6 +68,11 @@ public:
 private:
    void readyLog( Falcon::LogService* );
 
+   /** Empties the compiled module cache if it was requested through SIGHUP. */
+   void checkModuleCache();
+   static void onHangup( int sig );
+   static volatile sig_atomic_t m_bFlushModules;
+
    Falcon::Module* m_logModule;
    Falcon::LogArea* m_log;
    Falcon::ModuleLoader* m_loader;
@@ -0,0 +1,237 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: falhttpd_filecache.cpp
+
+   Micro HTTPD server providing Falcon scripts on the web.
+
+   Cache of small static files.
+
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 16:20:41 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include "falhttpd_filecache.h"
+
+#include <falcon/memory.h>
+
+#ifdef _WIN32
+#include <falcon/fstream.h>
+#else
+#include <falcon/autocstring.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Falcon;
+
+FileCache::Entry::Entry( const String& sFile, int64 mtime ):
+   m_sFile( sFile ),
+   m_mtime( mtime ),
+   m_data( 0 ),
+   m_size( 0 ),
+   m_bMapped( false ),
+   m_refCount( 1 )
+{
+}
+
+
+FileCache::Entry::~Entry()
+{
+   if ( m_data != 0 )
+   {
+#ifndef _WIN32
+      if ( m_bMapped )
+      {
+         munmap( m_data, m_size );
+         return;
+      }
+#endif
+      memFree( m_data );
+   }
+}
+
+
+bool FileCache::Entry::load()
+{
+#ifdef _WIN32
+   FileStream fs;
+   if ( ! fs.open( m_sFile, BaseFileStream::e_omReadOnly, BaseFileStream::e_smShareRead ) )
+      return false;
+
+   int64 size = fs.seekEnd( 0 );
+   if ( size < 0 || size > 0x7FFFFFFF || fs.seekBegin( 0 ) != 0 )
+      return false;
+
+   m_size = (uint32) size;
+   if ( m_size == 0 )
+      return true;
+
+   m_data = (byte*) memAlloc( m_size );
+   uint32 done = 0;
+   while( done < m_size )
+   {
+      int32 r = fs.read( m_data + done, m_size - done );
+      if ( r <= 0 )
+         return false;
+      done += r;
+   }
+
+   return true;
+#else
+   AutoCString cfile( m_sFile );
+   int fd = ::open( cfile.c_str(), O_RDONLY );
+   if ( fd < 0 )
+      return false;
+
+   struct stat st;
+   if ( fstat( fd, &st ) != 0 || st.st_size > 0x7FFFFFFF )
+   {
+      ::close( fd );
+      return false;
+   }
+
+   m_size = (uint32) st.st_size;
+   // an empty file can't be mapped, but it's fine to cache it.
+   if ( m_size != 0 )
+   {
+      void* map = mmap( 0, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( map != MAP_FAILED )
+      {
+         m_data = (byte*) map;
+         m_bMapped = true;
+      }
+   }
+
+   ::close( fd );
+   return m_size == 0 || m_data != 0;
+#endif
+}
+
+//=================================================================
+// The cache
+//
+
+FileCache::FileCache( int64 maxSize, int64 maxFileSize ):
+   m_maxSize( maxSize ),
+   m_maxFileSize( maxFileSize > maxSize ? maxSize : maxFileSize ),
+   m_usedSize( 0 )
+{
+}
+
+
+FileCache::~FileCache()
+{
+   // entries still referenced at this point are leaked on purpose;
+   // the server is going down anyhow.
+   EntryList::iterator iter = m_lru.begin();
+   while( iter != m_lru.end() )
+   {
+      Entry* entry = *iter;
+      if ( --entry->m_refCount == 0 )
+         delete entry;
+      ++iter;
+   }
+}
+
+
+FileCache::Entry* FileCache::get( const String& sFile, int64 mtime, int64 size )
+{
+   if ( size > m_maxFileSize )
+      return 0;
+
+   m_mtx.lock();
+   EntryMap::iterator pos = m_entries.find( sFile );
+   if ( pos != m_entries.end() )
+   {
+      Entry* entry = pos->second;
+      if ( entry->m_mtime == mtime && entry->m_size == size )
+      {
+         m_lru.erase( entry->m_lruPos );
+         m_lru.push_front( entry );
+         entry->m_lruPos = m_lru.begin();
+         entry->m_refCount++;
+         m_mtx.unlock();
+         return entry;
+      }
+
+      // the file has been changed.
+      unlink( entry );
+      unref( entry );
+   }
+   m_mtx.unlock();
+
+   // load the file outside the lock.
+   Entry* entry = new Entry( sFile, mtime );
+   if ( ! entry->load() || entry->m_size != size )
+   {
+      // failed, or changed while we were loading it.
+      delete entry;
+      return 0;
+   }
+
+   m_mtx.lock();
+   // someone may have loaded it in the meanwhile.
+   pos = m_entries.find( sFile );
+   if ( pos != m_entries.end() )
+   {
+      Entry* old = pos->second;
+      unlink( old );
+      unref( old );
+   }
+
+   evict( entry->m_size );
+   m_entries[ sFile ] = entry;
+   m_lru.push_front( entry );
+   entry->m_lruPos = m_lru.begin();
+   m_usedSize += entry->m_size;
+   // one reference for the cache, one for the caller.
+   entry->m_refCount++;
+   m_mtx.unlock();
+
+   return entry;
+}
+
+
+void FileCache::release( Entry* entry )
+{
+   m_mtx.lock();
+   unref( entry );
+   m_mtx.unlock();
+}
+
+
+void FileCache::unlink( Entry* entry )
+{
+   m_entries.erase( entry->m_sFile );
+   m_lru.erase( entry->m_lruPos );
+   m_usedSize -= entry->m_size;
+}
+
+
+void FileCache::unref( Entry* entry )
+{
+   if ( --entry->m_refCount == 0 )
+      delete entry;
+}
+
+
+void FileCache::evict( int64 needed )
+{
+   while( ! m_lru.empty() && m_usedSize + needed > m_maxSize )
+   {
+      Entry* entry = m_lru.back();
+      unlink( entry );
+      unref( entry );
+   }
+}
+
+/* falhttpd_filecache.cpp */
@@ -0,0 +1,110 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: falhttpd_filecache.h
+
+   Micro HTTPD server providing Falcon scripts on the web.
+
+   Cache of small static files.
+
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 16:20:41 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#ifndef FALHTTPD_FILECACHE_H_
+#define FALHTTPD_FILECACHE_H_
+
+#include <falcon/types.h>
+#include <falcon/string.h>
+#include <falcon/mt.h>
+
+#include <map>
+#include <list>
+
+/** LRU cache of small static files.
+
+   Files are kept in memory (mapped, where the system allows it) and are
+   served without reading them again. Each entry is keyed by the path of
+   the file and is valid as long as the modification time and the size
+   of the file on disk don't change.
+
+   Entries are reference counted, so that an entry being sent is not
+   destroyed if it's evicted by another request in the meanwhile.
+*/
+class FileCache
+{
+public:
+   class Entry
+   {
+   public:
+      const Falcon::byte* data() const { return m_data; }
+      Falcon::uint32 size() const { return m_size; }
+      Falcon::int64 mtime() const { return m_mtime; }
+
+   private:
+      Entry( const Falcon::String& sFile, Falcon::int64 mtime );
+      ~Entry();
+
+      bool load();
+
+      Falcon::String m_sFile;
+      Falcon::int64 m_mtime;
+      Falcon::byte* m_data;
+      Falcon::uint32 m_size;
+      bool m_bMapped;
+      int m_refCount;
+      std::list<Entry*>::iterator m_lruPos;
+
+      friend class FileCache;
+   };
+
+   /** Creates the cache.
+      \param maxSize Maximum amount of memory used by the cached files.
+      \param maxFileSize Maximum size of a file to be cached.
+   */
+   FileCache( Falcon::int64 maxSize, Falcon::int64 maxFileSize );
+   ~FileCache();
+
+   /** Gets a cached file, loading it if necessary.
+
+      \param sFile The file to be retrieved.
+      \param mtime Modification time of the file (in timestamp long format).
+      \param size Size of the file on disk.
+      \return A referenced entry or 0 if the file can't be cached.
+
+      The returned entry must be released through release().
+   */
+   Entry* get( const Falcon::String& sFile, Falcon::int64 mtime, Falcon::int64 size );
+
+   /** Releases an entry returned by get(). */
+   void release( Entry* entry );
+
+   Falcon::int64 maxFileSize() const { return m_maxFileSize; }
+   Falcon::int64 usedSize() const { return m_usedSize; }
+
+private:
+   typedef std::map<Falcon::String, Entry*> EntryMap;
+   typedef std::list<Entry*> EntryList;
+
+   void unlink( Entry* entry );
+   void unref( Entry* entry );
+   void evict( Falcon::int64 needed );
+
+   Falcon::Mutex m_mtx;
+   EntryMap m_entries;
+   // most recently used entries are at front.
+   EntryList m_lru;
+
+   Falcon::int64 m_maxSize;
+   Falcon::int64 m_maxFileSize;
+   Falcon::int64 m_usedSize;
+};
+
+#endif
+
+/* falhttpd_filecache.h */
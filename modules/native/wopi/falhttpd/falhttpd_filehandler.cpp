@@ -21,6 +21,130 @@
 #include "falhttpd_rh.h"
 #include "falhttpd_filehandler.h"
 #include "falhttpd_client.h"
+#include "falhttpd_filecache.h"
+
+#ifdef __linux__
+#include <falcon/fstream_sys_unix.h>
+#include <sys/sendfile.h>
+#include <errno.h>
+#define FALHTTPD_SENDFILE
+#endif
+
+#define FILE_BUFFER_SIZE 16384
+
+// Gets a request header, regardless of the case of its name.
+static bool s_getHeader( Falcon::WOPI::Request* req, const String& sName, String& sValue )
+{
+   Iterator iter( &req->headers()->items() );
+   while( iter.hasCurrent() )
+   {
+      if( iter.getCurrentKey().isString() && iter.getCurrent().isString()
+          && iter.getCurrentKey().asString()->compareIgnoreCase( sName ) == 0 )
+      {
+         sValue = *iter.getCurrent().asString();
+         return true;
+      }
+      iter.next();
+   }
+
+   return false;
+}
+
+// Removes the quotes around an entity tag.
+// The header parser removes the ones around the whole header value,
+// so each side of the tag may or may not still have its own.
+static String s_unquote( const String& sTag )
+{
+   String sRes = sTag;
+   sRes.trim();
+   if ( sRes.startsWith( "W/" ) )
+      sRes = sRes.subString( 2 );
+   if ( sRes.startsWith( "\"" ) )
+      sRes = sRes.subString( 1 );
+   if ( sRes.endsWith( "\"" ) )
+      sRes = sRes.subString( 0, sRes.length() - 1 );
+
+   return sRes;
+}
+
+// Checks an If-None-Match list against our ETag.
+static bool s_matchETag( const String& sList, const String& sETag )
+{
+   String sOurs = s_unquote( sETag );
+
+   uint32 pos = 0;
+   while( pos < sList.length() )
+   {
+      uint32 pos1 = sList.find( ",", pos );
+      if ( pos1 == String::npos )
+         pos1 = sList.length();
+
+      // weak comparison is fine for GET requests
+      String sTag = s_unquote( sList.subString( pos, pos1 ) );
+      if ( sTag == "*" || sTag == sOurs )
+         return true;
+
+      pos = pos1 + 1;
+   }
+
+   return false;
+}
+
+// Parses a Range header.
+// Returns 1 if the range is valid, -1 if it can't be satisfied and 0 if it
+// must be ignored (malformed, or asking for more ranges at once).
+static int s_parseRange( const String& sRange, int64 fileSize, int64& from, int64& to )
+{
+   String sSpec = sRange;
+   sSpec.trim();
+   if ( ! sSpec.startsWith( "bytes=" ) )
+      return 0;
+
+   sSpec = sSpec.subString( 6 );
+   sSpec.trim();
+   if ( sSpec.find( "," ) != String::npos )
+      return 0;
+
+   uint32 pos = sSpec.find( "-" );
+   if ( pos == String::npos )
+      return 0;
+
+   String sFrom = sSpec.subString( 0, pos );
+   String sTo = sSpec.subString( pos + 1 );
+   sFrom.trim();
+   sTo.trim();
+
+   if ( sFrom.size() == 0 )
+   {
+      // suffix range: the last n bytes.
+      int64 suffix;
+      if ( ! sTo.parseInt( suffix ) || suffix < 0 )
+         return 0;
+      if ( suffix == 0 || fileSize == 0 )
+         return -1;
+
+      from = suffix >= fileSize ? 0 : fileSize - suffix;
+      to = fileSize - 1;
+      return 1;
+   }
+
+   if ( ! sFrom.parseInt( from ) || from < 0 )
+      return 0;
+
+   if ( sTo.size() == 0 )
+      to = fileSize - 1;
+   else if ( ! sTo.parseInt( to ) || to < from )
+      return 0;
+
+   if ( from >= fileSize )
+      return -1;
+
+   if ( to >= fileSize )
+      to = fileSize - 1;
+
+   return 1;
+}
+
 
 FileHandler::FileHandler( const Falcon::String& sFile, FalhttpdClient* cli ):
       FalhttpdRequestHandler( sFile, cli )
@@ -49,8 +173,59 @@ void FileHandler::serve( Falcon::WOPI::Request* req )
       return;
    }
 
+   int64 fileSize = stats.m_size;
+   int64 mtime = stats.m_mtime->toLongFormat();
+   String sLastModified = stats.m_mtime->toRFC2822();
+   String sETag = "\"";
+   sETag.H( (uint64) fileSize, false ).A( "-" ).H( (uint64) mtime, false ).A( "\"" );
+
+   TimeStamp now;
+   now.currentTime();
+   String sCommon = "Date: " + now.toRFC2822() + "\r\n"
+         "Last-Modified: " + sLastModified + "\r\n"
+         "ETag: " + sETag + "\r\n";
+
+   // the client has already an up to date copy?
+   String sValue;
+   if( s_getHeader( req, "If-None-Match", sValue ) && s_matchETag( sValue, sETag ) )
+   {
+      m_client->log()->log( LOGLEVEL_INFO, "File not modified "+ m_sFile );
+      m_client->sendData( "HTTP/1.1 304 Not Modified\r\n" + sCommon + "\r\n" );
+      return;
+   }
+
+   int64 from = 0;
+   int64 to = fileSize - 1;
+   bool bRange = false;
+   if( s_getHeader( req, "Range", sValue ) )
+   {
+      // If-Range asks to ignore the range if the file was changed;
+      // weak tags can't be used here.
+      String sIfRange;
+      if( ! s_getHeader( req, "If-Range", sIfRange ) || sIfRange == sLastModified
+          || ( ! sIfRange.startsWith( "W/" ) && s_unquote( sIfRange ) == s_unquote( sETag ) ) )
+      {
+         int res = s_parseRange( sValue, fileSize, from, to );
+         if( res < 0 )
+         {
+            String sReply = "HTTP/1.1 416 Requested range not satisfiable\r\n" + sCommon;
+            sReply.A( "Content-Range: bytes */" ).N( fileSize ).A( "\r\n" );
+            sReply += "Content-Length: 0\r\n\r\n";
+            m_client->sendData( sReply );
+            return;
+         }
+
+         bRange = res > 0;
+      }
+   }
+
+   // Small files are served from memory; others are opened now so that
+   // we can still report an error before the reply is sent.
+   FileCache* cache = m_client->options().m_pFileCache;
+   FileCache::Entry* entry = cache == 0 ? 0 : cache->get( m_sFile, mtime, fileSize );
+
    FileStream fs;
-   if( ! fs.open( m_sFile ) )
+   if( entry == 0 && ! fs.open( m_sFile, BaseFileStream::e_omReadOnly, BaseFileStream::e_smShareRead ) )
    {
       m_client->log()->log( LOGLEVEL_WARN, "Can't open file "+ m_sFile );
       m_client->replyError( 403 );
@@ -60,32 +235,90 @@ void FileHandler::serve( Falcon::WOPI::Request* req )
    m_client->log()->log( LOGLEVEL_INFO, "Sending file "+ m_sFile );
 
    // ok we can serve the file
-   String sReply = "HTTP/1.1 200 OK\r\n";
-
-   TimeStamp now;
-   now.currentTime();
+   int64 len = to - from + 1;
+   String sReply = bRange ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
    sReply += "Content-Type: " + sMimeType + "; charset=" + m_client->options().m_sTextEncoding + "\r\n";
-   sReply += "Date: " + now.toRFC2822() + "\r\n";
-   sReply += "Last-Modified: " + stats.m_mtime->toRFC2822() + "\r\n";
-
+   sReply += sCommon;
+   sReply += "Accept-Ranges: bytes\r\n";
+   if( bRange )
+   {
+      sReply.A( "Content-Range: bytes " ).N( from ).A( "-" ).N( to ).A( "/" ).N( fileSize ).A( "\r\n" );
+   }
+   sReply.A( "Content-Length: " ).N( len ).A( "\r\n" );
    sReply += "\r\n";
-   // content length not strictly necessary now
 
    m_client->sendData( sReply );
-   char buffer[4096];
-   int len = fs.read( buffer, 4096 );
+
+   if( req->m_method == "HEAD" || len == 0 )
+   {
+      // nothing else to send
+   }
+   else if( entry != 0 )
+   {
+      m_client->sendData( entry->data() + from, (uint32) len );
+   }
+   else if( ! sendFile( fs, from, len ) )
+   {
+      // the header is gone; we can just drop the connection.
+      m_client->log()->log( LOGLEVEL_WARN, "Error while reading file "+ m_sFile );
+   }
+
+   if( entry != 0 )
+      cache->release( entry );
+}
+
+
+bool FileHandler::sendFile( FileStream& fs, int64 from, int64 len )
+{
+#ifdef FALHTTPD_SENDFILE
+   // let the kernel move the data from the file to the socket.
+   int fd = static_cast<const UnixFileSysData *>( fs.getFileSysData() )->m_handle;
+   off_t offset = (off_t) from;
    while( len > 0 )
    {
-      m_client->sendData( buffer, len );
-      len = fs.read( buffer, 4096 );
+      size_t count = len > 0x40000000 ? 0x40000000 : (size_t) len;
+      ssize_t res = ::sendfile( m_client->socket(), fd, &offset, count );
+      if( res < 0 )
+      {
+         if( errno == EINTR || errno == EAGAIN )
+            continue;
+
+         // not supported for this file; use the generic way.
+         if( errno == EINVAL || errno == ENOSYS )
+            break;
+
+         return false;
+      }
+
+      // the file was shortened while we were sending it.
+      if( res == 0 )
+         return false;
+
+      len -= res;
    }
 
-   if ( len < 0 )
+   if( len == 0 )
+      return true;
+
+   from = (int64) offset;
+#endif
+
+   if( from != 0 && fs.seekBegin( from ) != from )
+      return false;
+
+   char buffer[FILE_BUFFER_SIZE];
+   while( len > 0 )
    {
-      // error!
-      m_client->log()->log( LOGLEVEL_WARN, "Error while reading file "+ m_sFile );
-      m_client->replyError( 403 );
+      int32 size = len > FILE_BUFFER_SIZE ? FILE_BUFFER_SIZE : (int32) len;
+      size = fs.read( buffer, size );
+      if( size <= 0 )
+         return false;
+
+      m_client->sendData( buffer, size );
+      len -= size;
    }
+
+   return true;
 }
 
 /* end of falhttpd_filehandler.cpp */
@@ -28,6 +28,9 @@ public:
    FileHandler( const Falcon::String& sFile, FalhttpdClient* client );
    virtual ~FileHandler();
    virtual void serve( Falcon::WOPI::Request* req );
+
+private:
+   bool sendFile( Falcon::FileStream& fs, Falcon::int64 from, Falcon::int64 len );
 };
 
 #endif
@@ -20,12 +20,14 @@
 #include <falcon/engine.h>
 #include <falcon/sys.h>
 #include <falcon/wopi/mem_sm.h>
+#include <falcon/wopi/shm_sm.h>
 #include <falcon/wopi/utils.h>
 
 #include "falhttpd_rh.h"
 #include "falhttpd_filehandler.h"
 #include "falhttpd_scripthandler.h"
 #include "falhttpd_dirhandler.h"
+#include "falhttpd_filecache.h"
 
 #include <list>
 
@@ -38,7 +40,10 @@ FalhttpOptions::FalhttpOptions():
    m_bQuiet( false ),
    m_bHelp( false ),
    m_bSysLog( true ),
-   m_bAllowDir( true )
+   m_bAllowDir( true ),
+   m_nFileCacheSize( 8*1024*1024 ),
+   m_nFileCacheMaxFile( 64*1024 ),
+   m_pFileCache( 0 )
 {
    m_maxUpload = 200000;
    m_maxMemUpload = 5000;
@@ -49,11 +54,22 @@ FalhttpOptions::FalhttpOptions():
    
    m_pSessionManager->timeout(30);
    setIndexFile( "index.ftd;index.fal;index.html;index.htm" );
+   setupFileCache();
 }
 
 FalhttpOptions::~FalhttpOptions()
 {
+   delete m_pFileCache;
+}
+
+
+void FalhttpOptions::setupFileCache()
+{
+   delete m_pFileCache;
+   m_pFileCache = 0;
 
+   if( m_nFileCacheSize > 0 && m_nFileCacheMaxFile > 0 )
+      m_pFileCache = new FileCache( m_nFileCacheSize, m_nFileCacheMaxFile );
 }
 
 
@@ -277,6 +293,7 @@ void FalhttpOptions::loadIni( Falcon::LogArea* log, Falcon::ConfigFileService* c
    cfs->getValue( "TempDir", m_sUploadPath );
    cfs->getValue( "Interface", m_sIface );
    cfs->getValue( "PersistentDataDir", m_sAppDataDir );
+   cfs->getValue( "ModuleCache", m_sModuleCache );
 
    if( cfs->getValue( "Port", sPort ) )
    {
@@ -295,6 +312,27 @@ void FalhttpOptions::loadIni( Falcon::LogArea* log, Falcon::ConfigFileService* c
       }
    }
 
+   Falcon::String sStore;
+   if( cfs->getValue( "SharedSessions", sStore ) && sStore.size() != 0 )
+   {
+      // share the sessions with the other servers using the same store.
+      try
+      {
+         Falcon::WOPI::SessionManager* sm = new Falcon::WOPI::ShmSessionManager( sStore );
+         sm->timeout( m_pSessionManager->timeout() );
+         sm->startup();
+         delete m_pSessionManager;
+         m_pSessionManager = sm;
+         log->log( LOGLEVEL_INFO, "Using shared session store " + sStore );
+      }
+      catch( Falcon::Error* e )
+      {
+         log->log( LOGLEVEL_ERROR, "Cannot open shared session store "
+               + sStore + ": " + e->toString() );
+         e->decref();
+      }
+   }
+
    Falcon::String sBoolVal;
    if( cfs->getValue( "AllowDir", sBoolVal ) )
    {
@@ -306,6 +344,31 @@ void FalhttpOptions::loadIni( Falcon::LogArea* log, Falcon::ConfigFileService* c
       setIndexFile( sIndex );
    }
 
+   Falcon::String sCacheVal;
+   bool bCacheChanged = false;
+   if( cfs->getValue( "FileCacheSize", sCacheVal ) )
+   {
+      Falcon::int64 nSize;
+      if( sCacheVal.parseInt( nSize ) )
+      {
+         m_nFileCacheSize = nSize * 1024;
+         bCacheChanged = true;
+      }
+   }
+
+   if( cfs->getValue( "FileCacheMaxFile", sCacheVal ) )
+   {
+      Falcon::int64 nSize;
+      if( sCacheVal.parseInt( nSize ) )
+      {
+         m_nFileCacheMaxFile = nSize * 1024;
+         bCacheChanged = true;
+      }
+   }
+
+   if( bCacheChanged )
+      setupFileCache();
+
    parseMimeTypes( log, cfs );
    parseRedirects( log, cfs );
 }
@@ -31,6 +31,7 @@ s
 
 class FalhttpdClient;
 class FalhttpdRequestHandler;
+class FileCache;
 
 class FalhttpOptions
 {
@@ -70,6 +71,8 @@ public:
    Falcon::String m_sTextEncoding;
    Falcon::String m_sSourceEncoding;
    Falcon::String m_sAppDataDir;
+   /** Directory where the compiled scripts are cached ("" to save them besides the sources). */
+   Falcon::String m_sModuleCache;
 
    std::list<Falcon::String> m_lIndexFiles;
 
@@ -82,10 +85,17 @@ public:
 
    bool m_bAllowDir;
 
+   /** Memory used to cache small static files (0 to disable the cache). */
+   Falcon::int64 m_nFileCacheSize;
+   /** Maximum size of a static file to be cached. */
+   Falcon::int64 m_nFileCacheMaxFile;
+
    Falcon::WOPI::SessionManager* m_pSessionManager;
+   FileCache* m_pFileCache;
 
 private:
    bool checkBool( const Falcon::String& b );
+   void setupFileCache();
    void parseMimeTypes( Falcon::LogArea* log, Falcon::ConfigFileService* cfs );
    void addMimeType( Falcon::LogArea* log, Falcon::ConfigFileService* cfs, const Falcon::String& key );
    void parseRedirects( Falcon::LogArea* log, Falcon::ConfigFileService* cfs );
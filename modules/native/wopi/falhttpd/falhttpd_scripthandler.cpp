@@ -57,6 +57,7 @@ void ScriptHandler::serve( Falcon::WOPI::Request* req )
    // find the file.
    Falcon::ModuleLoader ml( *app->loader() );
    ml.sourceEncoding( m_client->options().m_sSourceEncoding );
+   ml.moduleCacheDir( m_client->options().m_sModuleCache );
    Falcon::Engine::setEncodings( m_client->options().m_sSourceEncoding, m_client->options().m_sTextEncoding );
 
    if( m_client->options().m_loadPath.size() == 0 )
@@ -17,14 +17,14 @@
 
 #include <fastcgi.h>
 //We're not an application program; instead, we're using the FCGI api directly
-#define NO_FCGI_DEFINES
-#include <fcgi_stdio.h>
+#include <fcgiapp.h>
 
 #include <stdio.h>
 
 #include <falcon/engine.h>
 #include <falcon/stdstreams.h>
 #include <falcon/sys.h>
+#include <falcon/mt.h>
 #include <falcon/wopi/wopi_ext.h>
 
 #include <cgi_options.h>
@@ -32,12 +32,105 @@
 #include <cgi_reply.h>
 #include <falcgi_perform.h>
 
+#include "ffalcgi_vmpool.h"
+
+#include <vector>
+
+#ifndef FALCON_SYSTEM_WIN
+#include <signal.h>
+
+// set by SIGHUP to drop the compiled modules kept across requests.
+static volatile sig_atomic_t s_bFlushModules = 0;
+
+static void on_hangup( int )
+{
+   s_bFlushModules = 1;
+}
+#endif
+
 static void report_temp_file_error( const Falcon::String& fileName, void* data )
 {
    Falcon::AutoCString cstr(fileName);
-   printf( "ERROR: Cannot remove temp file %s\r\n", cstr.c_str() );
+   fprintf( stderr, "ERROR: Cannot remove temp file %s\r\n", cstr.c_str() );
 }
 
+// some platforms require accept() serialization.
+static Falcon::Mutex s_acceptMtx;
+
+/** Thread accepting and serving FastCGI requests. */
+class FCGIWorker: public Falcon::Runnable
+{
+public:
+   FCGIWorker( VMPool& pool ):
+      m_pool( pool )
+   {}
+
+   virtual void* run();
+
+private:
+   VMPool& m_pool;
+};
+
+
+void* FCGIWorker::run()
+{
+   FCGX_Request req;
+   if( FCGX_InitRequest( &req, 0, 0 ) != 0 )
+      return 0;
+
+   while( true )
+   {
+      s_acceptMtx.lock();
+      int rc = FCGX_Accept_r( &req );
+      s_acceptMtx.unlock();
+
+      if( rc < 0 )
+         break;
+
+#ifndef FALCON_SYSTEM_WIN
+      if( s_bFlushModules )
+      {
+         s_bFlushModules = 0;
+         Falcon::Engine::flushModuleCache();
+         m_pool.invalidate();
+      }
+#endif
+
+      void *tempFileList = 0;
+      PooledVM* vm = 0;
+      try
+      {
+         vm = m_pool.acquire();
+         tempFileList = vm->serve( &req );
+         m_pool.release( vm );
+      }
+      catch( Falcon::Error* e )
+      {
+         // the script can't be loaded, or the VM broke outside the script;
+         // in the latter case its state is unknown, so it is not reused.
+         if( vm != 0 )
+            m_pool.discard( vm );
+
+         Falcon::AutoCString cError( e->toString() );
+         FCGX_FPrintF( req.out, "Content-Type: text/plain\r\n\r\nFALCON ERROR:\r\n%s\r\n", cError.c_str() );
+         FCGX_FPrintF( req.err, "FALCON ERROR:\r\n%s\r\n", cError.c_str() );
+         e->decref();
+      }
+
+      FCGX_Finish_r( &req );
+
+      // Free the temp files
+      if( tempFileList != 0 )
+      {
+         Falcon::WOPI::Request::removeTempFiles( tempFileList, 0, report_temp_file_error );
+      }
+   }
+
+   FCGX_Free( &req, 1 );
+   return 0;
+}
+
+
 int main( int argc, char* argv[] )
 {
    // we need to re-randomize based on our pid + time,
@@ -46,22 +139,47 @@ int main( int argc, char* argv[] )
 
    // start the engine
    Falcon::Engine::Init();
+   // the process serves many requests; keep the compiled scripts around.
+   Falcon::Engine::cacheModules( true );
+
+#ifndef FALCON_SYSTEM_WIN
+   signal( SIGHUP, on_hangup );
+#endif
 
    CGIOptions cgiopt;
-   if ( cgiopt.init( argc, argv ) )
+   if ( cgiopt.init( argc, argv ) && FCGX_Init() == 0 )
    {
-      while( FCGI_Accept() >= 0 )
-      {
-         void *tempFileList = perform( cgiopt, argc, argv );
+      VMPool pool( cgiopt, cgiopt.m_nVMs );
 
-         // perform complete GC to reset open states (i.e. open file handles).
-         Falcon::memPool->performGC();
-
-         // Free the temp files
-         if( tempFileList != 0 )
+      // this thread is a worker too.
+      std::vector<Falcon::SysThread*> threads;
+      std::vector<FCGIWorker*> workers;
+      for( Falcon::uint32 i = 1; i < cgiopt.m_nThreads; ++i )
+      {
+         FCGIWorker* worker = new FCGIWorker( pool );
+         Falcon::SysThread* th = new Falcon::SysThread( worker );
+         if( ! th->start() )
          {
-            Falcon::WOPI::Request::removeTempFiles( tempFileList, 0, report_temp_file_error );
+            // never run; nothing will dispose of it.
+            th->disengage();
+            delete worker;
+            fprintf( stderr, "ERROR: Cannot start worker thread %d of %d; serving with %d threads\r\n",
+                  (int) i + 1, (int) cgiopt.m_nThreads, (int) i );
+            break;
          }
+
+         threads.push_back( th );
+         workers.push_back( worker );
+      }
+
+      FCGIWorker mainWorker( pool );
+      mainWorker.run();
+
+      for( std::size_t i = 0; i < threads.size(); ++i )
+      {
+         void* result;
+         threads[i]->join( result );
+         delete workers[i];
       }
    }
 
@@ -72,3 +190,5 @@ int main( int argc, char* argv[] )
 
    return 0;
 }
+
+/* end of ffalcgi.cpp */
@@ -21,29 +21,9 @@
 
 #include <errno.h>
 
-#include <fastcgi.h>
-#include <fcgi_stdio.h>
+#include "ffalcgi_stream.h"
 
-class FFCGIStream: public Falcon::Stream
-{
-public:
-   FFCGIStream( FILE* tgt );
-
-   virtual ~FFCGIStream();
-
-   virtual Falcon::int32 write( const void* data, Falcon::int32 size );
-   virtual Falcon::int32 read( void* data, Falcon::int32 size );
-   virtual bool put( Falcon::uint32 chr );
-   virtual bool get( Falcon::uint32& chr );
-   virtual bool close();
-   virtual Falcon::int64 lastError() const;
-   virtual bool flush();
-
-private:
-   FILE* m_target;
-};
-
-FFCGIStream::FFCGIStream( FILE* tgt ):
+FFCGIStream::FFCGIStream( FCGX_Stream* tgt ):
       Stream(t_stream),
       m_target(tgt)
 {
@@ -57,22 +37,29 @@ FFCGIStream::~FFCGIStream()
 
 Falcon::int32 FFCGIStream::write( const void* data, Falcon::int32 size )
 {
-   return fwrite( const_cast<void*>(data), 1, size, m_target );
+   if( m_target == 0 )
+      return -1;
+   return FCGX_PutStr( (const char*) data, size, m_target );
 }
 
 Falcon::int32 FFCGIStream::read( void* data, Falcon::int32 size )
 {
-   return fread( data, 1, size, m_target );
+   if( m_target == 0 )
+      return -1;
+   return FCGX_GetStr( (char*) data, size, m_target );
 }
 
 bool FFCGIStream::put( Falcon::uint32 chr )
 {
-   return fputc( chr, m_target ) >= 0 ;
+   return m_target != 0 && FCGX_PutChar( (int) chr, m_target ) >= 0 ;
 }
 
 bool FFCGIStream::get( Falcon::uint32& chr )
 {
-   int ichr = fgetc( m_target );
+   if( m_target == 0 )
+      return false;
+
+   int ichr = FCGX_GetChar( m_target );
    chr = (Falcon::uint32) ichr;
    return ichr >= 0;
 }
@@ -85,29 +72,32 @@ bool FFCGIStream::close()
 
 Falcon::int64 FFCGIStream::lastError() const
 {
-   return (Falcon::int64) errno;
+   if( m_target == 0 )
+      return (Falcon::int64) errno;
+   return (Falcon::int64) FCGX_GetError( m_target );
 }
 
 
 bool FFCGIStream::flush()
 {
-   return fflush( m_target ) == 0 ;
+   return m_target != 0 && FCGX_FFlush( m_target ) == 0 ;
 }
 
+// The requests are served through the streams of their FastCGI request;
+// these are here only for the code shared with the CGI driver.
 Falcon::Stream* makeOutputStream()
 {
-   Falcon::Stream* test = new  FFCGIStream( stdout );
-   return test;
+   return new FFCGIStream( 0 );
 }
 
 Falcon::Stream* makeInputStream()
 {
-   return new FFCGIStream( stdin );
+   return new FFCGIStream( 0 );
 }
 
 Falcon::Stream* makeErrorStream()
 {
-   return new FFCGIStream( stderr );
+   return new FFCGIStream( 0 );
 }
 
 /* end of falcgi_make_streams.cpp */
@@ -0,0 +1,54 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: ffalcgi_stream.h
+
+   Falcon FastCGI program driver - Streams on FastCGI requests.
+
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 22:48:10 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Falcon FastCGI program driver - Streams on FastCGI requests.
+*/
+
+#ifndef FFALCGI_STREAM_H_
+#define FFALCGI_STREAM_H_
+
+#include <falcon/stream.h>
+
+#include <fcgiapp.h>
+
+/** Stream reading or writing a stream of a FastCGI request.
+   The stream doesn't own the underlying FastCGI stream, which is
+   released when the request is finished; a stream with no target
+   fails all the operations.
+*/
+class FFCGIStream: public Falcon::Stream
+{
+public:
+   FFCGIStream( FCGX_Stream* tgt );
+
+   virtual ~FFCGIStream();
+
+   virtual Falcon::int32 write( const void* data, Falcon::int32 size );
+   virtual Falcon::int32 read( void* data, Falcon::int32 size );
+   virtual bool put( Falcon::uint32 chr );
+   virtual bool get( Falcon::uint32& chr );
+   virtual bool close();
+   virtual Falcon::int64 lastError() const;
+   virtual bool flush();
+
+private:
+   FCGX_Stream* m_target;
+};
+
+#endif /* FFALCGI_STREAM_H_ */
+
+/* end of ffalcgi_stream.h */
@@ -0,0 +1,346 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: ffalcgi_vmpool.cpp
+
+   Falcon FastCGI program driver - Pool of ready virtual machines.
+
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 22:51:36 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Falcon FastCGI program driver - Pool of ready virtual machines.
+*/
+
+#include "ffalcgi_vmpool.h"
+#include "ffalcgi_stream.h"
+
+#include <falcon/sys.h>
+#include <falcon/wopi/wopi_ext.h>
+#include <falcon/wopi/wopi.h>
+#include <falcon/wopi/file_sm.h>
+#include <falcon/wopi/replystream.h>
+
+#include <cgi_options.h>
+#include <cgi_request.h>
+#include <cgi_reply.h>
+#include <falcgi_perform.h>
+
+//================================================================
+// A VM in the pool
+//
+
+PooledVM::PooledVM( CGIOptions& options, const Falcon::ModuleLoader& loader,
+         Falcon::Module* core, Falcon::Module* wopi, Falcon::uint32 generation ):
+   m_options( options ),
+   m_loader( loader ),
+   m_vm( new Falcon::VMachine ),
+   m_rt( 0 ),
+   m_main( 0 ),
+   m_liveMain( 0 ),
+   m_globals( 0 ),
+   m_iRequest( 0 ),
+   m_iReply( 0 ),
+   m_iUploaded( 0 ),
+   m_requestClass( 0 ),
+   m_replyClass( 0 ),
+   m_generation( generation )
+{
+   // the copy doesn't carry the encoding.
+   m_loader.sourceEncoding( loader.sourceEncoding() );
+
+   try
+   {
+      m_vm->link( core );
+      m_vm->link( wopi );
+
+      m_iRequest = m_vm->findGlobalItem( "Request" );
+      fassert( m_iRequest != 0 );
+      m_iReply = m_vm->findGlobalItem( "Reply" );
+      fassert( m_iReply != 0 );
+      m_iUploaded = m_vm->findGlobalItem( "Uploaded" );
+      fassert( m_iUploaded != 0 );
+      Falcon::Item* i_wopi = m_vm->findGlobalItem( "Wopi" );
+      fassert( i_wopi != 0 );
+
+      m_requestClass = m_iRequest->asObject()->generator();
+      m_replyClass = m_iReply->asObject()->generator();
+
+      m_vm->appSearchPath( m_loader.getSearchPath() );
+
+      m_main = m_loader.loadName( m_options.m_sMainScript );
+      Falcon::dyncast<Falcon::WOPI::CoreWopi*>( i_wopi->asObject() )->configFromModule( m_main );
+
+      // the modules loaded by the script are initialized here, once.
+      m_rt = new Falcon::Runtime( &m_loader );
+      m_rt->addModule( m_main );
+      m_vm->link( m_rt );
+      m_liveMain = m_vm->mainModule();
+      fassert( m_liveMain != 0 );
+
+      // save the globals of the script as they are before its first run.
+      Falcon::ItemArray& globs = m_liveMain->globals();
+      Falcon::CoreArray* saved = new Falcon::CoreArray( globs.length() );
+      for( Falcon::uint32 i = 0; i < globs.length(); ++i )
+      {
+         saved->append( globs[i] );
+      }
+      m_globals = new Falcon::GarbageLock( Falcon::Item( saved ) );
+   }
+   catch( Falcon::Error* )
+   {
+      m_vm->finalize();
+      delete m_rt;
+      if( m_main != 0 )
+         m_main->decref();
+      throw;
+   }
+}
+
+
+PooledVM::~PooledVM()
+{
+   delete m_globals;
+   m_vm->finalize();
+   delete m_rt;
+   m_main->decref();
+}
+
+
+void PooledVM::restoreGlobals()
+{
+   const Falcon::ItemArray& saved = m_globals->item().asArray()->items();
+   Falcon::ItemArray& globs = m_liveMain->globals();
+   for( Falcon::uint32 i = 0; i < saved.length(); ++i )
+   {
+      globs[i] = saved[i];
+   }
+}
+
+
+void* PooledVM::serve( FCGX_Request* req )
+{
+   double nStartedAt = Falcon::Sys::_seconds();
+
+   restoreGlobals();
+
+   // each request has its own Request and Reply.
+   CGIRequest* request = Falcon::dyncast<CGIRequest*>( m_requestClass->createInstance() );
+   CGIReply* reply = Falcon::dyncast<CGIReply*>( m_replyClass->createInstance() );
+   m_iRequest->setObject( request );
+   m_iReply->setObject( reply );
+
+   Falcon::Stream* input = new FFCGIStream( req->in );
+   reply->init( new FFCGIStream( req->out ) );
+
+   m_vm->stdOut( new Falcon::WOPI::ReplyStream( reply ) );
+   m_vm->stdErr( new Falcon::WOPI::ReplyStream( reply ) );
+   m_vm->stdIn( input );
+
+   Falcon::uint32 nSessionToken = 0;
+
+   try
+   {
+      request->init( input, m_iUploaded->asClass(), reply, m_options.m_smgr, req->envp );
+
+      Falcon::WOPI::Request* base = request->base();
+      base->startedAt( nStartedAt );
+      base->setMaxMemUpload( m_options.m_maxMemUpload );
+      if( m_options.m_sUploadPath != "" )
+         base->setUploadPath( m_options.m_sUploadPath );
+      nSessionToken = base->sessionToken();
+
+      request->configFromModule( m_main );
+
+      m_vm->launch();
+   }
+   catch( Falcon::Error* e )
+   {
+      Falcon::String sError = "FALCON ERROR:\r\n" + e->toString() + "\r\n";
+
+      // Write to the log ...
+      Falcon::AutoCString cError( sError );
+      FCGX_PutS( cError.c_str(), req->err );
+
+      // ...and to the document
+      reply->commit();
+      m_vm->stdOut()->writeString( sError );
+
+      e->decref();
+   }
+
+   m_vm->stdOut()->close();
+
+   if( m_options.m_smgr != 0 && nSessionToken != 0 )
+   {
+      m_options.m_smgr->releaseSessions( nSessionToken );
+   }
+
+   void* tempFiles = request->base() != 0 ? request->base()->getTempFiles() : 0;
+
+   // the streams refer to the request, that is about to be finished.
+   m_vm->stdOut( 0 );
+   m_vm->stdErr( 0 );
+   m_vm->stdIn( 0 );
+   reply->release();
+
+   // reset open states (i.e. open file handles).
+   m_vm->performGC();
+
+   return tempFiles;
+}
+
+
+//================================================================
+// The pool
+//
+
+VMPool::VMPool( CGIOptions& options, Falcon::uint32 size ):
+   m_options( options ),
+   m_loader( "." ),
+   m_evFree( false, false ),
+   m_size( size == 0 ? 1 : size ),
+   m_created( 0 ),
+   m_generation( 0 )
+{
+   configure_loader( m_options, m_loader );
+
+   m_core = Falcon::core_module_init();
+   m_wopi = Falcon::WOPI::wopi_module_init( CGIRequest::factory, CGIReply::factory );
+}
+
+
+VMPool::~VMPool()
+{
+   for( std::size_t i = 0; i < m_free.size(); ++i )
+   {
+      delete m_free[i];
+   }
+
+   m_wopi->decref();
+   m_core->decref();
+}
+
+
+PooledVM* VMPool::acquire()
+{
+   while( true )
+   {
+      m_mtx.lock();
+      if( ! m_free.empty() )
+      {
+         PooledVM* vm = m_free.back();
+         m_free.pop_back();
+         m_mtx.unlock();
+         return vm;
+      }
+
+      if( m_created < m_size )
+      {
+         ++m_created;
+         m_mtx.unlock();
+         return create();
+      }
+
+      // wait for a release; it can't happen before the reset, as we hold the lock.
+      m_evFree.reset();
+      m_mtx.unlock();
+      m_evFree.wait();
+   }
+}
+
+
+PooledVM* VMPool::create()
+{
+   m_mtx.lock();
+   Falcon::uint32 generation = m_generation;
+   m_mtx.unlock();
+
+   PooledVM* vm;
+   try
+   {
+      vm = new PooledVM( m_options, m_loader, m_core, m_wopi, generation );
+   }
+   catch( Falcon::Error* )
+   {
+      // give the slot to another thread.
+      m_mtx.lock();
+      --m_created;
+      m_evFree.set();
+      m_mtx.unlock();
+      throw;
+   }
+
+   // the sessions are configured by the first script loaded.
+   m_mtx.lock();
+   if( m_options.m_smgr == 0 )
+   {
+      Falcon::WOPI::SessionManager* smgr = new Falcon::WOPI::FileSessionManager( "" );
+      smgr->configFromModule( vm->main() );
+      if( smgr->timeout() == 0 )
+         smgr->timeout( 600 );
+      smgr->startup();
+      m_options.m_smgr = smgr;
+   }
+   m_mtx.unlock();
+
+   return vm;
+}
+
+
+void VMPool::release( PooledVM* vm )
+{
+   PooledVM* stale = 0;
+
+   m_mtx.lock();
+   if( vm->generation() == m_generation )
+   {
+      m_free.push_back( vm );
+   }
+   else
+   {
+      stale = vm;
+      --m_created;
+   }
+   m_evFree.set();
+   m_mtx.unlock();
+
+   delete stale;
+}
+
+
+void VMPool::discard( PooledVM* vm )
+{
+   m_mtx.lock();
+   --m_created;
+   m_evFree.set();
+   m_mtx.unlock();
+
+   delete vm;
+}
+
+
+void VMPool::invalidate()
+{
+   std::vector<PooledVM*> stale;
+
+   m_mtx.lock();
+   ++m_generation;
+   stale.swap( m_free );
+   m_created -= stale.size();
+   m_evFree.set();
+   m_mtx.unlock();
+
+   for( std::size_t i = 0; i < stale.size(); ++i )
+   {
+      delete stale[i];
+   }
+}
+
+/* end of ffalcgi_vmpool.cpp */
@@ -0,0 +1,127 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: ffalcgi_vmpool.h
+
+   Falcon FastCGI program driver - Pool of ready virtual machines.
+
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 22:51:36 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Falcon FastCGI program driver - Pool of ready virtual machines.
+*/
+
+#ifndef FFALCGI_VMPOOL_H_
+#define FFALCGI_VMPOOL_H_
+
+#include <falcon/engine.h>
+#include <falcon/mt.h>
+#include <falcon/garbagelock.h>
+
+#include <fcgiapp.h>
+
+#include <vector>
+
+class CGIOptions;
+
+/** A virtual machine ready to run the main script.
+
+   The VM is created with the core and WOPI modules and the main script
+   linked; the modules loaded by the script are initialized once, when the
+   VM is created. Each request gets new Request and Reply objects, and
+   the global variables of the main script are restored to the values
+   they had after the link, so that the script always starts clean.
+*/
+class PooledVM
+{
+public:
+   /** Creates the VM and links the main script.
+      \throw Falcon::Error if the main script cannot be loaded.
+   */
+   PooledVM( CGIOptions& options, const Falcon::ModuleLoader& loader,
+         Falcon::Module* core, Falcon::Module* wopi, Falcon::uint32 generation );
+   ~PooledVM();
+
+   /** Runs the main script on a request.
+      \return The temporary files created by the request, to be removed
+         through Falcon::WOPI::Request::removeTempFiles().
+   */
+   void* serve( FCGX_Request* req );
+
+   const Falcon::Module* main() const { return m_main; }
+   Falcon::uint32 generation() const { return m_generation; }
+
+private:
+   void restoreGlobals();
+
+   CGIOptions& m_options;
+   Falcon::ModuleLoader m_loader;
+   Falcon::VMachine* m_vm;
+   Falcon::Runtime* m_rt;
+   Falcon::Module* m_main;
+   Falcon::LiveModule* m_liveMain;
+   Falcon::GarbageLock* m_globals;
+
+   Falcon::Item* m_iRequest;
+   Falcon::Item* m_iReply;
+   Falcon::Item* m_iUploaded;
+
+   const Falcon::CoreClass* m_requestClass;
+   const Falcon::CoreClass* m_replyClass;
+   Falcon::uint32 m_generation;
+};
+
+
+/** Pool of virtual machines serving the main script.
+
+   The VMs are created on demand, up to the pool size; the threads
+   requiring a VM when all of them are busy wait for one to be released.
+   After invalidate(), the script is loaded again and the VMs in use are
+   discarded as they are released.
+*/
+class VMPool
+{
+public:
+   VMPool( CGIOptions& options, Falcon::uint32 size );
+   ~VMPool();
+
+   /** Gets a VM, waiting for one to be free if necessary.
+      \throw Falcon::Error if the main script cannot be loaded.
+   */
+   PooledVM* acquire();
+
+   /** Returns a VM to the pool after a request. */
+   void release( PooledVM* vm );
+   /** Destroys a VM that failed while serving a request, freeing its slot. */
+   void discard( PooledVM* vm );
+
+   /** Discards all the VMs, so that the main script is loaded again. */
+   void invalidate();
+
+private:
+   PooledVM* create();
+
+   CGIOptions& m_options;
+   Falcon::ModuleLoader m_loader;
+   Falcon::Module* m_core;
+   Falcon::Module* m_wopi;
+
+   Falcon::Mutex m_mtx;
+   // manual reset; set when a VM is released.
+   Falcon::Event m_evFree;
+   std::vector<PooledVM*> m_free;
+   Falcon::uint32 m_size;
+   Falcon::uint32 m_created;
+   Falcon::uint32 m_generation;
+};
+
+#endif /* FFALCGI_VMPOOL_H_ */
+
+/* end of ffalcgi_vmpool.h */
@@ -182,11 +182,36 @@ public:
 
 private:
 
+   /** Search of a fixed boundary in raw data.
+      Uses the Boyer-Moore-Horspool algorithm: the skip table is built
+      once for each boundary, and then used for all the searches in the
+      incoming data.
+   */
+   class BoundSearch
+   {
+   public:
+      BoundSearch( const String& boundary );
+      ~BoundSearch();
+
+      //! Size of the boundary, in bytes.
+      uint32 size() const { return m_nSize; }
+
+      //! Returns the position of the boundary in the data, or String::npos.
+      uint32 find( const byte* data, uint32 size ) const;
+
+   private:
+      byte* m_bound;
+      uint32 m_nSize;
+      uint32 m_skip[256];
+
+      BoundSearch( const BoundSearch& );
+   };
+
    class PartHandlerBuffer
    {
    public:
       enum e_constants {
-         buffer_size = 8192
+         buffer_size = 65536
       };
 
       PartHandlerBuffer( int64* pToMax );
@@ -209,8 +234,11 @@ private:
          flush(out);
       }
 
-      //! Searches this string in the buffer.
-      uint32 find( const String& str );
+      //! Searches a boundary in the buffer.
+      uint32 find( const BoundSearch& bound );
+
+      //! Searches the end of a header line (CRLF) in the buffer.
+      uint32 findLine();
 
       //! refills buffer
       bool fill( Stream* input );
@@ -230,11 +258,17 @@ private:
    PartHandlerBuffer* m_pBuffer;
    bool m_bOwnBuffer;
 
-   void passSetting( PartHandler* child );
+   // Search of the boundary closing this part, prepared by the parent.
+   const BoundSearch* m_pEnclosingBound;
+
+   void passSetting( PartHandler* child, const BoundSearch* bound );
 
 
    //! Searches for the boundary and store the data in m_stream
-   bool scanForBound( const String& boundary, Stream* input, bool& isLast );
+   bool scanForBound( const BoundSearch& bound, Stream* input, bool& isLast );
+
+   //! Searches for the boundary of the enclosing multipart element.
+   bool scanForEnclosingBound( Stream* input, bool& isLast );
 
 
    bool parseHeaderField( const String& line );
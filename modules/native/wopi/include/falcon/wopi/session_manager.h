@@ -19,6 +19,12 @@
 
 #define FALCON_WOPI_SESSION_TO_ATTRIB "wopi_sessionTO"
 
+/** Number of independently locked shards of the session map (power of 2). */
+#define FALCON_WOPI_SESSION_SHARDS 16
+
+/** Number of one-second slots in the session expiration wheel. */
+#define FALCON_WOPI_SESSION_WHEEL_SLOTS 64
+
 #include <falcon/engine.h>
 #include <map>
 #include <list>
@@ -115,37 +121,43 @@ public:
    bool isInvalid() const { return m_bInvalid; }
    void setInvalid() { m_bInvalid = true; }
 
-   /** The weak reference to this class */
+   /** Marks a session closed while another request holds it.
+      The session is not in the session map anymore, and it's disposed
+      by the holder when released.
+
+      \note This should be called in the session lock context.
+   */
+   void setClosed() { m_bClosed = true; }
+   bool isClosed() const { return m_bClosed; }
+
+   /** The weak reference to this class.
+
+      Weak references are created, dropped and invalidated in the lock
+      context of the session manager shard holding the session.
+   */
    class WeakRef
    {
    public:
       WeakRef( SessionData* r ):
-         m_ref(r),
-         m_bDropped(false)
+         m_ref(r)
       {
       }
 
       void onDestroy()
       {
-         if( m_bDropped )
-            delete this;
-         else
-            m_ref = 0;
+         m_ref = 0;
       }
 
       SessionData* get() const { return m_ref; }
-   
-      void dropped()
-      {
-         if ( m_ref == 0 )
-            delete this;
-         else
-            m_bDropped = true;
-      }
+
+      /** Releases this reference.
+         The reference is removed from the referenced session, if still alive,
+         and then destroyed.
+      */
+      void dropped();
 
    private:
       SessionData* m_ref;
-      bool m_bDropped;
    };
 
    /** Gets a weak reference to this class.
@@ -170,15 +182,64 @@ private:
    String m_errorDesc;
    String m_sID;
    bool m_bInvalid;
+   bool m_bClosed;
 
    mutable std::list<WeakRef*> m_reflist;
 };
 
 
-/** Repository for session variables. */
+/** Repository for session variables.
+
+   Sessions are distributed across FALCON_WOPI_SESSION_SHARDS shards by the
+   hash of their ID; each shard has its own lock, so that concurrent requests
+   working on different sessions don't serialize on the manager.
+
+   When a timeout is set, released sessions are scheduled on a per-shard
+   expiration wheel, which is swept once a second by a background thread.
+   The thread is started the first time a session is scheduled.
+*/
 class SessionManager
 {
 public:
+   /** Activity counters of a session map shard. */
+   class ShardStats
+   {
+   public:
+      /** Sessions currently in the shard. */
+      uint32 m_sessions;
+      /** Existing sessions found by getSession. */
+      uint32 m_hits;
+      /** Sessions not found by getSession, and so created and resumed. */
+      uint32 m_misses;
+      /** Sessions found by getSession, but assigned to another request. */
+      uint32 m_busy;
+      /** Sessions created by startSession. */
+      uint32 m_created;
+      /** Sessions removed by the expiration wheel. */
+      uint32 m_expired;
+      /** Sessions explicitly closed. */
+      uint32 m_closed;
+      /** Entries waiting on the expiration wheel. */
+      uint32 m_scheduled;
+      /** Times the shard lock was found busy. */
+      uint32 m_contended;
+
+      ShardStats():
+         m_sessions(0),
+         m_hits(0),
+         m_misses(0),
+         m_busy(0),
+         m_created(0),
+         m_expired(0),
+         m_closed(0),
+         m_scheduled(0),
+         m_contended(0)
+      {}
+
+      /** Adds the counters of another shard to these. */
+      void add( const ShardStats& other );
+   };
+
    SessionManager();
    virtual ~SessionManager();
 
@@ -225,22 +286,33 @@ public:
        All the released sessions are first touched, then stored and finally
        released.
 
-       \note This function must be called in the same thread of expireOldSessions
-       to avoid concurrent expiration & storage (there can't be any mutex protection
-       against this. A refcount protection may prevent crashes, but may cause
-       dirty files and memory leaks to be left on the ground).
+       Released sessions are scheduled for expiration if a timeout is set;
+       assigned sessions are never expired.
    */
    bool releaseSessions( uint32 token );
 
    /** Creates an unique session token. */
    uint32 getSessionToken();
 
-   /** Closes a session explicitly, freeing its data. */
+   /** Closes a session explicitly, freeing its data.
+
+      A session assigned to another token is removed from the session map
+      at once, but it's disposed only when that token releases it.
+   */
    bool closeSession( const String& sSID, uint32 token );
 
    void timeout( uint32 to ) { m_nSessionTimeout = to; }
    uint32 timeout() const { return m_nSessionTimeout; }
 
+   /** Number of shards of the session map. */
+   uint32 shardCount() const { return FALCON_WOPI_SESSION_SHARDS; }
+
+   /** Takes a snapshot of the activity counters of a shard.
+      \param id The shard number, from 0 to shardCount()-1.
+      \param stats Where to store the counters.
+   */
+   void shardStats( uint32 id, ShardStats& stats ) const;
+
    /** Prepare first execution.
        To be called after a complete configuration.
     */
@@ -261,33 +333,100 @@ protected:
    SessionData* createUniqueId( String& sSID );
 
 private:
-
-   /**
-      Delete sessions that are expired in time.
-      
-      \note This function must be called in the same thread of releaseSessions()
-       to avoid concurrent expiration & storage (there can't be any mutex protection
-       against this. A refcount protection may prevent crashes, but may cause
-       dirty files and memory leaks to be left on the ground).
-   */
- 
-   void expireOldSessions();
-
    typedef std::map<String, SessionData*> SessionMap;
 
    typedef std::list<SessionData::WeakRef*> SessionList;
    typedef std::map<uint32, SessionList> SessionUserMap;
-   typedef std::multimap<double, SessionData::WeakRef*> ExpirationMap;
 
-   //Rightful owner of sessions
-   SessionMap m_smap;
+   /** A session waiting for expiration on the wheel. */
+   class ExpiryEntry
+   {
+   public:
+      numeric m_expire;
+      SessionData::WeakRef* m_ref;
+
+      ExpiryEntry( numeric expire, SessionData::WeakRef* ref ):
+         m_expire( expire ),
+         m_ref( ref )
+      {}
+   };
+
+   typedef std::list<ExpiryEntry> ExpiryBucket;
+
+   /** A part of the session map with its own lock.
+
+      The users map of a shard records the sessions of the shard assigned
+      to each token, so that all the weak references to a session are
+      handled in the lock context of its shard.
+   */
+   class Shard
+   {
+   public:
+      //Rightful owner of sessions
+      SessionMap m_smap;
+
+      // Owning weakrefs
+      SessionUserMap m_susers;
+      ExpiryBucket m_wheel[FALCON_WOPI_SESSION_WHEEL_SLOTS];
+
+      mutable ShardStats m_stats;
+      mutable Falcon::Mutex m_mtx;
+
+      void lock() const
+      {
+         if ( ! m_mtx.trylock() )
+         {
+            m_mtx.lock();
+            m_stats.m_contended++;
+         }
+      }
+
+      void unlock() const { m_mtx.unlock(); }
+   };
+
+   /** Background thread sweeping the expiration wheel. */
+   class Expirer: public Runnable
+   {
+   public:
+      Expirer( SessionManager* owner );
+      virtual ~Expirer();
+      virtual void* run();
+
+      /** Asks the thread to terminate and waits for it. */
+      void stop();
+
+   private:
+      SessionManager* m_owner;
+      SysThread* m_thread;
+      Event m_wakeup;
+      Mutex m_mtx;
+      bool m_bTerminate;
+   };
+
+   Shard& shardOf( const String& sSID );
+
+   /** Puts a released session on the expiration wheel.
+      \note To be called in the lock context of the shard.
+   */
+   void schedule( Shard& shard, SessionData* sd );
+
+   /** Starts the expiration thread, if not already running. */
+   void startExpirer();
+
+   /**
+      Delete the sessions expired in the wheel slots between two ticks.
+
+      Ticks are the integer part of Falcon::Sys::_seconds(); the slots after
+      the one of fromTick up to the one of toTick are swept.
+   */
+   void expireSessions( int64 fromTick, int64 toTick );
+
+   Shard m_shards[FALCON_WOPI_SESSION_SHARDS];
 
-   // Owning weakrefs
-   SessionUserMap m_susers;
-   ExpirationMap m_expmap;
-   mutable Falcon::Mutex m_mtx;
+   Expirer* m_expirer;
+   Falcon::Mutex m_mtxExpirer;
 
-   uint32 m_nLastToken;
+   volatile int32 m_nLastToken;
    uint32 m_nSessionTimeout;
 };
 
@@ -137,6 +137,33 @@ public:
     */
    uint32 lastVersion() const { return m_version; }
 
+   /** Maps a fixed size area of the shared memory directly in the process.
+
+       This is an alternative to read() and commit(), for data structures that
+       must be accessed in place by all the processes; the two access methods
+       cannot be used on the same memory.
+
+       If the memory is smaller than the required size, it is extended, and the
+       new part is filled with zeroes. The area stays mapped until this object
+       is destroyed; mapping it again returns the same area.
+
+       The area is not protected against concurrent access: use lock() and
+       unlock() to serialize the updates across processes.
+
+       \param size The size of the area, in bytes.
+       \return The start of the area.
+       \throws Falcon::IoError if the memory cannot be extended or mapped.
+   */
+   byte* mapArea( uint32 size );
+
+   /** Locks the shared memory against the other processes using it.
+       \throws Falcon::IoError on system error.
+   */
+   void lock();
+
+   /** Unlocks the shared memory locked with lock(). */
+   void unlock();
+
 
 private:
    // Private D-pointer
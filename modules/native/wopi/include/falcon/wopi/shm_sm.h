@@ -0,0 +1,177 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: shm_sm.h
+
+   Falcon Web Oriented Programming Interface.
+
+   Shared memory based session manager.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 21:40:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Shared memory based session manager.
+*/
+
+#ifndef _SHM_SESSION_MANAGER_H
+#define _SHM_SESSION_MANAGER_H
+
+#include <falcon/wopi/session_manager.h>
+
+/** Default number of sessions that the shared store can hold. */
+#define FALCON_WOPI_SHM_SLOTS       4096
+
+/** Default number of payload blocks in the shared store. */
+#define FALCON_WOPI_SHM_BLOCKS      16384
+
+/** Default size of a payload block, in bytes. */
+#define FALCON_WOPI_SHM_BLOCK_SIZE  256
+
+/** Maximum size of a session ID stored in the shared store, in UTF-8 bytes. */
+#define FALCON_WOPI_SHM_SID_SIZE    64
+
+namespace Falcon {
+
+class SharedMem;
+class StringStream;
+
+namespace WOPI {
+
+class ShmSessionManager;
+
+/** Session data stored in a shared memory session store.
+*/
+class ShmSessionData: public SessionData
+{
+public:
+   ShmSessionData( const String& SID, ShmSessionManager* owner );
+   virtual ~ShmSessionData();
+
+   virtual bool resume();
+   virtual bool store();
+
+   /** Removes the session from the store.
+      The stored session is removed only if it wasn't stored again by
+      another process after it was resumed or stored by this one.
+   */
+   virtual bool dispose();
+
+private:
+   ShmSessionManager* m_owner;
+
+   // version of the stored data this session is aligned with (0 if none).
+   uint32 m_version;
+};
+
+
+/** Session manager sharing the sessions across processes.
+
+   The sessions are serialized in a shared memory area, so that all the
+   processes using a store with the same name can resume the sessions
+   stored by the others, without going through the filesystem.
+
+   The area is organized as a fixed size open addressing hash table of
+   session slots, indexed by the hash of the session ID, and a slab of
+   fixed size blocks holding the serialized session data as a linked
+   chain. Updates are serialized across processes by the shared memory
+   lock; each slot has also a sequence counter, odd while the slot is
+   being updated, that allows reads to proceed without locking and to
+   retry if an update was performed in the meanwhile.
+
+   The processes sharing a store must use the same geometry (slots,
+   blocks and block size). Sessions not refreshed within the timeout are
+   purged at startup and when the store runs out of space.
+*/
+class ShmSessionManager: public SessionManager
+{
+public:
+   /** Creates or opens a shared session store.
+      \param name The name of the store shared by the processes.
+      \param slots Maximum number of sessions in the store.
+      \param blocks Number of blocks available for the session data.
+      \param blockSize Size of each data block.
+      \throws IoError if the shared memory cannot be created, or if it
+         exists with a different geometry.
+   */
+   ShmSessionManager( const String& name,
+         uint32 slots = FALCON_WOPI_SHM_SLOTS,
+         uint32 blocks = FALCON_WOPI_SHM_BLOCKS,
+         uint32 blockSize = FALCON_WOPI_SHM_BLOCK_SIZE );
+   virtual ~ShmSessionManager();
+
+   virtual void startup();
+
+   /** Reads the serialized data of a session.
+      \param sSID The session ID.
+      \param target The stream receiving the data.
+      \param version Receives the version of the data.
+      \return false if the session is not in the store.
+   */
+   bool readSession( const String& sSID, StringStream& target, uint32& version );
+
+   /** Stores the serialized data of a session.
+      \param sSID The session ID.
+      \param data The serialized data.
+      \param size The size of the data.
+      \param version Receives the new version of the data.
+      \return false if the session can't fit in the store.
+   */
+   bool writeSession( const String& sSID, const byte* data, uint32 size, uint32& version );
+
+   /** Removes a session from the store.
+      \param sSID The session ID.
+      \param version The version to be removed; if the stored session has
+         another version, it is left untouched.
+      \return true if the session was removed.
+   */
+   bool removeSession( const String& sSID, uint32 version );
+
+   /** Removes the sessions not stored since the timeout.
+      \return Count of removed sessions.
+   */
+   uint32 purgeExpired();
+
+protected:
+   virtual SessionData* createSession( const String& sSID );
+
+private:
+   SharedMem* m_shm;
+   byte* m_area;
+   uint32 m_slots;
+   uint32 m_blocks;
+   uint32 m_blockSize;
+
+   class Slot;
+   class Header;
+
+   Header* header() const;
+   Slot* slotAt( uint32 pos ) const;
+   byte* blockAt( uint32 id ) const;
+
+   /** Reads a session without locking the store.
+      \return 1 if found, 0 if not found, -1 if the read must be retried.
+   */
+   int32 tryRead( const char* sid, uint32 sidSize, uint32 hash, StringStream& target, uint32& version ) const;
+
+   /** Finds the slot of a session, or the first usable slot for it.
+      \note To be called with the store locked.
+   */
+   int32 locate( const char* sid, uint32 sidSize, uint32 hash, int32& freePos ) const;
+   bool copyData( const Slot* slot, StringStream& target ) const;
+   void freeData( Slot* slot );
+   void clearSlot( uint32 pos );
+   uint32 purgeLocked( int64 now );
+};
+
+}
+}
+
+#endif
+
+/* end of shm_sm.h */
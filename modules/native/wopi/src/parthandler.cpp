@@ -170,6 +170,7 @@ void HeaderValue::setRawValue( const String& v )
 PartHandler::PartHandler():
    m_pBuffer( 0 ),
    m_bOwnBuffer( false ),
+   m_pEnclosingBound( 0 ),
 
    m_nPartSize(-1),
    // Initially, think we're the main part.
@@ -191,6 +192,7 @@ PartHandler::PartHandler():
 PartHandler::PartHandler( const String& sBound ):
    m_pBuffer( 0 ),
    m_bOwnBuffer( false ),
+   m_pEnclosingBound( 0 ),
 
    m_sEnclosingBoundary( sBound ),
    m_nPartSize(-1),
@@ -356,13 +358,13 @@ bool PartHandler::parseBody( Stream* input, bool& isLast )
       // are we part of a bigger multipart element?
       if ( m_sEnclosingBoundary.size() != 0 )
       {
-         return scanForBound( "\r\n--"+m_sEnclosingBoundary, input, isLast );
+         return scanForEnclosingBound( input, isLast );
       }
    }
    // are we part of a bigger multipart element?
    else if ( m_sEnclosingBoundary.size() != 0 )
    {
-      return scanForBound( "\r\n--"+m_sEnclosingBoundary, input, isLast );
+      return scanForEnclosingBound( input, isLast );
    }
    else
    {
@@ -398,7 +400,8 @@ bool PartHandler::parsePrologue( Stream* input )
 
    // When processed through web servers, the prologue is removed.
    // shouldn't be the last, or we have no multipart
-   if (! scanForBound( "--"+m_sBoundary, input, bIsLast ) || bIsLast )
+   BoundSearch bound( "--"+m_sBoundary );
+   if (! scanForBound( bound, input, bIsLast ) || bIsLast )
    {
       m_sError = "Can't find the initial boundary; " + m_sError;
       return false;
@@ -409,9 +412,12 @@ bool PartHandler::parsePrologue( Stream* input )
 
 bool PartHandler::parseMultipartBody( Stream* input )
 {
+   // all the parts are closed by the same boundary.
+   BoundSearch bound( "\r\n--"+m_sBoundary );
+
    PartHandler* child = new PartHandler( m_sBoundary );
    m_pSubPart = child;
-   passSetting( child );
+   passSetting( child, &bound );
 
    bool bResult;
    bool bIsLast;
@@ -420,7 +426,7 @@ bool PartHandler::parseMultipartBody( Stream* input )
    {
       child->m_pNextPart = new PartHandler( m_sBoundary );
       child = child->m_pNextPart;
-      passSetting( child );
+      passSetting( child, &bound );
    }
 
    if( ! bResult )
@@ -430,16 +436,26 @@ bool PartHandler::parseMultipartBody( Stream* input )
 }
 
 
+bool PartHandler::scanForEnclosingBound( Stream* input, bool& isLast )
+{
+   if( m_pEnclosingBound != 0 )
+      return scanForBound( *m_pEnclosingBound, input, isLast );
+
+   BoundSearch bound( "\r\n--"+m_sEnclosingBoundary );
+   return scanForBound( bound, input, isLast );
+}
+
+
 
-bool PartHandler::scanForBound( const String& boundary, Stream* input, bool& isLast )
+bool PartHandler::scanForBound( const BoundSearch& bound, Stream* input, bool& isLast )
 {
-   TRACE( "ScanForBound... %s", boundary.getRawStorage() );
+   TRACE( "ScanForBound... %d", bound.size() );
    
    // the boundary is valid only if followed by 2 characters, either \r\n or --
-   uint32 boundSize = boundary.size()+2;
+   uint32 boundSize = bound.size()+2;
    
    m_pBuffer->fill( input );
-   uint32 nBoundPos = m_pBuffer->find( boundary );
+   uint32 nBoundPos = m_pBuffer->find( bound );
 
    while( nBoundPos == String::npos )
    {
@@ -467,13 +483,13 @@ bool PartHandler::scanForBound( const String& boundary, Stream* input, bool& isL
       // get new data in.
       m_pBuffer->fill( input );
       // find again
-      nBoundPos = m_pBuffer->find( boundary );
+      nBoundPos = m_pBuffer->find( bound );
    }
 
    // We found a match. Is this the last?
    m_pBuffer->m_nBufPos = nBoundPos;
 
-   if( ! m_pBuffer->hasMore( boundary.size() + 2, input, m_stream ) )
+   if( ! m_pBuffer->hasMore( bound.size() + 2, input, m_stream ) )
    {
       m_sError = "Malformed part (missing ending)";
       return false;
@@ -482,15 +498,15 @@ bool PartHandler::scanForBound( const String& boundary, Stream* input, bool& isL
    m_pBuffer->flush( m_stream );
 
    String sRealBound;
-   m_pBuffer->grabMore( sRealBound, boundary.size() + 2 );
+   m_pBuffer->grabMore( sRealBound, bound.size() + 2 );
 
 
    if( sRealBound.endsWith( "--" ) )
    {
       // was the last part -- but is it the flux last element?
-      if( m_pBuffer->hasMore( boundary.size() + 4, input, m_stream ) )
+      if( m_pBuffer->hasMore( bound.size() + 4, input, m_stream ) )
       {
-         m_pBuffer->grabMore( sRealBound, boundary.size() + 4 );
+         m_pBuffer->grabMore( sRealBound, bound.size() + 4 );
 
          if( ! sRealBound.endsWith( "\r\n" ) )
          {
@@ -498,7 +514,7 @@ bool PartHandler::scanForBound( const String& boundary, Stream* input, bool& isL
             return false;
          }
 
-         m_pBuffer->m_nBufPos += boundary.size() + 4;
+         m_pBuffer->m_nBufPos += bound.size() + 4;
       }
       isLast = true;
    }
@@ -510,7 +526,7 @@ bool PartHandler::scanForBound( const String& boundary, Stream* input, bool& isL
          return false;
       }
 
-      m_pBuffer->m_nBufPos += boundary.size() + 2;
+      m_pBuffer->m_nBufPos += bound.size() + 2;
       isLast = false;
    }
 
@@ -534,7 +550,7 @@ bool PartHandler::parseHeader( Stream* input )
 
    while( true )
    {
-      pos = m_pBuffer->find( "\r\n" );
+      pos = m_pBuffer->findLine();
 
       // No more headers? -- get new data
       if( pos == String::npos )
@@ -718,7 +734,7 @@ void PartHandler::initBuffer()
    m_pBuffer = new PartHandlerBuffer( m_pToBodyLeft );
 }
 
-void PartHandler::passSetting( PartHandler* child )
+void PartHandler::passSetting( PartHandler* child, const BoundSearch* bound )
 {
    child->m_bUseMemoryUpload = m_bUseMemoryUpload;
    child->m_owner = m_owner;
@@ -727,6 +743,60 @@ void PartHandler::passSetting( PartHandler* child )
 
    // Pass the same pointer of the owner
    child->m_pToBodyLeft = m_pToBodyLeft;
+   child->m_pEnclosingBound = bound;
+}
+
+
+PartHandler::BoundSearch::BoundSearch( const String& boundary )
+{
+   // boundaries are made of 7-bit characters.
+   m_nSize = boundary.length();
+   m_bound = (byte*) memAlloc( m_nSize + 1 );
+   for( uint32 i = 0; i < m_nSize; ++i )
+   {
+      m_bound[i] = (byte) boundary.getCharAt( i );
+   }
+
+   // a mismatch on a byte not in the boundary skips the whole boundary;
+   // otherwise, we align its last occurrence (but the final one).
+   for( uint32 i = 0; i < 256; ++i )
+   {
+      m_skip[i] = m_nSize;
+   }
+
+   for( uint32 i = 0; i + 1 < m_nSize; ++i )
+   {
+      m_skip[m_bound[i]] = m_nSize - 1 - i;
+   }
+}
+
+
+PartHandler::BoundSearch::~BoundSearch()
+{
+   memFree( m_bound );
+}
+
+
+uint32 PartHandler::BoundSearch::find( const byte* data, uint32 size ) const
+{
+   if( m_nSize == 0 || size < m_nSize )
+      return String::npos;
+
+   uint32 last = m_nSize - 1;
+   byte lastByte = m_bound[last];
+   const byte* pos = data;
+   const byte* end = data + (size - m_nSize);
+
+   while( pos <= end )
+   {
+      byte chr = pos[last];
+      if( chr == lastByte && memcmp( pos, m_bound, last ) == 0 )
+         return (uint32) (pos - data);
+
+      pos += m_skip[chr];
+   }
+
+   return String::npos;
 }
 
 
@@ -778,16 +848,31 @@ void PartHandler::PartHandlerBuffer::flush( Stream* output )
 }
 
 
-uint32 PartHandler::PartHandlerBuffer::find( const String& str )
+uint32 PartHandler::PartHandlerBuffer::find( const BoundSearch& bound )
 {
-   TRACE( "FIND: finding %s", str.getRawStorage() );
+   TRACE( "FIND: finding %d bytes", bound.size() );
    if( m_nBufPos >= m_nBufSize )
       return String::npos;
 
-   // do not create a new string, just scan in the buffer.
-   String temp;
-   temp.adopt( (char*) m_buffer + m_nBufPos, m_nBufSize - m_nBufPos, 0 );
-   return temp.find( str );
+   return bound.find( m_buffer + m_nBufPos, m_nBufSize - m_nBufPos );
+}
+
+
+uint32 PartHandler::PartHandlerBuffer::findLine()
+{
+   const byte* start = m_buffer + m_nBufPos;
+   const byte* end = m_buffer + m_nBufSize;
+   const byte* pos = start;
+
+   // memchr is usually vectorized; let it look for the CR.
+   while( pos < end && (pos = (const byte*) memchr( pos, '\r', end - pos )) != 0 )
+   {
+      if( pos + 1 < end && pos[1] == '\n' )
+         return (uint32) (pos - start);
+      ++pos;
+   }
+
+   return String::npos;
 }
 
 
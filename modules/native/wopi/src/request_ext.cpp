@@ -496,6 +496,54 @@ FALCON_FUNC Request_hasSession( VMachine *vm )
 }
 
 
+/*#
+   @method sessionStats Request
+   @brief Returns the activity counters of the session manager.
+   @return An array with a dictionary for each shard of the session map.
+
+   Sessions are distributed across independently locked shards by the hash
+   of their ID. Each dictionary in the returned array describes a shard, and
+   contains the following keys:
+    - sessions: Sessions currently held in the shard.
+    - hits: Existing sessions found by @a Request.getSession.
+    - misses: Sessions not found by @a Request.getSession, and so created.
+    - busy: Sessions found, but in use by another request.
+    - created: Sessions created by @a Request.startSession.
+    - expired: Sessions removed after their timeout.
+    - closed: Sessions explicitly closed.
+    - scheduled: Sessions waiting for expiration.
+    - contended: Times the shard lock was found busy.
+
+   The counters are cumulative since the start of the server process.
+*/
+FALCON_FUNC Request_sessionStats( VMachine *vm )
+{
+   CoreRequest *self = dyncast<CoreRequest*>( vm->self().asObject() );
+   SessionManager* sm = self->smgr();
+
+   CoreArray* shards = new CoreArray( sm->shardCount() );
+   for( uint32 i = 0; i < sm->shardCount(); ++i )
+   {
+      SessionManager::ShardStats stats;
+      sm->shardStats( i, stats );
+
+      LinearDict* dict = new LinearDict( 9 );
+      dict->put( new CoreString( "sessions" ), (int64) stats.m_sessions );
+      dict->put( new CoreString( "hits" ), (int64) stats.m_hits );
+      dict->put( new CoreString( "misses" ), (int64) stats.m_misses );
+      dict->put( new CoreString( "busy" ), (int64) stats.m_busy );
+      dict->put( new CoreString( "created" ), (int64) stats.m_created );
+      dict->put( new CoreString( "expired" ), (int64) stats.m_expired );
+      dict->put( new CoreString( "closed" ), (int64) stats.m_closed );
+      dict->put( new CoreString( "scheduled" ), (int64) stats.m_scheduled );
+      dict->put( new CoreString( "contended" ), (int64) stats.m_contended );
+      shards->append( new CoreDict( dict ) );
+   }
+
+   vm->retval( shards );
+}
+
+
 /*#
    @method tempFile Request
    @brief Creates a temporary file.
@@ -594,6 +642,7 @@ void InitRequestClass( Module* self, ObjectFactory cff, ext_func_t init_func )
       ->addParam("sid");
    self->addClassMethod( c_request, "closeSession", &Request_closeSession );
    self->addClassMethod( c_request, "hasSession", &Request_hasSession );
+   self->addClassMethod( c_request, "sessionStats", &Request_sessionStats );
    self->addClassMethod( c_request, "tempFile", &Request_tempFile ).asSymbol()
       ->addParam( "name" );
 }
@@ -28,15 +28,24 @@ namespace WOPI {
 // Main falcon
 //
 
+// The data must be complete before being locked, as the lock marks it;
+// an item assigned to an existing lock may be collected before the lock
+// is visited again.
+static CoreDict* s_newSessionDict( const String& SID )
+{
+   CoreDict* dict = new CoreDict( new LinearDict );
+   dict->bless(true);
+   dict->put( SafeItem( new CoreString( "SID" )), SafeItem(new CoreString(SID)) );
+   return dict;
+}
+
 SessionData::SessionData( const String& SID ):
+      m_dataLock( SafeItem( s_newSessionDict( SID ) ) ),
       m_lastError( 0 ),
       m_sID( SID ),
-      m_bInvalid( false )
+      m_bInvalid( false ),
+      m_bClosed( false )
 {
-   m_dataLock.item() = SafeItem( new CoreDict( new LinearDict ) );
-   m_dataLock.item().asDict()->bless(true);
-   m_dataLock.item().asDict()->put( SafeItem( new CoreString( "SID" )),
-            SafeItem(new CoreString(sID())) );
 }
 
 SessionData::~SessionData()
@@ -71,6 +80,13 @@ SessionData::WeakRef* SessionData::getWeakRef()
    return wr;
 }
 
+void SessionData::WeakRef::dropped()
+{
+   if ( m_ref != 0 )
+      m_ref->m_reflist.remove( this );
+   delete this;
+}
+
 void SessionData::clearRefs()
 {
    std::list<WeakRef*>::iterator iter = m_reflist.begin();
@@ -82,11 +98,71 @@ void SessionData::clearRefs()
    m_reflist.clear();
 }
 
+//=======================================================================
+// Expiration thread
+//
+
+SessionManager::Expirer::Expirer( SessionManager* owner ):
+   m_owner( owner ),
+   m_thread( 0 ),
+   m_bTerminate( false )
+{
+   m_thread = new SysThread( this );
+   m_thread->start( ThreadParams().stackSize(0xA000) );
+}
+
+SessionManager::Expirer::~Expirer()
+{
+   stop();
+}
+
+void SessionManager::Expirer::stop()
+{
+   if ( m_thread != 0 )
+   {
+      m_mtx.lock();
+      m_bTerminate = true;
+      m_mtx.unlock();
+      m_wakeup.set();
+
+      void* res;
+      m_thread->join( res );
+      m_thread = 0;
+   }
+}
+
+void* SessionManager::Expirer::run()
+{
+   int64 lastTick = (int64) Sys::_seconds();
+
+   while( true )
+   {
+      m_wakeup.wait( 1000 );
+
+      m_mtx.lock();
+      bool bTerminate = m_bTerminate;
+      m_mtx.unlock();
+
+      if ( bTerminate )
+         break;
+
+      int64 tick = (int64) Sys::_seconds();
+      if ( tick > lastTick )
+      {
+         m_owner->expireSessions( lastTick, tick );
+         lastTick = tick;
+      }
+   }
+
+   return 0;
+}
+
 //=======================================================================
 // Main session manager
 //
 
 SessionManager::SessionManager():
+      m_expirer(0),
       m_nLastToken(0),
       m_nSessionTimeout(0)
 {
@@ -94,15 +170,46 @@ SessionManager::SessionManager():
 
 SessionManager::~SessionManager()
 {
-   m_mtx.lock();
-   SessionMap::iterator iter = m_smap.begin();
-   while( iter != m_smap.end() )
+   // stop the sweeps before destroying the sessions.
+   delete m_expirer;
+
+   for( uint32 i = 0; i < FALCON_WOPI_SESSION_SHARDS; ++i )
    {
-      SessionData* sd = iter->second;
-      delete sd;
-      ++iter;
+      Shard& shard = m_shards[i];
+      shard.lock();
+      SessionMap::iterator iter = shard.m_smap.begin();
+      while( iter != shard.m_smap.end() )
+      {
+         SessionData* sd = iter->second;
+         delete sd;
+         ++iter;
+      }
+
+      // the sessions in the map are gone; the closed ones are still held.
+      SessionUserMap::iterator uiter = shard.m_susers.begin();
+      while( uiter != shard.m_susers.end() )
+      {
+         SessionList::iterator liter = uiter->second.begin();
+         while( liter != uiter->second.end() )
+         {
+            delete (*liter)->get();
+            (*liter)->dropped();
+            ++liter;
+         }
+         ++uiter;
+      }
+
+      for( uint32 slot = 0; slot < FALCON_WOPI_SESSION_WHEEL_SLOTS; ++slot )
+      {
+         ExpiryBucket::iterator eiter = shard.m_wheel[slot].begin();
+         while( eiter != shard.m_wheel[slot].end() )
+         {
+            eiter->m_ref->dropped();
+            ++eiter;
+         }
+      }
+      shard.unlock();
    }
-   m_mtx.unlock();
 }
 
 static void _init_srand() {
@@ -114,48 +221,59 @@ static void _init_srand() {
   }
 }
 
+
+SessionManager::Shard& SessionManager::shardOf( const String& sSID )
+{
+   uint32 h = sSID.hash();
+   // fold the upper bits, as SIDs differing only in the last chars are common.
+   h ^= h >> 16;
+   h ^= h >> 8;
+   return m_shards[ h & (FALCON_WOPI_SESSION_SHARDS-1) ];
+}
+
+
 SessionData* SessionManager::getSession( const Falcon::String& sSID, uint32 token )
 {
    SessionData* sd = 0;
    bool bCreated;
-   
-   // Should we start a new thread for this?
-   if( timeout() > 0 )
-      expireOldSessions();
+   Shard& shard = shardOf( sSID );
 
-   m_mtx.lock();
-   SessionMap::iterator iter = m_smap.find( sSID );
-   if( iter != m_smap.end() )
+   shard.lock();
+   SessionMap::iterator iter = shard.m_smap.find( sSID );
+   if( iter != shard.m_smap.end() )
    {
       sd = iter->second;
       if ( sd == 0 || sd->isAssigned() )
       {
-         m_mtx.unlock();
+         shard.m_stats.m_busy++;
+         shard.unlock();
          return 0;
       }
 
+      shard.m_stats.m_hits++;
       sd->assign( token );
       // We must manipulate m_susers in the lock to prevent concurrent update
       // from other threads.
-      m_susers[token].push_back( sd->getWeakRef() );
+      shard.m_susers[token].push_back( sd->getWeakRef() );
 
       // now that the session is assigned, we are free to manipulate it outside the lock.
-      m_mtx.unlock();
+      shard.unlock();
 
       bCreated = false;
    }
    else
    {
+      shard.m_stats.m_misses++;
       // create the session (fast)
       sd = createSession( sSID );
       // assign to our maps
-      m_smap[sSID] = sd;
-      m_susers[token].push_back( sd->getWeakRef() );
+      shard.m_smap[sSID] = sd;
+      shard.m_susers[token].push_back( sd->getWeakRef() );
       // assign the session
       sd->assign( token );
 
       // try to resume after unlock
-      m_mtx.unlock();
+      shard.unlock();
 
       bCreated = true;
    }
@@ -164,10 +282,12 @@ SessionData* SessionManager::getSession( const Falcon::String& sSID, uint32 toke
    if( ! sd->resume() )
    {
       // all useless work.
-      m_mtx.lock();
-      m_smap.erase( sSID );
+      shard.lock();
+      SessionMap::iterator pos = shard.m_smap.find( sSID );
+      if( pos != shard.m_smap.end() && pos->second == sd )
+         shard.m_smap.erase( pos );
       sd->clearRefs();
-      m_mtx.unlock();
+      shard.unlock();
 
       //If the session was created, we should have done it.
       if( ! bCreated )
@@ -192,31 +312,34 @@ SessionData* SessionManager::startSession( uint32 token )
 
    // No one can possibly use this SD as no one can know it.
    sd = createUniqueId( sSID );
-   m_mtx.lock();
-   m_susers[token].push_back( sd->getWeakRef() );
+   Shard& shard = shardOf( sSID );
+   shard.lock();
+   shard.m_susers[token].push_back( sd->getWeakRef() );
    // assign the session
    sd->assign( token );
-   m_mtx.unlock();
+   shard.unlock();
 
    return sd;
 }
 
 SessionData* SessionManager::startSession( uint32 token, const Falcon::String &sSID )
 {
-	SessionData* sd = 0;
-
-	m_mtx.lock();
-	if ( m_smap.find( sSID ) == m_smap.end() )
-	{
-	   sd = createSession(sSID);
-      m_smap[ sSID ] = sd;
-      m_susers[token].push_back( sd->getWeakRef() );
+   SessionData* sd = 0;
+   Shard& shard = shardOf( sSID );
+
+   shard.lock();
+   if ( shard.m_smap.find( sSID ) == shard.m_smap.end() )
+   {
+      sd = createSession(sSID);
+      shard.m_smap[ sSID ] = sd;
+      shard.m_susers[token].push_back( sd->getWeakRef() );
+      shard.m_stats.m_created++;
       // assign the session
       sd->assign( token );
-	}
-   m_mtx.unlock();
+   }
+   shard.unlock();
 
-	// else, it's still 0
+   // else, it's still 0
    return sd;
 }
 
@@ -224,16 +347,24 @@ SessionData* SessionManager::startSession( uint32 token, const Falcon::String &s
 // release all the sessions associated with this token
 bool SessionManager::releaseSessions( uint32 token )
 {
-   m_mtx.lock();
-   // do we have the session?
-   SessionUserMap::iterator pos = m_susers.find( token );
-   if( pos != m_susers.end() )
+   bool bScheduled = false;
+
+   for( uint32 i = 0; i < FALCON_WOPI_SESSION_SHARDS; ++i )
    {
+      Shard& shard = m_shards[i];
+
+      shard.lock();
+      // do we have the session?
+      SessionUserMap::iterator pos = shard.m_susers.find( token );
+      if( pos == shard.m_susers.end() )
+      {
+         shard.unlock();
+         continue;
+      }
+
       // copy the list of sessions to be closed, so that we can work on it.
       SessionList lCopy = pos->second;
-      m_susers.erase( pos );
-      m_mtx.unlock();
-
+      shard.m_susers.erase( pos );
 
       SessionList::iterator iter = lCopy.begin();
       while( iter != lCopy.end() )
@@ -244,99 +375,198 @@ bool SessionManager::releaseSessions( uint32 token )
          // Still a valid reference?
          if( sd != 0 )
          {
-            // store on persistent media
-            sd->store();
-
-            // mark as used now
-            sd->touch();
-
-            // make available for other requests
-            m_mtx.lock();
-            if( timeout() > 0 )
+            if( ! sd->isClosed() )
             {
-               m_expmap.insert( ExpirationMap::value_type( sd->lastTouched() + timeout(), sd->getWeakRef() ) );
+               // store on persistent media; the session is still assigned to us,
+               // so it can't expire in the meanwhile.
+               shard.unlock();
+               sd->store();
+
+               // mark as used now
+               sd->touch();
+               shard.lock();
             }
 
-            sd->release();
-            m_mtx.unlock();
-            
+            // Closed by another request while we held it?
+            if( sd->isClosed() )
+            {
+               sd->clearRefs();
+               shard.unlock();
+               sd->dispose();
+               delete sd;
+               shard.lock();
+            }
+            else
+            {
+               // make available for other requests
+               if( timeout() > 0 )
+               {
+                  schedule( shard, sd );
+                  bScheduled = true;
+               }
+
+               sd->release();
+            }
          }
 
          wsd->dropped();
          ++iter;
       }
+      shard.unlock();
    }
-   else
-   {
-      m_mtx.unlock();
-   }
+
+   if( bScheduled )
+      startExpirer();
 
    return true;
 }
 
 bool SessionManager::closeSession( const String& sSID, uint32 token )
 {
-   m_mtx.lock();
-   SessionMap::iterator iter = m_smap.find( sSID );
-   if( iter != m_smap.end() )
+   Shard& shard = shardOf( sSID );
+
+   shard.lock();
+   SessionMap::iterator iter = shard.m_smap.find( sSID );
+   if( iter != shard.m_smap.end() )
    {
       SessionData* sd = iter->second;
-      m_smap.erase( sSID );
+      shard.m_smap.erase( iter );
+      shard.m_stats.m_closed++;
+
+      // another request is using it; it will dispose it when done.
+      if( sd->isAssigned() && sd->assigned() != token )
+      {
+         sd->setClosed();
+         shard.unlock();
+         return true;
+      }
+
       sd->clearRefs();
-      m_mtx.unlock();
+      shard.unlock();
 
       sd->dispose();
       delete sd;
       return true;
    }
 
-   m_mtx.unlock();
+   shard.unlock();
    return false;
 }
 
 
-void SessionManager::expireOldSessions()
+void SessionManager::schedule( Shard& shard, SessionData* sd )
 {
-   numeric now = Sys::_seconds();
+   numeric expire = sd->lastTouched() + timeout();
+
+   // The slot is swept at the first tick past the expiration time.
+   uint32 slot = (uint32) ( ((int64) expire + 1) % FALCON_WOPI_SESSION_WHEEL_SLOTS );
+   shard.m_wheel[slot].push_back( ExpiryEntry( expire, sd->getWeakRef() ) );
+   shard.m_stats.m_scheduled++;
+}
 
-   std::deque<SessionData*> expiredSessions;
-   m_mtx.lock();
-   while( ! m_expmap.empty() && m_expmap.begin()->first < now )
+
+void SessionManager::startExpirer()
+{
+   m_mtxExpirer.lock();
+   if ( m_expirer == 0 )
    {
-      SessionData::WeakRef* wsd = m_expmap.begin()->second;
-      SessionData* sd = wsd->get();
-      
-      // Is the session still alive?
-      if ( sd != 0 && sd->lastTouched() + timeout() < now )
+      m_expirer = new Expirer( this );
+   }
+   m_mtxExpirer.unlock();
+}
+
+
+void SessionManager::expireSessions( int64 fromTick, int64 toTick )
+{
+   // a full turn of the wheel sweeps all the slots.
+   if ( toTick - fromTick > FALCON_WOPI_SESSION_WHEEL_SLOTS )
+      fromTick = toTick - FALCON_WOPI_SESSION_WHEEL_SLOTS;
+
+   for( uint32 i = 0; i < FALCON_WOPI_SESSION_SHARDS; ++i )
+   {
+      Shard& shard = m_shards[i];
+      std::deque<SessionData*> expiredSessions;
+
+      shard.lock();
+      numeric now = Sys::_seconds();
+
+      for( int64 tick = fromTick + 1; tick <= toTick; ++tick )
       {
-         // the data is dead, so we remove it now from the available map
-         m_smap.erase( sd->sID() );
+         ExpiryBucket& bucket = shard.m_wheel[ tick % FALCON_WOPI_SESSION_WHEEL_SLOTS ];
+         ExpiryBucket::iterator iter = bucket.begin();
+         while( iter != bucket.end() )
+         {
+            // entries of later turns of the wheel stay here.
+            if ( iter->m_expire >= now )
+            {
+               ++iter;
+               continue;
+            }
+
+            SessionData* sd = iter->m_ref->get();
+
+            // Is the session still alive, released and not touched since?
+            // -- if it was touched, the release scheduled it again.
+            if ( sd != 0 && ! sd->isAssigned() && sd->lastTouched() + timeout() < now )
+            {
+               // the data is dead, so we remove it now from the available map
+               shard.m_smap.erase( sd->sID() );
+
+               // prevents others (and ourselves) to use it again
+               sd->clearRefs();
 
-         // prevents others (and ourselves) to use it again
-         sd->clearRefs();
+               // and we push it aside for later clearing
+               expiredSessions.push_back( sd );
+               shard.m_stats.m_expired++;
+            }
 
-         // and we push it aside for later clearing
-         expiredSessions.push_back( sd );
+            // also, take it away from our expired data
+            iter->m_ref->dropped();
+            iter = bucket.erase( iter );
+            shard.m_stats.m_scheduled--;
+         }
       }
 
-      // also, take it away from our expired data
-      m_expmap.erase( m_expmap.begin() );
+      shard.unlock();
+
+      // now we can destroy the expired sessions
+      std::deque<SessionData*>::iterator elem = expiredSessions.begin();
+      while( elem != expiredSessions.end() )
+      {
+         SessionData* sd = *elem;
+         sd->dispose();
+         delete sd;
+         ++elem;
+      }
    }
+}
 
-   m_mtx.unlock();
 
-   // now we can destroy the expired sessions
-   std::deque<SessionData*>::iterator elem = expiredSessions.begin();
-   while( elem != expiredSessions.end() )
-   {
-      SessionData* sd = *elem;
-      sd->dispose();
-      delete sd;
-      ++elem;
-   }
+void SessionManager::ShardStats::add( const ShardStats& other )
+{
+   m_sessions += other.m_sessions;
+   m_hits += other.m_hits;
+   m_misses += other.m_misses;
+   m_busy += other.m_busy;
+   m_created += other.m_created;
+   m_expired += other.m_expired;
+   m_closed += other.m_closed;
+   m_scheduled += other.m_scheduled;
+   m_contended += other.m_contended;
 }
 
 
+void SessionManager::shardStats( uint32 id, ShardStats& stats ) const
+{
+   fassert( id < FALCON_WOPI_SESSION_SHARDS );
+   const Shard& shard = m_shards[id];
+
+   shard.lock();
+   stats = shard.m_stats;
+   stats.m_sessions = (uint32) shard.m_smap.size();
+   shard.unlock();
+}
+
 
 SessionData* SessionManager::createUniqueId( Falcon::String& sSID )
 {
@@ -354,19 +584,21 @@ SessionData* SessionManager::createUniqueId( Falcon::String& sSID )
          sSID += alpha[ rand() % 62 ];
       }
       
-      m_mtx.lock();
-      if ( m_smap.find( sSID ) == m_smap.end() )
+      Shard& shard = shardOf( sSID );
+      shard.lock();
+      if ( shard.m_smap.find( sSID ) == shard.m_smap.end() )
       {
          found = true;
          sd = createSession(sSID);
-         m_smap[ sSID ] = sd;
+         shard.m_smap[ sSID ] = sd;
+         shard.m_stats.m_created++;
       }
       else
       {
          // try again
          sSID.size(0);
       }
-      m_mtx.unlock();
+      shard.unlock();
    }
    
    return sd;
@@ -375,13 +607,11 @@ SessionData* SessionManager::createUniqueId( Falcon::String& sSID )
 
 uint32 SessionManager::getSessionToken()
 {
-   m_mtx.lock();
-   uint32 ret = ++m_nLastToken;
+   uint32 ret = (uint32) atomicInc( m_nLastToken );
 
    // prevent roll-over error
    if ( ret == 0 )
-      ret = ++m_nLastToken;
-   m_mtx.unlock();
+      ret = (uint32) atomicInc( m_nLastToken );
 
    return ret;
 }
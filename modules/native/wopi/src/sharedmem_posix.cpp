@@ -54,7 +54,9 @@ public:
       bSemReady(false),
       shmfd(0),
       filefd(0),
-      bd(0)
+      bd(0),
+      area(0),
+      areaSize(0)
       {}
 
    bool bSemReady;
@@ -64,6 +66,10 @@ public:
 
    // Memory mapped data
    BufferData* bd;
+
+   // Directly mapped area, including the buffer data.
+   void* area;
+   uint32 areaSize;
 };
 
 
@@ -232,6 +238,12 @@ void SharedMem::close()
       munmap( d->bd, sizeof(BufferData) );
    }
 
+   if( d->area != 0 )
+   {
+      munmap( d->area, d->areaSize );
+      d->area = 0;
+   }
+
    // we're in trouble.
    if( d->bSemReady )
    {
@@ -440,6 +452,73 @@ void SharedMem::internal_read( Stream* target )
    }
 }
 
+byte* SharedMem::mapArea( uint32 size )
+{
+   if( d->area != 0 )
+   {
+      return ((byte*) d->area) + sizeof(BufferData);
+   }
+
+   lock();
+
+   int fd = d->shmfd <= 0 ? d->filefd : d->shmfd;
+   uint32 fullSize = size + sizeof(BufferData);
+
+   off_t pos = lseek( fd, 0, SEEK_END );
+   if( pos < 0 )
+   {
+      unlock();
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                                    .extra("lseek" )
+                                    .sysError( errno ) );
+   }
+
+   // extending a file fills it with zeroes.
+   if( pos < (off_t) fullSize && ftruncate( fd, fullSize ) != 0 )
+   {
+      unlock();
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                                .extra( String("ftruncate to ").N( (int64) fullSize).A( " bytes" ) )
+                                .sysError( errno ) );
+   }
+
+   void* data = mmap( 0, fullSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+   unlock();
+
+   if( data == MAP_FAILED )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                              .extra( String("mmap ").N( (int64) fullSize).A(" bytes") )
+                              .sysError( errno ) );
+   }
+
+   d->area = data;
+   d->areaSize = fullSize;
+   return ((byte*) data) + sizeof(BufferData);
+}
+
+
+void SharedMem::lock()
+{
+   while( sem_wait( d->sema ) != 0 )
+   {
+      // signals may interrupt the wait.
+      if( errno != EINTR )
+      {
+         throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                                            .extra("sem_wait" )
+                                            .sysError( errno ) );
+      }
+   }
+}
+
+
+void SharedMem::unlock()
+{
+   sem_post( d->sema );
+}
+
+
 uint32 SharedMem::currentVersion() const
 {
    msync( d->bd, sizeof(BufferData), MS_SYNC );
@@ -45,16 +45,22 @@ public:
 	  mtx(INVALID_HANDLE_VALUE),
 	  hFile(INVALID_HANDLE_VALUE),
 	  hMemory(INVALID_HANDLE_VALUE),
-     bd(0)
+     hArea(INVALID_HANDLE_VALUE),
+     bd(0),
+     area(0)
       {}
 
    HANDLE mtx;
    HANDLE hFile;
    HANDLE hMemory;
+   HANDLE hArea;
 
    // Temporary buffer data
    BufferData* bd;
 
+   // Directly mapped area, including the buffer data.
+   void* area;
+
    String sMemName;
 
    void EnterSession()
@@ -255,6 +261,18 @@ void SharedMem::close()
       d->bd = NULL;
    }
 
+   if ( d->area != NULL )
+   {
+      UnmapViewOfFile( d->area );
+      d->area = NULL;
+   }
+
+   if( d->hArea != INVALID_HANDLE_VALUE )
+   {
+      CloseHandle( d->hArea );
+      d->hArea = INVALID_HANDLE_VALUE;
+   }
+
    if( d->hMemory != INVALID_HANDLE_VALUE )
    {
       CloseHandle( d->hMemory );
@@ -457,6 +475,73 @@ void SharedMem::internal_read( Stream* target )
 }
 
 
+byte* SharedMem::mapArea( uint32 size )
+{
+   if( d->area != 0 )
+   {
+      return ((byte*) d->area) + sizeof(BufferData);
+   }
+
+   lock();
+
+   // a mapping can't grow, so the area has its own, created at full size;
+   // new pages are filled with zeroes.
+   DWORD fullSize = size + sizeof(BufferData);
+   if( d->hFile != INVALID_HANDLE_VALUE && GetFileSize( d->hFile, 0 ) < fullSize )
+   {
+      SetFilePointer( d->hFile, fullSize, 0, FILE_BEGIN );
+      SetEndOfFile( d->hFile );
+   }
+
+   AutoWString wAreaName( d->sMemName + "_AREA" );
+   d->hArea = CreateFileMappingW(
+            d->hFile,
+            0,
+            PAGE_READWRITE,
+            0,
+            fullSize,
+            wAreaName.w_str() );
+
+   if ( d->hArea == NULL )
+   {
+      d->hArea = INVALID_HANDLE_VALUE;
+      unlock();
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                                .extra( String("CreateFileMappingW to ").N( (int64) fullSize).A( " bytes" ) )
+                                .sysError( GetLastError() ) );
+   }
+
+   d->area = MapViewOfFile( d->hArea, FILE_MAP_WRITE, 0, 0, fullSize );
+   unlock();
+
+   if( d->area == NULL )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                              .extra( String("MapViewOfFile ").N( (int64) fullSize).A(" bytes") )
+                              .sysError( GetLastError() ) );
+   }
+
+   return ((byte*) d->area) + sizeof(BufferData);
+}
+
+
+void SharedMem::lock()
+{
+   if( WaitForSingleObject( d->mtx, INFINITE ) != WAIT_OBJECT_0 )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+                                         .extra("WaitForSingleObject" )
+                                         .sysError( GetLastError() ) );
+   }
+}
+
+
+void SharedMem::unlock()
+{
+   ReleaseMutex( d->mtx );
+}
+
+
 uint32 SharedMem::currentVersion() const
 {
    d->EnterSession();
@@ -0,0 +1,571 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: shm_sm.cpp
+
+   Falcon Web Oriented Programming Interface
+
+   Shared memory based session manager.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 21:40:12 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Shared memory based session manager.
+*/
+
+#include <falcon/wopi/shm_sm.h>
+#include <falcon/wopi/sharedmem.h>
+
+#include <falcon/sys.h>
+#include <falcon/mt.h>
+#include <falcon/item.h>
+#include <falcon/error.h>
+#include <falcon/fassert.h>
+#include <falcon/autocstring.h>
+#include <falcon/stringstream.h>
+
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+// "FWSS"
+#define SHM_STORE_MAGIC    0x46575353
+
+// lock-free attempts before reading a session under the store lock.
+#define SHM_READ_SPINS     64
+
+#define SHM_SLOT_EMPTY     0
+#define SHM_SLOT_USED      1
+#define SHM_SLOT_DELETED   2
+
+namespace Falcon {
+namespace WOPI {
+
+//============================================================
+// Layout of the shared area
+//
+
+/* The area starts with a header, followed by the slot table and by the
+   data blocks. Block IDs are 1-based, so that 0 means "no block"; each
+   block starts with the ID of the next block in its chain.
+*/
+class ShmSessionManager::Header
+{
+public:
+   uint32 m_magic;
+   uint32 m_slots;
+   uint32 m_blocks;
+   uint32 m_blockSize;
+   uint32 m_freeHead;
+   uint32 m_freeCount;
+   uint32 m_lastVersion;
+   uint32 m_padding;
+};
+
+
+class ShmSessionManager::Slot
+{
+public:
+   // odd while the slot is being written.
+   volatile int32 m_seq;
+   uint32 m_state;
+   uint32 m_hash;
+   uint32 m_sidSize;
+   uint32 m_dataSize;
+   uint32 m_firstBlock;
+   uint32 m_version;
+   uint32 m_padding;
+   // milliseconds since epoch of the last store.
+   int64 m_storedAt;
+   char m_sid[FALCON_WOPI_SHM_SID_SIZE];
+};
+
+
+static inline void s_readBarrier()
+{
+#if defined(_MSC_VER)
+   MemoryBarrier();
+#elif defined(__GNUC__)
+   __sync_synchronize();
+#endif
+}
+
+static inline int64 s_now()
+{
+   return (int64) (Sys::_seconds() * 1000.0);
+}
+
+//============================================================
+// Shared memory session data
+//
+
+ShmSessionData::ShmSessionData( const String& SID, ShmSessionManager* owner ):
+   SessionData( SID ),
+   m_owner( owner ),
+   m_version( 0 )
+{
+}
+
+ShmSessionData::~ShmSessionData()
+{
+}
+
+bool ShmSessionData::resume()
+{
+   StringStream ss;
+   if ( ! m_owner->readSession( sID(), ss, m_version ) )
+   {
+      // it's a new session.
+      return false;
+   }
+
+   ss.seekBegin( 0 );
+   if( m_dataLock.item().deserialize( &ss, VMachine::getCurrent() ) != Item::sc_ok )
+   {
+      setError( "Deserialization failed from shared session store" );
+      return false;
+   }
+
+   return true;
+}
+
+
+bool ShmSessionData::store()
+{
+   StringStream ss;
+   if( m_dataLock.item().serialize( &ss ) != Item::sc_ok )
+   {
+      setError( "Serialization to shared session store failed" );
+      return false;
+   }
+
+   String data;
+   ss.closeToString( data );
+   bool bDone = m_owner->writeSession( sID(), data.getRawStorage(), data.size(), m_version );
+
+   if( ! bDone )
+   {
+      setError( "Shared session store full" );
+   }
+
+   return bDone;
+}
+
+bool ShmSessionData::dispose()
+{
+   if( m_version == 0 )
+      return false;
+
+   return m_owner->removeSession( sID(), m_version );
+}
+
+//============================================================
+// Shared memory session manager
+//
+
+ShmSessionManager::ShmSessionManager( const String& name, uint32 slots, uint32 blocks, uint32 blockSize ):
+   m_shm( 0 ),
+   m_area( 0 ),
+   m_slots( slots ),
+   m_blocks( blocks ),
+   // keep the block links aligned.
+   m_blockSize( (blockSize + 7) & ~7 )
+{
+   fassert( slots > 0 && blocks > 0 && blockSize > sizeof(uint32) );
+
+   m_shm = new SharedMem( "SESS_" + name );
+
+   try
+   {
+      m_area = m_shm->mapArea( sizeof(Header) + m_slots * sizeof(Slot) + m_blocks * m_blockSize );
+
+      m_shm->lock();
+      Header* hdr = header();
+      if( hdr->m_magic != SHM_STORE_MAGIC )
+      {
+         // first user of the store; the area is zeroed, so all the slots are empty.
+         hdr->m_slots = m_slots;
+         hdr->m_blocks = m_blocks;
+         hdr->m_blockSize = m_blockSize;
+         hdr->m_lastVersion = 0;
+
+         for( uint32 id = 1; id < m_blocks; ++id )
+         {
+            *(uint32*) blockAt( id ) = id + 1;
+         }
+         *(uint32*) blockAt( m_blocks ) = 0;
+         hdr->m_freeHead = 1;
+         hdr->m_freeCount = m_blocks;
+
+         hdr->m_magic = SHM_STORE_MAGIC;
+      }
+      else if( hdr->m_slots != m_slots || hdr->m_blocks != m_blocks || hdr->m_blockSize != m_blockSize )
+      {
+         m_shm->unlock();
+         throw new IoError( ErrorParam( e_io_error, __LINE__ )
+               .extra( "Incompatible shared session store " + name ) );
+      }
+      m_shm->unlock();
+   }
+   catch( ... )
+   {
+      delete m_shm;
+      throw;
+   }
+}
+
+
+ShmSessionManager::~ShmSessionManager()
+{
+   delete m_shm;
+}
+
+
+void ShmSessionManager::startup()
+{
+   purgeExpired();
+}
+
+
+SessionData* ShmSessionManager::createSession( const String& sSID )
+{
+   return new ShmSessionData( sSID, this );
+}
+
+
+ShmSessionManager::Header* ShmSessionManager::header() const
+{
+   return (Header*) m_area;
+}
+
+
+ShmSessionManager::Slot* ShmSessionManager::slotAt( uint32 pos ) const
+{
+   return ((Slot*)(m_area + sizeof(Header))) + pos;
+}
+
+
+byte* ShmSessionManager::blockAt( uint32 id ) const
+{
+   return m_area + sizeof(Header) + m_slots * sizeof(Slot) + (id-1) * m_blockSize;
+}
+
+
+bool ShmSessionManager::readSession( const String& sSID, StringStream& target, uint32& version )
+{
+   AutoCString csid( sSID );
+   if( csid.length() > FALCON_WOPI_SHM_SID_SIZE )
+      return false;
+
+   uint32 hash = sSID.hash();
+   for( int spin = 0; spin < SHM_READ_SPINS; ++spin )
+   {
+      int32 res = tryRead( csid.c_str(), csid.length(), hash, target, version );
+      if( res >= 0 )
+         return res == 1;
+   }
+
+   // the slot is changing too often (or its writer died); read it locked.
+   m_shm->lock();
+   int32 freePos;
+   int32 pos = locate( csid.c_str(), csid.length(), hash, freePos );
+   bool bFound = false;
+   if( pos >= 0 )
+   {
+      target.truncate( 0 );
+      target.seekBegin( 0 );
+      bFound = copyData( slotAt( pos ), target );
+      version = slotAt( pos )->m_version;
+   }
+   m_shm->unlock();
+
+   return bFound;
+}
+
+
+int32 ShmSessionManager::tryRead( const char* sid, uint32 sidSize, uint32 hash, StringStream& target, uint32& version ) const
+{
+   for( uint32 probe = 0; probe < m_slots; ++probe )
+   {
+      const Slot* slot = slotAt( (hash + probe) % m_slots );
+
+      int32 seq = slot->m_seq;
+      if( (seq & 1) != 0 )
+         return -1;
+      s_readBarrier();
+
+      uint32 state = slot->m_state;
+      if( state == SHM_SLOT_USED && slot->m_hash == hash
+            && slot->m_sidSize == sidSize && memcmp( slot->m_sid, sid, sidSize ) == 0 )
+      {
+         target.truncate( 0 );
+         target.seekBegin( 0 );
+         bool bComplete = copyData( slot, target );
+         uint32 ver = slot->m_version;
+
+         s_readBarrier();
+         if( slot->m_seq != seq || ! bComplete )
+            return -1;
+
+         version = ver;
+         return 1;
+      }
+
+      s_readBarrier();
+      if( slot->m_seq != seq )
+         return -1;
+
+      if( state == SHM_SLOT_EMPTY )
+         return 0;
+   }
+
+   return 0;
+}
+
+
+bool ShmSessionManager::writeSession( const String& sSID, const byte* data, uint32 size, uint32& version )
+{
+   AutoCString csid( sSID );
+   uint32 sidSize = csid.length();
+   if( sidSize > FALCON_WOPI_SHM_SID_SIZE )
+      return false;
+
+   uint32 hash = sSID.hash();
+   uint32 payload = m_blockSize - sizeof(uint32);
+   uint32 needed = (size + payload - 1) / payload;
+   int64 now = s_now();
+   Header* hdr = header();
+
+   m_shm->lock();
+
+   int32 freePos;
+   int32 pos = locate( csid.c_str(), sidSize, hash, freePos );
+   uint32 available = hdr->m_freeCount + (pos >= 0 ? (slotAt(pos)->m_dataSize + payload - 1) / payload : 0);
+
+   if( (pos < 0 && freePos < 0) || needed > available )
+   {
+      // make room throwing away the expired sessions.
+      if( purgeLocked( now ) > 0 )
+      {
+         pos = locate( csid.c_str(), sidSize, hash, freePos );
+         available = hdr->m_freeCount + (pos >= 0 ? (slotAt(pos)->m_dataSize + payload - 1) / payload : 0);
+      }
+
+      if( (pos < 0 && freePos < 0) || needed > available )
+      {
+         m_shm->unlock();
+         return false;
+      }
+   }
+
+   Slot* slot = slotAt( pos >= 0 ? pos : freePos );
+   atomicInc( slot->m_seq );
+
+   freeData( slot );
+   slot->m_state = SHM_SLOT_USED;
+   slot->m_hash = hash;
+   slot->m_sidSize = sidSize;
+   memcpy( slot->m_sid, csid.c_str(), sidSize );
+
+   uint32* link = &slot->m_firstBlock;
+   uint32 written = 0;
+   while( written < size )
+   {
+      uint32 id = hdr->m_freeHead;
+      byte* block = blockAt( id );
+      hdr->m_freeHead = *(uint32*) block;
+      hdr->m_freeCount--;
+
+      uint32 count = size - written > payload ? payload : size - written;
+      memcpy( block + sizeof(uint32), data + written, count );
+      written += count;
+
+      *link = id;
+      link = (uint32*) block;
+   }
+   *link = 0;
+   slot->m_dataSize = size;
+
+   // version 0 means "no version".
+   if( ++hdr->m_lastVersion == 0 )
+      hdr->m_lastVersion = 1;
+   version = slot->m_version = hdr->m_lastVersion;
+   slot->m_storedAt = now;
+
+   atomicInc( slot->m_seq );
+   m_shm->unlock();
+
+   return true;
+}
+
+
+bool ShmSessionManager::removeSession( const String& sSID, uint32 version )
+{
+   AutoCString csid( sSID );
+   if( csid.length() > FALCON_WOPI_SHM_SID_SIZE )
+      return false;
+
+   m_shm->lock();
+   int32 freePos;
+   int32 pos = locate( csid.c_str(), csid.length(), sSID.hash(), freePos );
+   bool bRemoved = pos >= 0 && slotAt( pos )->m_version == version;
+   if( bRemoved )
+   {
+      clearSlot( pos );
+   }
+   m_shm->unlock();
+
+   return bRemoved;
+}
+
+
+uint32 ShmSessionManager::purgeExpired()
+{
+   m_shm->lock();
+   uint32 count = purgeLocked( s_now() );
+   m_shm->unlock();
+
+   return count;
+}
+
+
+int32 ShmSessionManager::locate( const char* sid, uint32 sidSize, uint32 hash, int32& freePos ) const
+{
+   freePos = -1;
+
+   for( uint32 probe = 0; probe < m_slots; ++probe )
+   {
+      uint32 pos = (hash + probe) % m_slots;
+      const Slot* slot = slotAt( pos );
+
+      if( slot->m_state == SHM_SLOT_EMPTY )
+      {
+         if( freePos < 0 )
+            freePos = pos;
+         return -1;
+      }
+
+      if( slot->m_state == SHM_SLOT_DELETED )
+      {
+         if( freePos < 0 )
+            freePos = pos;
+      }
+      else if( slot->m_hash == hash && slot->m_sidSize == sidSize
+            && memcmp( slot->m_sid, sid, sidSize ) == 0 )
+      {
+         return pos;
+      }
+   }
+
+   return -1;
+}
+
+
+bool ShmSessionManager::copyData( const Slot* slot, StringStream& target ) const
+{
+   uint32 payload = m_blockSize - sizeof(uint32);
+   uint32 size = slot->m_dataSize;
+   uint32 id = slot->m_firstBlock;
+
+   // an unlocked read may see a chain being rewritten; never leave the area.
+   if( size > m_blocks * payload )
+      return false;
+
+   while( size > 0 )
+   {
+      if( id == 0 || id > m_blocks )
+         return false;
+
+      const byte* block = blockAt( id );
+      uint32 count = size > payload ? payload : size;
+      target.write( block + sizeof(uint32), count );
+      size -= count;
+      id = *(const uint32*) block;
+   }
+
+   return true;
+}
+
+
+void ShmSessionManager::freeData( Slot* slot )
+{
+   Header* hdr = header();
+   uint32 id = slot->m_firstBlock;
+
+   while( id != 0 )
+   {
+      uint32* block = (uint32*) blockAt( id );
+      uint32 next = *block;
+      *block = hdr->m_freeHead;
+      hdr->m_freeHead = id;
+      hdr->m_freeCount++;
+      id = next;
+   }
+
+   slot->m_firstBlock = 0;
+   slot->m_dataSize = 0;
+}
+
+
+void ShmSessionManager::clearSlot( uint32 pos )
+{
+   Slot* slot = slotAt( pos );
+
+   atomicInc( slot->m_seq );
+   freeData( slot );
+   slot->m_state = SHM_SLOT_DELETED;
+   slot->m_version = 0;
+   atomicInc( slot->m_seq );
+
+   // a deleted slot followed by an empty one is not part of any probe chain.
+   if( slotAt( (pos + 1) % m_slots )->m_state != SHM_SLOT_EMPTY )
+      return;
+
+   for( uint32 count = 0; count < m_slots; ++count )
+   {
+      slot = slotAt( pos );
+      if( slot->m_state != SHM_SLOT_DELETED )
+         break;
+
+      atomicInc( slot->m_seq );
+      slot->m_state = SHM_SLOT_EMPTY;
+      atomicInc( slot->m_seq );
+
+      pos = (pos + m_slots - 1) % m_slots;
+   }
+}
+
+
+uint32 ShmSessionManager::purgeLocked( int64 now )
+{
+   if( timeout() == 0 )
+      return 0;
+
+   int64 limit = now - ((int64) timeout()) * 1000;
+   uint32 count = 0;
+
+   for( uint32 pos = 0; pos < m_slots; ++pos )
+   {
+      Slot* slot = slotAt( pos );
+      if( slot->m_state == SHM_SLOT_USED && slot->m_storedAt < limit )
+      {
+         clearSlot( pos );
+         ++count;
+      }
+   }
+
+   return count;
+}
+
+}
+}
+
+/* end of shm_sm.cpp */
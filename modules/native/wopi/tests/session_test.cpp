@@ -0,0 +1,223 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: session_test.cpp
+
+   Falcon Web Oriented Programming Interface
+
+   Session manager test.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 18:20:41 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/*
+   Runs the memory session manager through the life of a session, and
+   then has a set of threads getting, releasing and closing a small set
+   of sessions while the expiration thread sweeps them, checking the
+   shard counters at the end.
+
+   Returns 0 on success, printing the failed checks otherwise.
+*/
+
+#include <falcon/engine.h>
+#include <falcon/sys.h>
+#include <falcon/wopi/mem_sm.h>
+
+#include "wopi_test.h"
+
+using namespace Falcon;
+using namespace Falcon::WOPI;
+
+static void totals( SessionManager& sm, SessionManager::ShardStats& total )
+{
+   total = SessionManager::ShardStats();
+   for( uint32 i = 0; i < sm.shardCount(); ++i )
+   {
+      SessionManager::ShardStats st;
+      sm.shardStats( i, st );
+      total.add( st );
+   }
+}
+
+static bool sessionSID( SessionData* sd, const String& sSID )
+{
+   Item* i_sid = sd->data()->find( "SID" );
+   return i_sid != 0 && i_sid->isString() && *i_sid->asString() == sSID;
+}
+
+//=======================================================================
+// Life of a session
+//
+
+static void testLifecycle()
+{
+   MemSessionManager sm;
+   sm.timeout( 1 );
+   sm.startup();
+
+   uint32 token = sm.getSessionToken();
+   SessionData* sd = sm.startSession( token );
+   CHECK( sd != 0 );
+   String sSID = sd->sID();
+   CHECK( sessionSID( sd, sSID ) );
+   CHECK( sd->assigned() == token );
+
+   // another request can't have it till it's released.
+   uint32 token2 = sm.getSessionToken();
+   CHECK( token2 != token );
+   CHECK( sm.getSession( sSID, token2 ) == 0 );
+   CHECK( sm.startSession( token2, sSID ) == 0 );
+
+   sm.releaseSessions( token );
+   CHECK( ! sd->isAssigned() );
+   CHECK( sm.getSession( sSID, token2 ) == sd );
+   sm.releaseSessions( token2 );
+
+   // expires once released for longer than the timeout.
+   pause( 3500 );
+   SessionManager::ShardStats total;
+   totals( sm, total );
+   CHECK( total.m_sessions == 0 );
+   CHECK( total.m_expired == 1 );
+   CHECK( total.m_scheduled == 0 );
+
+   // a new session is created on the same ID.
+   sd = sm.getSession( sSID, token );
+   CHECK( sd != 0 );
+   CHECK( sessionSID( sd, sSID ) );
+   totals( sm, total );
+   CHECK( total.m_misses == 1 );
+   CHECK( total.m_hits == 1 );
+   CHECK( total.m_busy == 1 );
+
+   // closing a session removes it at once.
+   CHECK( sm.closeSession( sSID, token ) );
+   CHECK( ! sm.closeSession( sSID, token ) );
+   sm.releaseSessions( token );
+   totals( sm, total );
+   CHECK( total.m_sessions == 0 );
+   CHECK( total.m_closed == 1 );
+}
+
+//=======================================================================
+// Concurrent use
+//
+
+#define SESSION_IDS 32
+#define CLIENTS 8
+#define ROUNDS 20000
+
+class Client: public Runnable
+{
+public:
+   Client( SessionManager* sm, uint32 seed ):
+      m_sm( sm ),
+      m_seed( seed ),
+      m_bad( 0 )
+   {}
+
+   virtual void* run()
+   {
+      for( int i = 0; i < ROUNDS; ++i )
+      {
+         uint32 token = m_sm->getSessionToken();
+         String sSID = "session";
+         sSID.N( (int64) (next() % SESSION_IDS) );
+
+         SessionData* sd = m_sm->getSession( sSID, token );
+         if( sd != 0 )
+         {
+            if( ! sessionSID( sd, sSID ) || sd->assigned() != token )
+               ++m_bad;
+
+            switch( next() % 8 )
+            {
+               // our session
+               case 0: m_sm->closeSession( sSID, token ); break;
+               // a session possibly in use by another client
+               case 1:
+               {
+                  String sOther = "session";
+                  sOther.N( (int64) (next() % SESSION_IDS) );
+                  m_sm->closeSession( sOther, token );
+               }
+               break;
+            }
+         }
+
+         m_sm->releaseSessions( token );
+      }
+
+      return 0;
+   }
+
+   int bad() const { return m_bad; }
+
+private:
+   uint32 next()
+   {
+      m_seed = m_seed * 1103515245 + 12345;
+      return m_seed >> 16;
+   }
+
+   SessionManager* m_sm;
+   uint32 m_seed;
+   int m_bad;
+};
+
+static void testConcurrency()
+{
+   MemSessionManager sm;
+   sm.timeout( 1 );
+   sm.startup();
+
+   Client* clients[CLIENTS];
+   SysThread* threads[CLIENTS];
+   for( int i = 0; i < CLIENTS; ++i )
+   {
+      clients[i] = new Client( &sm, i + 1 );
+      threads[i] = new SysThread( clients[i] );
+      threads[i]->start();
+   }
+
+   for( int i = 0; i < CLIENTS; ++i )
+   {
+      void* res;
+      threads[i]->join( res );
+      CHECK( clients[i]->bad() == 0 );
+      delete clients[i];
+   }
+
+   // every session found or created is either alive, expired or closed.
+   SessionManager::ShardStats total;
+   totals( sm, total );
+   CHECK( total.m_misses + total.m_created == total.m_sessions + total.m_expired + total.m_closed );
+   CHECK( total.m_hits + total.m_misses + total.m_busy == CLIENTS * ROUNDS );
+
+   // and the released ones expire.
+   pause( 3500 );
+   totals( sm, total );
+   CHECK( total.m_sessions == 0 );
+   CHECK( total.m_scheduled == 0 );
+   CHECK( total.m_misses + total.m_created == total.m_expired + total.m_closed );
+}
+
+
+int main( int, char* [] )
+{
+   Engine::Init();
+
+   testLifecycle();
+   testConcurrency();
+
+   Engine::Shutdown();
+
+   return testResult();
+}
+
+/* end of session_test.cpp */
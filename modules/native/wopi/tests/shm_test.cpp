@@ -0,0 +1,188 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: shm_test.cpp
+
+   Falcon Web Oriented Programming Interface
+
+   Shared memory session store test.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 19:02:16 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/*
+   Stores sessions in a small shared memory store and restores them
+   through a second manager opening the same store, as another process
+   would, then lets them expire.
+
+   Returns 0 on success, printing the failed checks otherwise.
+*/
+
+#include <falcon/engine.h>
+#include <falcon/stringstream.h>
+#include <falcon/wopi/shm_sm.h>
+
+#include "wopi_test.h"
+
+using namespace Falcon;
+using namespace Falcon::WOPI;
+
+// a store small enough to be filled.
+#define STORE_NAME "wopi_test"
+#define STORE_SLOTS 16
+#define STORE_BLOCKS 64
+#define STORE_BLOCK_SIZE 64
+
+static void setField( SessionData* sd, const String& key, const Item& value )
+{
+   sd->data()->put( SafeItem( new CoreString( key ) ), value );
+}
+
+static Item* field( SessionData* sd, const String& key )
+{
+   return sd->data()->find( key );
+}
+
+static void testStoreRestore()
+{
+   String longText;
+   for( int i = 0; i < 20; ++i )
+      longText += "0123456789";
+
+   ShmSessionManager sm( STORE_NAME, STORE_SLOTS, STORE_BLOCKS, STORE_BLOCK_SIZE );
+   sm.timeout( 1 );
+   sm.startup();
+
+   // the data spans several blocks.
+   uint32 token = sm.getSessionToken();
+   SessionData* sd = sm.startSession( token );
+   CHECK( sd != 0 );
+   String sSID = sd->sID();
+   setField( sd, "text", SafeItem( new CoreString( longText ) ) );
+   setField( sd, "count", (int64) 42 );
+   sm.releaseSessions( token );
+   CHECK( sd->lastError() == 0 );
+
+   StringStream ss;
+   uint32 version = 0;
+   CHECK( sm.readSession( sSID, ss, version ) );
+   CHECK( version != 0 );
+
+   // another process resumes and changes it.
+   uint32 newVersion = 0;
+   {
+      ShmSessionManager other( STORE_NAME, STORE_SLOTS, STORE_BLOCKS, STORE_BLOCK_SIZE );
+      other.startup();
+
+      uint32 token2 = other.getSessionToken();
+      SessionData* sd2 = other.getSession( sSID, token2 );
+      CHECK( sd2 != 0 );
+      if( sd2 != 0 )
+      {
+         Item* i_text = field( sd2, "text" );
+         CHECK( i_text != 0 && i_text->isString() && *i_text->asString() == longText );
+         Item* i_count = field( sd2, "count" );
+         CHECK( i_count != 0 && i_count->isInteger() && i_count->asInteger() == 42 );
+         Item* i_sid = field( sd2, "SID" );
+         CHECK( i_sid != 0 && i_sid->isString() && *i_sid->asString() == sSID );
+
+         setField( sd2, "count", (int64) 43 );
+      }
+      other.releaseSessions( token2 );
+
+      CHECK( other.readSession( sSID, ss, newVersion ) );
+      CHECK( newVersion != version );
+   }
+
+   // our copy expires, but it's older than the stored one, which stays.
+   pause( 2500 );
+   uint32 storedVersion = 0;
+   CHECK( sm.readSession( sSID, ss, storedVersion ) );
+   CHECK( storedVersion == newVersion );
+   CHECK( ! sm.removeSession( sSID, version ) );
+
+   // and so it's resumed with the changes.
+   token = sm.getSessionToken();
+   sd = sm.getSession( sSID, token );
+   CHECK( sd != 0 );
+   if( sd != 0 )
+   {
+      Item* i_count = field( sd, "count" );
+      CHECK( i_count != 0 && i_count->isInteger() && i_count->asInteger() == 43 );
+   }
+
+   // closing the session removes it from the store.
+   CHECK( sm.closeSession( sSID, token ) );
+   sm.releaseSessions( token );
+   CHECK( ! sm.readSession( sSID, ss, storedVersion ) );
+
+   // sessions that were never stored can't be resumed.
+   CHECK( sm.getSession( "not stored", token ) == 0 );
+
+   // data larger than the store is refused.
+   String huge;
+   for( int i = 0; i < STORE_BLOCKS * STORE_BLOCK_SIZE / 10; ++i )
+      huge += "0123456789";
+   CHECK( ! sm.writeSession( "huge", huge.getRawStorage(), huge.size(), storedVersion ) );
+   CHECK( ! sm.readSession( "huge", ss, storedVersion ) );
+}
+
+static void testExpire()
+{
+   ShmSessionManager sm( STORE_NAME, STORE_SLOTS, STORE_BLOCKS, STORE_BLOCK_SIZE );
+   sm.timeout( 1 );
+   sm.startup();
+
+   // released sessions are removed from the store when expired.
+   uint32 token = sm.getSessionToken();
+   SessionData* sd = sm.startSession( token );
+   String sSID = sd->sID();
+   sm.releaseSessions( token );
+
+   StringStream ss;
+   uint32 version;
+   CHECK( sm.readSession( sSID, ss, version ) );
+   pause( 2500 );
+   CHECK( ! sm.readSession( sSID, ss, version ) );
+
+   // the sessions left by other processes are purged after the timeout.
+   String data = "data";
+   CHECK( sm.writeSession( "left", data.getRawStorage(), data.size(), version ) );
+   CHECK( sm.purgeExpired() == 0 );
+   pause( 1500 );
+   CHECK( sm.purgeExpired() == 1 );
+   CHECK( ! sm.readSession( "left", ss, version ) );
+
+   // the same store can't be opened with another geometry.
+   bool bRaised = false;
+   try
+   {
+      ShmSessionManager other( STORE_NAME, STORE_SLOTS * 2, STORE_BLOCKS, STORE_BLOCK_SIZE );
+   }
+   catch( Error* e )
+   {
+      bRaised = true;
+      e->decref();
+   }
+   CHECK( bRaised );
+}
+
+
+int main( int, char* [] )
+{
+   Engine::Init();
+
+   testStoreRestore();
+   testExpire();
+
+   Engine::Shutdown();
+
+   return testResult();
+}
+
+/* end of shm_test.cpp */
@@ -0,0 +1,63 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: wopi_test.h
+
+   Falcon Web Oriented Programming Interface
+
+   Helpers shared by the WOPI tests.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Mon, 19 Oct 2026 21:14:08 +0200
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/*
+   Each test program includes this once; the checks print the failed
+   conditions and count them, and testResult() turns the count into
+   the exit code of main().
+*/
+
+#ifndef FALCON_WOPI_TEST_H
+#define FALCON_WOPI_TEST_H
+
+#include <falcon/mt.h>
+
+#include <stdio.h>
+
+static int s_failures = 0;
+
+#define CHECK( cond ) \
+   do { \
+      if( ! (cond) ) { \
+         printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond ); \
+         ++s_failures; \
+      } \
+   } while( 0 )
+
+// waits for the expiration thread to sweep.
+static void pause( Falcon::int32 msecs )
+{
+   Falcon::Event ev;
+   ev.wait( msecs );
+}
+
+// reports the outcome of the checks; returns the exit code.
+static int testResult()
+{
+   if( s_failures != 0 )
+   {
+      printf( "%d checks failed.\n", s_failures );
+      return 1;
+   }
+
+   printf( "Success.\n" );
+   return 0;
+}
+
+#endif
+
+/* end of wopi_test.h */